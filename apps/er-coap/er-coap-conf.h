@@ -53,6 +53,27 @@
 #define COAP_MAX_OPEN_TRANSACTIONS     4
 #endif /* COAP_MAX_OPEN_TRANSACTIONS */
 
+/*
+ * CoCoA congestion control: the retransmission timeout of each destination
+ * follows its round-trip time, estimated from exchanges with (weak) and
+ * without (strong) retransmissions, and at most COAP_NSTART confirmable
+ * messages are outstanding per destination. 0 keeps the fixed
+ * COAP_RESPONSE_TIMEOUT for every destination.
+ */
+#ifndef COAP_CONGESTION_CONTROL
+#define COAP_CONGESTION_CONTROL        0
+#endif /* COAP_CONGESTION_CONTROL */
+
+/* Number of destinations the round-trip time is estimated for */
+#ifndef COAP_MAX_PEERS
+#define COAP_MAX_PEERS                 4
+#endif /* COAP_MAX_PEERS */
+
+/* Confirmable messages outstanding per destination, the others wait */
+#ifndef COAP_NSTART
+#define COAP_NSTART                    1
+#endif /* COAP_NSTART */
+
 /* Maximum number of failed request attempts before action */
 #ifndef COAP_MAX_ATTEMPTS
 #define COAP_MAX_ATTEMPTS              4
@@ -68,6 +89,32 @@
 #define COAP_MAX_OBSERVERS    COAP_MAX_OPEN_TRANSACTIONS - 1
 #endif /* COAP_MAX_OBSERVERS */
 
+/*
+ * Number of shared buffers a rendered notification is kept in. The
+ * representation is rendered once per notification and fanned out to all
+ * observers from one buffer; a buffer is held until the last confirmable
+ * notification referencing it is acknowledged. Observers do not use
+ * transactions, so COAP_MAX_OBSERVERS is independent of
+ * COAP_MAX_OPEN_TRANSACTIONS.
+ */
+#ifndef COAP_MAX_NOTIFICATION_BUFFERS
+#define COAP_MAX_NOTIFICATION_BUFFERS  2
+#endif /* COAP_MAX_NOTIFICATION_BUFFERS */
+
+/*
+ * Minimum time in clock ticks between two notifications of the same
+ * resource. Notifications triggered within this interval are coalesced into
+ * one that is sent when it expires. 0 disables the rate limiter.
+ */
+#ifndef COAP_OBSERVE_MIN_INTERVAL
+#define COAP_OBSERVE_MIN_INTERVAL      0
+#endif /* COAP_OBSERVE_MIN_INTERVAL */
+
+/* Number of resources that can be rate-limited at the same time */
+#ifndef COAP_MAX_OBSERVABLES
+#define COAP_MAX_OBSERVABLES           4
+#endif /* COAP_MAX_OBSERVABLES */
+
 /* Interval in notifies in which NON notifies are changed to CON notifies to check client. */
 #define COAP_OBSERVE_REFRESH_INTERVAL  9999
 
@@ -233,6 +233,9 @@ coap_receive(void)
         } else if(message->type == COAP_TYPE_ACK) {
           /* transactions are closed through lookup below */
           PRINTF("Received ACK\n");
+          /* confirmable notifications are not kept in transactions */
+          coap_observe_ack(&UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport,
+                           message->mid);
         } else if(message->type == COAP_TYPE_RST) {
           PRINTF("Received RST\n");
           /* cancel possible subscriptions */
@@ -245,7 +248,7 @@ coap_receive(void)
           restful_response_handler callback = transaction->callback;
           void *callback_data = transaction->callback_data;
 
-          coap_clear_transaction(transaction);
+          coap_complete_transaction(transaction);
 
           /* check if someone registered for the response */
           if(callback) {
@@ -264,6 +267,20 @@ coap_receive(void)
                                    message);
         }
 #endif /* COAP_OBSERVE_CLIENT */
+
+#if COAP_PROXY
+        /* separate response to a request forwarded by the proxy */
+        if((message->type == COAP_TYPE_CON || message->type == COAP_TYPE_NON)
+           && message->code != 0 && !IS_OPTION(message, COAP_OPTION_OBSERVE)
+           && coap_proxy_handle_response(&UIP_IP_BUF->srcipaddr,
+                                         UIP_UDP_BUF->srcport, message)
+           && message->type == COAP_TYPE_CON) {
+          coap_init_message(message, COAP_TYPE_ACK, 0, message->mid);
+          coap_send_message(&UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport,
+                            uip_appdata, coap_serialize_message(message,
+                                                                uip_appdata));
+        }
+#endif /* COAP_PROXY */
       } /* request or response */
     } /* parsed correctly */
 
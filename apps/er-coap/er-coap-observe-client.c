@@ -46,7 +46,7 @@
 /* Compile this code only if client-side support for CoAP Observe is required */
 #if COAP_OBSERVE_CLIENT
 
-#define DEBUG 1
+#define DEBUG 0
 #if DEBUG
 #define PRINTF(...) printf(__VA_ARGS__)
 #define PRINT6ADDR(addr) PRINTF("[%02x%02x:%02x%02x:%02x%02x:%02x%02x:" \
@@ -182,7 +182,7 @@ coap_obs_remove_observee_by_url(uip_ipaddr_t *addr, uint16_t port,
     PRINTF("Remove check URL %s\n", url);
     if(uip_ipaddr_cmp(&obs->addr, addr)
        && obs->port == port
-       && (obs->url == url || memcmp(obs->url, url, strlen(obs->url)) == 0)) {
+       && (obs->url == url || strcmp(obs->url, url) == 0)) {
       coap_obs_remove_observee(obs);
       removed++;
     }
@@ -55,12 +55,26 @@
 /*---------------------------------------------------------------------------*/
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
 LIST(observers_list);
+MEMB(notification_buffers_memb, coap_notification_buffer_t,
+     COAP_MAX_NOTIFICATION_BUFFERS);
+#if COAP_OBSERVE_MIN_INTERVAL
+MEMB(observables_memb, coap_observable_t, COAP_MAX_OBSERVABLES);
+LIST(observables_list);
+
+/* what a rate-limited resource still has to notify */
+#define OBSERVABLE_PENDING_SUBPATH  1
+#define OBSERVABLE_PENDING_ALL      2
+#endif /* COAP_OBSERVE_MIN_INTERVAL */
+
+/* notifications are assembled in place in the outgoing uIP buffer */
+#define NOTIFICATION_PACKET ((uint8_t *)&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN])
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 static coap_observer_t *
-add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
-             size_t token_len, const char *uri, int uri_len)
+add_observer(resource_t *resource, uip_ipaddr_t *addr, uint16_t port,
+             const uint8_t *token, size_t token_len, const char *uri,
+             int uri_len)
 {
   /* Remove existing observe relationship, if any. */
   coap_remove_observer_by_uri(addr, port, uri);
@@ -72,6 +86,7 @@ add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
     if(max > uri_len) {
       max = uri_len;
     }
+    o->resource = resource;
     memcpy(o->url, uri, max);
     o->url[max] = 0;
     uip_ipaddr_copy(&o->addr, addr);
@@ -79,6 +94,8 @@ add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
     o->token_len = token_len;
     memcpy(o->token, token, token_len);
     o->last_mid = 0;
+    o->pending = NULL;
+    o->retrans_counter = 0;
 
     PRINTF("Adding observer (%u/%u) for /%s [0x%02X%02X]\n",
            list_length(observers_list) + 1, COAP_MAX_OBSERVERS,
@@ -89,6 +106,23 @@ add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
   return o;
 }
 /*---------------------------------------------------------------------------*/
+static void
+release_notification(coap_notification_buffer_t *n)
+{
+  if(n != NULL && --n->refcount == 0) {
+    memb_free(&notification_buffers_memb, n);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+clear_pending_notification(coap_observer_t *o)
+{
+  ctimer_stop(&o->retrans_timer);
+  release_notification(o->pending);
+  o->pending = NULL;
+  o->retrans_counter = 0;
+}
+/*---------------------------------------------------------------------------*/
 /*- Removal -----------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 void
@@ -97,8 +131,9 @@ coap_remove_observer(coap_observer_t *o)
   PRINTF("Removing observer for /%s [0x%02X%02X]\n", o->url, o->token[0],
          o->token[1]);
 
-  memb_free(&observers_memb, o);
+  clear_pending_notification(o);
   list_remove(observers_list, o);
+  memb_free(&observers_memb, o);
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -180,18 +215,148 @@ coap_remove_observer_by_mid(uip_ipaddr_t *addr, uint16_t port, uint16_t mid)
 /*---------------------------------------------------------------------------*/
 /*- Notification ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
-void
-coap_notify_observers(resource_t *resource)
+/*
+ * Finds the Observe option in a rendered notification. The token is empty
+ * and the option value a placeholder; both are filled in per observer.
+ */
+static void
+locate_observe_option(coap_notification_buffer_t *n)
 {
-  coap_notify_observers_sub(resource, NULL);
+  coap_option_iterator_t it;
+  const uint8_t *start;
+
+  n->observe_offset = COAP_HEADER_LEN;
+  n->observe_end = COAP_HEADER_LEN;
+
+  coap_option_iterator_init(&it, n->buffer, n->len);
+  start = it.next;
+  while(coap_option_next(&it) > 0 && it.number <= COAP_OPTION_OBSERVE) {
+    if(it.number == COAP_OPTION_OBSERVE) {
+      n->observe_offset = start - n->buffer;
+      n->observe_end = it.next - n->buffer;
+      return;
+    }
+    start = it.next;
+  }
 }
-void
-coap_notify_observers_sub(resource_t *resource, const char *subpath)
+/*---------------------------------------------------------------------------*/
+static coap_notification_buffer_t *
+render_notification(resource_t *resource, const char *url)
+{
+  /* static declaration reduces stack peaks */
+  static coap_packet_t notification[1];
+  static coap_packet_t request[1];
+  coap_notification_buffer_t *n;
+
+  n = memb_alloc(&notification_buffers_memb);
+  if(n == NULL) {
+    PRINTF("Observe: no notification buffer for %s\n", url);
+    return NULL;
+  }
+
+  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
+  /* create a "fake" request for the URI */
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, url);
+
+  resource->get_handler(request, notification,
+                        n->buffer + COAP_MAX_HEADER_SIZE,
+                        REST_MAX_CHUNK_SIZE, NULL);
+
+  if(notification->code < BAD_REQUEST_4_00) {
+    /* longest encoding, so that any per-observer value fits */
+    coap_set_header_observe(notification, 0xffffff);
+  }
+
+  n->len = coap_serialize_message(notification, n->buffer);
+  /* leave room for the longest token the observers may have */
+  if(n->len == 0 || n->len - notification->payload_len + COAP_TOKEN_LEN
+     > COAP_MAX_HEADER_SIZE) {
+    PRINTF("Observe: cannot serialize notification for %s\n", url);
+    memb_free(&notification_buffers_memb, n);
+    return NULL;
+  }
+
+  locate_observe_option(n);
+  n->refcount = 0;
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_notification(coap_observer_t *obs, coap_notification_buffer_t *n,
+                  coap_message_type_t type)
+{
+  uint8_t *packet = NOTIFICATION_PACKET;
+  coap_message_writer_t writer;
+  uint8_t *p;
+  uint32_t observe;
+  uint8_t len;
+
+  /* per-observer header and token */
+  coap_message_writer_init(&writer, packet, COAP_MAX_HEADER_SIZE, type,
+                           n->buffer[1], obs->last_mid, obs->token,
+                           obs->token_len);
+  p = writer.current;
+
+  /* shared options preceding the Observe option */
+  memcpy(p, n->buffer + COAP_HEADER_LEN, n->observe_offset - COAP_HEADER_LEN);
+  p += n->observe_offset - COAP_HEADER_LEN;
+
+  if(n->observe_end > n->observe_offset) {
+    /* the counter was advanced when this notification was first sent */
+    observe = (obs->obs_counter - 1) & 0xffffff;
+    len = observe > 0xffff ? 3 : observe > 0xff ? 2 : observe ? 1 : 0;
+    /* the delta only depends on the preceding options, keep it */
+    *p++ = (n->buffer[n->observe_offset] & 0xF0) | len;
+    while(len > 0) {
+      --len;
+      *p++ = (uint8_t)(observe >> (8 * len));
+    }
+  }
+
+  /* shared options following the Observe option and the payload */
+  memcpy(p, n->buffer + n->observe_end, n->len - n->observe_end);
+  p += n->len - n->observe_end;
+
+  PRINTF("           Observer ");
+  PRINT6ADDR(&obs->addr);
+  PRINTF(":%u MID %u\n", obs->port, obs->last_mid);
+
+  coap_send_message(&obs->addr, obs->port, packet, p - packet);
+}
+/*---------------------------------------------------------------------------*/
+static void
+retransmit_notification(void *ptr)
 {
-  /* build notification */
-  coap_packet_t notification[1]; /* this way the packet can be treated as pointer as usual */
-  coap_packet_t request[1]; /* this way the packet can be treated as pointer as usual */
+  coap_observer_t *obs = ptr;
+  uip_ipaddr_t addr;
+  uint16_t port;
+
+  if(obs->retrans_counter < COAP_MAX_RETRANSMIT) {
+    ++(obs->retrans_counter);
+    PRINTF("Retransmitting notification %u (%u)\n", obs->last_mid,
+           obs->retrans_counter);
+    send_notification(obs, obs->pending, COAP_TYPE_CON);
+    ctimer_set(&obs->retrans_timer,
+               coap_backoff_timeout(&obs->addr,
+                                    obs->retrans_timer.etimer.timer.interval),
+               retransmit_notification, obs);
+  } else {
+    PRINTF("Notification timeout\n");
+    /* handle observers as a timed out transaction does */
+    uip_ipaddr_copy(&addr, &obs->addr);
+    port = obs->port;
+    coap_remove_observer_by_client(&addr, port);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+notify_observers(resource_t *resource, const char *subpath)
+{
+  coap_notification_buffer_t *n = NULL;
   coap_observer_t *obs = NULL;
+  coap_message_type_t type;
+  int superseded;
   int url_len, obs_url_len;
   char url[COAP_OBSERVER_URL_LEN];
 
@@ -205,68 +370,168 @@ coap_notify_observers_sub(resource_t *resource, const char *subpath)
   /* url now contains the notify URL that needs to match the observer */
   PRINTF("Observe: Notification from %s\n", url);
 
-  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
-  /* create a "fake" request for the URI */
-  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
-  coap_set_header_uri_path(request, url);
-
   /* iterate over observers */
   url_len = strlen(url);
   for(obs = (coap_observer_t *)list_head(observers_list); obs;
       obs = obs->next) {
+    if(obs->resource != resource) {
+      continue;
+    }
     obs_url_len = strlen(obs->url);
 
-    /* Do a match based on the parent/sub-resource match so that it is
-       possible to do parent-node observe */
-    if((obs_url_len == url_len
-        || (obs_url_len > url_len
-            && (resource->flags & HAS_SUB_RESOURCES)
-            && obs->url[url_len] == '/'))
-       && strncmp(url, obs->url, url_len) == 0) {
-      coap_transaction_t *transaction = NULL;
-
-      /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
-      
-      if((transaction = coap_new_transaction(coap_get_mid(), &obs->addr, obs->port))) {
-
-        // disable this function. by White.
-        
-        if(obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0) {
-          PRINTF("           Force Confirmable for\n");
-          notification->type = COAP_TYPE_CON;
-        }
-        
+    /* The observers of a resource observe it or one of its sub-resources.
+       For a sub-resource, do a match based on the parent/sub-resource
+       match so that it is possible to do parent-node observe */
+    if(subpath == NULL
+       || ((obs_url_len == url_len
+            || (obs_url_len > url_len && obs->url[url_len] == '/'))
+           && strncmp(url, obs->url, url_len) == 0)) {
+
+      /* the representation is the same for all observers: render it once */
+      if(n == NULL && (n = render_notification(resource, url)) == NULL) {
+        return 0;
+      }
 
-        PRINTF("           Observer ");
-        PRINT6ADDR(&obs->addr);
-        PRINTF(":%u\n", obs->port);
+      /* a newer state replaces an unacknowledged one, but keeps its timer */
+      superseded = obs->pending != NULL;
+      if(superseded) {
+        release_notification(obs->pending);
+        obs->pending = NULL;
+      }
 
-        /* update last MID for RST matching */
-        obs->last_mid = transaction->mid;
+      type = COAP_TYPE_NON;
+      if(superseded || obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0) {
+        PRINTF("           Force Confirmable for\n");
+        type = COAP_TYPE_CON;
+      }
 
-        /* prepare response */
-        notification->mid = transaction->mid;
+      /* update last MID for RST matching */
+      obs->last_mid = coap_get_mid();
 
-        resource->get_handler(request, notification,
-                              transaction->packet + COAP_MAX_HEADER_SIZE,
-                              REST_MAX_CHUNK_SIZE, NULL);
+      if(n->observe_end > n->observe_offset) {
+        (obs->obs_counter)++;
+        /* mask out to keep the CoAP observe option length <= 3 bytes */
+        obs->obs_counter &= 0xffffff;
+      }
 
-        if(notification->code < BAD_REQUEST_4_00) {
-          coap_set_header_observe(notification, (obs->obs_counter)++);
-          /* mask out to keep the CoAP observe option length <= 3 bytes */
-          obs->obs_counter &= 0xffffff;
+      if(type == COAP_TYPE_CON) {
+        obs->pending = n;
+        ++(n->refcount);
+        if(!superseded) {
+          obs->retrans_counter = 0;
+          ctimer_set(&obs->retrans_timer, coap_initial_timeout(&obs->addr),
+                     retransmit_notification, obs);
         }
-        coap_set_token(notification, obs->token, obs->token_len);
+      }
 
-        transaction->packet_len =
-          coap_serialize_message(notification, transaction->packet);
+      send_notification(obs, n, type);
+    }
+  }
 
-        coap_send_transaction(transaction);
-      }
+  /* only confirmable notifications keep the buffer */
+  if(n != NULL && n->refcount == 0) {
+    memb_free(&notification_buffers_memb, n);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+#if COAP_OBSERVE_MIN_INTERVAL
+static void
+defer_notification(coap_observable_t *o, const char *subpath)
+{
+  if(subpath != NULL
+     && (o->pending == 0
+         || (o->pending == OBSERVABLE_PENDING_SUBPATH
+             && strncmp(o->subpath, subpath, sizeof(o->subpath) - 1) == 0))) {
+    strncpy(o->subpath, subpath, sizeof(o->subpath) - 1);
+    o->subpath[sizeof(o->subpath) - 1] = '\0';
+    o->pending = OBSERVABLE_PENDING_SUBPATH;
+  } else {
+    /* different sub-resources changed: notify the whole resource */
+    o->pending = OBSERVABLE_PENDING_ALL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+holdoff_expired(void *ptr)
+{
+  coap_observable_t *o = ptr;
+  uint8_t pending = o->pending;
+
+  if(pending) {
+    PRINTF("Observe: sending deferred notification for %s\n",
+           o->resource->url);
+    o->pending = 0;
+    /* the next interval starts with this notification */
+    ctimer_restart(&o->holdoff_timer);
+    if(!notify_observers(o->resource, pending == OBSERVABLE_PENDING_SUBPATH
+                         ? o->subpath : NULL)) {
+      o->pending = pending;
+    }
+  } else {
+    list_remove(observables_list, o);
+    memb_free(&observables_memb, o);
+  }
+}
+#endif /* COAP_OBSERVE_MIN_INTERVAL */
+/*---------------------------------------------------------------------------*/
+void
+coap_notify_observers(resource_t *resource)
+{
+  coap_notify_observers_sub(resource, NULL);
+}
+void
+coap_notify_observers_sub(resource_t *resource, const char *subpath)
+{
+#if COAP_OBSERVE_MIN_INTERVAL
+  coap_observable_t *o;
+
+  for(o = (coap_observable_t *)list_head(observables_list); o; o = o->next) {
+    if(o->resource == resource) {
+      /* notified recently: coalesce into one when the interval expires */
+      defer_notification(o, subpath);
+      return;
+    }
+  }
+
+  if((o = memb_alloc(&observables_memb)) != NULL) {
+    o->resource = resource;
+    o->pending = 0;
+    list_add(observables_list, o);
+    ctimer_set(&o->holdoff_timer, COAP_OBSERVE_MIN_INTERVAL,
+               holdoff_expired, o);
+  }
+
+  if(!notify_observers(resource, subpath) && o != NULL) {
+    /* out of notification buffers: try again when the interval expires */
+    defer_notification(o, subpath);
+  }
+#else /* COAP_OBSERVE_MIN_INTERVAL */
+  notify_observers(resource, subpath);
+#endif /* COAP_OBSERVE_MIN_INTERVAL */
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_observe_ack(uip_ipaddr_t *addr, uint16_t port, uint16_t mid)
+{
+  coap_observer_t *obs = NULL;
+
+  for(obs = (coap_observer_t *)list_head(observers_list); obs;
+      obs = obs->next) {
+    if(obs->pending != NULL && obs->last_mid == mid
+       && uip_ipaddr_cmp(&obs->addr, addr) && obs->port == port) {
+      PRINTF("Notification %u acknowledged\n", mid);
+      clear_pending_notification(obs);
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+list_t
+coap_get_observers(void)
+{
+  return observers_list;
+}
+/*---------------------------------------------------------------------------*/
 void
 coap_observe_handler(resource_t *resource, void *request, void *response)
 {
@@ -277,7 +542,8 @@ coap_observe_handler(resource_t *resource, void *request, void *response)
   if(coap_req->code == COAP_GET && coap_res->code < 128) { /* GET request and response without error code */
     if(IS_OPTION(coap_req, COAP_OPTION_OBSERVE)) {
       if(coap_req->observe == 0) {
-        obs = add_observer(&UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport,
+        obs = add_observer(resource, &UIP_IP_BUF->srcipaddr,
+                           UIP_UDP_BUF->srcport,
                            coap_req->token, coap_req->token_len,
                            coap_req->uri_path, coap_req->uri_path_len);
         if(obs) {
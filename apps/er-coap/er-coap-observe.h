@@ -43,19 +43,33 @@
 #include "er-coap-transactions.h"
 #include "stimer.h"
 
+#ifndef COAP_OBSERVER_URL_LEN
 #define COAP_OBSERVER_URL_LEN 20
+#endif
 
-typedef struct coap_observable {
-  uint32_t observe_clock;
-  struct stimer orphan_timer;
-  list_t observers;
-  coap_packet_t notification;
+/* a notification rendered once and shared by all observers it goes to */
+typedef struct coap_notification_buffer {
+  uint8_t refcount;
+  uint16_t len;
+  uint16_t observe_offset;      /* start of the Observe option in buffer */
+  uint16_t observe_end;         /* first byte after the Observe option */
   uint8_t buffer[COAP_MAX_PACKET_SIZE + 1];
+} coap_notification_buffer_t;
+
+/* rate limiter state of a resource that notified recently */
+typedef struct coap_observable {
+  struct coap_observable *next; /* for LIST */
+
+  resource_t *resource;
+  struct ctimer holdoff_timer;
+  uint8_t pending;
+  char subpath[COAP_OBSERVER_URL_LEN];
 } coap_observable_t;
 
 typedef struct coap_observer {
   struct coap_observer *next;   /* for LIST */
 
+  resource_t *resource;         /* as resolved when the observer registered */
   char url[COAP_OBSERVER_URL_LEN];
   uip_ipaddr_t addr;
   uint16_t port;
@@ -65,7 +79,9 @@ typedef struct coap_observer {
 
   int32_t obs_counter;
 
-  struct etimer retrans_timer;
+  /* confirmable notification waiting for an ACK, if any */
+  coap_notification_buffer_t *pending;
+  struct ctimer retrans_timer;
   uint8_t retrans_counter;
 } coap_observer_t;
 
@@ -78,6 +94,7 @@ int coap_remove_observer_by_uri(uip_ipaddr_t *addr, uint16_t port,
                                 const char *uri);
 int coap_remove_observer_by_mid(uip_ipaddr_t *addr, uint16_t port,
                                 uint16_t mid);
+void coap_observe_ack(uip_ipaddr_t *addr, uint16_t port, uint16_t mid);
 
 void coap_notify_observers(resource_t *resource);
 void coap_notify_observers_sub(resource_t *resource, const char *subpath);
@@ -0,0 +1,846 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *      Caching CoAP-to-CoAP reverse proxy for a border router
+ *
+ *      Requests to /proxy/<node address>/<path> are answered from an LRU
+ *      cache keyed by URI and Accept, or forwarded to the node. Cached
+ *      representations are served until their Max-Age expires and then
+ *      revalidated with their ETag. Any number of clients can observe a
+ *      resource through the proxy; the node sees a single observer.
+ */
+
+#include <string.h>
+
+#include "contiki.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include "net/ip/uiplib.h"
+#include "er-coap-engine.h"
+
+#if COAP_PROXY
+
+#if !COAP_OBSERVE_CLIENT
+#error "The CoAP proxy observes the nodes: set COAP_OBSERVE_CLIENT"
+#endif
+
+#if COAP_OBSERVE_MIN_INTERVAL
+#error "The CoAP proxy notifies every URL on its own: set COAP_OBSERVE_MIN_INTERVAL to 0"
+#endif
+
+#define DEBUG 0
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+#define UPSTREAM_PORT UIP_HTONS(COAP_DEFAULT_PORT)
+
+/* length of "<COAP_PROXY_PATH>/" */
+#define PREFIX_LEN    ((int)sizeof(COAP_PROXY_PATH))
+
+#define FLAG_SEND     0x01      /* request to send to the node */
+#define FLAG_FETCHING 0x02      /* request sent, no response yet */
+#define FLAG_REGISTER 0x04      /* the request carries Observe */
+#define FLAG_ANSWER   0x08      /* waiting requests to answer */
+#define FLAG_NOTIFY   0x10      /* observers to notify */
+#define FLAG_OBSERVE  0x20      /* clients observe the entry */
+#define FLAG_CANCEL   0x40      /* the node does not notify the entry */
+#define FLAG_FORWARD  0x80      /* POST, PUT or DELETE, never cached */
+
+typedef struct proxy_entry {
+  struct proxy_entry *next;     /* for LIST, most recently used first */
+
+  /* the cache key */
+  char url[COAP_PROXY_URL_LEN]; /* "<node address>/<path>" */
+  char query[COAP_PROXY_QUERY_LEN];
+  uint8_t has_accept;
+  uint16_t accept;
+
+  uip_ipaddr_t addr;
+  const char *path;             /* into url */
+  uint8_t method;
+  uint8_t flags;
+  uint8_t valid;                /* holds a representation to serve or revalidate */
+  uint8_t token_len;
+  uint8_t token[COAP_TOKEN_LEN];
+  coap_observee_t *observee;
+  struct ctimer separate_timer;
+  struct stimer max_age;
+
+  /* last response of the node, or the payload to forward */
+  uint8_t code;
+  uint8_t has_format;
+  uint16_t content_format;
+  uint8_t etag_len;
+  uint8_t etag[COAP_ETAG_LEN];
+  uint16_t payload_len;
+  uint8_t payload[REST_MAX_CHUNK_SIZE];
+} proxy_entry_t;
+
+/* a request answered once the node responded */
+typedef struct proxy_waiter {
+  struct proxy_waiter *next;    /* for LIST */
+
+  proxy_entry_t *entry;
+  coap_separate_t request;
+  uint16_t ack_mid;
+  uint8_t ack_pending;
+} proxy_waiter_t;
+
+MEMB(entries_memb, proxy_entry_t, COAP_PROXY_CACHE_ENTRIES);
+LIST(entries_list);
+MEMB(waiters_memb, proxy_waiter_t, COAP_PROXY_MAX_WAITING);
+LIST(waiters_list);
+
+struct coap_proxy_stats coap_proxy_stat;
+
+PROCESS(coap_proxy_process, "CoAP proxy");
+
+static void res_proxy_handler(void *request, void *response,
+                              uint8_t *buffer, uint16_t preferred_size,
+                              int32_t *offset);
+
+resource_t res_coap_proxy = {
+  NULL, NULL, HAS_SUB_RESOURCES | IS_OBSERVABLE, "title=\"CoAP proxy\";obs",
+  res_proxy_handler, res_proxy_handler, res_proxy_handler, res_proxy_handler,
+  { NULL }
+};
+/*---------------------------------------------------------------------------*/
+/*- Cache -------------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static int
+has_waiters(proxy_entry_t *e)
+{
+  proxy_waiter_t *w;
+
+  for(w = list_head(waiters_list); w; w = w->next) {
+    if(w->entry == e) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+free_entry(proxy_entry_t *e)
+{
+  ctimer_stop(&e->separate_timer);
+  if(e->observee != NULL) {
+    coap_obs_remove_observee(e->observee);
+  }
+  list_remove(entries_list, e);
+  memb_free(&entries_memb, e);
+}
+/*---------------------------------------------------------------------------*/
+static proxy_entry_t *
+new_entry(void)
+{
+  proxy_entry_t *e, *victim = NULL;
+
+  if((e = memb_alloc(&entries_memb)) == NULL) {
+    /* evict the least recently used entry that nobody waits for */
+    for(e = list_head(entries_list); e; e = e->next) {
+      if(e->flags == 0 && !has_waiters(e)) {
+        victim = e;
+      }
+    }
+    if(victim == NULL) {
+      return NULL;
+    }
+    PRINTF("Proxy: evicting %s\n", victim->url);
+    ++coap_proxy_stat.evictions;
+    free_entry(victim);
+    e = memb_alloc(&entries_memb);
+  }
+  memset(e, 0, sizeof(*e));
+  list_push(entries_list, e);
+  return e;
+}
+/*---------------------------------------------------------------------------*/
+static proxy_entry_t *
+find_entry(const char *url, const char *query, int has_accept,
+           unsigned int accept)
+{
+  proxy_entry_t *e;
+
+  for(e = list_head(entries_list); e; e = e->next) {
+    if(!(e->flags & FLAG_FORWARD) && strcmp(e->url, url) == 0
+       && strcmp(e->query, query) == 0 && e->has_accept == has_accept
+       && (!has_accept || e->accept == accept)) {
+      return e;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+touch_entry(proxy_entry_t *e)
+{
+  list_remove(entries_list, e);
+  list_push(entries_list, e);
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_fresh(proxy_entry_t *e)
+{
+  return e->valid && !stimer_expired(&e->max_age);
+}
+/*---------------------------------------------------------------------------*/
+/* one URL is the other or below it */
+static int
+is_nested(const char *a, const char *b)
+{
+  size_t a_len = strlen(a);
+  size_t b_len = strlen(b);
+
+  if(a_len > b_len) {
+    return is_nested(b, a);
+  }
+  return strncmp(a, b, a_len) == 0 && (a_len == b_len || b[a_len] == '/');
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Observers are notified by URL only, so an observed entry must be the only
+ * one for its URL and must not share a path with another observed entry.
+ */
+static int
+can_observe(proxy_entry_t *e, const char *url)
+{
+  proxy_entry_t *other;
+
+  if(PREFIX_LEN + strlen(url) >= COAP_OBSERVER_URL_LEN) {
+    return 0;
+  }
+  for(other = list_head(entries_list); other; other = other->next) {
+    if(other != e && (other->flags & FLAG_OBSERVE)
+       && is_nested(other->url, url)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_observed_by(coap_observer_t *obs, proxy_entry_t *e)
+{
+  return obs->resource == &res_coap_proxy
+         && strncmp(obs->url, COAP_PROXY_PATH "/", PREFIX_LEN) == 0
+         && strcmp(obs->url + PREFIX_LEN, e->url) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+has_observers(proxy_entry_t *e)
+{
+  coap_observer_t *obs;
+
+  for(obs = list_head(coap_get_observers()); obs; obs = obs->next) {
+    if(is_observed_by(obs, e)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+stop_observing(proxy_entry_t *e)
+{
+  if(e->observee != NULL) {
+    PRINTF("Proxy: no longer observing %s\n", e->url);
+    coap_obs_remove_observee(e->observee);
+    e->observee = NULL;
+  }
+  e->flags &= ~(FLAG_OBSERVE | FLAG_REGISTER | FLAG_NOTIFY | FLAG_CANCEL);
+}
+/*---------------------------------------------------------------------------*/
+/* the observation of the node ended: so does that of the clients */
+static void
+release_observers(proxy_entry_t *e)
+{
+  coap_observer_t *obs, *next;
+
+  for(obs = list_head(coap_get_observers()); obs; obs = next) {
+    next = obs->next;
+    if(is_observed_by(obs, e)) {
+      coap_remove_observer(obs);
+    }
+  }
+  stop_observing(e);
+}
+/*---------------------------------------------------------------------------*/
+/*- Responses of the nodes --------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static void
+fail_entry(proxy_entry_t *e, uint8_t code)
+{
+  PRINTF("Proxy: %s failed with %u\n", e->url, code);
+  ctimer_stop(&e->separate_timer);
+  if(e->observee != NULL) {
+    coap_obs_remove_observee(e->observee);
+    e->observee = NULL;
+  }
+  e->code = code;
+  e->valid = 0;
+  e->has_format = 0;
+  e->etag_len = 0;
+  e->payload_len = 0;
+  e->flags &= ~(FLAG_FETCHING | FLAG_REGISTER);
+  e->flags |= FLAG_ANSWER;
+  if(e->flags & FLAG_OBSERVE) {
+    e->flags |= FLAG_NOTIFY;
+  }
+  process_poll(&coap_proxy_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+invalidate(proxy_entry_t *changed)
+{
+  proxy_entry_t *e;
+
+  for(e = list_head(entries_list); e; e = e->next) {
+    if(!(e->flags & FLAG_FORWARD) && strcmp(e->url, changed->url) == 0) {
+      /* stale, but still worth revalidating */
+      stimer_set(&e->max_age, 0);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+store_response(proxy_entry_t *e, coap_packet_t *response)
+{
+  uint32_t age;
+  unsigned int format;
+  const uint8_t *data;
+
+  ctimer_stop(&e->separate_timer);
+  e->flags &= ~(FLAG_FETCHING | FLAG_REGISTER);
+  coap_get_header_max_age(response, &age);
+
+  if(response->code == VALID_2_03 && e->valid) {
+    PRINTF("Proxy: %s revalidated\n", e->url);
+    ++coap_proxy_stat.revalidated;
+  } else {
+    e->code = response->code;
+    e->has_format = coap_get_header_content_format(response, &format);
+    e->content_format = format;
+    e->etag_len = coap_get_header_etag(response, &data);
+    memcpy(e->etag, data, e->etag_len);
+    e->payload_len = coap_get_payload(response, &data);
+    if(e->payload_len > sizeof(e->payload)
+       || (IS_OPTION(response, COAP_OPTION_BLOCK2) && response->block2_more)) {
+      /* blockwise transfers are not proxied */
+      e->code = BAD_GATEWAY_5_02;
+      e->has_format = 0;
+      e->etag_len = 0;
+      e->payload_len = 0;
+    }
+    memcpy(e->payload, data, e->payload_len);
+    e->valid = !(e->flags & FLAG_FORWARD) && e->code == CONTENT_2_05;
+  }
+  stimer_set(&e->max_age, e->valid ? age : 0);
+
+  if((e->flags & FLAG_FORWARD) && (e->code == CREATED_2_01
+                                   || e->code == DELETED_2_02
+                                   || e->code == CHANGED_2_04)) {
+    invalidate(e);
+  }
+
+  e->flags |= FLAG_ANSWER;
+  if(e->flags & FLAG_OBSERVE) {
+    e->flags |= FLAG_NOTIFY;
+  }
+  process_poll(&coap_proxy_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+separate_timeout(void *ptr)
+{
+  fail_entry((proxy_entry_t *)ptr, GATEWAY_TIMEOUT_5_04);
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_upstream_response(void *data, void *response)
+{
+  proxy_entry_t *const e = (proxy_entry_t *)data;
+  coap_packet_t *const pkt = (coap_packet_t *)response;
+
+  if(pkt == NULL) {
+    fail_entry(e, GATEWAY_TIMEOUT_5_04);
+  } else if(pkt->type == COAP_TYPE_RST) {
+    fail_entry(e, BAD_GATEWAY_5_02);
+  } else if(pkt->code == 0) {
+    /* empty ACK: a separate response follows */
+    ctimer_set(&e->separate_timer, COAP_PROXY_SEPARATE_TIMEOUT,
+               separate_timeout, e);
+  } else {
+    if((e->flags & FLAG_REGISTER)
+       && (pkt->code >= BAD_REQUEST_4_00
+           || !IS_OPTION(pkt, COAP_OPTION_OBSERVE))) {
+      /* the node will not notify: stop observing once this is delivered */
+      if(e->observee != NULL) {
+        coap_obs_remove_observee(e->observee);
+        e->observee = NULL;
+      }
+      e->flags |= FLAG_CANCEL;
+    }
+    store_response(e, pkt);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_notification(coap_observee_t *observee, void *notification,
+                    coap_notification_flag_t flag)
+{
+  proxy_entry_t *const e = (proxy_entry_t *)observee->data;
+
+  ++coap_proxy_stat.notifications;
+  if(flag == ERROR_RESPONSE_CODE) {
+    coap_obs_remove_observee(observee);
+    e->observee = NULL;
+  }
+  store_response(e, (coap_packet_t *)notification);
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_proxy_handle_response(uip_ipaddr_t *addr, uint16_t port,
+                           coap_packet_t *response)
+{
+  proxy_entry_t *e;
+
+  for(e = list_head(entries_list); e; e = e->next) {
+    if((e->flags & FLAG_FETCHING) && port == UPSTREAM_PORT
+       && uip_ipaddr_cmp(&e->addr, addr)
+       && e->token_len == response->token_len
+       && memcmp(e->token, response->token, e->token_len) == 0) {
+      PRINTF("Proxy: separate response for %s\n", e->url);
+      handle_upstream_response(e, response);
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/*- Requests of the clients -------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static void
+serve(proxy_entry_t *e, void *request, void *response)
+{
+  const uint8_t *etag;
+
+  if(e->etag_len) {
+    coap_set_header_etag(response, e->etag, e->etag_len);
+  }
+  if(e->valid) {
+    coap_set_header_max_age(response, stimer_remaining(&e->max_age));
+  }
+  if(request != NULL && e->etag_len
+     && coap_get_header_etag(request, &etag) == e->etag_len
+     && memcmp(etag, e->etag, e->etag_len) == 0) {
+    coap_set_status_code(response, VALID_2_03);
+    return;
+  }
+  coap_set_status_code(response, e->code);
+  if(e->has_format) {
+    coap_set_header_content_format(response, e->content_format);
+  }
+  coap_set_payload(response, e->payload, e->payload_len);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Like coap_separate_accept(), but the empty ACK is left to the proxy
+ * process: sending it here would overwrite the client address in uip_buf,
+ * which the observe handler reads after this resource handler.
+ */
+static int
+add_waiter(proxy_entry_t *e, coap_packet_t *request)
+{
+  proxy_waiter_t *w;
+
+  if((w = memb_alloc(&waiters_memb)) == NULL) {
+    return 0;
+  }
+  memset(w, 0, sizeof(*w));
+  w->entry = e;
+  uip_ipaddr_copy(&w->request.addr, &UIP_IP_BUF->srcipaddr);
+  w->request.port = UIP_UDP_BUF->srcport;
+  w->request.type = request->type == COAP_TYPE_CON
+    ? COAP_TYPE_CON : COAP_TYPE_NON;
+  w->request.mid = coap_get_mid();
+  w->request.token_len = request->token_len;
+  memcpy(w->request.token, request->token, request->token_len);
+  w->ack_mid = request->mid;
+  w->ack_pending = request->type == COAP_TYPE_CON;
+  list_add(waiters_list, w);
+
+  erbium_status_code = MANUAL_RESPONSE;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_proxy_handler(void *request, void *response, uint8_t *buffer,
+                  uint16_t preferred_size, int32_t *offset)
+{
+  coap_packet_t *const req = (coap_packet_t *)request;
+  char url[COAP_PROXY_URL_LEN];
+  char query[COAP_PROXY_QUERY_LEN];
+  const char *str;
+  const uint8_t *payload;
+  char *path;
+  uip_ipaddr_t addr;
+  unsigned int format;
+  unsigned int accept = 0;
+  int has_accept;
+  int len;
+  proxy_entry_t *e;
+
+  len = coap_get_header_uri_path(request, &str) - PREFIX_LEN;
+  if(len <= 0 || len >= (int)sizeof(url)) {
+    coap_set_status_code(response, BAD_OPTION_4_02);
+    coap_set_payload(response, "BadUri", 6);
+    return;
+  }
+  memcpy(url, str + PREFIX_LEN, len);
+  url[len] = '\0';
+
+  path = strchr(url, '/');
+  if(path == NULL || path == url || path[1] == '\0'
+     || !uiplib_ip6addrconv(url, &addr)) {
+    coap_set_status_code(response, BAD_REQUEST_4_00);
+    coap_set_payload(response, "BadNode", 7);
+    return;
+  }
+
+  if(offset == NULL) {
+    /* rendering a notification: the observed entry of the URL */
+    for(e = list_head(entries_list); e; e = e->next) {
+      if((e->flags & FLAG_OBSERVE) && strcmp(e->url, url) == 0) {
+        serve(e, NULL, response);
+        return;
+      }
+    }
+    coap_set_status_code(response, SERVICE_UNAVAILABLE_5_03);
+    return;
+  }
+
+  ++coap_proxy_stat.requests;
+  len = coap_get_header_uri_query(request, &str);
+  if(len >= (int)sizeof(query)) {
+    coap_set_status_code(response, BAD_OPTION_4_02);
+    coap_set_payload(response, "BadQuery", 8);
+    return;
+  }
+  memcpy(query, str, len);
+  query[len] = '\0';
+  has_accept = coap_get_header_accept(request, &accept);
+
+  if(req->code == COAP_GET) {
+    e = find_entry(url, query, has_accept, accept);
+    if(IS_OPTION(req, COAP_OPTION_OBSERVE) && req->observe == 0
+       && !can_observe(e, url)) {
+      /* serve it, but do not register the client */
+      UNSET_OPTION(req, COAP_OPTION_OBSERVE);
+    }
+    if(e != NULL && is_fresh(e)) {
+      PRINTF("Proxy: hit %s\n", url);
+      ++coap_proxy_stat.hits;
+      touch_entry(e);
+      if(IS_OPTION(req, COAP_OPTION_OBSERVE)) {
+        if(req->observe == 0) {
+          e->flags |= FLAG_OBSERVE;
+        }
+        /* observe the node, or stop once the last client left */
+        process_poll(&coap_proxy_process);
+      }
+      serve(e, request, response);
+      return;
+    }
+  } else {
+    e = NULL;
+  }
+
+  if(e == NULL) {
+    if((e = new_entry()) == NULL) {
+      coap_set_status_code(response, SERVICE_UNAVAILABLE_5_03);
+      coap_set_payload(response, "ProxyFull", 9);
+      return;
+    }
+    strcpy(e->url, url);
+    strcpy(e->query, query);
+    e->path = e->url + (path - url) + 1;
+    uip_ipaddr_copy(&e->addr, &addr);
+    e->method = req->code;
+    if(req->code == COAP_GET) {
+      e->has_accept = has_accept;
+      e->accept = accept;
+    } else {
+      e->flags = FLAG_FORWARD;
+      e->has_format = coap_get_header_content_format(request, &format);
+      e->content_format = format;
+      e->payload_len = coap_get_payload(request, &payload);
+      if(e->payload_len > sizeof(e->payload)) {
+        free_entry(e);
+        coap_set_status_code(response, REQUEST_ENTITY_TOO_LARGE_4_13);
+        return;
+      }
+      memcpy(e->payload, payload, e->payload_len);
+    }
+  } else {
+    touch_entry(e);
+  }
+
+  if(!add_waiter(e, req)) {
+    if(e->flags & FLAG_FORWARD) {
+      free_entry(e);
+    }
+    coap_set_status_code(response, SERVICE_UNAVAILABLE_5_03);
+    coap_set_payload(response, "TooManyWaiting", 14);
+    return;
+  }
+  if(req->code == COAP_GET && IS_OPTION(req, COAP_OPTION_OBSERVE)
+     && req->observe == 0) {
+    e->flags |= FLAG_OBSERVE;
+  }
+  if(!(e->flags & FLAG_FETCHING)) {
+    e->flags |= FLAG_SEND;
+  }
+  process_poll(&coap_proxy_process);
+}
+/*---------------------------------------------------------------------------*/
+/*- Proxy process -----------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static void
+send_upstream(proxy_entry_t *e)
+{
+  static coap_packet_t request[1];
+  coap_transaction_t *t;
+  uint8_t *token;
+
+  e->flags &= ~FLAG_SEND;
+  coap_init_message(request, COAP_TYPE_CON, e->method, coap_get_mid());
+  e->token_len = coap_generate_token(&token);
+  memcpy(e->token, token, e->token_len);
+  coap_set_token(request, e->token, e->token_len);
+  coap_set_header_uri_path(request, e->path);
+  if(e->query[0] != '\0') {
+    coap_set_header_uri_query(request, e->query);
+  }
+
+  if(e->flags & FLAG_FORWARD) {
+    if(e->has_format) {
+      coap_set_header_content_format(request, e->content_format);
+    }
+    coap_set_payload(request, e->payload, e->payload_len);
+  } else {
+    if(e->has_accept) {
+      coap_set_header_accept(request, e->accept);
+    }
+    if(e->valid && e->etag_len) {
+      coap_set_header_etag(request, e->etag, e->etag_len);
+    }
+    if(e->flags & FLAG_OBSERVE) {
+      /* replaces the previous observation of the URL, if any */
+      e->observee = coap_obs_add_observee(&e->addr, UPSTREAM_PORT, e->token,
+                                          e->token_len, e->path,
+                                          handle_notification, e);
+      if(e->observee != NULL) {
+        coap_set_header_observe(request, 0);
+        e->flags |= FLAG_REGISTER;
+      } else {
+        e->flags |= FLAG_CANCEL;
+      }
+    }
+  }
+
+  if((t = coap_new_transaction(request->mid, &e->addr, UPSTREAM_PORT))
+     == NULL) {
+    fail_entry(e, SERVICE_UNAVAILABLE_5_03);
+    return;
+  }
+  t->callback = handle_upstream_response;
+  t->callback_data = e;
+  if((t->packet_len = coap_serialize_message(request, t->packet)) == 0) {
+    coap_clear_transaction(t);
+    fail_entry(e, BAD_GATEWAY_5_02);
+    return;
+  }
+
+  PRINTF("Proxy: forwarding %s\n", e->url);
+  ++coap_proxy_stat.forwarded;
+  e->flags |= FLAG_FETCHING;
+  coap_send_transaction(t);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_acks(void)
+{
+  proxy_waiter_t *w;
+  coap_message_writer_t writer;
+  uint8_t ack[4];
+
+  for(w = list_head(waiters_list); w; w = w->next) {
+    if(w->ack_pending) {
+      coap_message_writer_init(&writer, ack, sizeof(ack), COAP_TYPE_ACK, 0,
+                               w->ack_mid, NULL, 0);
+      coap_send_message(&w->request.addr, w->request.port, ack,
+                        coap_write_payload(&writer, NULL, 0));
+      w->ack_pending = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_observer(proxy_waiter_t *w)
+{
+  coap_observer_t *obs;
+
+  for(obs = list_head(coap_get_observers()); obs; obs = obs->next) {
+    if(is_observed_by(obs, w->entry)
+       && uip_ipaddr_cmp(&obs->addr, &w->request.addr)
+       && obs->port == w->request.port
+       && obs->token_len == w->request.token_len
+       && memcmp(obs->token, w->request.token, obs->token_len) == 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+answer_waiters(proxy_entry_t *e)
+{
+  static coap_packet_t response[1];
+  proxy_waiter_t *w, *next;
+  coap_transaction_t *t;
+
+  for(w = list_head(waiters_list); w; w = next) {
+    next = w->next;
+    if(w->entry != e) {
+      continue;
+    }
+    /* observers get the response as a notification */
+    if(!((e->flags & FLAG_NOTIFY) && is_observer(w))
+       && (t = coap_new_transaction(w->request.mid, &w->request.addr,
+                                    w->request.port)) != NULL) {
+      coap_separate_resume(response, &w->request, e->code);
+      serve(e, NULL, response);
+      if((t->packet_len = coap_serialize_message(response, t->packet))) {
+        coap_send_transaction(t);
+      } else {
+        coap_clear_transaction(t);
+      }
+    }
+    list_remove(waiters_list, w);
+    memb_free(&waiters_memb, w);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+notify(proxy_entry_t *e)
+{
+  char subpath[COAP_PROXY_URL_LEN + 1];
+
+  subpath[0] = '/';
+  strcpy(subpath + 1, e->url);
+  coap_notify_observers_sub(&res_coap_proxy, subpath);
+}
+/*---------------------------------------------------------------------------*/
+static void
+service_entry(proxy_entry_t *e)
+{
+  if((e->flags & FLAG_OBSERVE) && !has_observers(e) && !has_waiters(e)) {
+    /* the last client stopped observing */
+    stop_observing(e);
+  }
+
+  if(e->flags & FLAG_ANSWER) {
+    answer_waiters(e);
+    e->flags &= ~FLAG_ANSWER;
+  }
+  if(e->flags & FLAG_NOTIFY) {
+    e->flags &= ~FLAG_NOTIFY;
+    notify(e);
+    if(e->code >= BAD_REQUEST_4_00 || (e->flags & FLAG_CANCEL)) {
+      release_observers(e);
+    }
+  }
+
+  if((e->flags & FLAG_OBSERVE) && e->observee == NULL
+     && !(e->flags & FLAG_FETCHING)) {
+    e->flags |= FLAG_SEND;
+  }
+  if((e->flags & FLAG_SEND) && !(e->flags & FLAG_FETCHING)) {
+    send_upstream(e);
+  }
+
+  if((e->flags & FLAG_FORWARD) && !(e->flags & (FLAG_SEND | FLAG_FETCHING))
+     && !has_waiters(e)) {
+    free_entry(e);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_proxy_process, ev, data)
+{
+  proxy_entry_t *e, *next;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    /* all sending is done here, never from within the CoAP engine */
+    send_acks();
+    for(e = list_head(entries_list); e; e = next) {
+      next = e->next;
+      service_entry(e);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_proxy_init(void)
+{
+  memb_init(&entries_memb);
+  list_init(entries_list);
+  memb_init(&waiters_memb);
+  list_init(waiters_list);
+  memset(&coap_proxy_stat, 0, sizeof(coap_proxy_stat));
+
+  rest_activate_resource(&res_coap_proxy, COAP_PROXY_PATH);
+  process_start(&coap_proxy_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* COAP_PROXY */
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *      Caching CoAP-to-CoAP reverse proxy for a border router
+ */
+
+#ifndef COAP_PROXY_H_
+#define COAP_PROXY_H_
+
+#include "er-coap.h"
+
+#ifndef COAP_PROXY
+#define COAP_PROXY 0
+#endif
+
+/*
+ * Requests to <COAP_PROXY_PATH>/<node address>/<path> are served from the
+ * cache or forwarded to <path> on the node, port COAP_DEFAULT_PORT.
+ */
+#ifndef COAP_PROXY_PATH
+#define COAP_PROXY_PATH "proxy"
+#endif
+
+/* Representations cached, by URI and Accept, and requests forwarded */
+#ifndef COAP_PROXY_CACHE_ENTRIES
+#define COAP_PROXY_CACHE_ENTRIES 8
+#endif
+
+/* Requests waiting for a node to respond */
+#ifndef COAP_PROXY_MAX_WAITING
+#define COAP_PROXY_MAX_WAITING 8
+#endif
+
+/* Longest "<node address>/<path>" and Uri-Query */
+#ifndef COAP_PROXY_URL_LEN
+#define COAP_PROXY_URL_LEN 64
+#endif
+#ifndef COAP_PROXY_QUERY_LEN
+#define COAP_PROXY_QUERY_LEN 16
+#endif
+
+/* How long to wait for a separate response after the node's empty ACK */
+#ifndef COAP_PROXY_SEPARATE_TIMEOUT
+#define COAP_PROXY_SEPARATE_TIMEOUT (30 * CLOCK_SECOND)
+#endif
+
+struct coap_proxy_stats {
+  uint32_t requests;            /* downstream */
+  uint32_t hits;                /* answered from the cache */
+  uint32_t forwarded;           /* requests sent to the nodes */
+  uint32_t revalidated;         /* 2.03 Valid from the nodes */
+  uint32_t notifications;       /* from the nodes */
+  uint32_t evictions;
+};
+
+extern struct coap_proxy_stats coap_proxy_stat;
+
+void coap_proxy_init(void);
+int coap_proxy_handle_response(uip_ipaddr_t *addr, uint16_t port,
+                               coap_packet_t *response);
+
+#endif /* COAP_PROXY_H_ */
@@ -59,14 +59,210 @@ LIST(transactions_list);
 
 static struct process *transaction_handler_process = NULL;
 
+#if COAP_CONGESTION_CONTROL
+/* CoCoA: RTO = SRTT + K * RTTVAR for the strong and the weak estimator */
+#define COCOA_K_STRONG                  4
+#define COCOA_K_WEAK                    1
+/* RTTs of exchanges with more retransmissions are ambiguous, not used */
+#define COCOA_MAX_WEAK_RETRANSMISSIONS  2
+#define COCOA_MAX_RTO                   (CLOCK_SECOND * 60)
+
+/* round-trip time estimation of a destination */
+typedef struct coap_peer {
+  struct coap_peer *next;       /* for LIST, most recently used first */
+
+  uip_ipaddr_t addr;
+  clock_time_t rto;             /* overall retransmission timeout */
+  clock_time_t srtt_strong;     /* 0 until the first sample */
+  clock_time_t rttvar_strong;
+  clock_time_t srtt_weak;
+  clock_time_t rttvar_weak;
+  clock_time_t updated;         /* of the RTO, for aging */
+
+  uint16_t retransmissions;
+  uint16_t timeouts;
+  uint8_t outstanding;          /* confirmable messages, up to COAP_NSTART */
+} coap_peer_t;
+
+MEMB(peers_memb, coap_peer_t, COAP_MAX_PEERS);
+LIST(peers_list);
+
+struct coap_transaction_stats coap_transaction_stat;
+#endif /* COAP_CONGESTION_CONTROL */
+
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+#if COAP_CONGESTION_CONTROL
+static coap_peer_t *
+get_peer(const uip_ipaddr_t *addr, int create)
+{
+  coap_peer_t *p = NULL;
+  coap_peer_t *idle = NULL;
+
+  for(p = (coap_peer_t *)list_head(peers_list); p; p = p->next) {
+    if(uip_ipaddr_cmp(&p->addr, addr)) {
+      list_remove(peers_list, p);
+      list_push(peers_list, p);
+      return p;
+    }
+    if(p->outstanding == 0) {
+      /* least recently used without outstanding messages */
+      idle = p;
+    }
+  }
+
+  if(!create) {
+    return NULL;
+  }
+  if((p = memb_alloc(&peers_memb)) == NULL) {
+    if(idle == NULL) {
+      PRINTF("No room to estimate the RTT of a destination\n");
+      return NULL;
+    }
+    list_remove(peers_list, idle);
+    p = idle;
+  }
+
+  memset(p, 0, sizeof(coap_peer_t));
+  uip_ipaddr_copy(&p->addr, addr);
+  p->rto = COAP_RESPONSE_TIMEOUT_TICKS;
+  p->updated = clock_time();
+  list_push(peers_list, p);
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+update_estimator(clock_time_t *srtt, clock_time_t *rttvar, clock_time_t rtt,
+                 int k)
+{
+  /* 32-bit arithmetic: with a 16-bit clock_time_t at 128 Hz, 7 * srtt
+   * overflows once the RTT exceeds about 73 s */
+  uint32_t delta;
+  uint32_t rto;
+
+  if(*srtt == 0) {
+    *srtt = rtt;
+    *rttvar = rtt / 2;
+  } else {
+    delta = *srtt > rtt ? *srtt - rtt : rtt - *srtt;
+    *rttvar = ((uint32_t)3 * *rttvar + delta) / 4;
+    *srtt = ((uint32_t)7 * *srtt + rtt) / 8;
+  }
+  rto = *srtt + (uint32_t)k * *rttvar;
+  return rto > COCOA_MAX_RTO ? COCOA_MAX_RTO : rto;
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_rto(coap_peer_t *p, clock_time_t rtt, uint8_t retransmissions)
+{
+  clock_time_t rto;
+
+  if(rtt == 0) {
+    rtt = 1;
+  }
+
+  if(retransmissions == 0) {
+    rto = update_estimator(&p->srtt_strong, &p->rttvar_strong, rtt,
+                           COCOA_K_STRONG);
+    p->rto = ((uint32_t)rto + p->rto) / 2;
+    ++coap_transaction_stat.strong_samples;
+  } else if(retransmissions <= COCOA_MAX_WEAK_RETRANSMISSIONS) {
+    /* measured from the first transmission */
+    rto = update_estimator(&p->srtt_weak, &p->rttvar_weak, rtt,
+                           COCOA_K_WEAK);
+    p->rto = ((uint32_t)rto + (uint32_t)3 * p->rto) / 4;
+    ++coap_transaction_stat.weak_samples;
+  } else {
+    return;
+  }
+
+  if(p->rto > COCOA_MAX_RTO) {
+    p->rto = COCOA_MAX_RTO;
+  }
+  p->updated = clock_time();
+  PRINTF("RTT %lu, RTO %lu ticks\n", (unsigned long)rtt,
+         (unsigned long)p->rto);
+}
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+get_rto(coap_peer_t *p)
+{
+  clock_time_t now = clock_time();
+
+  /* an estimate that was not updated for a while ages towards the default */
+  if(p->rto < CLOCK_SECOND && now - p->updated > 16 * p->rto) {
+    p->rto <<= 1;
+    p->updated = now;
+  } else if(p->rto > 3 * CLOCK_SECOND && now - p->updated > 4 * p->rto) {
+    p->rto = (p->rto + COAP_RESPONSE_TIMEOUT_TICKS) / 2;
+    p->updated = now;
+  }
+  return p->rto;
+}
+/*---------------------------------------------------------------------------*/
+static void
+release_peer(uip_ipaddr_t *addr)
+{
+  coap_peer_t *p = get_peer(addr, 0);
+  coap_transaction_t *t = NULL;
+
+  if(p != NULL && p->outstanding > 0) {
+    --(p->outstanding);
+  }
+
+  /* send what waited for the destination, as far as COAP_NSTART allows */
+  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
+    if(t->deferred && uip_ipaddr_cmp(&t->addr, addr)) {
+      coap_send_transaction(t);
+    }
+  }
+}
+#endif /* COAP_CONGESTION_CONTROL */
+/*---------------------------------------------------------------------------*/
 void
 coap_register_as_transaction_handler()
 {
   transaction_handler_process = PROCESS_CURRENT();
 }
+/*---------------------------------------------------------------------------*/
+clock_time_t
+coap_initial_timeout(uip_ipaddr_t *addr)
+{
+#if COAP_CONGESTION_CONTROL
+  coap_peer_t *p = get_peer(addr, 1);
+  clock_time_t rto;
+
+  if(p != NULL) {
+    /* between RTO and 1.5 RTO */
+    rto = get_rto(p);
+    return rto + random_rand() % (rto / 2 + 1);
+  }
+#endif /* COAP_CONGESTION_CONTROL */
+  return COAP_RESPONSE_TIMEOUT_TICKS + (random_rand()
+                                        %
+                                        (clock_time_t)
+                                        COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+coap_backoff_timeout(uip_ipaddr_t *addr, clock_time_t interval)
+{
+#if COAP_CONGESTION_CONTROL
+  coap_peer_t *p = get_peer(addr, 0);
+
+  if(p != NULL) {
+    /* variable backoff factor: back off more when the RTO is short */
+    if(p->rto < CLOCK_SECOND) {
+      return interval * 3;
+    } else if(p->rto > 3 * CLOCK_SECOND) {
+      return interval + interval / 2;
+    }
+  }
+#endif /* COAP_CONGESTION_CONTROL */
+  return interval << 1;
+}
+/*---------------------------------------------------------------------------*/
 coap_transaction_t *
 coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
 {
@@ -75,6 +271,13 @@ coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
   if(t) {
     t->mid = mid;
     t->retrans_counter = 0;
+    /* the memory may still hold the callback of a previous transaction */
+    t->callback = NULL;
+    t->callback_data = NULL;
+#if COAP_CONGESTION_CONTROL
+    t->outstanding = 0;
+    t->deferred = 0;
+#endif /* COAP_CONGESTION_CONTROL */
 
     /* save client address */
     uip_ipaddr_copy(&t->addr, addr);
@@ -89,27 +292,57 @@ coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
 void
 coap_send_transaction(coap_transaction_t *t)
 {
+  int confirmable = COAP_TYPE_CON ==
+    ((COAP_HEADER_TYPE_MASK & t->packet[0]) >> COAP_HEADER_TYPE_POSITION);
+
+#if COAP_CONGESTION_CONTROL
+  coap_peer_t *peer = NULL;
+
+  if(confirmable) {
+    peer = get_peer(&t->addr, 1);
+    if(!t->outstanding) {
+      if(peer != NULL && peer->outstanding >= COAP_NSTART) {
+        PRINTF("Deferring transaction %u\n", t->mid);
+        if(!t->deferred) {
+          t->deferred = 1;
+          ++coap_transaction_stat.deferred;
+        }
+        return;
+      }
+      t->deferred = 0;
+      if(peer != NULL) {
+        t->outstanding = 1;
+        ++(peer->outstanding);
+      }
+      t->start_time = clock_time();
+    }
+    ++coap_transaction_stat.transmissions;
+    if(t->retrans_counter > 0) {
+      ++coap_transaction_stat.retransmissions;
+      if(peer != NULL) {
+        ++(peer->retransmissions);
+      }
+    }
+  }
+#endif /* COAP_CONGESTION_CONTROL */
+
   PRINTF("Sending transaction %u\n", t->mid);
 
   coap_send_message(&t->addr, t->port, t->packet, t->packet_len);
 
-  if(COAP_TYPE_CON ==
-     ((COAP_HEADER_TYPE_MASK & t->packet[0]) >> COAP_HEADER_TYPE_POSITION)) {
+  if(confirmable) {
     if(t->retrans_counter < COAP_MAX_RETRANSMIT) {
       /* not timed out yet */
       PRINTF("Keeping transaction %u\n", t->mid);
 
       if(t->retrans_counter == 0) {
-        t->retrans_timer.timer.interval =
-          COAP_RESPONSE_TIMEOUT_TICKS + (random_rand()
-                                         %
-                                         (clock_time_t)
-                                         COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+        t->retrans_timer.timer.interval = coap_initial_timeout(&t->addr);
         PRINTF("Initial interval %f\n",
                (float)t->retrans_timer.timer.interval / CLOCK_SECOND);
       } else {
-        t->retrans_timer.timer.interval <<= 1;  /* double */
-        PRINTF("Doubled (%u) interval %f\n", t->retrans_counter,
+        t->retrans_timer.timer.interval =
+          coap_backoff_timeout(&t->addr, t->retrans_timer.timer.interval);
+        PRINTF("Backed off (%u) interval %f\n", t->retrans_counter,
                (float)t->retrans_timer.timer.interval / CLOCK_SECOND);
       }
 
@@ -124,6 +357,13 @@ coap_send_transaction(coap_transaction_t *t)
       restful_response_handler callback = t->callback;
       void *callback_data = t->callback_data;
 
+#if COAP_CONGESTION_CONTROL
+      ++coap_transaction_stat.timeouts;
+      if(peer != NULL) {
+        ++(peer->timeouts);
+      }
+#endif /* COAP_CONGESTION_CONTROL */
+
       /* handle observers */
       coap_remove_observer_by_client(&t->addr, t->port);
 
@@ -146,9 +386,32 @@ coap_clear_transaction(coap_transaction_t *t)
 
     etimer_stop(&t->retrans_timer);
     list_remove(transactions_list, t);
+#if COAP_CONGESTION_CONTROL
+    if(t->outstanding) {
+      uip_ipaddr_t addr;
+
+      uip_ipaddr_copy(&addr, &t->addr);
+      memb_free(&transactions_memb, t);
+      release_peer(&addr);
+      return;
+    }
+#endif /* COAP_CONGESTION_CONTROL */
     memb_free(&transactions_memb, t);
   }
 }
+/*---------------------------------------------------------------------------*/
+void
+coap_complete_transaction(coap_transaction_t *t)
+{
+#if COAP_CONGESTION_CONTROL
+  coap_peer_t *peer;
+
+  if(t && t->outstanding && (peer = get_peer(&t->addr, 0)) != NULL) {
+    update_rto(peer, clock_time() - t->start_time, t->retrans_counter);
+  }
+#endif /* COAP_CONGESTION_CONTROL */
+  coap_clear_transaction(t);
+}
 coap_transaction_t *
 coap_get_transaction_by_mid(uint16_t mid)
 {
@@ -169,6 +432,11 @@ coap_check_transactions()
   coap_transaction_t *t = NULL;
 
   for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
+#if COAP_CONGESTION_CONTROL
+    if(t->deferred) {
+      continue;
+    }
+#endif /* COAP_CONGESTION_CONTROL */
     if(etimer_expired(&t->retrans_timer)) {
       ++(t->retrans_counter);
       PRINTF("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
@@ -177,3 +445,24 @@ coap_check_transactions()
   }
 }
 /*---------------------------------------------------------------------------*/
+#if COAP_CONGESTION_CONTROL
+int
+coap_get_peer_stats(const uip_ipaddr_t *addr, struct coap_peer_stats *stats)
+{
+  coap_peer_t *p = NULL;
+
+  for(p = (coap_peer_t *)list_head(peers_list); p; p = p->next) {
+    if(uip_ipaddr_cmp(&p->addr, addr)) {
+      stats->rto = p->rto;
+      stats->srtt_strong = p->srtt_strong;
+      stats->srtt_weak = p->srtt_weak;
+      stats->retransmissions = p->retransmissions;
+      stats->timeouts = p->timeouts;
+      stats->outstanding = p->outstanding;
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* COAP_CONGESTION_CONTROL */
@@ -62,17 +62,54 @@ typedef struct coap_transaction {
   restful_response_handler callback;
   void *callback_data;
 
+#if COAP_CONGESTION_CONTROL
+  clock_time_t start_time;      /* of the first transmission */
+  uint8_t outstanding;          /* counted against COAP_NSTART */
+  uint8_t deferred;             /* waiting for COAP_NSTART */
+#endif /* COAP_CONGESTION_CONTROL */
+
   uint16_t packet_len;
   uint8_t packet[COAP_MAX_PACKET_SIZE + 1];     /* +1 for the terminating '\0' which will not be sent
                                                  * Use snprintf(buf, len+1, "", ...) to completely fill payload */
 } coap_transaction_t;
 
+#if COAP_CONGESTION_CONTROL
+/* retransmission statistics of all destinations */
+struct coap_transaction_stats {
+  uint32_t transmissions;       /* confirmable, retransmissions included */
+  uint32_t retransmissions;
+  uint32_t timeouts;
+  uint32_t strong_samples;      /* RTT of exchanges without retransmission */
+  uint32_t weak_samples;        /* RTT of exchanges with retransmissions */
+  uint32_t deferred;            /* messages that waited for COAP_NSTART */
+};
+
+extern struct coap_transaction_stats coap_transaction_stat;
+
+/* round-trip time estimation of a destination */
+struct coap_peer_stats {
+  clock_time_t rto;             /* overall retransmission timeout */
+  clock_time_t srtt_strong;
+  clock_time_t srtt_weak;
+  uint16_t retransmissions;
+  uint16_t timeouts;
+  uint8_t outstanding;
+};
+
+int coap_get_peer_stats(const uip_ipaddr_t *addr,
+                        struct coap_peer_stats *stats);
+#endif /* COAP_CONGESTION_CONTROL */
+
 void coap_register_as_transaction_handler(void);
 
+clock_time_t coap_initial_timeout(uip_ipaddr_t *addr);
+clock_time_t coap_backoff_timeout(uip_ipaddr_t *addr, clock_time_t interval);
+
 coap_transaction_t *coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr,
                                          uint16_t port);
 void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
+void coap_complete_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
 
 void coap_check_transactions(void);
@@ -85,7 +85,7 @@ coap_log_2(uint16_t value)
 }
 /*---------------------------------------------------------------------------*/
 static uint32_t
-coap_parse_int_option(uint8_t *bytes, size_t length)
+coap_parse_int_option(const uint8_t *bytes, size_t length)
 {
   uint32_t var = 0;
   int i = 0;
@@ -110,6 +110,16 @@ coap_option_nibble(unsigned int value)
 }
 /*---------------------------------------------------------------------------*/
 static size_t
+coap_option_header_length(unsigned int delta, size_t length)
+{
+  size_t len = 1;
+
+  len += delta > 268 ? 2 : delta > 12 ? 1 : 0;
+  len += length > 268 ? 2 : length > 12 ? 1 : 0;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static size_t
 coap_set_option_header(unsigned int delta, size_t length, uint8_t *buffer)
 {
   size_t written = 0;
@@ -135,89 +145,76 @@ coap_set_option_header(unsigned int delta, size_t length, uint8_t *buffer)
   return ++written;
 }
 /*---------------------------------------------------------------------------*/
-static size_t
-coap_serialize_int_option(unsigned int number, unsigned int current_number,
-                          uint8_t *buffer, uint32_t value)
+/*
+ * Decodes the extended delta or length following an option header byte.
+ * Returns -1 for the reserved nibble 15 or when the field is truncated.
+ */
+static int32_t
+coap_option_extended(unsigned int nibble, const uint8_t **p,
+                     const uint8_t *end)
 {
-  size_t i = 0;
+  int32_t value = nibble;
 
-  if(0xFF000000 & value) {
-    ++i;
-  }
-  if(0xFFFF0000 & value) {
-    ++i;
-  }
-  if(0xFFFFFF00 & value) {
-    ++i;
-  }
-  if(0xFFFFFFFF & value) {
-    ++i;
-  }
-  PRINTF("OPTION %u (delta %u, len %zu)\n", number, number - current_number,
-         i);
-
-  i = coap_set_option_header(number - current_number, i, buffer);
-
-  if(0xFF000000 & value) {
-    buffer[i++] = (uint8_t)(value >> 24);
-  }
-  if(0xFFFF0000 & value) {
-    buffer[i++] = (uint8_t)(value >> 16);
-  }
-  if(0xFFFFFF00 & value) {
-    buffer[i++] = (uint8_t)(value >> 8);
+  if(nibble == 13) {
+    if(*p + 1 > end) {
+      return -1;
+    }
+    value = 13 + (*p)[0];
+    *p += 1;
+  } else if(nibble == 14) {
+    if(*p + 2 > end) {
+      return -1;
+    }
+    value = 269 + ((*p)[0] << 8 | (*p)[1]);
+    *p += 2;
+  } else if(nibble == 15) {
+    return -1;
   }
-  if(0xFFFFFFFF & value) {
-    buffer[i++] = (uint8_t)(value);
+  return value;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Decodes the option at it->next without consuming it. Returns the start of
+ * the following option, or NULL if the option is malformed.
+ */
+static const uint8_t *
+coap_option_decode(const coap_option_iterator_t *it, unsigned int *number,
+                   size_t *length, const uint8_t **value)
+{
+  const uint8_t *p = it->next + 1;
+  int32_t delta = it->next[0] >> 4;
+  int32_t len = it->next[0] & 0x0F;
+
+  /* short deltas and lengths are the common case */
+  if((delta > 12 && (delta = coap_option_extended(delta, &p, it->end)) < 0)
+     || (len > 12 && (len = coap_option_extended(len, &p, it->end)) < 0)
+     || p + len > it->end) {
+    PRINTF("BAD REQUEST: malformed option at %u\n",
+           (unsigned)(it->next - it->buffer));
+    return NULL;
   }
-  return i;
+  *number = it->number + delta;
+  *length = len;
+  *value = p;
+  return p + len;
 }
 /*---------------------------------------------------------------------------*/
-static size_t
-coap_serialize_array_option(unsigned int number, unsigned int current_number,
-                            uint8_t *buffer, uint8_t *array, size_t length,
-                            char split_char)
+static int
+coap_write_split_option(coap_message_writer_t *writer, unsigned int number,
+                        const char *string, size_t length, char split_char)
 {
-  size_t i = 0;
+  const char *part_end;
 
   PRINTF("ARRAY type %u, len %zu, full [%.*s]\n", number, length,
-         (int)length, array);
-
-  if(split_char != '\0') {
-    int j;
-    uint8_t *part_start = array;
-    uint8_t *part_end = NULL;
-    size_t temp_length;
-
-    for(j = 0; j <= length + 1; ++j) {
-      PRINTF("STEP %u/%zu (%c)\n", j, length, array[j]);
-      if(array[j] == split_char || j == length) {
-        part_end = array + j;
-        temp_length = part_end - part_start;
-
-        i += coap_set_option_header(number - current_number, temp_length,
-                                    &buffer[i]);
-        memcpy(&buffer[i], part_start, temp_length);
-        i += temp_length;
-
-        PRINTF("OPTION type %u, delta %u, len %zu, part [%.*s]\n", number,
-               number - current_number, i, (int)temp_length, part_start);
-
-        ++j;                    /* skip the splitter */
-        current_number = number;
-        part_start = array + j;
-      }
-    }                           /* for */
-  } else {
-    i += coap_set_option_header(number - current_number, length, &buffer[i]);
-    memcpy(&buffer[i], array, length);
-    i += length;
+         (int)length, string);
 
-    PRINTF("OPTION type %u, delta %u, len %zu\n", number,
-           number - current_number, length);
+  /* one option per part, empty parts included */
+  while((part_end = memchr(string, split_char, length)) != NULL) {
+    coap_write_option(writer, number, string, part_end - string);
+    length -= part_end - string + 1;
+    string = part_end + 1;
   }
-
-  return i;
+  return coap_write_option(writer, number, string, length);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -310,14 +307,205 @@ coap_init_message(void *packet, coap_message_type_t type, uint8_t code,
   coap_pkt->mid = mid;
 
   
+}
+/*---------------------------------------------------------------------------*/
+coap_status_t
+coap_option_iterator_init(coap_option_iterator_t *it, const uint8_t *data,
+                          uint16_t data_len)
+{
+  memset(it, 0, sizeof(coap_option_iterator_t));
+
+  if(data_len < COAP_HEADER_LEN) {
+    coap_error_message = "Message shorter than CoAP header";
+    return BAD_REQUEST_4_00;
+  }
+
+  if(((COAP_HEADER_VERSION_MASK & data[0]) >> COAP_HEADER_VERSION_POSITION)
+     != 1) {
+    coap_error_message = "CoAP version must be 1";
+    return BAD_REQUEST_4_00;
+  }
+
+  it->token_len = (COAP_HEADER_TOKEN_LEN_MASK & data[0])
+    >> COAP_HEADER_TOKEN_LEN_POSITION;
+  if(it->token_len > COAP_TOKEN_LEN
+     || COAP_HEADER_LEN + it->token_len > data_len) {
+    coap_error_message = "Token Length must not be more than 8";
+    return BAD_REQUEST_4_00;
+  }
+
+  it->type = (COAP_HEADER_TYPE_MASK & data[0]) >> COAP_HEADER_TYPE_POSITION;
+  it->code = data[1];
+  it->mid = data[2] << 8 | data[3];
+  it->token = data + COAP_HEADER_LEN;
+
+  it->buffer = data;
+  it->end = data + data_len;
+  it->next = it->token + it->token_len;
+
+  return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Moves to the next option. Returns 1 for an option, 0 at the end of the
+ * options, and -1 if the message is malformed.
+ */
+int
+coap_option_next(coap_option_iterator_t *it)
+{
+  const uint8_t *next;
+
+  if(it->next >= it->end || it->next[0] == 0xFF) {
+    return 0;
+  }
+  if((next = coap_option_decode(it, &it->number, &it->length,
+                                &it->value)) == NULL) {
+    it->next = it->end;
+    return -1;
+  }
+  it->next = next;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Moves to the next occurrence of the option. Options are ordered, so the
+ * iterator stops in front of the first larger option when there is none.
+ */
+int
+coap_option_find(coap_option_iterator_t *it, unsigned int number)
+{
+  const uint8_t *next;
+  unsigned int next_number;
+  size_t length;
+  const uint8_t *value;
+
+  while(it->next < it->end && it->next[0] != 0xFF) {
+    if((next = coap_option_decode(it, &next_number, &length, &value)) == NULL) {
+      it->next = it->end;
+      return -1;
+    }
+    if(next_number > number) {
+      return 0;
+    }
+    it->number = next_number;
+    it->length = length;
+    it->value = value;
+    it->next = next;
+    if(next_number == number) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+coap_option_get_int(const coap_option_iterator_t *it)
+{
+  return coap_parse_int_option(it->value, it->length);
+}
+/*---------------------------------------------------------------------------*/
+/* only valid once coap_option_next() has returned 0 */
+uint16_t
+coap_option_get_payload(const coap_option_iterator_t *it,
+                        const uint8_t **payload)
+{
+  if(it->next < it->end && it->next[0] == 0xFF) {
+    *payload = it->next + 1;
+    return it->end - *payload;
+  }
+  *payload = NULL;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_message_writer_init(coap_message_writer_t *writer, uint8_t *buffer,
+                         size_t size, coap_message_type_t type, uint8_t code,
+                         uint16_t mid, const uint8_t *token, size_t token_len)
+{
+  writer->buffer = buffer;
+  writer->end = buffer + size;
+  writer->number = 0;
+
+  if(token_len > COAP_TOKEN_LEN || COAP_HEADER_LEN + token_len > size) {
+    writer->current = NULL;
+    return;
+  }
+
+  buffer[0] = (COAP_HEADER_VERSION_MASK & 1 << COAP_HEADER_VERSION_POSITION)
+    | (COAP_HEADER_TYPE_MASK & type << COAP_HEADER_TYPE_POSITION)
+    | (COAP_HEADER_TOKEN_LEN_MASK & token_len << COAP_HEADER_TOKEN_LEN_POSITION);
+  buffer[1] = code;
+  buffer[2] = (uint8_t)(mid >> 8);
+  buffer[3] = (uint8_t)(mid);
+  memcpy(buffer + COAP_HEADER_LEN, token, token_len);
+  writer->current = buffer + COAP_HEADER_LEN + token_len;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_write_option(coap_message_writer_t *writer, unsigned int number,
+                  const void *value, size_t length)
+{
+  unsigned int delta = number - writer->number;
+
+  if(writer->current == NULL) {
+    return 0;
+  }
+  if(number < writer->number
+     || writer->current + coap_option_header_length(delta, length) + length
+     > writer->end) {
+    PRINTF("Cannot write option %u (len %zu)\n", number, length);
+    writer->current = NULL;
+    return 0;
+  }
+
+  PRINTF("OPTION %u (delta %u, len %zu)\n", number, delta, length);
+
+  writer->current += coap_set_option_header(delta, length, writer->current);
+  memcpy(writer->current, value, length);
+  writer->current += length;
+  writer->number = number;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+coap_write_int_option(coap_message_writer_t *writer, unsigned int number,
+                      uint32_t value)
+{
+  uint8_t bytes[4];
+  size_t length = value > 0xFFFFFF ? 4 : value > 0xFFFF ? 3
+    : value > 0xFF ? 2 : value ? 1 : 0;
+  size_t i;
+
+  for(i = 0; i < length; ++i) {
+    bytes[i] = (uint8_t)(value >> (8 * (length - 1 - i)));
+  }
+  return coap_write_option(writer, number, bytes, length);
+}
+/*---------------------------------------------------------------------------*/
+/* the payload may already lie in the buffer; returns the message length */
+size_t
+coap_write_payload(coap_message_writer_t *writer, const void *payload,
+                   size_t length)
+{
+  if(writer->current == NULL
+     || (length && writer->current + 1 + length > writer->end)) {
+    writer->current = NULL;
+    return 0;
+  }
+  if(length) {
+    *writer->current++ = 0xFF;
+    memmove(writer->current, payload, length);
+    writer->current += length;
+  }
+  return writer->current - writer->buffer;
 }
 /*---------------------------------------------------------------------------*/
 size_t
 coap_serialize_message(void *packet, uint8_t *buffer)
 {
   coap_packet_t *const coap_pkt = (coap_packet_t *)packet;
-  uint8_t *option;
-  unsigned int current_number = 0;
+  coap_message_writer_t writer;
+  uint32_t block;
 
   /* Initialize */
   coap_pkt->buffer = buffer;
@@ -325,106 +513,110 @@ coap_serialize_message(void *packet, uint8_t *buffer)
 
   PRINTF("-Serializing MID %u to %p, ", coap_pkt->mid, coap_pkt->buffer);
 
-  /* set header fields */
-  coap_pkt->buffer[0] = 0x00;
-  coap_pkt->buffer[0] |= COAP_HEADER_VERSION_MASK
-    & (coap_pkt->version) << COAP_HEADER_VERSION_POSITION;
-  coap_pkt->buffer[0] |= COAP_HEADER_TYPE_MASK
-    & (coap_pkt->type) << COAP_HEADER_TYPE_POSITION;
-  coap_pkt->buffer[0] |= COAP_HEADER_TOKEN_LEN_MASK
-    & (coap_pkt->token_len) << COAP_HEADER_TOKEN_LEN_POSITION;
-  coap_pkt->buffer[1] = coap_pkt->code;
-  coap_pkt->buffer[2] = (uint8_t)((coap_pkt->mid) >> 8);
-  coap_pkt->buffer[3] = (uint8_t)(coap_pkt->mid);
+  /* the payload may lie behind the header space, options must not reach it */
+  coap_message_writer_init(&writer, buffer, COAP_MAX_HEADER_SIZE,
+                           coap_pkt->type, coap_pkt->code, coap_pkt->mid,
+                           coap_pkt->token,
+                           coap_pkt->code ? coap_pkt->token_len : 0);
 
   /* empty packet, dont need to do more stuff */
   if(!coap_pkt->code) {
     PRINTF("-Done serializing empty message at %p-\n", coap_pkt->buffer);
-    return 4;
+    return COAP_HEADER_LEN;
   }
 
-  /* set Token */
-  PRINTF("Token (len %u)", coap_pkt->token_len);
-  option = coap_pkt->buffer + COAP_HEADER_LEN;
-  for(current_number = 0; current_number < coap_pkt->token_len;
-      ++current_number) {
-    PRINTF(" %02X", coap_pkt->token[current_number]);
-    *option = coap_pkt->token[current_number];
-    ++option;
-  }
-  PRINTF("-\n");
-
-  /* Serialize options */
-  current_number = 0;
-
-  PRINTF("-Serializing options at %p-\n", option);
+  PRINTF("-Serializing options at %p-\n", writer.current);
 
   /* The options must be serialized in the order of their number */
-  COAP_SERIALIZE_BYTE_OPTION(COAP_OPTION_IF_MATCH, if_match, "If-Match");
-  COAP_SERIALIZE_STRING_OPTION(COAP_OPTION_URI_HOST, uri_host, '\0',
-                               "Uri-Host");
-  COAP_SERIALIZE_BYTE_OPTION(COAP_OPTION_ETAG, etag, "ETag");
-  COAP_SERIALIZE_INT_OPTION(COAP_OPTION_IF_NONE_MATCH,
-                            content_format -
-                            coap_pkt->
-                            content_format /* hack to get a zero field */,
-                            "If-None-Match");
-  COAP_SERIALIZE_INT_OPTION(COAP_OPTION_OBSERVE, observe, "Observe");
-  COAP_SERIALIZE_INT_OPTION(COAP_OPTION_URI_PORT, uri_port, "Uri-Port");
-  COAP_SERIALIZE_STRING_OPTION(COAP_OPTION_LOCATION_PATH, location_path, '/',
-                               "Location-Path");
-  COAP_SERIALIZE_STRING_OPTION(COAP_OPTION_URI_PATH, uri_path, '/',
-                               "Uri-Path");
-  PRINTF("Serialize content format: %d\n", coap_pkt->content_format);
-  COAP_SERIALIZE_INT_OPTION(COAP_OPTION_CONTENT_FORMAT, content_format,
-                            "Content-Format");
-  COAP_SERIALIZE_INT_OPTION(COAP_OPTION_MAX_AGE, max_age, "Max-Age");
-  COAP_SERIALIZE_STRING_OPTION(COAP_OPTION_URI_QUERY, uri_query, '&',
-                               "Uri-Query");
-  COAP_SERIALIZE_INT_OPTION(COAP_OPTION_ACCEPT, accept, "Accept");
-  COAP_SERIALIZE_STRING_OPTION(COAP_OPTION_LOCATION_QUERY, location_query,
-                               '&', "Location-Query");
-  COAP_SERIALIZE_BLOCK_OPTION(COAP_OPTION_BLOCK2, block2, "Block2");
-  COAP_SERIALIZE_BLOCK_OPTION(COAP_OPTION_BLOCK1, block1, "Block1");
-  COAP_SERIALIZE_INT_OPTION(COAP_OPTION_SIZE2, size2, "Size2");
-  COAP_SERIALIZE_STRING_OPTION(COAP_OPTION_PROXY_URI, proxy_uri, '\0',
-                               "Proxy-Uri");
-  COAP_SERIALIZE_STRING_OPTION(COAP_OPTION_PROXY_SCHEME, proxy_scheme, '\0',
-                               "Proxy-Scheme");
-  COAP_SERIALIZE_INT_OPTION(COAP_OPTION_SIZE1, size1, "Size1");
-
-  PRINTF("-Done serializing at %p----\n", option);
-
-  /* Pack payload */
-  if((option - coap_pkt->buffer) <= COAP_MAX_HEADER_SIZE) {
-    /* Payload marker */
-    if(coap_pkt->payload_len) {
-      *option = 0xFF;
-      ++option;
-    }
-    memmove(option, coap_pkt->payload, coap_pkt->payload_len);
-  } else {
+  if(IS_OPTION(coap_pkt, COAP_OPTION_IF_MATCH)) {
+    coap_write_option(&writer, COAP_OPTION_IF_MATCH, coap_pkt->if_match,
+                      coap_pkt->if_match_len);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_URI_HOST)) {
+    coap_write_option(&writer, COAP_OPTION_URI_HOST, coap_pkt->uri_host,
+                      coap_pkt->uri_host_len);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_ETAG)) {
+    coap_write_option(&writer, COAP_OPTION_ETAG, coap_pkt->etag,
+                      coap_pkt->etag_len);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_IF_NONE_MATCH)) {
+    coap_write_option(&writer, COAP_OPTION_IF_NONE_MATCH, NULL, 0);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_OBSERVE)) {
+    coap_write_int_option(&writer, COAP_OPTION_OBSERVE, coap_pkt->observe);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_URI_PORT)) {
+    coap_write_int_option(&writer, COAP_OPTION_URI_PORT, coap_pkt->uri_port);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_LOCATION_PATH)) {
+    coap_write_split_option(&writer, COAP_OPTION_LOCATION_PATH,
+                            coap_pkt->location_path,
+                            coap_pkt->location_path_len, '/');
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_URI_PATH)) {
+    coap_write_split_option(&writer, COAP_OPTION_URI_PATH, coap_pkt->uri_path,
+                            coap_pkt->uri_path_len, '/');
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_CONTENT_FORMAT)) {
+    coap_write_int_option(&writer, COAP_OPTION_CONTENT_FORMAT,
+                          coap_pkt->content_format);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_MAX_AGE)) {
+    coap_write_int_option(&writer, COAP_OPTION_MAX_AGE, coap_pkt->max_age);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_URI_QUERY)) {
+    coap_write_split_option(&writer, COAP_OPTION_URI_QUERY,
+                            coap_pkt->uri_query, coap_pkt->uri_query_len,
+                            '&');
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_ACCEPT)) {
+    coap_write_int_option(&writer, COAP_OPTION_ACCEPT, coap_pkt->accept);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_LOCATION_QUERY)) {
+    coap_write_split_option(&writer, COAP_OPTION_LOCATION_QUERY,
+                            coap_pkt->location_query,
+                            coap_pkt->location_query_len, '&');
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_BLOCK2)) {
+    block = coap_pkt->block2_num << 4
+      | (coap_pkt->block2_more ? 0x8 : 0)
+      | (0xF & coap_log_2(coap_pkt->block2_size / 16));
+    coap_write_int_option(&writer, COAP_OPTION_BLOCK2, block);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_BLOCK1)) {
+    block = coap_pkt->block1_num << 4
+      | (coap_pkt->block1_more ? 0x8 : 0)
+      | (0xF & coap_log_2(coap_pkt->block1_size / 16));
+    coap_write_int_option(&writer, COAP_OPTION_BLOCK1, block);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_SIZE2)) {
+    coap_write_int_option(&writer, COAP_OPTION_SIZE2, coap_pkt->size2);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_PROXY_URI)) {
+    coap_write_option(&writer, COAP_OPTION_PROXY_URI, coap_pkt->proxy_uri,
+                      coap_pkt->proxy_uri_len);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_PROXY_SCHEME)) {
+    coap_write_option(&writer, COAP_OPTION_PROXY_SCHEME,
+                      coap_pkt->proxy_scheme, coap_pkt->proxy_scheme_len);
+  }
+  if(IS_OPTION(coap_pkt, COAP_OPTION_SIZE1)) {
+    coap_write_int_option(&writer, COAP_OPTION_SIZE1, coap_pkt->size1);
+  }
+
+  if(writer.current == NULL) {
     /* an error occurred: caller must check for !=0 */
     coap_pkt->buffer = NULL;
     coap_error_message = "Serialized header exceeds COAP_MAX_HEADER_SIZE";
     return 0;
   }
 
-  PRINTF("-Done %u B (header len %u, payload len %u)-\n",
-         (unsigned int)(coap_pkt->payload_len + option - buffer),
-         (unsigned int)(option - buffer),
-         (unsigned int)coap_pkt->payload_len);
+  PRINTF("-Done serializing at %p----\n", writer.current);
 
-  PRINTF("Dump [0x%02X %02X %02X %02X  %02X %02X %02X %02X]\n",
-         coap_pkt->buffer[0],
-         coap_pkt->buffer[1],
-         coap_pkt->buffer[2],
-         coap_pkt->buffer[3],
-         coap_pkt->buffer[4],
-         coap_pkt->buffer[5], coap_pkt->buffer[6], coap_pkt->buffer[7]
-         );
-
-  return (option - buffer) + coap_pkt->payload_len; /* packet length */
+  /* Pack payload, the buffers hold COAP_MAX_PACKET_SIZE + 1 bytes */
+  writer.end = buffer + COAP_MAX_PACKET_SIZE + 1;
+  return coap_write_payload(&writer, coap_pkt->payload, coap_pkt->payload_len);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -448,6 +640,13 @@ coap_status_t
 coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
 {
   coap_packet_t *const coap_pkt = (coap_packet_t *)packet;
+  coap_option_iterator_t it;
+  coap_status_t status;
+  const uint8_t *payload;
+  uint8_t *current_option;
+  unsigned int option_number;
+  size_t option_length;
+  int next;
 
   /* initialize packet */
   memset(coap_pkt, 0, sizeof(coap_packet_t));
@@ -456,28 +655,16 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
   coap_pkt->buffer = data;
 
   /* parse header fields */
-  coap_pkt->version = (COAP_HEADER_VERSION_MASK & coap_pkt->buffer[0])
-    >> COAP_HEADER_VERSION_POSITION;
-  coap_pkt->type = (COAP_HEADER_TYPE_MASK & coap_pkt->buffer[0])
-    >> COAP_HEADER_TYPE_POSITION;
-  coap_pkt->token_len = (COAP_HEADER_TOKEN_LEN_MASK & coap_pkt->buffer[0])
-    >> COAP_HEADER_TOKEN_LEN_POSITION;
-  coap_pkt->code = coap_pkt->buffer[1];
-  coap_pkt->mid = coap_pkt->buffer[2] << 8 | coap_pkt->buffer[3];
-
-  if(coap_pkt->version != 1) {
-    coap_error_message = "CoAP version must be 1";
-    return BAD_REQUEST_4_00;
+  if((status = coap_option_iterator_init(&it, data, data_len)) != NO_ERROR) {
+    return status;
   }
+  coap_pkt->version = 1;
+  coap_pkt->type = it.type;
+  coap_pkt->token_len = it.token_len;
+  coap_pkt->code = it.code;
+  coap_pkt->mid = it.mid;
 
-  if(coap_pkt->token_len > COAP_TOKEN_LEN) {
-    coap_error_message = "Token Length must not be more than 8";
-    return BAD_REQUEST_4_00;
-  }
-
-  uint8_t *current_option = data + COAP_HEADER_LEN;
-
-  memcpy(coap_pkt->token, current_option, coap_pkt->token_len);
+  memcpy(coap_pkt->token, it.token, coap_pkt->token_len);
   PRINTF("Token (len %u) [0x%02X%02X%02X%02X%02X%02X%02X%02X]\n",
          coap_pkt->token_len, coap_pkt->token[0], coap_pkt->token[1],
          coap_pkt->token[2], coap_pkt->token[3], coap_pkt->token[4],
@@ -485,63 +672,11 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
          );                     /*FIXME always prints 8 bytes */
 
   /* parse options */
-  memset(coap_pkt->options, 0, sizeof(coap_pkt->options));
-  current_option += coap_pkt->token_len;
-
-  unsigned int option_number = 0;
-  unsigned int option_delta = 0;
-  size_t option_length = 0;
-
-  while(current_option < data + data_len) {
-    /* payload marker 0xFF, currently only checking for 0xF* because rest is reserved */
-    if((current_option[0] & 0xF0) == 0xF0) {
-      coap_pkt->payload = ++current_option;
-      coap_pkt->payload_len = data_len - (coap_pkt->payload - data);
-
-      /* also for receiving, the Erbium upper bound is REST_MAX_CHUNK_SIZE */
-      if(coap_pkt->payload_len > REST_MAX_CHUNK_SIZE) {
-        coap_pkt->payload_len = REST_MAX_CHUNK_SIZE;
-        /* null-terminate payload */
-      }
-      coap_pkt->payload[coap_pkt->payload_len] = '\0';
-
-      break;
-    }
-
-    option_delta = current_option[0] >> 4;
-    option_length = current_option[0] & 0x0F;
-    ++current_option;
-
-    if(option_delta == 13) {
-      option_delta += current_option[0];
-      ++current_option;
-    } else if(option_delta == 14) {
-      option_delta += 255;
-      option_delta += current_option[0] << 8;
-      ++current_option;
-      option_delta += current_option[0];
-      ++current_option;
-    }
-
-    if(option_length == 13) {
-      option_length += current_option[0];
-      ++current_option;
-    } else if(option_length == 14) {
-      option_length += 255;
-      option_length += current_option[0] << 8;
-      ++current_option;
-      option_length += current_option[0];
-      ++current_option;
-    }
-
-    if(current_option + option_length > data + data_len) {
-      /* Malformed CoAP - out of bounds */
-      PRINTF("BAD REQUEST: options outside data packet: %u > %u\n",
-             (unsigned)(current_option + option_length - data), data_len);
-      return BAD_REQUEST_4_00;
-    }
-
-    option_number += option_delta;
+  while((next = coap_option_next(&it)) > 0) {
+    option_number = it.number;
+    option_length = it.length;
+    /* multi-options are merged in place, so the buffer is written to */
+    current_option = data + (it.value - it.buffer);
 
     if(option_number > COAP_OPTION_SIZE1) {
       /* Malformed CoAP - out of bounds */
@@ -549,8 +684,7 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
       return BAD_REQUEST_4_00;
     }
 
-    PRINTF("OPTION %u (delta %u, len %zu): ", option_number, option_delta,
-           option_length);
+    PRINTF("OPTION %u (len %zu): ", option_number, option_length);
 
     SET_OPTION(coap_pkt, option_number);
 
@@ -706,8 +840,24 @@ coap_parse_message(void *packet, uint8_t *data, uint16_t data_len)
       }
     }
 
-    current_option += option_length;
-  }                             /* for */
+  }
+  if(next < 0) {
+    /* Malformed CoAP - out of bounds */
+    coap_error_message = "Malformed option";
+    return BAD_REQUEST_4_00;
+  }
+
+  coap_pkt->payload_len = coap_option_get_payload(&it, &payload);
+  if(payload != NULL) {
+    coap_pkt->payload = data + (payload - it.buffer);
+
+    /* also for receiving, the Erbium upper bound is REST_MAX_CHUNK_SIZE */
+    if(coap_pkt->payload_len > REST_MAX_CHUNK_SIZE) {
+      coap_pkt->payload_len = REST_MAX_CHUNK_SIZE;
+    }
+    /* null-terminate payload */
+    coap_pkt->payload[coap_pkt->payload_len] = '\0';
+  }
   PRINTF("-Done parsing-------\n");
 
   return NO_ERROR;
@@ -1224,7 +1374,9 @@ coap_set_payload(void *packet, const void *payload, size_t length)
   coap_pkt->payload_len = MIN(REST_MAX_CHUNK_SIZE, length);
 
   if(priority_flag==1){
-    UIP_IP_BUF->tcflow = packet_priority;
+    /* Low nibble of the traffic class, keep the flow label bits. uip6
+     * rewrites vtc on send, so priorities are limited to 0..15. */
+    UIP_IP_BUF->tcflow = (packet_priority << 4) | (UIP_IP_BUF->tcflow & 0x0f);
   }
   priority_flag = 0;
   //packet_priority = 0;
@@ -77,6 +77,7 @@
 enum { OPTION_MAP_SIZE = sizeof(uint8_t) * 8 };
 
 #define SET_OPTION(packet, opt) ((packet)->options[opt / OPTION_MAP_SIZE] |= 1 << (opt % OPTION_MAP_SIZE))
+#define UNSET_OPTION(packet, opt) ((packet)->options[opt / OPTION_MAP_SIZE] &= ~(1 << (opt % OPTION_MAP_SIZE)))
 #define IS_OPTION(packet, opt) ((packet)->options[opt / OPTION_MAP_SIZE] & (1 << (opt % OPTION_MAP_SIZE)))
 
 /* parsed message struct */
@@ -132,45 +133,38 @@ typedef struct {
   uint8_t *payload;
 } coap_packet_t;
 
-/* option format serialization */
-#define COAP_SERIALIZE_INT_OPTION(number, field, text) \
-  if(IS_OPTION(coap_pkt, number)) { \
-    PRINTF(text " [%u]\n", (unsigned int)coap_pkt->field); \
-    option += coap_serialize_int_option(number, current_number, option, coap_pkt->field); \
-    current_number = number; \
-  }
-#define COAP_SERIALIZE_BYTE_OPTION(number, field, text) \
-  if(IS_OPTION(coap_pkt, number)) { \
-    PRINTF(text " %u [0x%02X%02X%02X%02X%02X%02X%02X%02X]\n", (unsigned int)coap_pkt->field##_len, \
-           coap_pkt->field[0], \
-           coap_pkt->field[1], \
-           coap_pkt->field[2], \
-           coap_pkt->field[3], \
-           coap_pkt->field[4], \
-           coap_pkt->field[5], \
-           coap_pkt->field[6], \
-           coap_pkt->field[7] \
-           ); /* FIXME always prints 8 bytes */ \
-    option += coap_serialize_array_option(number, current_number, option, coap_pkt->field, coap_pkt->field##_len, '\0'); \
-    current_number = number; \
-  }
-#define COAP_SERIALIZE_STRING_OPTION(number, field, splitter, text) \
-  if(IS_OPTION(coap_pkt, number)) { \
-    PRINTF(text " [%.*s]\n", (int)coap_pkt->field##_len, coap_pkt->field); \
-    option += coap_serialize_array_option(number, current_number, option, (uint8_t *)coap_pkt->field, coap_pkt->field##_len, splitter); \
-    current_number = number; \
-  }
-#define COAP_SERIALIZE_BLOCK_OPTION(number, field, text) \
-  if(IS_OPTION(coap_pkt, number)) \
-  { \
-    PRINTF(text " [%lu%s (%u B/blk)]\n", (unsigned long)coap_pkt->field##_num, coap_pkt->field##_more ? "+" : "", coap_pkt->field##_size); \
-    uint32_t block = coap_pkt->field##_num << 4; \
-    if(coap_pkt->field##_more) { block |= 0x8; } \
-    block |= 0xF & coap_log_2(coap_pkt->field##_size / 16); \
-    PRINTF(text " encoded: 0x%lX\n", (unsigned long)block); \
-    option += coap_serialize_int_option(number, current_number, option, block); \
-    current_number = number; \
-  }
+/*
+ * In-place view of a received message. The header fields are decoded up
+ * front; options are decoded one at a time by coap_option_next(), straight
+ * from the buffer and without copying anything.
+ */
+typedef struct {
+  const uint8_t *buffer; /* start of the message */
+  const uint8_t *end;    /* first byte beyond the message */
+  const uint8_t *next;   /* header of the next option or the payload marker */
+
+  coap_message_type_t type;
+  uint8_t code;
+  uint16_t mid;
+  uint8_t token_len;
+  const uint8_t *token;
+
+  unsigned int number;   /* current option */
+  size_t length;
+  const uint8_t *value;
+} coap_option_iterator_t;
+
+/*
+ * Builds a message in a single pass. Options must be written in ascending
+ * order; every write is checked against the end of the buffer, and once a
+ * write failed the writer stays failed (current is NULL).
+ */
+typedef struct {
+  uint8_t *buffer;      /* start of the message */
+  uint8_t *current;     /* next byte to write, NULL after an error */
+  uint8_t *end;         /* first byte beyond the space for header and options */
+  unsigned int number;  /* last option written */
+} coap_message_writer_t;
 
 /* to store error code and human-readable payload */
 extern coap_status_t erbium_status_code;
@@ -187,6 +181,26 @@ void coap_send_message(uip_ipaddr_t *addr, uint16_t port, uint8_t *data,
 coap_status_t coap_parse_message(void *request, uint8_t *data,
                                  uint16_t data_len);
 
+coap_status_t coap_option_iterator_init(coap_option_iterator_t *it,
+                                        const uint8_t *data,
+                                        uint16_t data_len);
+int coap_option_next(coap_option_iterator_t *it);
+int coap_option_find(coap_option_iterator_t *it, unsigned int number);
+uint32_t coap_option_get_int(const coap_option_iterator_t *it);
+uint16_t coap_option_get_payload(const coap_option_iterator_t *it,
+                                 const uint8_t **payload);
+
+void coap_message_writer_init(coap_message_writer_t *writer, uint8_t *buffer,
+                              size_t size, coap_message_type_t type,
+                              uint8_t code, uint16_t mid,
+                              const uint8_t *token, size_t token_len);
+int coap_write_option(coap_message_writer_t *writer, unsigned int number,
+                      const void *value, size_t length);
+int coap_write_int_option(coap_message_writer_t *writer, unsigned int number,
+                          uint32_t value);
+size_t coap_write_payload(coap_message_writer_t *writer, const void *payload,
+                          size_t length);
+
 int coap_get_query_variable(void *packet, const char *name,
                             const char **output);
 int coap_get_post_variable(void *packet, const char *name,
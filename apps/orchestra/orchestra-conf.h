@@ -49,6 +49,8 @@
 #define ORCHESTRA_RULES { &eb_per_time_source, &unicast_per_neighbor_rpl_storing, &default_common }
 /* Example configuration for RPL non-storing mode: */
 /* #define ORCHESTRA_RULES { &eb_per_time_source, &unicast_per_neighbor_rpl_ns, &default_common } */
+/* Example configuration with extra cells for busy neighbors (see below): */
+/* #define ORCHESTRA_RULES { &eb_per_time_source, &unicast_per_neighbor_rpl_storing, &unicast_adaptive, &default_common } */
 
 #endif /* ORCHESTRA_CONF_RULES */
 
@@ -72,6 +74,39 @@
 #define ORCHESTRA_UNICAST_PERIOD                  17
 #endif /* ORCHESTRA_CONF_UNICAST_PERIOD */
 
+/* Traffic-adaptive unicast cells (rule unicast_adaptive): length of the
+ * slotframe holding the extra cells. Requires TSCH_CALLBACK_PACKET_SENT and
+ * TSCH_CALLBACK_PACKET_RECEIVED to be set to the Orchestra callbacks. */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_PERIOD
+#define ORCHESTRA_ADAPTIVE_PERIOD                 ORCHESTRA_CONF_ADAPTIVE_PERIOD
+#else /* ORCHESTRA_CONF_ADAPTIVE_PERIOD */
+#define ORCHESTRA_ADAPTIVE_PERIOD                 13
+#endif /* ORCHESTRA_CONF_ADAPTIVE_PERIOD */
+
+/* Traffic-adaptive unicast cells: the maximum number of extra cells per
+ * neighbor and direction */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS
+#define ORCHESTRA_ADAPTIVE_MAX_CELLS              ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS
+#else /* ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS */
+#define ORCHESTRA_ADAPTIVE_MAX_CELLS              3
+#endif /* ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS */
+
+/* Traffic-adaptive unicast cells: the number of adaptive slotframes
+ * over which traffic is counted before updating the cells */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_EPOCH
+#define ORCHESTRA_ADAPTIVE_EPOCH                  ORCHESTRA_CONF_ADAPTIVE_EPOCH
+#else /* ORCHESTRA_CONF_ADAPTIVE_EPOCH */
+#define ORCHESTRA_ADAPTIVE_EPOCH                  8
+#endif /* ORCHESTRA_CONF_ADAPTIVE_EPOCH */
+
+/* Traffic-adaptive unicast cells: no cells are added towards neighbors
+ * with an ETX above this */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_MAX_ETX
+#define ORCHESTRA_ADAPTIVE_MAX_ETX                ORCHESTRA_CONF_ADAPTIVE_MAX_ETX
+#else /* ORCHESTRA_CONF_ADAPTIVE_MAX_ETX */
+#define ORCHESTRA_ADAPTIVE_MAX_ETX                4
+#endif /* ORCHESTRA_CONF_ADAPTIVE_MAX_ETX */
+
 /* Is the per-neighbor unicast slotframe sender-based (if not, it is receiver-based).
  * Note: sender-based works only with RPL storing mode as it relies on DAO and
  * routing entries to keep track of children and parents. */
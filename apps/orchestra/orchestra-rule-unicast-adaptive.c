@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+/**
+ * \file
+ *         Orchestra: traffic-adaptive unicast cells, complementing the
+ *         per-neighbor unicast slotframe. For every neighbor we exchange
+ *         unicast frames with, both ends count the frames acknowledged in
+ *         each epoch (ORCHESTRA_ADAPTIVE_EPOCH slotframes, aligned on the
+ *         ASN) and derive from that count the number of extra cells the
+ *         sender needs. Cell i from A to B is at timeslot
+ *         hash(A, B) + i * period / (ORCHESTRA_ADAPTIVE_MAX_CELLS + 1),
+ *         so that both ends agree on the cells without any negotiation.
+ *
+ *         The receiver counts every frame its sender got an ACK for, and
+ *         possibly more when ACKs are lost. It also rounds its count up and
+ *         releases cells one epoch late, so it listens in every cell the
+ *         sender may use. The sender adds cells only when its queue to the
+ *         neighbor built up and the link is not failing. Cells that were
+ *         all full get one more, since the count cannot exceed what they
+ *         carry: without a per-neighbor unicast cell, that is all it sees.
+ */
+
+#include "contiki.h"
+#include "orchestra.h"
+#include "net/link-stats.h"
+#include "net/nbr-table.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include <string.h>
+
+#if ORCHESTRA_ADAPTIVE_PERIOD < ORCHESTRA_ADAPTIVE_MAX_CELLS + 1
+#error ORCHESTRA_ADAPTIVE_PERIOD must be greater than ORCHESTRA_ADAPTIVE_MAX_CELLS
+#endif
+
+/* Length of an epoch in timeslots */
+#define EPOCH_SLOTS ((uint32_t)ORCHESTRA_ADAPTIVE_PERIOD * ORCHESTRA_ADAPTIVE_EPOCH)
+/* How often we look for the end of an epoch. Eight times per epoch,
+ * so that both ends update their cells close to the epoch boundary */
+#define CHECK_INTERVAL MAX(1, (clock_time_t)((uint64_t)CLOCK_SECOND * EPOCH_SLOTS \
+    * TSCH_DEFAULT_TS_TIMESLOT_LENGTH / 1000000 / 8))
+/* The sender adds cells only if at least that many packets were left
+ * in the neighbor queue after a transmission during the epoch */
+#define BACKLOG_THRESHOLD 2
+/* The receiver adds that many frames to its count, to cover frames
+ * counted in a different epoch by the two ends */
+#define RX_SLACK 1
+/* Distance between the cells of a neighbor */
+#define CELL_SPACING (ORCHESTRA_ADAPTIVE_PERIOD / (ORCHESTRA_ADAPTIVE_MAX_CELLS + 1))
+
+/* Per-neighbor traffic and cells */
+struct adaptive_nbr {
+  uint32_t epoch; /* The epoch the counters below refer to */
+  uint16_t tx_count; /* Frames the neighbor acknowledged in this epoch */
+  uint16_t rx_count; /* Frames received from the neighbor in this epoch */
+  uint16_t rx_prev; /* rx_count of the previous epoch */
+  uint8_t backlog; /* Largest queue left after a transmission in this epoch */
+  uint8_t tx_cells; /* Extra cells for sending to the neighbor */
+  uint8_t rx_cells; /* Extra cells for receiving from the neighbor */
+};
+NBR_TABLE(struct adaptive_nbr, adaptive_nbrs);
+
+static uint16_t slotframe_handle = 0;
+static uint16_t channel_offset = 0;
+static struct tsch_slotframe *sf_adaptive;
+static struct ctimer epoch_timer;
+
+/*---------------------------------------------------------------------------*/
+static uint32_t
+current_epoch(void)
+{
+  return tsch_current_asn.ls4b / EPOCH_SLOTS;
+}
+/*---------------------------------------------------------------------------*/
+/* The timeslot of cell i, from tx to rx */
+static uint16_t
+get_cell_timeslot(const linkaddr_t *tx, const linkaddr_t *rx, int i)
+{
+  uint16_t hash = ORCHESTRA_LINKADDR_HASH(tx) * 257 + ORCHESTRA_LINKADDR_HASH(rx);
+  return (hash + i * CELL_SPACING) % ORCHESTRA_ADAPTIVE_PERIOD;
+}
+/*---------------------------------------------------------------------------*/
+/* The number of extra cells needed to carry count frames per epoch with
+ * a 50% margin, i.e. one cell per slotframe carries half an epoch's worth
+ * of slotframes. The base unicast cell counts as one. Cells are released
+ * one per epoch. */
+static uint8_t
+needed_cells(uint16_t count, uint8_t current)
+{
+  uint32_t cells = ((uint32_t)count * 2 + ORCHESTRA_ADAPTIVE_EPOCH - 1) / ORCHESTRA_ADAPTIVE_EPOCH;
+  cells = cells > 0 ? cells - 1 : 0;
+  if(cells > ORCHESTRA_ADAPTIVE_MAX_CELLS) {
+    cells = ORCHESTRA_ADAPTIVE_MAX_CELLS;
+  }
+  if(current > 0 && cells < current - 1) {
+    cells = current - 1;
+  }
+  return cells;
+}
+/*---------------------------------------------------------------------------*/
+/* Move on to the next epoch, return 1 if the cells of the neighbor changed */
+static int
+next_epoch(struct adaptive_nbr *e, const linkaddr_t *addr)
+{
+  uint8_t tx_cells = needed_cells(e->tx_count, e->tx_cells);
+  uint8_t rx_cells = needed_cells(MAX(e->rx_count, e->rx_prev) + RX_SLACK, e->rx_cells);
+  int changed;
+
+  if(e->tx_cells > 0 && e->tx_cells < ORCHESTRA_ADAPTIVE_MAX_CELLS
+     && e->tx_count >= (uint16_t)e->tx_cells * ORCHESTRA_ADAPTIVE_EPOCH) {
+    /* Every cell carried a frame in every slotframe of the epoch: the count
+     * only tells what the cells could carry. Add one, the receiver rounds
+     * its count up and listens in it already */
+    tx_cells = MAX(tx_cells, e->tx_cells + 1);
+  }
+  if(tx_cells > e->tx_cells) {
+    /* Add cells only for a backlog, and not over a failing link */
+    const struct link_stats *stats = link_stats_from_lladdr(addr);
+    if(e->backlog < BACKLOG_THRESHOLD
+       || (stats != NULL && stats->etx > ORCHESTRA_ADAPTIVE_MAX_ETX * LINK_STATS_ETX_DIVISOR)) {
+      tx_cells = e->tx_cells;
+    }
+  }
+
+  changed = tx_cells != e->tx_cells || rx_cells != e->rx_cells;
+  e->tx_cells = tx_cells;
+  e->rx_cells = rx_cells;
+  e->rx_prev = e->rx_count;
+  e->tx_count = 0;
+  e->rx_count = 0;
+  e->backlog = 0;
+  e->epoch++;
+  return changed;
+}
+/*---------------------------------------------------------------------------*/
+/* Bring the neighbor up to the current epoch, return 1 if its cells changed */
+static int
+update_nbr(struct adaptive_nbr *e, const linkaddr_t *addr, uint32_t epoch)
+{
+  int changed = 0;
+  int i;
+  /* After the first idle epoch, the count remains 0 and every further epoch
+   * releases one cell, so there is no need to go through more of them */
+  for(i = 0; e->epoch != epoch && i < ORCHESTRA_ADAPTIVE_MAX_CELLS + 2; i++) {
+    changed |= next_epoch(e, addr);
+  }
+  e->epoch = epoch;
+  return changed;
+}
+/*---------------------------------------------------------------------------*/
+/* Do we need a cell at this timeslot? Returns the link options, or 0 */
+static uint8_t
+cell_options(uint16_t timeslot, const linkaddr_t **tx_addr)
+{
+  struct adaptive_nbr *e;
+  uint8_t options = 0;
+  *tx_addr = NULL;
+  for(e = nbr_table_head(adaptive_nbrs); e != NULL; e = nbr_table_next(adaptive_nbrs, e)) {
+    const linkaddr_t *addr = nbr_table_get_lladdr(adaptive_nbrs, e);
+    int i;
+    for(i = 0; i < e->rx_cells; i++) {
+      if(get_cell_timeslot(addr, &linkaddr_node_addr, i) == timeslot) {
+        options |= LINK_OPTION_RX;
+      }
+    }
+    for(i = 0; i < e->tx_cells; i++) {
+      if(*tx_addr == NULL && get_cell_timeslot(&linkaddr_node_addr, addr, i) == timeslot) {
+        *tx_addr = addr;
+      }
+    }
+  }
+  /* Receiving wins: the sender would otherwise transmit to nobody.
+   * If we drop a Tx cell, our neighbor only listens in vain. */
+  return options ? options : (*tx_addr != NULL ? LINK_OPTION_TX : 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Install or remove the cell at a timeslot to match the neighbor table */
+static void
+update_cell(uint16_t timeslot)
+{
+  const linkaddr_t *tx_addr;
+  uint8_t options = cell_options(timeslot, &tx_addr);
+  struct tsch_link *l = tsch_schedule_get_link_by_timeslot(sf_adaptive, timeslot);
+
+  if(options == 0) {
+    if(l != NULL) {
+      tsch_schedule_remove_link(sf_adaptive, l);
+    }
+  } else {
+    const linkaddr_t *addr = options == LINK_OPTION_TX ? tx_addr : &tsch_broadcast_address;
+    if(l == NULL || l->link_options != options || !linkaddr_cmp(&l->addr, addr)) {
+      tsch_schedule_add_link(sf_adaptive, options, LINK_TYPE_NORMAL, addr,
+                             timeslot, channel_offset);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Update all cells that a neighbor uses or used */
+static void
+update_nbr_cells(const linkaddr_t *addr)
+{
+  int i;
+  for(i = 0; i <= ORCHESTRA_ADAPTIVE_MAX_CELLS; i++) {
+    update_cell(get_cell_timeslot(addr, &linkaddr_node_addr, i));
+    update_cell(get_cell_timeslot(&linkaddr_node_addr, addr, i));
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct adaptive_nbr *
+get_nbr(const linkaddr_t *addr)
+{
+  struct adaptive_nbr *e = nbr_table_get_from_lladdr(adaptive_nbrs, addr);
+  uint32_t epoch = current_epoch();
+  if(e == NULL) {
+    e = nbr_table_add_lladdr(adaptive_nbrs, addr, NBR_TABLE_REASON_MAC, NULL);
+    if(e != NULL) {
+      memset(e, 0, sizeof(*e));
+      e->epoch = epoch;
+    }
+  } else if(update_nbr(e, addr, epoch)) {
+    update_nbr_cells(addr);
+  }
+  return e;
+}
+/*---------------------------------------------------------------------------*/
+static void
+nbr_removed(void *item)
+{
+  /* The neighbor is being evicted from the table, release its cells */
+  struct adaptive_nbr *e = item;
+  e->tx_cells = 0;
+  e->rx_cells = 0;
+  update_nbr_cells(nbr_table_get_lladdr(adaptive_nbrs, e));
+}
+/*---------------------------------------------------------------------------*/
+static void
+epoch_timer_callback(void *ptr)
+{
+  if(tsch_is_associated) {
+    struct adaptive_nbr *e;
+    struct adaptive_nbr *next;
+    uint32_t epoch = current_epoch();
+    for(e = nbr_table_head(adaptive_nbrs); e != NULL; e = next) {
+      const linkaddr_t *addr = nbr_table_get_lladdr(adaptive_nbrs, e);
+      next = nbr_table_next(adaptive_nbrs, e);
+      if(update_nbr(e, addr, epoch)) {
+        update_nbr_cells(addr);
+      }
+      if(e->tx_cells == 0 && e->rx_cells == 0 && e->rx_prev == 0
+         && e->tx_count == 0 && e->rx_count == 0) {
+        /* No traffic in the last epoch and no cells, forget the neighbor */
+        nbr_table_remove(adaptive_nbrs, e);
+      }
+    }
+  }
+  ctimer_set(&epoch_timer, CHECK_INTERVAL, epoch_timer_callback, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(const linkaddr_t *dest, int status, int transmissions)
+{
+  if(status == MAC_TX_OK && !linkaddr_cmp(dest, &linkaddr_null)) {
+    struct adaptive_nbr *e = get_nbr(dest);
+    if(e != NULL) {
+      int backlog = tsch_queue_packet_count(dest);
+      if(e->tx_count < 0xffff) {
+        e->tx_count++;
+      }
+      if(backlog > e->backlog) {
+        e->backlog = MIN(backlog, 0xff);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_received(const linkaddr_t *src, const linkaddr_t *dest)
+{
+  if(linkaddr_cmp(dest, &linkaddr_node_addr)) {
+    struct adaptive_nbr *e = get_nbr(src);
+    if(e != NULL && e->rx_count < 0xffff) {
+      e->rx_count++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(uint16_t sf_handle)
+{
+  slotframe_handle = sf_handle;
+  channel_offset = sf_handle;
+  /* Slotframe for the extra unicast cells, empty until traffic shows up */
+  sf_adaptive = tsch_schedule_add_slotframe(slotframe_handle, ORCHESTRA_ADAPTIVE_PERIOD);
+  nbr_table_register(adaptive_nbrs, (nbr_table_callback *)nbr_removed);
+  ctimer_set(&epoch_timer, CHECK_INTERVAL, epoch_timer_callback, NULL);
+}
+/*---------------------------------------------------------------------------*/
+struct orchestra_rule unicast_adaptive = {
+  init,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  packet_sent,
+  packet_received,
+};
@@ -106,6 +106,30 @@ orchestra_callback_child_removed(const linkaddr_t *addr)
 }
 /*---------------------------------------------------------------------------*/
 void
+orchestra_callback_packet_sent(const linkaddr_t *dest, int status, int transmissions)
+{
+  /* Notify all Orchestra rules that a packet left the TSCH queue */
+  int i;
+  for(i = 0; i < NUM_RULES; i++) {
+    if(all_rules[i]->packet_sent != NULL) {
+      all_rules[i]->packet_sent(dest, status, transmissions);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+orchestra_callback_packet_received(const linkaddr_t *src, const linkaddr_t *dest)
+{
+  /* Notify all Orchestra rules that a frame was received */
+  int i;
+  for(i = 0; i < NUM_RULES; i++) {
+    if(all_rules[i]->packet_received != NULL) {
+      all_rules[i]->packet_received(src, dest);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
 orchestra_callback_packet_ready(void)
 {
   int i;
@@ -50,12 +50,15 @@ struct orchestra_rule {
   int  (* select_packet)(uint16_t *slotframe, uint16_t *timeslot);
   void (* child_added)(const linkaddr_t *addr);
   void (* child_removed)(const linkaddr_t *addr);
+  void (* packet_sent)(const linkaddr_t *dest, int status, int transmissions);
+  void (* packet_received)(const linkaddr_t *src, const linkaddr_t *dest);
 };
 
-struct orchestra_rule eb_per_time_source;
-struct orchestra_rule unicast_per_neighbor_rpl_storing;
-struct orchestra_rule unicast_per_neighbor_rpl_ns;
-struct orchestra_rule default_common;
+extern struct orchestra_rule eb_per_time_source;
+extern struct orchestra_rule unicast_per_neighbor_rpl_storing;
+extern struct orchestra_rule unicast_per_neighbor_rpl_ns;
+extern struct orchestra_rule default_common;
+extern struct orchestra_rule unicast_adaptive;
 
 extern linkaddr_t orchestra_parent_linkaddr;
 extern int orchestra_parent_knows_us;
@@ -71,5 +74,9 @@ void orchestra_callback_new_time_source(const struct tsch_neighbor *old, const s
 void orchestra_callback_child_added(const linkaddr_t *addr);
 /* Set with #define NETSTACK_CONF_ROUTING_NEIGHBOR_REMOVED_CALLBACK orchestra_callback_child_removed */
 void orchestra_callback_child_removed(const linkaddr_t *addr);
+/* Set with #define TSCH_CALLBACK_PACKET_SENT orchestra_callback_packet_sent */
+void orchestra_callback_packet_sent(const linkaddr_t *dest, int status, int transmissions);
+/* Set with #define TSCH_CALLBACK_PACKET_RECEIVED orchestra_callback_packet_received */
+void orchestra_callback_packet_received(const linkaddr_t *src, const linkaddr_t *dest);
 
 #endif /* __ORCHESTRA_H__ */
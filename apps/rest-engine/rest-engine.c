@@ -58,6 +58,101 @@ PROCESS(rest_engine_process, "REST Engine");
 /*---------------------------------------------------------------------------*/
 LIST(restful_services);
 LIST(restful_periodic_services);
+
+#if REST_MAX_PATH_NODES
+/* a URI-Path segment of the activated resources */
+typedef struct rest_path_node {
+  struct rest_path_node *next;     /* next segment at the same level */
+  struct rest_path_node *children; /* segments following this one */
+  const char *segment;             /* points into the URL of a resource */
+  uint8_t segment_len;
+  resource_t *resource;            /* resource at this path, if any */
+} rest_path_node_t;
+
+MEMB(path_nodes_memb, rest_path_node_t, REST_MAX_PATH_NODES);
+static rest_path_node_t *path_trie;
+#endif /* REST_MAX_PATH_NODES */
+
+/* resources were activated that are not in the trie */
+static uint8_t unindexed_resources;
+/*---------------------------------------------------------------------------*/
+#if REST_MAX_PATH_NODES
+static int
+segment_length(const char *path, int len)
+{
+  const char *slash = memchr(path, '/', len);
+
+  return slash == NULL ? len : slash - path;
+}
+/*---------------------------------------------------------------------------*/
+static rest_path_node_t *
+find_segment(rest_path_node_t *node, const char *segment, int len)
+{
+  for(; node != NULL; node = node->next) {
+    if(node->segment_len == len && memcmp(node->segment, segment, len) == 0) {
+      return node;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+add_to_trie(resource_t *resource)
+{
+  rest_path_node_t **level = &path_trie;
+  rest_path_node_t *node;
+  const char *segment = resource->url;
+  const char *end = segment + strlen(segment);
+  int len;
+
+  while(1) {
+    len = segment_length(segment, end - segment);
+    if((node = find_segment(*level, segment, len)) == NULL) {
+      if(len > 0xff || (node = memb_alloc(&path_nodes_memb)) == NULL) {
+        return 0;
+      }
+      node->segment = segment;
+      node->segment_len = len;
+      node->children = NULL;
+      node->resource = NULL;
+      node->next = *level;
+      *level = node;
+    }
+    segment += len;
+    if(segment == end) {
+      break;
+    }
+    /* skip the slash */
+    ++segment;
+    level = &node->children;
+  }
+
+  node->resource = resource;
+  return 1;
+}
+#endif /* REST_MAX_PATH_NODES */
+/*---------------------------------------------------------------------------*/
+static resource_t *
+find_in_list(const char *url, int url_len)
+{
+  resource_t *resource = NULL;
+  int res_url_len;
+
+  for(resource = (resource_t *)list_head(restful_services);
+      resource; resource = resource->next) {
+
+    /* if the web service handles that kind of requests and urls matches */
+    res_url_len = strlen(resource->url);
+    if((url_len == res_url_len
+        || (url_len > res_url_len
+            && (resource->flags & HAS_SUB_RESOURCES)
+            && url[res_url_len] == '/'))
+       && strncmp(resource->url, url, res_url_len) == 0) {
+      return resource;
+    }
+  }
+  return NULL;
+}
 /*---------------------------------------------------------------------------*/
 /*- REST Engine API ---------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -107,6 +202,15 @@ rest_activate_resource(resource_t *resource, char *path)
 
   PRINTF("Activating: %s\n", resource->url);
 
+#if REST_MAX_PATH_NODES
+  if(!add_to_trie(resource)) {
+    PRINTF("No room in the path trie for %s\n", resource->url);
+    unindexed_resources = 1;
+  }
+#else /* REST_MAX_PATH_NODES */
+  unindexed_resources = 1;
+#endif /* REST_MAX_PATH_NODES */
+
   /* Only add periodic resources with a periodic_handler and a period > 0. */
   if(resource->flags & IS_PERIODIC && resource->periodic->periodic_handler
      && resource->periodic->period) {
@@ -132,64 +236,94 @@ rest_get_resources(void)
   return restful_services;
 }
 /*---------------------------------------------------------------------------*/
+resource_t *
+rest_find_resource(const char *url, int url_len)
+{
+  resource_t *parent = NULL;
+#if REST_MAX_PATH_NODES
+  rest_path_node_t *node = path_trie;
+  const char *segment = url;
+  const char *end = url + url_len;
+  int len;
+
+  /* one pass over the segments of the path */
+  while(1) {
+    len = segment_length(segment, end - segment);
+    if((node = find_segment(node, segment, len)) == NULL) {
+      break;
+    }
+    segment += len;
+    if(segment == end) {
+      if(node->resource != NULL) {
+        return node->resource;
+      }
+      break;
+    }
+    /* more segments follow */
+    if(node->resource != NULL && (node->resource->flags & HAS_SUB_RESOURCES)) {
+      parent = node->resource;
+    }
+    ++segment;
+    node = node->children;
+  }
+#endif /* REST_MAX_PATH_NODES */
+
+  if(unindexed_resources) {
+    resource_t *resource = find_in_list(url, url_len);
+
+    if(resource != NULL) {
+      return resource;
+    }
+  }
+  return parent;
+}
+/*---------------------------------------------------------------------------*/
 int
 rest_invoke_restful_service(void *request, void *response, uint8_t *buffer,
                             uint16_t buffer_size, int32_t *offset)
 {
-  uint8_t found = 0;
   uint8_t allowed = 1;
 
   resource_t *resource = NULL;
   const char *url = NULL;
-  int url_len, res_url_len;
+  int url_len;
 
   url_len = REST.get_url(request, &url);
-  for(resource = (resource_t *)list_head(restful_services);
-      resource; resource = resource->next) {
+  resource = rest_find_resource(url, url_len);
+  if(resource == NULL) {
+    REST.set_response_status(response, REST.status.NOT_FOUND);
+    return 0;
+  }
 
-    /* if the web service handles that kind of requests and urls matches */
-    res_url_len = strlen(resource->url);
-    if((url_len == res_url_len
-        || (url_len > res_url_len
-            && (resource->flags & HAS_SUB_RESOURCES)
-            && url[res_url_len] == '/'))
-       && strncmp(resource->url, url, res_url_len) == 0) {
-      found = 1;
-      rest_resource_flags_t method = REST.get_method_type(request);
-
-      PRINTF("/%s, method %u, resource->flags %u\n", resource->url,
-             (uint16_t)method, resource->flags);
-
-      if((method & METHOD_GET) && resource->get_handler != NULL) {
-        /* call handler function */
-        resource->get_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_POST) && resource->post_handler != NULL) {
-        /* call handler function */
-        resource->post_handler(request, response, buffer, buffer_size,
-                               offset);
-      } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
-        /* call handler function */
-        resource->put_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
-        /* call handler function */
-        resource->delete_handler(request, response, buffer, buffer_size,
-                                 offset);
-      } else {
-        allowed = 0;
-        REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
-      }
-      break;
-    }
+  rest_resource_flags_t method = REST.get_method_type(request);
+
+  PRINTF("/%s, method %u, resource->flags %u\n", resource->url,
+         (uint16_t)method, resource->flags);
+
+  if((method & METHOD_GET) && resource->get_handler != NULL) {
+    /* call handler function */
+    resource->get_handler(request, response, buffer, buffer_size, offset);
+  } else if((method & METHOD_POST) && resource->post_handler != NULL) {
+    /* call handler function */
+    resource->post_handler(request, response, buffer, buffer_size, offset);
+  } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
+    /* call handler function */
+    resource->put_handler(request, response, buffer, buffer_size, offset);
+  } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
+    /* call handler function */
+    resource->delete_handler(request, response, buffer, buffer_size, offset);
+  } else {
+    allowed = 0;
+    REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
   }
-  if(!found) {
-    REST.set_response_status(response, REST.status.NOT_FOUND);
-  } else if(allowed) {
+
+  if(allowed) {
     /* final handler for special flags */
     if(resource->flags & IS_OBSERVABLE) {
       REST.subscription_handler(resource, request, response);
     }
   }
-  return found & allowed;
+  return allowed;
 }
 /*-----------------------------------------------------------------------------------*/
 PROCESS_THREAD(rest_engine_process, ev, data)
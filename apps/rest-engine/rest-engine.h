@@ -62,6 +62,16 @@
 #define REST_MAX_CHUNK_SIZE     64
 #endif
 
+/*
+ * Number of URI-Path segments in the trie the resources are looked up in.
+ * Each activated resource takes one per segment not shared with another
+ * resource. Resources that do not fit are found by a scan of the resource
+ * list. 0 disables the trie.
+ */
+#ifndef REST_MAX_PATH_NODES
+#define REST_MAX_PATH_NODES     16
+#endif
+
 struct resource_s;
 struct periodic_resource_s;
 
@@ -248,6 +258,19 @@ void rest_init_engine(void);
  */
 void rest_activate_resource(resource_t *resource, char *path);
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief      Looks up the resource that handles a URI path.
+ * \param url
+ *             The URI path, without leading slash. It need not be
+ *             null-terminated.
+ * \param url_len
+ *             The length of the URI path.
+ * \return     The resource activated at url or, if there is none, the
+ *             resource with sub-resources at the longest parent path of
+ *             url. NULL if there is neither.
+ */
+resource_t *rest_find_resource(const char *url, int url_len);
+/*---------------------------------------------------------------------------*/
 /**
  * \brief      Returns the list of registered RESTful resources.
  * \return     The resource list.
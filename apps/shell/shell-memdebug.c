@@ -40,6 +40,7 @@
 
 #include "contiki.h"
 #include "shell-memdebug.h"
+#include "lib/memb.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -55,6 +56,13 @@ SHELL_COMMAND(peek_command,
 	      "peek",
 	      "peek <address>: read a byte from address <address>",
 	      &shell_peek_process);
+#if MEMB_STATS
+PROCESS(shell_memb_process, "memb");
+SHELL_COMMAND(memb_command,
+	      "memb",
+	      "memb: show memory block usage",
+	      &shell_memb_process);
+#endif /* MEMB_STATS */
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(shell_poke_process, ev, data)
 {
@@ -119,10 +127,38 @@ PROCESS_THREAD(shell_peek_process, ev, data)
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
+#if MEMB_STATS
+PROCESS_THREAD(shell_memb_process, ev, data)
+{
+  struct memb *m;
+  char buf[64];
+
+  PROCESS_BEGIN();
+
+  shell_output_str(&memb_command, "name: size used/num max failures", "");
+  for(m = memb_stats_head(); m != NULL; m = memb_stats_next(m)) {
+    snprintf(buf, sizeof(buf), "%s: %u %u/%u %u %u",
+             m->name, m->size, m->used, m->num, m->max_used, m->failures);
+#if MEMB_WITH_SLAB
+    if(m->slab != NULL) {
+      shell_output_str(&memb_command, buf, " (shared)");
+      continue;
+    }
+#endif /* MEMB_WITH_SLAB */
+    shell_output_str(&memb_command, buf, "");
+  }
+
+  PROCESS_END();
+}
+#endif /* MEMB_STATS */
+/*---------------------------------------------------------------------------*/
 void
 shell_memdebug_init(void)
 {
   shell_register_command(&poke_command);
   shell_register_command(&peek_command);
+#if MEMB_STATS
+  shell_register_command(&memb_command);
+#endif /* MEMB_STATS */
 }
 /*---------------------------------------------------------------------------*/
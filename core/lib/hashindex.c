@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         hashindex library. Indexes items by a key that is part of
+ *         the items, in an open addressing hash table of pointers with
+ *         linear probing. Removal moves the following entries back
+ *         rather than leaving tombstones, so that lookups never probe
+ *         further than needed.
+ */
+
+#include <string.h>
+#include "lib/hashindex.h"
+
+/*---------------------------------------------------------------------------*/
+/* The key of an item */
+static const uint8_t *
+item_key(const struct hashindex *h, const void *item)
+{
+  return (const uint8_t *)item + h->key_offset;
+}
+/*---------------------------------------------------------------------------*/
+/* The home slot of a key */
+static int
+key_slot(const struct hashindex *h, const uint8_t *key)
+{
+  /* FNV-1a, so that keys differing only in the last bytes still
+     spread over the whole table */
+  uint32_t hash = 2166136261UL;
+  int i;
+
+  for(i = 0; i < h->key_len; i++) {
+    hash ^= key[i];
+    hash *= 16777619UL;
+  }
+  return (hash ^ (hash >> 16)) % h->size;
+}
+/*---------------------------------------------------------------------------*/
+void
+hashindex_init(struct hashindex *h)
+{
+  memset(h->slots, 0, h->size * sizeof(void *));
+  h->num = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+hashindex_add(struct hashindex *h, void *item)
+{
+  int i;
+
+  /* Keep one slot free to end the probes */
+  if(h->num >= h->size - 1) {
+    return 0;
+  }
+  i = key_slot(h, item_key(h, item));
+  while(h->slots[i] != NULL) {
+    i = (i + 1) % h->size;
+  }
+  h->slots[i] = item;
+  h->num++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+hashindex_remove(struct hashindex *h, void *item)
+{
+  int i = key_slot(h, item_key(h, item));
+  int j;
+  int home;
+
+  while(h->slots[i] != item) {
+    if(h->slots[i] == NULL) {
+      return;
+    }
+    i = (i + 1) % h->size;
+  }
+
+  h->slots[i] = NULL;
+  h->num--;
+  for(j = (i + 1) % h->size; h->slots[j] != NULL; j = (j + 1) % h->size) {
+    home = key_slot(h, item_key(h, h->slots[j]));
+    /* Leave the entry if its home slot is cyclically in (i, j] */
+    if(i <= j ? (i < home && home <= j) : (i < home || home <= j)) {
+      continue;
+    }
+    h->slots[i] = h->slots[j];
+    h->slots[j] = NULL;
+    i = j;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void *
+hashindex_lookup_next(const struct hashindex *h, const void *key, int *slot)
+{
+  int i;
+
+  i = *slot < 0 ? key_slot(h, key) : (*slot + 1) % h->size;
+  for(; h->slots[i] != NULL; i = (i + 1) % h->size) {
+    if(memcmp(item_key(h, h->slots[i]), key, h->key_len) == 0) {
+      *slot = i;
+      return h->slots[i];
+    }
+  }
+  *slot = i;
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+void *
+hashindex_lookup(const struct hashindex *h, const void *key)
+{
+  int slot = -1;
+
+  return hashindex_lookup_next(h, key, &slot);
+}
+/*---------------------------------------------------------------------------*/
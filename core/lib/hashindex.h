@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Header file for the hashindex library
+ */
+
+#ifndef HASHINDEX_H_
+#define HASHINDEX_H_
+
+#include "contiki-conf.h"
+#include "sys/cc.h"
+#include <stddef.h>
+
+/**
+ * An index of items by a key of key_len bytes found key_offset bytes
+ * into every item. The index is an open addressing hash table of
+ * pointers to the items, with linear probing. It must have more slots
+ * than there are items to index, so that a free slot ends every probe.
+ */
+struct hashindex {
+  void **slots;
+  uint16_t size;
+  uint16_t num;
+  uint16_t key_offset;
+  uint8_t key_len;
+};
+
+/**
+ * Declare a hash index.
+ *
+ * Example, to index struct neighbor by its addr field:
+ \code
+HASHINDEX(neighbor_index, 2 * MAX_NEIGHBORS,
+          offsetof(struct neighbor, addr), sizeof(linkaddr_t));
+ \endcode
+ *
+ * \param name The name of the hash index
+ * \param size The number of slots, larger than the number of items
+ * \param key_offset The offset of the key in the items
+ * \param key_len The length of the key in bytes
+ */
+#define HASHINDEX(name, size, key_offset, key_len) \
+        static void *CC_CONCAT(name,_hashindex_slots)[size]; \
+        static struct hashindex name = {CC_CONCAT(name,_hashindex_slots), \
+                                        size, 0, key_offset, key_len}
+
+/**
+ * \brief Empty a hash index
+ * \param h Pointer to the hash index
+ */
+void hashindex_init(struct hashindex *h);
+
+/**
+ * \brief Add an item to a hash index
+ * \param h Pointer to the hash index
+ * \param item The item, whose key must not change while it is indexed
+ * \retval 0 Failure; the hash index is full
+ * \retval 1 Success; the item is added
+ */
+int hashindex_add(struct hashindex *h, void *item);
+
+/**
+ * \brief Remove an item from a hash index. Nothing is done if the item
+ *        is not in the index.
+ * \param h Pointer to the hash index
+ * \param item The item
+ */
+void hashindex_remove(struct hashindex *h, void *item);
+
+/**
+ * \brief Find the first item with a key
+ * \param h Pointer to the hash index
+ * \param key The key_len bytes of the key
+ * \return The item, or NULL if no item has the key
+ */
+void *hashindex_lookup(const struct hashindex *h, const void *key);
+
+/**
+ * \brief Find the items with a key one after the other, for keys that
+ *        are only part of what identifies an item
+ * \param h Pointer to the hash index
+ * \param key The key_len bytes of the key
+ * \param slot Where the search is kept between calls; must be -1 to
+ *        find the first item
+ * \return The next item, or NULL if no more items have the key
+ */
+void *hashindex_lookup_next(const struct hashindex *h, const void *key,
+                            int *slot);
+
+#endif /* HASHINDEX_H_ */
@@ -47,17 +47,205 @@
 #include "contiki.h"
 #include "lib/memb.h"
 
+#if MEMB_STATS
+static struct memb *stats_head, *stats_tail;
+/*---------------------------------------------------------------------------*/
+static void
+stats_register(struct memb *m)
+{
+  if(m->next != NULL || m == stats_tail) {
+    return;
+  }
+  if(stats_tail == NULL) {
+    stats_head = m;
+  } else {
+    stats_tail->next = m;
+  }
+  stats_tail = m;
+}
+/*---------------------------------------------------------------------------*/
+struct memb *
+memb_stats_head(void)
+{
+  return stats_head;
+}
+/*---------------------------------------------------------------------------*/
+struct memb *
+memb_stats_next(struct memb *m)
+{
+  return m->next;
+}
+#endif /* MEMB_STATS */
+/*---------------------------------------------------------------------------*/
+#if MEMB_WITH_SLAB || MEMB_STATS
+static void
+count_alloc(struct memb *m, void *ptr)
+{
+#if MEMB_STATS
+  stats_register(m);
+  if(ptr == NULL) {
+    m->failures++;
+    return;
+  }
+#endif /* MEMB_STATS */
+  if(ptr != NULL) {
+    m->used++;
+  }
+#if MEMB_STATS
+  if(m->used > m->max_used) {
+    m->max_used = m->used;
+  }
+#endif /* MEMB_STATS */
+}
+#endif /* MEMB_WITH_SLAB || MEMB_STATS */
+/*---------------------------------------------------------------------------*/
+/* Index of the block that ptr points to, or -1 */
+static int
+block_index(struct memb *m, void *ptr)
+{
+  unsigned long offset;
+
+  if((char *)ptr < (char *)m->mem) {
+    return -1;
+  }
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset >= (unsigned long)m->num * m->size || offset % m->size != 0) {
+    return -1;
+  }
+  return offset / m->size;
+}
+/*---------------------------------------------------------------------------*/
+#if MEMB_WITH_SLAB
+/* Blocks that have been freed are linked through m->links, blocks
+   that were never allocated are taken in order from m->fresh */
+static void *
+slab_alloc(struct memb *m)
+{
+  unsigned short i;
+  char *block;
+
+  if(m->slab != NULL) {
+    if(m->used >= m->num || m->size > m->slab->size) {
+      return NULL;
+    }
+    block = memb_alloc(m->slab);
+    if(block != NULL) {
+      m->slab->owner[block_index(m->slab, block)] = m;
+    }
+    return block;
+  }
+
+  if(m->free != 0) {
+    i = m->free - 1;
+    m->free = m->links[i];
+  } else if(m->fresh < m->num) {
+    i = m->fresh++;
+  } else {
+    return NULL;
+  }
+  m->count[i] = 1;
+  return (char *)m->mem + i * m->size;
+}
+/*---------------------------------------------------------------------------*/
+static char
+slab_free(struct memb *m, void *ptr)
+{
+  int i;
+
+  if(m->slab != NULL) {
+    i = block_index(m->slab, ptr);
+    if(i < 0) {
+      return -1;
+    }
+    if(m->slab->count[i] == 0) {
+      /* Already free */
+      return 0;
+    }
+    if(m->slab->owner[i] != m) {
+      /* Allocated for another memory block that shares the slab */
+      return -1;
+    }
+    m->slab->owner[i] = NULL;
+    m->used--;
+    return memb_free(m->slab, ptr);
+  }
+
+  i = block_index(m, ptr);
+  if(i < 0) {
+    return -1;
+  }
+  if(m->owner != NULL && m->owner[i] != NULL) {
+    /* Must be freed through the memory block that it was allocated for */
+    return -1;
+  }
+  if(m->count[i] > 0) {
+    /* Make sure that we don't deallocate free memory. */
+    if(--(m->count[i]) == 0) {
+      m->used--;
+      m->links[i] = m->free;
+      m->free = i + 1;
+    }
+  }
+  return m->count[i];
+}
+/*---------------------------------------------------------------------------*/
+/* Give the blocks allocated for a memory block back to its slab */
+static void
+slab_release(struct memb *m)
+{
+  struct memb *slab;
+  unsigned short i;
+
+  slab = m->slab;
+  for(i = 0; i < slab->num; i++) {
+    if(slab->owner[i] == m) {
+      slab->owner[i] = NULL;
+      slab->count[i] = 1;
+      memb_free(slab, (char *)slab->mem + i * slab->size);
+    }
+  }
+}
+#endif /* MEMB_WITH_SLAB */
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
-  memset(m->count, 0, m->num);
-  memset(m->mem, 0, m->size * m->num);
+#if MEMB_WITH_SLAB
+  if(m->slab != NULL) {
+    slab_release(m);
+  }
+#endif /* MEMB_WITH_SLAB */
+  if(m->mem != NULL) {
+    memset(m->count, 0, m->num);
+    memset(m->mem, 0, m->size * m->num);
+  }
+#if MEMB_WITH_SLAB
+  if(m->owner != NULL) {
+    memset(m->owner, 0, m->num * sizeof(m->owner[0]));
+  }
+  m->free = 0;
+  m->fresh = 0;
+#endif /* MEMB_WITH_SLAB */
+#if MEMB_WITH_SLAB || MEMB_STATS
+  m->used = 0;
+#endif /* MEMB_WITH_SLAB || MEMB_STATS */
+#if MEMB_STATS
+  m->max_used = 0;
+  m->failures = 0;
+  stats_register(m);
+#endif /* MEMB_STATS */
 }
 /*---------------------------------------------------------------------------*/
 void *
 memb_alloc(struct memb *m)
 {
+#if MEMB_WITH_SLAB
+  void *ptr;
+
+  ptr = slab_alloc(m);
+  count_alloc(m, ptr);
+  return ptr;
+#else /* MEMB_WITH_SLAB */
   int i;
 
   for(i = 0; i < m->num; ++i) {
@@ -66,18 +254,28 @@ memb_alloc(struct memb *m)
 	 indicate that it now is used and return a pointer to the
 	 memory block. */
       ++(m->count[i]);
+#if MEMB_STATS
+      count_alloc(m, (char *)m->mem + (i * m->size));
+#endif /* MEMB_STATS */
       return (void *)((char *)m->mem + (i * m->size));
     }
   }
 
+#if MEMB_STATS
+  count_alloc(m, NULL);
+#endif /* MEMB_STATS */
   /* No free block was found, so we return NULL to indicate failure to
      allocate block. */
   return NULL;
+#endif /* MEMB_WITH_SLAB */
 }
 /*---------------------------------------------------------------------------*/
 char
 memb_free(struct memb *m, void *ptr)
 {
+#if MEMB_WITH_SLAB
+  return slab_free(m, ptr);
+#else /* MEMB_WITH_SLAB */
   int i;
   char *ptr2;
 
@@ -92,24 +290,56 @@ memb_free(struct memb *m, void *ptr)
       if(m->count[i] > 0) {
 	/* Make sure that we don't deallocate free memory. */
 	--(m->count[i]);
+#if MEMB_STATS
+	m->used--;
+#endif /* MEMB_STATS */
       }
       return m->count[i];
     }
     ptr2 += m->size;
   }
   return -1;
+#endif /* MEMB_WITH_SLAB */
 }
 /*---------------------------------------------------------------------------*/
 int
 memb_inmemb(struct memb *m, void *ptr)
 {
+#if MEMB_WITH_SLAB
+  int i;
+
+  if(m->slab != NULL) {
+    i = block_index(m->slab, ptr);
+    return i >= 0 && m->slab->owner[i] == m;
+  }
+#endif /* MEMB_WITH_SLAB */
   return (char *)ptr >= (char *)m->mem &&
     (char *)ptr < (char *)m->mem + (m->num * m->size);
 }
 /*---------------------------------------------------------------------------*/
 int
+memb_index(struct memb *m, void *ptr)
+{
+#if MEMB_WITH_SLAB
+  if(m->slab != NULL) {
+    m = m->slab;
+  }
+#endif /* MEMB_WITH_SLAB */
+  return block_index(m, ptr);
+}
+/*---------------------------------------------------------------------------*/
+int
 memb_numfree(struct memb *m)
 {
+#if MEMB_WITH_SLAB
+  int num_free;
+
+  num_free = m->num - m->used;
+  if(m->slab != NULL && memb_numfree(m->slab) < num_free) {
+    num_free = memb_numfree(m->slab);
+  }
+  return num_free;
+#else /* MEMB_WITH_SLAB */
   int i;
   int num_free = 0;
 
@@ -120,5 +350,6 @@ memb_numfree(struct memb *m)
   }
 
   return num_free;
+#endif /* MEMB_WITH_SLAB */
 }
 /** @} */
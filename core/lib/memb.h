@@ -88,16 +88,160 @@ MEMB(connections, struct connection, 16);
  */
 #define MEMB(name, structure, num) \
         static char CC_CONCAT(name,_memb_count)[num]; \
+        MEMB_LINKS(name, num) \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_count), \
-                                          (void *)CC_CONCAT(name,_memb_mem)}
+                                          (void *)CC_CONCAT(name,_memb_mem) \
+                                          MEMB_EXTRA_FIELDS(NULL, NULL, \
+                                                            MEMB_LINKS_PTR(name), \
+                                                            name)}
+
+/**
+ * MEMB_CONF_WITH_SLAB gives memory blocks a free list, so that
+ * memb_alloc() and memb_free() no longer scan the block, and lets
+ * blocks declared with MEMB_SHARED() take their memory from a slab
+ * declared with MEMB_SLAB().
+ */
+#ifdef MEMB_CONF_WITH_SLAB
+#define MEMB_WITH_SLAB MEMB_CONF_WITH_SLAB
+#else /* MEMB_CONF_WITH_SLAB */
+#define MEMB_WITH_SLAB 0
+#endif /* MEMB_CONF_WITH_SLAB */
+
+/**
+ * MEMB_CONF_STATS keeps the number of used blocks, the highest number
+ * of used blocks and the number of failed allocations of each memory
+ * block. Memory blocks are listed for memb_stats_head() once they
+ * have been initialized or used.
+ */
+#ifdef MEMB_CONF_STATS
+#define MEMB_STATS MEMB_CONF_STATS
+#else /* MEMB_CONF_STATS */
+#define MEMB_STATS 0
+#endif /* MEMB_CONF_STATS */
+
+#if MEMB_WITH_SLAB
+/* The free list links are kept apart from the blocks, so that a freed
+   block keeps its contents until it is allocated again */
+#define MEMB_LINKS(name, num) \
+        static unsigned short CC_CONCAT(name,_memb_links)[num];
+#define MEMB_LINKS_PTR(name) CC_CONCAT(name,_memb_links)
+#define MEMB_SLAB_FIELDS(slab, owner, links) , slab, owner, links, 0, 0
+#else /* MEMB_WITH_SLAB */
+#define MEMB_LINKS(name, num)
+#define MEMB_LINKS_PTR(name) NULL
+#define MEMB_SLAB_FIELDS(slab, owner, links)
+#endif /* MEMB_WITH_SLAB */
+
+#if MEMB_WITH_SLAB || MEMB_STATS
+#define MEMB_USED_FIELD , 0
+#else /* MEMB_WITH_SLAB || MEMB_STATS */
+#define MEMB_USED_FIELD
+#endif /* MEMB_WITH_SLAB || MEMB_STATS */
+
+#if MEMB_STATS
+#define MEMB_STATS_FIELDS(name) , 0, 0, #name, NULL
+#else /* MEMB_STATS */
+#define MEMB_STATS_FIELDS(name)
+#endif /* MEMB_STATS */
+
+#define MEMB_EXTRA_FIELDS(slab, owner, links, name) \
+        MEMB_SLAB_FIELDS(slab, owner, links) MEMB_USED_FIELD \
+        MEMB_STATS_FIELDS(name)
+
+#if MEMB_WITH_SLAB
+/* Slab blocks are rounded up to keep them aligned to a pointer */
+#define MEMB_SLAB_BLOCK_SIZE(size) \
+        (((size) + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *))
+
+/**
+ * Declare a slab: a memory block of a size class that other memory
+ * blocks can share with MEMB_SHARED(). Unlike MEMB(), the slab is
+ * global, so that it can be shared by several modules.
+ * Example:
+ \code
+MEMB_SLAB(small_slab, 32, 24);
+ \endcode
+ * \param name The name of the slab
+ * \param size The size of each block, in bytes
+ * \param num The total number of blocks in the slab
+ */
+#define MEMB_SLAB(name, size, num) \
+        static char CC_CONCAT(name,_memb_count)[num]; \
+        static struct memb *CC_CONCAT(name,_memb_owner)[num]; \
+        MEMB_LINKS(name, num) \
+        static void *CC_CONCAT(name,_memb_mem)[MEMB_SLAB_BLOCK_SIZE(size) / \
+                                                sizeof(void *) * (num)]; \
+        struct memb name = {MEMB_SLAB_BLOCK_SIZE(size), num, \
+                            CC_CONCAT(name,_memb_count), \
+                            (void *)CC_CONCAT(name,_memb_mem) \
+                            MEMB_EXTRA_FIELDS(NULL, \
+                                              CC_CONCAT(name,_memb_owner), \
+                                              MEMB_LINKS_PTR(name), \
+                                              name)}
+
+/**
+ * Declare a memory block that takes up to num blocks from a slab.
+ * The blocks of the slab must be at least as large as the structure.
+ * Memory blocks that share a slab can together hold more than the
+ * slab has room for, and can each use blocks that the others have
+ * left free. memb_free() only frees, and memb_inmemb() only accepts,
+ * blocks that are allocated from the same memory block, and
+ * memb_init() gives the blocks of the memory block back to the slab.
+ * Without
+ * MEMB_CONF_WITH_SLAB this is the same as MEMB().
+ * Example:
+ \code
+MEMB_SLAB_DECLARE(small_slab);
+MEMB_SHARED(connections, struct connection, 16, small_slab);
+ \endcode
+ * \param name The name of the memory block
+ * \param structure The name of the struct that the memory block holds
+ * \param num The most blocks that the memory block may use
+ * \param slab The slab that the blocks are taken from
+ */
+#define MEMB_SHARED(name, structure, num, slab) \
+        static struct memb name = {sizeof(structure), num, NULL, NULL \
+                                   MEMB_EXTRA_FIELDS(&slab, NULL, NULL, name)}
+#else /* MEMB_WITH_SLAB */
+#define MEMB_SLAB(name, size, num) extern struct memb name
+#define MEMB_SHARED(name, structure, num, slab) MEMB(name, structure, num)
+#endif /* MEMB_WITH_SLAB */
+
+/**
+ * Declare a slab that is defined with MEMB_SLAB() in another module.
+ */
+#define MEMB_SLAB_DECLARE(name) extern struct memb name
 
 struct memb {
   unsigned short size;
   unsigned short num;
   char *count;
   void *mem;
+#if MEMB_WITH_SLAB
+  /* Slab that the blocks are taken from, or NULL */
+  struct memb *slab;
+  /* For a slab, the memory block that each block was allocated for,
+     NULL for blocks allocated from the slab directly */
+  struct memb **owner;
+  /* For each free block, the next free block plus one, 0 at the end
+     of the list */
+  unsigned short *links;
+  /* First block on the free list plus one, 0 when the list is empty */
+  unsigned short free;
+  /* Blocks from this one on have not been allocated since memb_init() */
+  unsigned short fresh;
+#endif /* MEMB_WITH_SLAB */
+#if MEMB_WITH_SLAB || MEMB_STATS
+  unsigned short used;
+#endif /* MEMB_WITH_SLAB || MEMB_STATS */
+#if MEMB_STATS
+  unsigned short max_used;
+  unsigned short failures;
+  const char *name;
+  struct memb *next;
+#endif /* MEMB_STATS */
 };
 
 /**
@@ -130,8 +274,37 @@ char  memb_free(struct memb *m, void *ptr);
 
 int memb_inmemb(struct memb *m, void *ptr);
 
+/**
+ * Get the index of a block in a memory block.
+ *
+ * \param m A memory block previously declared with MEMB().
+ *
+ * \param ptr A pointer to a block of the memory block.
+ *
+ * \return The index of the block, from 0 to the number of blocks
+ * minus one, or -1 if "ptr" does not point to a block of the memory
+ * block. For a memory block declared with MEMB_SHARED(), this is the
+ * index of the block in the slab.
+ */
+int memb_index(struct memb *m, void *ptr);
+
 int  memb_numfree(struct memb *m);
 
+#if MEMB_STATS
+/**
+ * Get the first memory block for which statistics are kept.
+ * \return The first memory block, or NULL
+ */
+struct memb *memb_stats_head(void);
+
+/**
+ * Get the next memory block for which statistics are kept.
+ * \param m A memory block from memb_stats_head() or memb_stats_next()
+ * \return The next memory block, or NULL
+ */
+struct memb *memb_stats_next(struct memb *m);
+#endif /* MEMB_STATS */
+
 /** @} */
 /** @} */
 
@@ -49,6 +49,10 @@
 #include "contiki-conf.h"
 #include <string.h>
 
+#if MMEM_INCREMENTAL_COMPACTION
+#include "sys/process.h"
+#endif /* MMEM_INCREMENTAL_COMPACTION */
+
 #ifdef MMEM_CONF_SIZE
 #define MMEM_SIZE MMEM_CONF_SIZE
 #else
@@ -58,6 +62,58 @@
 LIST(mmemlist);
 unsigned int avail_memory;
 static char memory[MMEM_SIZE];
+static unsigned long moved_memory;
+
+#if MMEM_INCREMENTAL_COMPACTION
+/* The blocks on mmemlist are kept in address order, with holes between
+   them after mmem_free(). All memory from end onwards is free. */
+static unsigned int end;
+
+PROCESS(mmem_compact_process, "mmem compaction");
+/*---------------------------------------------------------------------------*/
+/* Move blocks down over the holes before them, at most budget bytes
+   unless a single block is larger. Returns non-zero if holes are left. */
+static int
+compact(unsigned int budget)
+{
+  struct mmem *n;
+  char *expected;
+  unsigned int moved;
+
+  moved = 0;
+  expected = memory;
+  for(n = list_head(mmemlist); n != NULL; n = n->next) {
+    if(n->ptr != expected) {
+      if(moved > 0 && moved + n->size > budget) {
+        moved_memory += moved;
+        return 1;
+      }
+      memmove(expected, n->ptr, n->size);
+      n->ptr = expected;
+      moved += n->size;
+    }
+    expected += n->size;
+  }
+  moved_memory += moved;
+  end = expected - memory;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(mmem_compact_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    /* Yield between steps so that other processes run first */
+    while(compact(MMEM_COMPACTION_STEP)) {
+      PROCESS_PAUSE();
+    }
+  }
+
+  PROCESS_END();
+}
+#endif /* MMEM_INCREMENTAL_COMPACTION */
 
 /*---------------------------------------------------------------------------*/
 /**
@@ -82,11 +138,48 @@ static char memory[MMEM_SIZE];
 int
 mmem_alloc(struct mmem *m, unsigned int size)
 {
+#if MMEM_INCREMENTAL_COMPACTION
+  struct mmem *n;
+  struct mmem *prev;
+  char *hole;
+#endif /* MMEM_INCREMENTAL_COMPACTION */
+
   /* Check if we have enough memory left for this allocation. */
   if(avail_memory < size) {
     return 0;
   }
 
+#if MMEM_INCREMENTAL_COMPACTION
+  if(MMEM_SIZE - end < size) {
+    /* Use the first hole that is large enough */
+    prev = NULL;
+    hole = memory;
+    for(n = list_head(mmemlist); n != NULL; n = n->next) {
+      if((char *)n->ptr - hole >= size) {
+        if(prev == NULL) {
+          list_push(mmemlist, m);
+        } else {
+          list_insert(mmemlist, prev, m);
+        }
+        m->ptr = hole;
+        m->size = size;
+        avail_memory -= size;
+        return 1;
+      }
+      hole = (char *)n->ptr + n->size;
+      prev = n;
+    }
+    /* No hole is large enough, so all free memory is joined at the end */
+    compact(MMEM_SIZE);
+  }
+
+  list_add(mmemlist, m);
+  m->ptr = &memory[end];
+  m->size = size;
+  end += size;
+  avail_memory -= size;
+  return 1;
+#else /* MMEM_INCREMENTAL_COMPACTION */
   /* We had enough memory so we add this memory block to the end of
      the list of allocated memory blocks. */
   list_add(mmemlist, m);
@@ -104,6 +197,7 @@ mmem_alloc(struct mmem *m, unsigned int size)
   /* Return non-zero to indicate that we were able to allocate
      memory. */
   return 1;
+#endif /* MMEM_INCREMENTAL_COMPACTION */
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -118,25 +212,45 @@ mmem_alloc(struct mmem *m, unsigned int size)
 void
 mmem_free(struct mmem *m)
 {
+#if MMEM_INCREMENTAL_COMPACTION
+  struct mmem *tail;
+  int last;
+
+  last = m->next == NULL;
+  avail_memory += m->size;
+  list_remove(mmemlist, m);
+  if(last) {
+    /* Everything after the new last block, including a hole before the
+       freed block, is free now */
+    tail = list_tail(mmemlist);
+    end = tail == NULL ? 0 : (char *)tail->ptr + tail->size - memory;
+  }
+  if(end > MMEM_SIZE - avail_memory) {
+    process_poll(&mmem_compact_process);
+  }
+#else /* MMEM_INCREMENTAL_COMPACTION */
   struct mmem *n;
+  unsigned int moved;
 
   if(m->next != NULL) {
     /* Compact the memory after the allocation that is to be removed
        by moving it downwards. */
-    memmove(m->ptr, m->next->ptr,
-	    &memory[MMEM_SIZE - avail_memory] - (char *)m->next->ptr);
+    moved = &memory[MMEM_SIZE - avail_memory] - (char *)m->next->ptr;
+    memmove(m->ptr, m->next->ptr, moved);
     
     /* Update all the memory pointers that points to memory that is
        after the allocation that is to be removed. */
     for(n = m->next; n != NULL; n = n->next) {
       n->ptr = (void *)((char *)n->ptr - m->size);
     }
+    moved_memory += moved;
   }
 
   avail_memory += m->size;
 
   /* Remove the memory block from the list. */
   list_remove(mmemlist, m);
+#endif /* MMEM_INCREMENTAL_COMPACTION */
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -157,8 +271,49 @@ mmem_init(void)
   }
   list_init(mmemlist);
   avail_memory = MMEM_SIZE;
+#if MMEM_INCREMENTAL_COMPACTION
+  end = 0;
+  process_start(&mmem_compact_process, NULL);
+#endif /* MMEM_INCREMENTAL_COMPACTION */
   inited = 1;
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get the fragmentation of the managed memory
+ * \param stats Filled in with the fragmentation statistics
+ *
+ *             Without MMEM_CONF_INCREMENTAL_COMPACTION the memory is
+ *             always compacted, so all free memory is in one block.
+ *
+ */
+void
+mmem_get_stats(struct mmem_stats *stats)
+{
+#if MMEM_INCREMENTAL_COMPACTION
+  struct mmem *n;
+  char *hole;
+  unsigned int gap;
+
+  stats->largest_free = MMEM_SIZE - end;
+  stats->holes = 0;
+  hole = memory;
+  for(n = list_head(mmemlist); n != NULL; n = n->next) {
+    gap = (char *)n->ptr - hole;
+    if(gap > 0) {
+      stats->holes++;
+      if(gap > stats->largest_free) {
+        stats->largest_free = gap;
+      }
+    }
+    hole = (char *)n->ptr + n->size;
+  }
+#else /* MMEM_INCREMENTAL_COMPACTION */
+  stats->largest_free = avail_memory;
+  stats->holes = 0;
+#endif /* MMEM_INCREMENTAL_COMPACTION */
+  stats->free = avail_memory;
+  stats->moved = moved_memory;
+}
+/*---------------------------------------------------------------------------*/
 
 /** @} */
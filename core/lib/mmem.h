@@ -83,9 +83,37 @@ struct mmem {
 /* XXX: tagga minne med "interrupt usage", vilke gr att man r
    speciellt varsam under free(). */
 
+/* MMEM_CONF_INCREMENTAL_COMPACTION makes mmem_free() leave a hole
+   instead of moving the memory that follows the freed block. The holes
+   are reused by mmem_alloc() and closed by a process that moves at
+   most MMEM_CONF_COMPACTION_STEP bytes, or one block if it is larger,
+   each time it runs. Memory can then move whenever the calling process
+   yields, so MMEM_PTR() must be read again after yielding. */
+#ifdef MMEM_CONF_INCREMENTAL_COMPACTION
+#define MMEM_INCREMENTAL_COMPACTION MMEM_CONF_INCREMENTAL_COMPACTION
+#else
+#define MMEM_INCREMENTAL_COMPACTION 0
+#endif
+
+#ifdef MMEM_CONF_COMPACTION_STEP
+#define MMEM_COMPACTION_STEP MMEM_CONF_COMPACTION_STEP
+#else
+#define MMEM_COMPACTION_STEP 64
+#endif
+
+/** \brief Fragmentation of the managed memory, from mmem_get_stats() */
+struct mmem_stats {
+  unsigned int free;         /**< Free bytes */
+  unsigned int largest_free; /**< Largest block that can be allocated
+                                  without compacting */
+  unsigned int holes;        /**< Free gaps between allocated blocks */
+  unsigned long moved;       /**< Bytes moved by compaction so far */
+};
+
 int  mmem_alloc(struct mmem *m, unsigned int size);
 void mmem_free(struct mmem *);
 void mmem_init(void);
+void mmem_get_stats(struct mmem_stats *stats);
 
 #endif /* MMEM_H_ */
 
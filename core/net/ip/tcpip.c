@@ -824,6 +824,10 @@ PROCESS_THREAD(tcpip_process, ev, data)
   }
 #endif
 
+  /* Let incoming packets and timer events for the stack overtake
+     application events when the event queue is busy. */
+  process_set_priority(&tcpip_process, PROCESS_PRIORITY_HIGH);
+
   tcpip_event = process_alloc_event();
 #if UIP_CONF_ICMP6
   tcpip_icmp6_event = process_alloc_event();
@@ -213,6 +213,13 @@ static int last_tx_status;
 
 static int last_rssi;
 
+#if SICSLOWPAN_FRAG_STATS
+struct sicslowpan_frag_stats sicslowpan_frag_stat;
+#define FRAG_STAT(code) (code)
+#else /* SICSLOWPAN_FRAG_STATS */
+#define FRAG_STAT(code)
+#endif /* SICSLOWPAN_FRAG_STATS */
+
 /* ----------------------------------------------------------------- */
 /* Support for reassembling multiple packets                         */
 /* ----------------------------------------------------------------- */
@@ -220,6 +227,11 @@ static int last_rssi;
 #if SICSLOWPAN_CONF_FRAG
 static uint16_t my_tag;
 
+/* Attributes of the packet being fragmented, set again on every
+   fragment after the first */
+static struct packetbuf_attr frag_attrs[PACKETBUF_NUM_ATTRS];
+static struct packetbuf_addr frag_addrs[PACKETBUF_NUM_ADDRS];
+
 /** The total length of the IPv6 packet in the sicslowpan_buf. */
 
 /* This needs to be defined in NBR / Nodes depending on available RAM   */
@@ -251,6 +263,20 @@ static uint16_t my_tag;
 /* Assuming that the worst growth for uncompression is 38 bytes */
 #define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38)
 
+/* SICSLOWPAN_CONF_REASS_IN_PLACE gives every reassembly context a
+ * buffer for a whole IPv6 packet, and fragments are copied straight to
+ * their offset in it. This replaces the fragment buffers, which must
+ * otherwise be searched on every fragment and when the packet is
+ * complete.
+ */
+#ifdef SICSLOWPAN_CONF_REASS_IN_PLACE
+#define SICSLOWPAN_REASS_IN_PLACE SICSLOWPAN_CONF_REASS_IN_PLACE
+#else
+#define SICSLOWPAN_REASS_IN_PLACE 0
+#endif
+
+#define SICSLOWPAN_REASS_BUF_SIZE (UIP_BUFSIZE - UIP_LLH_LEN)
+
 /* all information needed for reassembly */
 struct sicslowpan_frag_info {
   /** When reassembling, the source address of the fragments being merged */
@@ -266,15 +292,22 @@ struct sicslowpan_frag_info {
   /** Reassembly %process %timer. */
   struct timer reass_timer;
 
+#if SICSLOWPAN_REASS_IN_PLACE
+  /** The packet being reassembled */
+  uint8_t buf[SICSLOWPAN_REASS_BUF_SIZE];
+#else /* SICSLOWPAN_REASS_IN_PLACE */
   /** Fragment size of first fragment */
   uint16_t first_frag_len;
   /** First fragment - needs a larger buffer since the size is uncompressed size
    and we need to know total size to know when we have received last fragment. */
   uint8_t first_frag[SICSLOWPAN_FIRST_FRAGMENT_SIZE];
+#endif /* SICSLOWPAN_REASS_IN_PLACE */
 };
 
 static struct sicslowpan_frag_info frag_info[SICSLOWPAN_REASS_CONTEXTS];
 
+#if !SICSLOWPAN_REASS_IN_PLACE
+
 struct sicslowpan_frag_buf {
   /* the index of the frag_info */
   uint8_t index;
@@ -286,14 +319,174 @@ struct sicslowpan_frag_buf {
 };
 
 static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
+#endif /* !SICSLOWPAN_REASS_IN_PLACE */
+
+/* SICSLOWPAN_CONF_SFR sends unicast packets that need fragmentation
+ * with selective fragment recovery (RFC 8931). The sender keeps the
+ * datagram until the receiver has acknowledged every fragment, and
+ * sends again only the fragments that an RFRAG-ACK reports missing.
+ * Routers forward fragments of packets for other nodes without
+ * reassembling them. Fragments with the RFC 4944 dispatches are
+ * received as before.
+ *
+ * Only the first fragment tells a router whether the datagram is for
+ * itself or where to forward it. Fragments that arrive before it are
+ * kept for reassembly and dropped if the datagram is forwarded, and
+ * they are not acknowledged until the first fragment is in, so that
+ * the sender sends them again.
+ */
+#ifdef SICSLOWPAN_CONF_SFR
+#define SICSLOWPAN_SFR SICSLOWPAN_CONF_SFR
+#else
+#define SICSLOWPAN_SFR 0
+#endif
+
+#if SICSLOWPAN_SFR
+/* Datagrams we have sent and that are not yet acknowledged */
+#ifdef SICSLOWPAN_CONF_SFR_TX_CONTEXTS
+#define SICSLOWPAN_SFR_TX_CONTEXTS SICSLOWPAN_CONF_SFR_TX_CONTEXTS
+#else
+#define SICSLOWPAN_SFR_TX_CONTEXTS 1
+#endif
+
+/* Datagrams being reassembled */
+#ifdef SICSLOWPAN_CONF_SFR_RX_CONTEXTS
+#define SICSLOWPAN_SFR_RX_CONTEXTS SICSLOWPAN_CONF_SFR_RX_CONTEXTS
+#else
+#define SICSLOWPAN_SFR_RX_CONTEXTS SICSLOWPAN_REASS_CONTEXTS
+#endif
+
+/* Datagrams being forwarded, each one an entry of the virtual
+   reassembly buffer (VRB) */
+#ifdef SICSLOWPAN_CONF_SFR_VRB_ENTRIES
+#define SICSLOWPAN_SFR_VRB_ENTRIES SICSLOWPAN_CONF_SFR_VRB_ENTRIES
+#else
+#define SICSLOWPAN_SFR_VRB_ENTRIES 4
+#endif
+
+/* Time to wait for an RFRAG-ACK before sending the missing fragments
+   again, and the number of times they are sent again */
+#ifdef SICSLOWPAN_CONF_SFR_ACK_TIMEOUT
+#define SICSLOWPAN_SFR_ACK_TIMEOUT SICSLOWPAN_CONF_SFR_ACK_TIMEOUT
+#else
+#define SICSLOWPAN_SFR_ACK_TIMEOUT CLOCK_SECOND
+#endif
+
+#ifdef SICSLOWPAN_CONF_SFR_MAX_RETRIES
+#define SICSLOWPAN_SFR_MAX_RETRIES SICSLOWPAN_CONF_SFR_MAX_RETRIES
+#else
+#define SICSLOWPAN_SFR_MAX_RETRIES 3
+#endif
+
+/* Room left in the first fragment of a packet that goes through
+   routers, for its headers to grow when they are compressed again:
+   the hop limit, and the interface identifier of the source when it
+   was derived from our link layer address */
+#ifdef SICSLOWPAN_CONF_SFR_FORWARD_ROOM
+#define SICSLOWPAN_SFR_FORWARD_ROOM SICSLOWPAN_CONF_SFR_FORWARD_ROOM
+#else
+#define SICSLOWPAN_SFR_FORWARD_ROOM 9
+#endif
+
+/* RFRAG header fields */
+#define SFR_ACK_REQ 0x8000
+#define SFR_SEQ(w) (((w) >> 10) & 0x1f)
+#define SFR_SIZE(w) ((w) & 0x03ff)
+/* One bit per fragment in an RFRAG-ACK, sequence 0 is the MSB */
+#define SFR_BIT(seq) ((uint32_t)0x80000000 >> (seq))
+#define SFR_MAX_FRAGMENTS 32
+#define SFR_NULL_BITMAP 0
+#define SFR_FULL_BITMAP 0xffffffff
+
+#define SFR_BUF_SIZE (UIP_BUFSIZE - UIP_LLH_LEN)
+/* A datagram is reassembled in its compressed form, behind room for
+   the headers to grow when they are decompressed */
+#define SFR_HEADROOM (UIP_IPH_LEN + UIP_UDPH_LEN)
+
+/* A datagram we have sent, in compressed form */
+struct sfr_tx {
+  /** Link layer destination, the next hop */
+  linkaddr_t dest;
+  /** Fragments acknowledged by the receiver */
+  uint32_t acked;
+  /** Size of the compressed datagram, 0 if the context is free */
+  uint16_t size;
+  /** Size of the first fragment */
+  uint16_t first_len;
+  /** Size of the other fragments but the last */
+  uint16_t frag_len;
+  uint8_t fragments;
+  uint8_t tag;
+  uint8_t retries;
+  struct ctimer timer;
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  uint8_t buf[SFR_BUF_SIZE];
+};
+
+static struct sfr_tx sfr_tx[SICSLOWPAN_SFR_TX_CONTEXTS];
+
+enum {
+  SFR_RX_FREE,
+  SFR_RX_ACTIVE,
+  /* The datagram is delivered, but the sender may not know yet */
+  SFR_RX_DONE
+};
+
+/* A datagram being reassembled */
+struct sfr_rx {
+  linkaddr_t sender;
+  /** Fragments received */
+  uint32_t bitmap;
+  /** Size of the compressed datagram, 0 until the first fragment */
+  uint16_t size;
+  /** Bytes of the compressed datagram received */
+  uint16_t received;
+  /** Start of the decompressed datagram in buf */
+  uint16_t start;
+  /** Size of the decompressed datagram */
+  uint16_t len;
+  uint8_t tag;
+  uint8_t state;
+  struct timer timer;
+  /** When the first fragment to arrive did */
+  clock_time_t start_time;
+  uint8_t buf[SFR_HEADROOM + SFR_BUF_SIZE];
+};
+
+static struct sfr_rx sfr_rx[SICSLOWPAN_SFR_RX_CONTEXTS];
+
+/* A datagram being forwarded. Fragments from prev with in_tag go to
+   next with out_tag, and RFRAG-ACKs go the other way. The header in
+   the first fragment is compressed again for the next hop, and delta
+   is the difference this makes to the offsets of the others. */
+struct sfr_vrb {
+  linkaddr_t prev;
+  linkaddr_t next;
+  struct timer timer;
+  int16_t delta;
+  uint8_t in_tag;
+  uint8_t out_tag;
+  uint8_t used;
+};
+
+static struct sfr_vrb sfr_vrb[SICSLOWPAN_SFR_VRB_ENTRIES];
+
+/* Datagram completed by sfr_input(), acknowledged once delivered */
+static struct sfr_rx *sfr_delivered;
+#endif /* SICSLOWPAN_SFR */
 
 /*---------------------------------------------------------------------------*/
 static int
 clear_fragments(uint8_t frag_info_index)
 {
-  int i, clear_count;
+#if !SICSLOWPAN_REASS_IN_PLACE
+  int i;
+#endif /* !SICSLOWPAN_REASS_IN_PLACE */
+  int clear_count;
   clear_count = 0;
   frag_info[frag_info_index].len = 0;
+#if !SICSLOWPAN_REASS_IN_PLACE
   for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
     if(frag_buf[i].len > 0 && frag_buf[i].index == frag_info_index) {
       /* deallocate the buffer */
@@ -301,9 +494,11 @@ clear_fragments(uint8_t frag_info_index)
       clear_count++;
     }
   }
+#endif /* !SICSLOWPAN_REASS_IN_PLACE */
   return clear_count;
 }
 /*---------------------------------------------------------------------------*/
+#if !SICSLOWPAN_REASS_IN_PLACE
 static int
 timeout_fragments(int not_context)
 {
@@ -313,15 +508,30 @@ timeout_fragments(int not_context)
     if(frag_info[i].len > 0 && i != not_context &&
        timer_expired(&frag_info[i].reass_timer)) {
       /* This context can be freed */
+      FRAG_STAT(sicslowpan_frag_stat.rx_timeouts++);
       count += clear_fragments(i);
     }
   }
   return count;
 }
+#endif /* !SICSLOWPAN_REASS_IN_PLACE */
 /*---------------------------------------------------------------------------*/
 static int
 store_fragment(uint8_t index, uint8_t offset)
 {
+#if SICSLOWPAN_REASS_IN_PLACE
+  int len = packetbuf_datalen() - packetbuf_hdr_len;
+
+  if((offset << 3) + len > SICSLOWPAN_REASS_BUF_SIZE) {
+    PRINTF("Fragment beyond the reassembly buffer\n");
+    return -1;
+  }
+  /* copy the data from packetbuf to its place in the packet */
+  memcpy(frag_info[index].buf + (offset << 3), packetbuf_ptr + packetbuf_hdr_len,
+         len);
+  PRINTF("Fragsize: %d\n", len);
+  return len;
+#else /* SICSLOWPAN_REASS_IN_PLACE */
   int i;
   for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
     if(frag_buf[i].len == 0) {
@@ -339,6 +549,7 @@ store_fragment(uint8_t index, uint8_t offset)
   }
   /* failed */
   return -1;
+#endif /* SICSLOWPAN_REASS_IN_PLACE */
 }
 /*---------------------------------------------------------------------------*/
 /* add a new fragment to the buffer */
@@ -354,6 +565,7 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
     for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
       /* clear all fragment info with expired timer to free all fragment buffers */
       if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
+        FRAG_STAT(sicslowpan_frag_stat.rx_timeouts++);
 	clear_fragments(i);
       }
 
@@ -370,6 +582,13 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
       return -1;
     }
 
+#if SICSLOWPAN_REASS_IN_PLACE
+    if(frag_size > SICSLOWPAN_REASS_BUF_SIZE) {
+      PRINTF("*** Packet too large to reassemble - size: %d\n", frag_size);
+      return -1;
+    }
+#endif /* SICSLOWPAN_REASS_IN_PLACE */
+
     /* Found a free fragment info to store data in */
     frag_info[found].len = frag_size;
     frag_info[found].tag = tag;
@@ -399,9 +618,11 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
 
   /* i is the index of the reassembly context */
   len = store_fragment(i, offset);
+#if !SICSLOWPAN_REASS_IN_PLACE
   if(len < 0 && timeout_fragments(i) > 0) {
     len = store_fragment(i, offset);
   }
+#endif /* !SICSLOWPAN_REASS_IN_PLACE */
   if(len > 0) {
     frag_info[i].reassembled_len += len;
     return i;
@@ -418,8 +639,27 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
 static void
 copy_frags2uip(int context)
 {
+#if SICSLOWPAN_FRAG_STATS
+  clock_time_t reass_time;
+#endif /* SICSLOWPAN_FRAG_STATS */
+#if !SICSLOWPAN_REASS_IN_PLACE
   int i;
+#endif /* !SICSLOWPAN_REASS_IN_PLACE */
+
+#if SICSLOWPAN_FRAG_STATS
+  reass_time = clock_time() - frag_info[context].reass_timer.start;
+  sicslowpan_frag_stat.rx_packets++;
+  sicslowpan_frag_stat.reass_time += reass_time;
+  if(reass_time > sicslowpan_frag_stat.reass_time_max) {
+    sicslowpan_frag_stat.reass_time_max = reass_time;
+  }
+#endif /* SICSLOWPAN_FRAG_STATS */
 
+#if SICSLOWPAN_REASS_IN_PLACE
+  /* The fragments are in place already */
+  memcpy((uint8_t *)UIP_IP_BUF, frag_info[context].buf,
+         frag_info[context].len);
+#else /* SICSLOWPAN_REASS_IN_PLACE */
   /* Copy from the fragment context info buffer first */
   memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)frag_info[context].first_frag,
 	 frag_info[context].first_frag_len);
@@ -430,10 +670,19 @@ copy_frags2uip(int context)
 	     (uint8_t *)frag_buf[i].data, frag_buf[i].len);
     }
   }
+#endif /* SICSLOWPAN_REASS_IN_PLACE */
   /* deallocate all the fragments for this context */
   clear_fragments(context);
 }
 #endif /* SICSLOWPAN_CONF_FRAG */
+/*---------------------------------------------------------------------------*/
+#if SICSLOWPAN_FRAG_STATS
+void
+sicslowpan_frag_stats_reset(void)
+{
+  memset(&sicslowpan_frag_stat, 0, sizeof(sicslowpan_frag_stat));
+}
+#endif /* SICSLOWPAN_FRAG_STATS */
 
 /* -------------------------------------------------------------------------- */
 
@@ -668,7 +917,8 @@ uncompress_addr(uip_ipaddr_t *ipaddr, uint8_t const prefix[],
 static void
 compress_hdr_iphc(linkaddr_t *link_destaddr)
 {
-  uint8_t tmp, iphc0, iphc1;
+  uint8_t tmp, iphc0, iphc1, lldest;
+  struct sicslowpan_addr_context *dest_context, *src_context;
 #if DEBUG
   { uint16_t ndx;
     PRINTF("before compression (%d): ", UIP_IP_BUF->len[1]);
@@ -699,11 +949,14 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
    */
 
 
-  /* check if dest context exists (for allocating third byte) */
-  /* TODO: fix this so that it remembers the looked up values for
-     avoiding two lookups - or set the lookup values immediately */
-  if(addr_context_lookup_by_prefix(&UIP_IP_BUF->destipaddr) != NULL ||
-     addr_context_lookup_by_prefix(&UIP_IP_BUF->srcipaddr) != NULL) {
+  /* check if dest or src context exists (for allocating third byte).
+     Both are looked up once and used again below. */
+  dest_context = addr_context_lookup_by_prefix(&UIP_IP_BUF->destipaddr);
+  src_context = addr_context_lookup_by_prefix(&UIP_IP_BUF->srcipaddr);
+  lldest = UIP_IP_BUF->destipaddr.u16[1] == 0 &&
+    UIP_IP_BUF->destipaddr.u16[2] == 0 &&
+    UIP_IP_BUF->destipaddr.u16[3] == 0;
+  if(dest_context != NULL || src_context != NULL) {
     /* set context flag and increase hc06_ptr */
     PRINTF("IPHC: compressing dest or src ipaddr - setting CID\n");
     iphc1 |= SICSLOWPAN_IPHC_CID;
@@ -796,22 +1049,18 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
     PRINTF("IPHC: compressing unspecified - setting SAC\n");
     iphc1 |= SICSLOWPAN_IPHC_SAC;
     iphc1 |= SICSLOWPAN_IPHC_SAM_00;
-  } else if((context = addr_context_lookup_by_prefix(&UIP_IP_BUF->srcipaddr))
-     != NULL) {
+  } else if(src_context != NULL) {
     /* elide the prefix - indicate by CID and set context + SAC */
     PRINTF("IPHC: compressing src with context - setting CID & SAC ctx: %d\n",
-           context->number);
+           src_context->number);
     iphc1 |= SICSLOWPAN_IPHC_CID | SICSLOWPAN_IPHC_SAC;
-    PACKETBUF_IPHC_BUF[2] |= context->number << 4;
+    PACKETBUF_IPHC_BUF[2] |= src_context->number << 4;
     /* compession compare with this nodes address (source) */
 
     iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_SAM_BIT,
                               &UIP_IP_BUF->srcipaddr, &uip_lladdr);
     /* No context found for this address */
-  } else if(uip_is_addr_linklocal(&UIP_IP_BUF->srcipaddr) &&
-            UIP_IP_BUF->destipaddr.u16[1] == 0 &&
-            UIP_IP_BUF->destipaddr.u16[2] == 0 &&
-            UIP_IP_BUF->destipaddr.u16[3] == 0) {
+  } else if(uip_is_addr_linklocal(&UIP_IP_BUF->srcipaddr) && lldest) {
     iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_SAM_BIT,
                               &UIP_IP_BUF->srcipaddr, &uip_lladdr);
   } else {
@@ -850,20 +1099,17 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
     }
   } else {
     /* Address is unicast, try to compress */
-    if((context = addr_context_lookup_by_prefix(&UIP_IP_BUF->destipaddr)) != NULL) {
+    if(dest_context != NULL) {
       /* elide the prefix */
       iphc1 |= SICSLOWPAN_IPHC_DAC;
-      PACKETBUF_IPHC_BUF[2] |= context->number;
+      PACKETBUF_IPHC_BUF[2] |= dest_context->number;
       /* compession compare with link adress (destination) */
 
       iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_DAM_BIT,
                                 &UIP_IP_BUF->destipaddr,
                                 (uip_lladdr_t *)link_destaddr);
       /* No context found for this address */
-    } else if(uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) &&
-              UIP_IP_BUF->destipaddr.u16[1] == 0 &&
-              UIP_IP_BUF->destipaddr.u16[2] == 0 &&
-              UIP_IP_BUF->destipaddr.u16[3] == 0) {
+    } else if(uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) && lldest) {
       iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_DAM_BIT,
                &UIP_IP_BUF->destipaddr, (uip_lladdr_t *)link_destaddr);
     } else {
@@ -1216,6 +1462,66 @@ compress_hdr_ipv6(linkaddr_t *link_destaddr)
 }
 /** @} */
 
+/*--------------------------------------------------------------------*/
+/** \name Header compression for either scheme
+ * @{                                                                 */
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Compress the headers in uip_buf with the configured scheme,
+ * into packetbuf
+ * \param link_destaddr L2 destination address, needed to compress IP
+ * dest
+ */
+static void
+compress_hdr(linkaddr_t *link_destaddr)
+{
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6
+  compress_hdr_ipv6(link_destaddr);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6 */
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  compress_hdr_iphc(link_destaddr);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Uncompress the headers at PACKETBUF_HC1_PTR into buf
+ * \param buf Pointer to the buffer to uncompress the headers into
+ * \param ip_len Equal to 0 if the packet is not a fragment (IP length
+ * is then inferred from the L2 length), non 0 if the packet is a 1st
+ * fragment.
+ * \return 1 on success, 0 if the dispatch is unknown
+ */
+static int
+uncompress_hdr(uint8_t *buf, uint16_t ip_len)
+{
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  if((PACKETBUF_HC1_PTR[PACKETBUF_HC1_DISPATCH] & 0xe0) == SICSLOWPAN_DISPATCH_IPHC) {
+    PRINTFI("sicslowpan input: IPHC\n");
+    uncompress_hdr_iphc(buf, ip_len);
+    return 1;
+  }
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+  switch(PACKETBUF_HC1_PTR[PACKETBUF_HC1_DISPATCH]) {
+  case SICSLOWPAN_DISPATCH_IPV6:
+    PRINTFI("sicslowpan input: IPV6\n");
+    packetbuf_hdr_len += SICSLOWPAN_IPV6_HDR_LEN;
+
+    /* Put uncompressed IP header in sicslowpan_buf. */
+    memcpy(buf, packetbuf_ptr + packetbuf_hdr_len, UIP_IPH_LEN);
+
+    /* Update uncomp_hdr_len and packetbuf_hdr_len. */
+    packetbuf_hdr_len += UIP_IPH_LEN;
+    uncomp_hdr_len += UIP_IPH_LEN;
+    return 1;
+  default:
+    /* unknown header */
+    PRINTFI("sicslowpan input: unknown dispatch: %u\n",
+           PACKETBUF_HC1_PTR[PACKETBUF_HC1_DISPATCH]);
+    return 0;
+  }
+}
+/** @} */
+
 /*--------------------------------------------------------------------*/
 /** \name Input/output functions common to all compression schemes
  * @{                                                                 */
@@ -1262,6 +1568,627 @@ send_packet(linkaddr_t *dest)
   watchdog_periodic();
 }
 /*--------------------------------------------------------------------*/
+/**
+ * \brief The room left in a frame to dest for the 6lowpan headers and
+ * payload
+ */
+static int
+mac_max_payload(linkaddr_t *dest)
+{
+  int framer_hdrlen;
+
+  /* Calculate NETSTACK_FRAMER's header length, that will be added in the NETSTACK_RDC.
+   * We calculate it here only to make a better decision of whether the outgoing packet
+   * needs to be fragmented or not. */
+#ifndef SICSLOWPAN_USE_FIXED_HDRLEN
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+  framer_hdrlen = NETSTACK_FRAMER.length();
+  if(framer_hdrlen < 0) {
+    /* Framing failed, we assume the maximum header length */
+    framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
+  }
+#else /* USE_FRAMER_HDRLEN */
+  framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
+#endif /* USE_FRAMER_HDRLEN */
+
+  return MAC_MAX_PAYLOAD - framer_hdrlen;
+}
+/*--------------------------------------------------------------------*/
+#if SICSLOWPAN_SFR
+/** \name Selective fragment recovery (RFC 8931)
+ * @{
+ */
+static void
+sfr_set_header(uint8_t *ptr, uint8_t tag, int ack_req, uint8_t seq,
+               uint16_t size, uint16_t offset)
+{
+  ptr[0] = SICSLOWPAN_DISPATCH_RFRAG;
+  ptr[1] = tag;
+  SET16(ptr, 2, (ack_req ? SFR_ACK_REQ : 0) | (seq << 10) | size);
+  SET16(ptr, 4, offset);
+}
+/*--------------------------------------------------------------------*/
+static void
+sfr_send_ack(const linkaddr_t *dest, uint8_t tag, uint32_t bitmap)
+{
+  linkaddr_t addr;
+
+  /* dest may be an attribute of the packet in packetbuf */
+  linkaddr_copy(&addr, dest);
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+  packetbuf_ptr[0] = SICSLOWPAN_DISPATCH_RFRAG_ACK;
+  packetbuf_ptr[1] = tag;
+  SET16(packetbuf_ptr, 2, bitmap >> 16);
+  SET16(packetbuf_ptr, 4, bitmap & 0xffff);
+  packetbuf_set_datalen(SICSLOWPAN_RFRAG_ACK_HDR_LEN);
+  PRINTFO("sicslowpan output: RFRAG-ACK tag %u, bitmap %08lx\n",
+          tag, (unsigned long)bitmap);
+  send_packet(&addr);
+}
+/*--------------------------------------------------------------------*/
+/* Send the fragments of tx that are not acknowledged yet. The last
+   one asks for an RFRAG-ACK. */
+static void
+sfr_send(struct sfr_tx *tx)
+{
+  uint16_t offset;
+  uint16_t len;
+  uint8_t last;
+  uint8_t seq;
+
+  for(last = tx->fragments - 1; tx->acked & SFR_BIT(last); last--);
+
+  for(seq = 0; seq <= last; seq++) {
+    if(tx->acked & SFR_BIT(seq)) {
+      continue;
+    }
+    if(seq == 0) {
+      offset = 0;
+      len = tx->first_len;
+    } else {
+      offset = tx->first_len + (seq - 1) * tx->frag_len;
+      len = MIN(tx->frag_len, tx->size - offset);
+    }
+    PRINTFO("sicslowpan output: RFRAG seq %u, offset %u, len %u, tag %u\n",
+            seq, offset, len, tx->tag);
+    packetbuf_clear();
+    packetbuf_attr_copyfrom(tx->attrs, tx->addrs);
+    packetbuf_ptr = packetbuf_dataptr();
+    /* The first fragment carries the size of the datagram */
+    sfr_set_header(packetbuf_ptr, tx->tag, seq == last, seq, len,
+                   seq == 0 ? tx->size : offset);
+    memcpy(packetbuf_ptr + SICSLOWPAN_RFRAG_HDR_LEN, tx->buf + offset, len);
+    packetbuf_set_datalen(SICSLOWPAN_RFRAG_HDR_LEN + len);
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING, seq != last);
+    send_packet(&tx->dest);
+    FRAG_STAT(sicslowpan_frag_stat.tx_fragments++);
+    FRAG_STAT(sicslowpan_frag_stat.tx_retransmits += (tx->retries > 0));
+  }
+}
+/*--------------------------------------------------------------------*/
+static void sfr_timeout(void *ptr);
+
+static void
+sfr_retry(struct sfr_tx *tx)
+{
+  if(tx->retries == SICSLOWPAN_SFR_MAX_RETRIES) {
+    PRINTFO("sicslowpan output: giving up datagram with tag %u\n", tx->tag);
+    FRAG_STAT(sicslowpan_frag_stat.tx_dropped++);
+    ctimer_stop(&tx->timer);
+    tx->size = 0;
+    return;
+  }
+  tx->retries++;
+  sfr_send(tx);
+  ctimer_set(&tx->timer, SICSLOWPAN_SFR_ACK_TIMEOUT, sfr_timeout, tx);
+}
+/*--------------------------------------------------------------------*/
+/* No RFRAG-ACK in time */
+static void
+sfr_timeout(void *ptr)
+{
+  sfr_retry(ptr);
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Send the packet in uip_buf with selective fragment recovery.
+ * The headers are compressed in packetbuf already.
+ * \return 1 if the fragments are sent, 0 if the packet must be sent
+ * with RFC 4944 fragments instead
+ */
+static int
+sfr_output(linkaddr_t *dest, int max_payload)
+{
+  struct sfr_tx *tx;
+  uint16_t first_len;
+  uint16_t frag_len;
+  uint16_t size;
+  int i;
+
+  size = packetbuf_hdr_len + uip_len - uncomp_hdr_len;
+  frag_len = MIN(max_payload - SICSLOWPAN_RFRAG_HDR_LEN, SFR_SIZE(0xffff));
+  first_len = frag_len;
+  if(!uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) &&
+     !uip_is_addr_mac_addr_based(&UIP_IP_BUF->destipaddr, (uip_lladdr_t *)dest)) {
+    first_len -= SICSLOWPAN_SFR_FORWARD_ROOM;
+  }
+  /* The headers must all be in the first fragment, for the routers on
+     the way to forward it */
+  if(size > SFR_BUF_SIZE || first_len < packetbuf_hdr_len ||
+     1 + (size - first_len + frag_len - 1) / frag_len > SFR_MAX_FRAGMENTS) {
+    return 0;
+  }
+
+  tx = NULL;
+  for(i = 0; i < SICSLOWPAN_SFR_TX_CONTEXTS; i++) {
+    if(sfr_tx[i].size == 0) {
+      tx = &sfr_tx[i];
+      break;
+    }
+  }
+  if(tx == NULL) {
+    PRINTFO("sicslowpan output: all datagrams awaiting RFRAG-ACKs\n");
+    return 0;
+  }
+
+  memcpy(tx->buf, packetbuf_ptr, packetbuf_hdr_len);
+  memcpy(tx->buf + packetbuf_hdr_len, (uint8_t *)UIP_IP_BUF + uncomp_hdr_len,
+         uip_len - uncomp_hdr_len);
+  packetbuf_attr_copyto(tx->attrs, tx->addrs);
+  linkaddr_copy(&tx->dest, dest);
+  tx->size = size;
+  tx->first_len = first_len;
+  tx->frag_len = frag_len;
+  tx->fragments = 1 + (size - first_len + frag_len - 1) / frag_len;
+  tx->tag = my_tag++;
+  tx->acked = 0;
+  tx->retries = 0;
+
+  sfr_send(tx);
+  ctimer_set(&tx->timer, SICSLOWPAN_SFR_ACK_TIMEOUT, sfr_timeout, tx);
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+static void
+sfr_ack_input(void)
+{
+  linkaddr_t sender;
+  uint32_t bitmap;
+  uint32_t all;
+  uint8_t tag;
+  int i;
+
+  if(packetbuf_datalen() < SICSLOWPAN_RFRAG_ACK_HDR_LEN) {
+    return;
+  }
+  linkaddr_copy(&sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  tag = PACKETBUF_FRAG_PTR[1];
+  bitmap = ((uint32_t)GET16(PACKETBUF_FRAG_PTR, 2) << 16) |
+    GET16(PACKETBUF_FRAG_PTR, 4);
+  PRINTFI("sicslowpan input: RFRAG-ACK tag %u, bitmap %08lx\n",
+          tag, (unsigned long)bitmap);
+
+  /* For a datagram we forward: pass it on to the previous hop */
+  for(i = 0; i < SICSLOWPAN_SFR_VRB_ENTRIES; i++) {
+    struct sfr_vrb *vrb = &sfr_vrb[i];
+    if(vrb->used && vrb->out_tag == tag && linkaddr_cmp(&vrb->next, &sender)) {
+      if(bitmap == SFR_NULL_BITMAP || bitmap == SFR_FULL_BITMAP) {
+        /* Aborted or complete */
+        vrb->used = 0;
+      } else {
+        timer_restart(&vrb->timer);
+      }
+      FRAG_STAT(sicslowpan_frag_stat.forwarded++);
+      sfr_send_ack(&vrb->prev, vrb->in_tag, bitmap);
+      return;
+    }
+  }
+
+  /* For a datagram we sent */
+  for(i = 0; i < SICSLOWPAN_SFR_TX_CONTEXTS; i++) {
+    struct sfr_tx *tx = &sfr_tx[i];
+    if(tx->size > 0 && tx->tag == tag && linkaddr_cmp(&tx->dest, &sender)) {
+      FRAG_STAT(sicslowpan_frag_stat.acks_received++);
+      if(bitmap == SFR_NULL_BITMAP) {
+        PRINTFI("sicslowpan input: datagram with tag %u aborted\n", tag);
+        FRAG_STAT(sicslowpan_frag_stat.tx_dropped++);
+        ctimer_stop(&tx->timer);
+        tx->size = 0;
+        return;
+      }
+      tx->acked |= bitmap;
+      all = tx->fragments == SFR_MAX_FRAGMENTS ?
+        SFR_FULL_BITMAP : ~(SFR_FULL_BITMAP >> tx->fragments);
+      if((tx->acked & all) == all) {
+        ctimer_stop(&tx->timer);
+        tx->size = 0;
+      } else {
+        sfr_retry(tx);
+      }
+      return;
+    }
+  }
+}
+/*--------------------------------------------------------------------*/
+static struct sfr_vrb *
+sfr_vrb_lookup(const linkaddr_t *prev, uint8_t tag)
+{
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_SFR_VRB_ENTRIES; i++) {
+    if(sfr_vrb[i].used && timer_expired(&sfr_vrb[i].timer)) {
+      sfr_vrb[i].used = 0;
+    }
+    if(sfr_vrb[i].used && sfr_vrb[i].in_tag == tag &&
+       linkaddr_cmp(&sfr_vrb[i].prev, prev)) {
+      return &sfr_vrb[i];
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/* The link layer address of the next hop of the packet in uip_buf, or
+   NULL if it is for us or must go through the IP layer */
+static const uip_lladdr_t *
+sfr_next_hop(void)
+{
+#if UIP_CONF_ROUTER
+  uip_ipaddr_t *nexthop;
+  uip_ds6_route_t *route;
+  uip_ds6_nbr_t *nbr;
+
+  if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->srcipaddr) ||
+     uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) ||
+     uip_ds6_is_my_aaddr(&UIP_IP_BUF->destipaddr) ||
+     UIP_IP_BUF->ttl <= 1) {
+    return NULL;
+  }
+  /* A routing header is processed by every hop */
+  if(UIP_IP_BUF->proto == UIP_PROTO_ROUTING ||
+     (UIP_IP_BUF->proto == UIP_PROTO_HBHO &&
+      uip_buf[UIP_LLIPH_LEN] == UIP_PROTO_ROUTING)) {
+    return NULL;
+  }
+
+  if(uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)) {
+    nexthop = &UIP_IP_BUF->destipaddr;
+  } else if((route = uip_ds6_route_lookup(&UIP_IP_BUF->destipaddr)) != NULL) {
+    nexthop = uip_ds6_route_nexthop(route);
+  } else {
+    nexthop = uip_ds6_defrt_choose();
+  }
+  if(nexthop == NULL || (nbr = uip_ds6_nbr_lookup(nexthop)) == NULL) {
+    return NULL;
+  }
+  return uip_ds6_nbr_get_ll(nbr);
+#else /* UIP_CONF_ROUTER */
+  return NULL;
+#endif /* UIP_CONF_ROUTER */
+}
+/*--------------------------------------------------------------------*/
+/* Forward a first fragment, the headers of which are decompressed in
+   uip_buf followed by payload_len bytes of payload. The headers are
+   compressed again for the next hop. Returns 0 if the datagram is to
+   be reassembled here instead. */
+static int
+sfr_forward_first(struct sfr_vrb *vrb, const linkaddr_t *prev, uint8_t tag,
+                  uint8_t ecn, int ack_req, uint16_t dgram_size,
+                  uint16_t hc_len, uint16_t payload_len)
+{
+  const uip_lladdr_t *lladdr;
+  linkaddr_t next;
+  uint16_t ip_len;
+  uint8_t in_hdr_len;
+  int16_t delta;
+  int len;
+  int i;
+
+  if(vrb != NULL) {
+    linkaddr_copy(&next, &vrb->next);
+  } else {
+    lladdr = sfr_next_hop();
+    if(lladdr == NULL) {
+      return 0;
+    }
+    linkaddr_copy(&next, (const linkaddr_t *)lladdr);
+  }
+
+  in_hdr_len = uncomp_hdr_len;
+  ip_len = uncomp_hdr_len + payload_len;
+  UIP_IP_BUF->ttl--;
+
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+  packetbuf_hdr_len = 0;
+  uncomp_hdr_len = 0;
+  compress_hdr(&next);
+  len = packetbuf_hdr_len + ip_len - uncomp_hdr_len;
+  if(uncomp_hdr_len > ip_len || len > SFR_SIZE(0xffff) ||
+     SICSLOWPAN_RFRAG_HDR_LEN + len > mac_max_payload(&next)) {
+    PRINTFI("sicslowpan input: can not forward RFRAG with tag %u\n", tag);
+    UIP_IP_BUF->ttl++;
+    uncomp_hdr_len = in_hdr_len;
+    return 0;
+  }
+
+  if(vrb == NULL) {
+    for(i = 0; i < SICSLOWPAN_SFR_VRB_ENTRIES; i++) {
+      if(!sfr_vrb[i].used) {
+        vrb = &sfr_vrb[i];
+        break;
+      }
+    }
+    if(vrb == NULL) {
+      UIP_IP_BUF->ttl++;
+      uncomp_hdr_len = in_hdr_len;
+      return 0;
+    }
+    vrb->used = 1;
+    linkaddr_copy(&vrb->prev, prev);
+    linkaddr_copy(&vrb->next, &next);
+    vrb->in_tag = tag;
+    vrb->out_tag = my_tag++;
+  }
+  delta = len - (hc_len + payload_len);
+  vrb->delta = delta;
+  timer_set(&vrb->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+
+  memmove(packetbuf_ptr + SICSLOWPAN_RFRAG_HDR_LEN, packetbuf_ptr, packetbuf_hdr_len);
+  sfr_set_header(packetbuf_ptr, vrb->out_tag, ack_req, 0, len, dgram_size + delta);
+  packetbuf_ptr[0] |= ecn;
+  memcpy(packetbuf_ptr + SICSLOWPAN_RFRAG_HDR_LEN + packetbuf_hdr_len,
+         (uint8_t *)UIP_IP_BUF + uncomp_hdr_len, ip_len - uncomp_hdr_len);
+  packetbuf_set_datalen(SICSLOWPAN_RFRAG_HDR_LEN + len);
+  PRINTFO("sicslowpan output: forwarding RFRAG with tag %u as %u, delta %d\n",
+          tag, vrb->out_tag, delta);
+  send_packet(&next);
+  FRAG_STAT(sicslowpan_frag_stat.forwarded++);
+
+  /* Fragments that arrived before this one were kept for reassembly.
+     They have not been acknowledged, so the sender sends them again. */
+  for(i = 0; i < SICSLOWPAN_SFR_RX_CONTEXTS; i++) {
+    if(sfr_rx[i].state != SFR_RX_FREE && sfr_rx[i].tag == tag &&
+       linkaddr_cmp(&sfr_rx[i].sender, prev)) {
+      sfr_rx[i].state = SFR_RX_FREE;
+    }
+  }
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+static struct sfr_rx *
+sfr_rx_lookup(const linkaddr_t *sender, uint8_t tag)
+{
+  static uint8_t last;
+  struct sfr_rx *rx;
+  struct sfr_rx *free_rx;
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_SFR_RX_CONTEXTS; i++) {
+    rx = &sfr_rx[i];
+    if(rx->state != SFR_RX_FREE && timer_expired(&rx->timer)) {
+      if(rx->state == SFR_RX_ACTIVE) {
+        FRAG_STAT(sicslowpan_frag_stat.rx_timeouts++);
+      }
+      rx->state = SFR_RX_FREE;
+    }
+    if(rx->state != SFR_RX_FREE && rx->tag == tag &&
+       linkaddr_cmp(&rx->sender, sender)) {
+      return rx;
+    }
+  }
+
+  /* Take a free context, or else one that is done. These are taken in
+     turn, for a tag to be remembered as long as possible. */
+  free_rx = NULL;
+  for(i = 1; i <= SICSLOWPAN_SFR_RX_CONTEXTS; i++) {
+    rx = &sfr_rx[(last + i) % SICSLOWPAN_SFR_RX_CONTEXTS];
+    if(rx->state == SFR_RX_FREE) {
+      free_rx = rx;
+      break;
+    } else if(rx->state == SFR_RX_DONE && free_rx == NULL) {
+      free_rx = rx;
+    }
+  }
+
+  if(free_rx != NULL) {
+    last = free_rx - sfr_rx;
+    free_rx->state = SFR_RX_ACTIVE;
+    free_rx->tag = tag;
+    linkaddr_copy(&free_rx->sender, sender);
+    free_rx->bitmap = 0;
+    free_rx->size = 0;
+    free_rx->received = 0;
+    timer_set(&free_rx->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+    free_rx->start_time = clock_time();
+  }
+  return free_rx;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Process an RFRAG in packetbuf: forward it, or add it to its
+ * datagram
+ * \return 1 if the datagram is complete and in uip_buf
+ */
+static int
+sfr_input(void)
+{
+  struct sfr_vrb *vrb;
+  struct sfr_rx *rx;
+  linkaddr_t sender;
+  uint16_t payload_len;
+  uint16_t offset;
+  uint16_t hc_len;
+  uint16_t size;
+  uint16_t w;
+  uint8_t *ip;
+  uint8_t seq;
+  uint8_t tag;
+  uint8_t ecn;
+  int ack_req;
+  int complete;
+
+  if(packetbuf_datalen() < SICSLOWPAN_RFRAG_HDR_LEN) {
+    return 0;
+  }
+  linkaddr_copy(&sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  ecn = PACKETBUF_FRAG_PTR[0] & 0x01;
+  tag = PACKETBUF_FRAG_PTR[1];
+  w = GET16(PACKETBUF_FRAG_PTR, 2);
+  ack_req = (w & SFR_ACK_REQ) != 0;
+  seq = SFR_SEQ(w);
+  size = SFR_SIZE(w);
+  offset = GET16(PACKETBUF_FRAG_PTR, 4);
+  packetbuf_hdr_len = SICSLOWPAN_RFRAG_HDR_LEN;
+  PRINTFI("sicslowpan input: RFRAG seq %u, size %u, offset %u, tag %u\n",
+          seq, size, offset, tag);
+  FRAG_STAT(sicslowpan_frag_stat.rx_fragments++);
+
+  if(packetbuf_datalen() < SICSLOWPAN_RFRAG_HDR_LEN + size) {
+    FRAG_STAT(sicslowpan_frag_stat.rx_dropped++);
+    return 0;
+  }
+
+  vrb = sfr_vrb_lookup(&sender, tag);
+  if(vrb != NULL && seq > 0) {
+    uint8_t *frag = packetbuf_ptr;
+
+    /* Only the tag and the offset change, but the frame goes out
+       without the attributes of the received one */
+    frag[1] = vrb->out_tag;
+    SET16(frag, 4, offset + vrb->delta);
+    timer_restart(&vrb->timer);
+    packetbuf_clear();
+    packetbuf_ptr = packetbuf_dataptr();
+    memmove(packetbuf_ptr, frag, SICSLOWPAN_RFRAG_HDR_LEN + size);
+    packetbuf_set_datalen(SICSLOWPAN_RFRAG_HDR_LEN + size);
+    send_packet(&vrb->next);
+    FRAG_STAT(sicslowpan_frag_stat.forwarded++);
+    return 0;
+  }
+
+  payload_len = 0;
+  hc_len = 0;
+  if(seq == 0) {
+    /* Uncompress the headers into uip_buf, and put the payload of the
+       fragment behind them */
+    if(!uncompress_hdr((uint8_t *)UIP_IP_BUF, 0) ||
+       packetbuf_hdr_len > SICSLOWPAN_RFRAG_HDR_LEN + size) {
+      FRAG_STAT(sicslowpan_frag_stat.rx_dropped++);
+      return 0;
+    }
+    hc_len = packetbuf_hdr_len - SICSLOWPAN_RFRAG_HDR_LEN;
+    payload_len = size - hc_len;
+    if(uncomp_hdr_len + payload_len > SFR_BUF_SIZE || offset < size) {
+      FRAG_STAT(sicslowpan_frag_stat.rx_dropped++);
+      return 0;
+    }
+    memcpy((uint8_t *)UIP_IP_BUF + uncomp_hdr_len,
+           packetbuf_ptr + packetbuf_hdr_len, payload_len);
+
+    if(sfr_forward_first(vrb, &sender, tag, ecn, ack_req, offset,
+                         hc_len, payload_len)) {
+      return 0;
+    }
+  }
+
+  rx = sfr_rx_lookup(&sender, tag);
+  if(rx == NULL) {
+    PRINTFI("sicslowpan input: no room to reassemble tag %u\n", tag);
+    FRAG_STAT(sicslowpan_frag_stat.rx_dropped++);
+    /* Have the sender give up rather than send again */
+    FRAG_STAT(sicslowpan_frag_stat.acks_sent++);
+    sfr_send_ack(&sender, tag, SFR_NULL_BITMAP);
+    return 0;
+  }
+
+  if(rx->state == SFR_RX_DONE || (rx->bitmap & SFR_BIT(seq))) {
+    /* Sent again, an RFRAG-ACK may have been lost */
+    if(ack_req && rx->size > 0) {
+      FRAG_STAT(sicslowpan_frag_stat.acks_sent++);
+      sfr_send_ack(&sender, tag,
+                   rx->state == SFR_RX_DONE ? SFR_FULL_BITMAP : rx->bitmap);
+    }
+    return 0;
+  }
+
+  if(seq == 0) {
+    /* The headers end where the compressed ones did */
+    rx->start = SFR_HEADROOM + hc_len - uncomp_hdr_len;
+    rx->size = offset;
+    rx->len = offset - hc_len + uncomp_hdr_len;
+    if(offset > SFR_BUF_SIZE || rx->len > SFR_BUF_SIZE) {
+      FRAG_STAT(sicslowpan_frag_stat.rx_dropped++);
+      rx->state = SFR_RX_FREE;
+      return 0;
+    }
+    memcpy(rx->buf + rx->start, UIP_IP_BUF, uncomp_hdr_len + payload_len);
+  } else {
+    if(offset + size > SFR_BUF_SIZE) {
+      FRAG_STAT(sicslowpan_frag_stat.rx_dropped++);
+      return 0;
+    }
+    memcpy(rx->buf + SFR_HEADROOM + offset,
+           packetbuf_ptr + SICSLOWPAN_RFRAG_HDR_LEN, size);
+  }
+  rx->bitmap |= SFR_BIT(seq);
+  rx->received += size;
+  timer_restart(&rx->timer);
+
+  complete = rx->size > 0 && rx->received >= rx->size;
+  if(complete) {
+    /* Now that the size is known, set the lengths in the headers */
+    ip = rx->buf + rx->start;
+    SICSLOWPAN_IP_BUF(ip)->len[0] = (rx->len - UIP_IPH_LEN) >> 8;
+    SICSLOWPAN_IP_BUF(ip)->len[1] = (rx->len - UIP_IPH_LEN) & 0x00FF;
+    if(SICSLOWPAN_IP_BUF(ip)->proto == UIP_PROTO_UDP) {
+      memcpy(&SICSLOWPAN_UDP_BUF(ip)->udplen, &SICSLOWPAN_IP_BUF(ip)->len[0], 2);
+    }
+    memcpy((uint8_t *)UIP_IP_BUF, ip, rx->len);
+    uip_len = rx->len;
+    rx->state = SFR_RX_DONE;
+#if SICSLOWPAN_FRAG_STATS
+    {
+      clock_time_t reass_time = clock_time() - rx->start_time;
+      sicslowpan_frag_stat.rx_packets++;
+      sicslowpan_frag_stat.reass_time += reass_time;
+      if(reass_time > sicslowpan_frag_stat.reass_time_max) {
+        sicslowpan_frag_stat.reass_time_max = reass_time;
+      }
+    }
+#endif /* SICSLOWPAN_FRAG_STATS */
+  }
+
+  if(complete) {
+    /* The sender learns that it is done once the datagram has been
+       delivered, see sfr_ack_delivered() */
+    sfr_delivered = rx;
+  } else if(ack_req && rx->size > 0) {
+    /* Without the first fragment, we do not know yet whether the
+       datagram is for us or is forwarded */
+    FRAG_STAT(sicslowpan_frag_stat.acks_sent++);
+    sfr_send_ack(&sender, tag, rx->bitmap);
+  }
+  return complete;
+}
+/*--------------------------------------------------------------------*/
+/* Acknowledge the datagram that sfr_input() completed. This is done
+   after it has been delivered, as sending clears the packetbuf, the
+   attributes and addresses of which the upper layers use. */
+static void
+sfr_ack_delivered(void)
+{
+  if(sfr_delivered != NULL) {
+    FRAG_STAT(sicslowpan_frag_stat.acks_sent++);
+    sfr_send_ack(&sfr_delivered->sender, sfr_delivered->tag, SFR_FULL_BITMAP);
+    sfr_delivered = NULL;
+  }
+}
+/** @} */
+#endif /* SICSLOWPAN_SFR */
+/*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
  *  network using 6lowpan.
  *  \param localdest The MAC address of the destination
@@ -1274,7 +2201,6 @@ send_packet(linkaddr_t *dest)
 static uint8_t
 output(const uip_lladdr_t *localdest)
 {
-  int framer_hdrlen;
   int max_payload;
 
   /* The MAC address of the destination of the packet */
@@ -1294,6 +2220,12 @@ output(const uip_lladdr_t *localdest)
     set_packet_attrs();
   }
 
+  /* Queueing class for the MAC layer, from the traffic class set by upper
+   * layers (e.g. coap_set_uip_traffic_class). The traffic class straddles
+   * vtc and tcflow, extract it the same way IPHC does. */
+  packetbuf_set_attr(PACKETBUF_ATTR_TRAFFIC_CLASS,
+                     (uint8_t)((UIP_IP_BUF->vtc << 4) | (UIP_IP_BUF->tcflow >> 4)));
+
 #if PACKETBUF_WITH_PACKET_TYPE
 #define TCP_FIN 0x01
 #define TCP_ACK 0x10
@@ -1326,38 +2258,18 @@ output(const uip_lladdr_t *localdest)
 
   if(uip_len >= COMPRESSION_THRESHOLD) {
     /* Try to compress the headers */
-#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6
-    compress_hdr_ipv6(&dest);
-#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6 */
-#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
-    compress_hdr_iphc(&dest);
-#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+    compress_hdr(&dest);
   } else {
     compress_hdr_ipv6(&dest);
   }
   PRINTFO("sicslowpan output: header of len %d\n", packetbuf_hdr_len);
 
-  /* Calculate NETSTACK_FRAMER's header length, that will be added in the NETSTACK_RDC.
-   * We calculate it here only to make a better decision of whether the outgoing packet
-   * needs to be fragmented or not. */
-#ifndef SICSLOWPAN_USE_FIXED_HDRLEN
-  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
-  framer_hdrlen = NETSTACK_FRAMER.length();
-  if(framer_hdrlen < 0) {
-    /* Framing failed, we assume the maximum header length */
-    framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
-  }
-#else /* USE_FRAMER_HDRLEN */
-  framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
-#endif /* USE_FRAMER_HDRLEN */
-
-  max_payload = MAC_MAX_PAYLOAD - framer_hdrlen;
+  max_payload = mac_max_payload(&dest);
   if((int)uip_len - (int)uncomp_hdr_len > max_payload - (int)packetbuf_hdr_len) {
 #if SICSLOWPAN_CONF_FRAG
     /* Number of bytes processed. */
     uint16_t processed_ip_out_len;
 
-    struct queuebuf *q;
     uint16_t frag_tag;
 
     /*
@@ -1366,17 +2278,30 @@ output(const uip_lladdr_t *localdest)
      * The first fragment contains frag1 dispatch, then
      * IPv6/IPHC/HC_UDP dispatchs/headers.
      * The following fragments contain only the fragn dispatch.
+     *
+     * The fragments are handed to the MAC back to back, and all but
+     * the last one have the frame pending attribute set so that the
+     * MAC can send them as a burst. Each fragment is built directly
+     * in packetbuf, and the MAC keeps its own copy.
      */
     int estimated_fragments = ((int)uip_len) / (max_payload - SICSLOWPAN_FRAGN_HDR_LEN) + 1;
-    int freebuf = queuebuf_numfree() - 1;
+    int freebuf = queuebuf_numfree();
     PRINTFO("uip_len: %d, fragments: %d, free bufs: %d\n", uip_len, estimated_fragments, freebuf);
+    FRAG_STAT(sicslowpan_frag_stat.tx_packets++);
     if(freebuf < estimated_fragments) {
       PRINTFO("Dropping packet, not enough free bufs\n");
+      FRAG_STAT(sicslowpan_frag_stat.tx_dropped++);
       return 0;
     }
 
     PRINTFO("Fragmentation sending packet len %d\n", uip_len);
 
+#if SICSLOWPAN_SFR
+    if(!linkaddr_cmp(&dest, &linkaddr_null) && sfr_output(&dest, max_payload)) {
+      return 1;
+    }
+#endif /* SICSLOWPAN_SFR */
+
     /* Create 1st Fragment */
     PRINTFO("sicslowpan output: 1rst fragment ");
 
@@ -1404,21 +2329,17 @@ output(const uip_lladdr_t *localdest)
     memcpy(packetbuf_ptr + packetbuf_hdr_len,
            (uint8_t *)UIP_IP_BUF + uncomp_hdr_len, packetbuf_payload_len);
     packetbuf_set_datalen(packetbuf_payload_len + packetbuf_hdr_len);
-    q = queuebuf_new_from_packetbuf();
-    if(q == NULL) {
-      PRINTFO("could not allocate queuebuf for first fragment, dropping packet\n");
-      return 0;
-    }
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 1);
+    packetbuf_attr_copyto(frag_attrs, frag_addrs);
     send_packet(&dest);
-    queuebuf_to_packetbuf(q);
-    queuebuf_free(q);
-    q = NULL;
+    FRAG_STAT(sicslowpan_frag_stat.tx_fragments++);
 
     /* Check tx result. */
     if((last_tx_status == MAC_TX_COLLISION) ||
        (last_tx_status == MAC_TX_ERR) ||
        (last_tx_status == MAC_TX_ERR_FATAL)) {
       PRINTFO("error in fragment tx, dropping subsequent fragments.\n");
+      FRAG_STAT(sicslowpan_frag_stat.tx_dropped++);
       return 0;
     }
 
@@ -1427,38 +2348,36 @@ output(const uip_lladdr_t *localdest)
 
     /*
      * Create following fragments
-     * Datagram tag is already in the buffer, we need to set the
-     * FRAGN dispatch and for each fragment, the offset
+     * Each one starts from a clear packetbuf with the attributes of the
+     * first fragment, the FRAGN dispatch, the datagram tag and the offset
      */
-    packetbuf_hdr_len = SICSLOWPAN_FRAGN_HDR_LEN;
-/*     PACKETBUF_FRAG_BUF->dispatch_size = */
-/*       uip_htons((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len); */
-    SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
-          ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
-    packetbuf_payload_len = (max_payload - packetbuf_hdr_len) & 0xfffffff8;
+    packetbuf_payload_len = (max_payload - SICSLOWPAN_FRAGN_HDR_LEN) & 0xfffffff8;
     while(processed_ip_out_len < uip_len) {
       PRINTFO("sicslowpan output: fragment ");
+      packetbuf_clear();
+      packetbuf_attr_copyfrom(frag_attrs, frag_addrs);
+      packetbuf_ptr = packetbuf_dataptr();
+      packetbuf_hdr_len = SICSLOWPAN_FRAGN_HDR_LEN;
+/*     PACKETBUF_FRAG_BUF->dispatch_size = */
+/*       uip_htons((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len); */
+      SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+            ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
+      SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, frag_tag);
       PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = processed_ip_out_len >> 3;
 
       /* Copy payload and send */
-      if(uip_len - processed_ip_out_len < packetbuf_payload_len) {
+      if(uip_len - processed_ip_out_len <= packetbuf_payload_len) {
         /* last fragment */
         packetbuf_payload_len = uip_len - processed_ip_out_len;
+        packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 0);
       }
       PRINTFO("(offset %d, len %d, tag %d)\n",
              processed_ip_out_len >> 3, packetbuf_payload_len, frag_tag);
       memcpy(packetbuf_ptr + packetbuf_hdr_len,
              (uint8_t *)UIP_IP_BUF + processed_ip_out_len, packetbuf_payload_len);
       packetbuf_set_datalen(packetbuf_payload_len + packetbuf_hdr_len);
-      q = queuebuf_new_from_packetbuf();
-      if(q == NULL) {
-        PRINTFO("could not allocate queuebuf, dropping fragment\n");
-        return 0;
-      }
       send_packet(&dest);
-      queuebuf_to_packetbuf(q);
-      queuebuf_free(q);
-      q = NULL;
+      FRAG_STAT(sicslowpan_frag_stat.tx_fragments++);
       processed_ip_out_len += packetbuf_payload_len;
 
       /* Check tx result. */
@@ -1466,6 +2385,7 @@ output(const uip_lladdr_t *localdest)
          (last_tx_status == MAC_TX_ERR) ||
          (last_tx_status == MAC_TX_ERR_FATAL)) {
         PRINTFO("error in fragment tx, dropping subsequent fragments.\n");
+        FRAG_STAT(sicslowpan_frag_stat.tx_dropped++);
         return 0;
       }
     }
@@ -1536,6 +2456,27 @@ input(void)
 
 #if SICSLOWPAN_CONF_FRAG
 
+#if SICSLOWPAN_SFR
+  switch(PACKETBUF_FRAG_PTR[0] & 0xfe) {
+    case SICSLOWPAN_DISPATCH_RFRAG:
+      if(sfr_input()) {
+        PRINTFI("sicslowpan input: IP packet ready (length %d)\n", uip_len);
+        if(callback) {
+          set_packet_attrs();
+          callback->input_callback();
+        }
+        tcpip_input();
+        sfr_ack_delivered();
+      }
+      return;
+    case SICSLOWPAN_DISPATCH_RFRAG_ACK:
+      sfr_ack_input();
+      return;
+    default:
+      break;
+  }
+#endif /* SICSLOWPAN_SFR */
+
   /*
    * Since we don't support the mesh and broadcast header, the first header
    * we look for is the fragmentation header
@@ -1556,13 +2497,19 @@ input(void)
       is_fragment = 1;
 
       /* Add the fragment to the fragmentation context */
+      FRAG_STAT(sicslowpan_frag_stat.rx_fragments++);
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
 
       if(frag_context == -1) {
+        FRAG_STAT(sicslowpan_frag_stat.rx_dropped++);
         return;
       }
 
+#if SICSLOWPAN_REASS_IN_PLACE
+      buffer = frag_info[frag_context].buf;
+#else /* SICSLOWPAN_REASS_IN_PLACE */
       buffer = frag_info[frag_context].first_frag;
+#endif /* SICSLOWPAN_REASS_IN_PLACE */
 
       break;
     case SICSLOWPAN_DISPATCH_FRAGN:
@@ -1585,9 +2532,11 @@ input(void)
 
       /* Add the fragment to the fragmentation context (this will also
          copy the payload) */
+      FRAG_STAT(sicslowpan_frag_stat.rx_fragments++);
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
 
       if(frag_context == -1) {
+        FRAG_STAT(sicslowpan_frag_stat.rx_dropped++);
         return;
       }
 
@@ -1611,29 +2560,8 @@ input(void)
 #endif /* SICSLOWPAN_CONF_FRAG */
 
   /* Process next dispatch and headers */
-#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
-  if((PACKETBUF_HC1_PTR[PACKETBUF_HC1_DISPATCH] & 0xe0) == SICSLOWPAN_DISPATCH_IPHC) {
-    PRINTFI("sicslowpan input: IPHC\n");
-    uncompress_hdr_iphc(buffer, frag_size);
-  } else
-#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
-    switch(PACKETBUF_HC1_PTR[PACKETBUF_HC1_DISPATCH]) {
-    case SICSLOWPAN_DISPATCH_IPV6:
-      PRINTFI("sicslowpan input: IPV6\n");
-      packetbuf_hdr_len += SICSLOWPAN_IPV6_HDR_LEN;
-
-      /* Put uncompressed IP header in sicslowpan_buf. */
-      memcpy(buffer, packetbuf_ptr + packetbuf_hdr_len, UIP_IPH_LEN);
-
-      /* Update uncomp_hdr_len and packetbuf_hdr_len. */
-      packetbuf_hdr_len += UIP_IPH_LEN;
-      uncomp_hdr_len += UIP_IPH_LEN;
-      break;
-    default:
-      /* unknown header */
-      PRINTFI("sicslowpan input: unknown dispatch: %u\n",
-             PACKETBUF_HC1_PTR[PACKETBUF_HC1_DISPATCH]);
-      return;
+  if(!uncompress_hdr(buffer, frag_size)) {
+    return;
   }
 
 
@@ -1679,7 +2607,9 @@ input(void)
     /* Add the size of the header only for the first fragment. */
     if(first_fragment != 0) {
       frag_info[frag_context].reassembled_len = uncomp_hdr_len + packetbuf_payload_len;
+#if !SICSLOWPAN_REASS_IN_PLACE
       frag_info[frag_context].first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
+#endif /* !SICSLOWPAN_REASS_IN_PLACE */
     }
     /* For the last fragment, we are OK if there is extrenous bytes at
        the end of the packet. */
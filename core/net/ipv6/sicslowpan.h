@@ -82,6 +82,8 @@
 #define SICSLOWPAN_DISPATCH_IPHC                    0x60 /* 011xxxxx = ... */
 #define SICSLOWPAN_DISPATCH_FRAG1                   0xc0 /* 11000xxx */
 #define SICSLOWPAN_DISPATCH_FRAGN                   0xe0 /* 11100xxx */
+#define SICSLOWPAN_DISPATCH_RFRAG                   0xe8 /* 1110100x */
+#define SICSLOWPAN_DISPATCH_RFRAG_ACK               0xea /* 1110101x */
 /** @} */
 
 /** \name HC1 encoding
@@ -175,6 +177,8 @@
 #define SICSLOWPAN_HC1_HC_UDP_HDR_LEN               7
 #define SICSLOWPAN_FRAG1_HDR_LEN                    4
 #define SICSLOWPAN_FRAGN_HDR_LEN                    5
+#define SICSLOWPAN_RFRAG_HDR_LEN                    6
+#define SICSLOWPAN_RFRAG_ACK_HDR_LEN                6
 /** @} */
 
 /**
@@ -189,6 +193,24 @@
 /*   uint8_t offset; */
 /* }; */
 
+/**
+ * \brief The headers for selective fragment recovery (RFC 8931)
+ * \note For the first fragment (sequence 0), the offset field holds
+ * the size of the whole datagram. Sizes and offsets are in bytes, of
+ * the datagram in its compressed form.
+ */
+/* struct sicslowpan_rfrag_hdr { */
+/*   uint8_t dispatch_ecn; */
+/*   uint8_t tag; */
+/*   uint16_t ack_req_seq_size; */
+/*   uint16_t offset; */
+/* }; */
+/* struct sicslowpan_rfrag_ack_hdr { */
+/*   uint8_t dispatch_ecn; */
+/*   uint8_t tag; */
+/*   uint32_t bitmap; */
+/* }; */
+
 /**
  * \brief The HC1 header when HC_UDP is not used
  *
@@ -319,6 +341,37 @@ struct sicslowpan_nh_compressor {
 
 };
 
+/* SICSLOWPAN_CONF_FRAG_STATS keeps counters of sent and received
+   fragments, lost fragments and reassembly times. */
+#ifdef SICSLOWPAN_CONF_FRAG_STATS
+#define SICSLOWPAN_FRAG_STATS SICSLOWPAN_CONF_FRAG_STATS
+#else /* SICSLOWPAN_CONF_FRAG_STATS */
+#define SICSLOWPAN_FRAG_STATS 0
+#endif /* SICSLOWPAN_CONF_FRAG_STATS */
+
+#if SICSLOWPAN_FRAG_STATS
+/** \brief Fragmentation statistics, kept if SICSLOWPAN_CONF_FRAG_STATS is set */
+struct sicslowpan_frag_stats {
+  uint32_t tx_packets;       /**< Packets sent as fragments */
+  uint32_t tx_fragments;     /**< Fragments handed to the MAC */
+  uint32_t tx_dropped;       /**< Packets not sent completely */
+  uint32_t rx_fragments;     /**< Fragments received */
+  uint32_t rx_packets;       /**< Packets reassembled */
+  uint32_t rx_dropped;       /**< Fragments dropped on arrival */
+  uint32_t rx_timeouts;      /**< Reassemblies given up, fragments lost */
+  clock_time_t reass_time;   /**< Total time to reassemble rx_packets */
+  clock_time_t reass_time_max; /**< Longest time to reassemble a packet */
+  uint32_t tx_retransmits;   /**< Fragments sent again after an RFRAG-ACK or timeout */
+  uint32_t acks_sent;        /**< RFRAG-ACKs sent */
+  uint32_t acks_received;    /**< RFRAG-ACKs received for our own datagrams */
+  uint32_t forwarded;        /**< Fragments and RFRAG-ACKs forwarded without reassembly */
+};
+
+extern struct sicslowpan_frag_stats sicslowpan_frag_stat;
+
+void sicslowpan_frag_stats_reset(void);
+#endif /* SICSLOWPAN_FRAG_STATS */
+
 int sicslowpan_get_last_rssi(void);
 
 extern const struct network_driver sicslowpan_driver;
@@ -47,6 +47,7 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include "lib/list.h"
+#include "lib/hashindex.h"
 #include "net/link-stats.h"
 #include "net/linkaddr.h"
 #include "net/packetbuf.h"
@@ -71,12 +72,25 @@ void LINK_NEIGHBOR_CALLBACK(const linkaddr_t *addr, int status, int numtx);
 
 NBR_TABLE_GLOBAL(uip_ds6_nbr_t, ds6_neighbors);
 
+#if UIP_DS6_NBR_WITH_HASH
+#if UIP_DS6_NBR_HASH_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error "UIP_DS6_NBR_CONF_HASH_SIZE must be greater than NBR_TABLE_CONF_MAX_NEIGHBORS"
+#endif
+
+/* Neighbors by the interface ID of their IPv6 address, which differs
+   between neighbors that share a prefix */
+HASHINDEX(nbr_index, UIP_DS6_NBR_HASH_SIZE,
+          offsetof(uip_ds6_nbr_t, ipaddr) + 8, 8);
+#endif /* UIP_DS6_NBR_WITH_HASH */
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_neighbors_init(void)
 {
   link_stats_init();
   nbr_table_register(ds6_neighbors, (nbr_table_callback *)uip_ds6_nbr_rm);
+#if UIP_DS6_NBR_WITH_HASH
+  hashindex_init(&nbr_index);
+#endif /* UIP_DS6_NBR_WITH_HASH */
 }
 /*---------------------------------------------------------------------------*/
 uip_ds6_nbr_t *
@@ -84,10 +98,23 @@ uip_ds6_nbr_add(const uip_ipaddr_t *ipaddr, const uip_lladdr_t *lladdr,
                 uint8_t isrouter, uint8_t state, nbr_table_reason_t reason,
                 void *data)
 {
-  uip_ds6_nbr_t *nbr = nbr_table_add_lladdr(ds6_neighbors, (linkaddr_t*)lladdr
-                                            , reason, data);
+  uip_ds6_nbr_t *nbr;
+
+#if UIP_DS6_NBR_WITH_HASH
+  /* Adding a neighbor that is already in the table resets its entry */
+  nbr = nbr_table_get_from_lladdr(ds6_neighbors, (linkaddr_t*)lladdr);
+  if(nbr != NULL) {
+    hashindex_remove(&nbr_index, nbr);
+  }
+#endif /* UIP_DS6_NBR_WITH_HASH */
+
+  nbr = nbr_table_add_lladdr(ds6_neighbors, (linkaddr_t*)lladdr
+                             , reason, data);
   if(nbr) {
     uip_ipaddr_copy(&nbr->ipaddr, ipaddr);
+#if UIP_DS6_NBR_WITH_HASH
+    hashindex_add(&nbr_index, nbr);
+#endif /* UIP_DS6_NBR_WITH_HASH */
 #if UIP_ND6_SEND_RA || !UIP_CONF_ROUTER
     nbr->isrouter = isrouter;
 #endif /* UIP_ND6_SEND_RA || !UIP_CONF_ROUTER */
@@ -131,6 +158,9 @@ uip_ds6_nbr_rm(uip_ds6_nbr_t *nbr)
     uip_packetqueue_free(&nbr->packethandle);
 #endif /* UIP_CONF_IPV6_QUEUE_PKT */
     NEIGHBOR_STATE_CHANGED(nbr);
+#if UIP_DS6_NBR_WITH_HASH
+    hashindex_remove(&nbr_index, nbr);
+#endif /* UIP_DS6_NBR_WITH_HASH */
     return nbr_table_remove(ds6_neighbors, nbr);
   }
   return 0;
@@ -168,6 +198,20 @@ uip_ds6_nbr_num(void)
 uip_ds6_nbr_t *
 uip_ds6_nbr_lookup(const uip_ipaddr_t *ipaddr)
 {
+#if UIP_DS6_NBR_WITH_HASH
+  uip_ds6_nbr_t *nbr;
+  int slot = -1;
+
+  if(ipaddr != NULL) {
+    while((nbr = hashindex_lookup_next(&nbr_index, &ipaddr->u8[8],
+                                       &slot)) != NULL) {
+      if(uip_ipaddr_cmp(&nbr->ipaddr, ipaddr)) {
+        return nbr;
+      }
+    }
+  }
+  return NULL;
+#else /* UIP_DS6_NBR_WITH_HASH */
   uip_ds6_nbr_t *nbr = nbr_table_head(ds6_neighbors);
   if(ipaddr != NULL) {
     while(nbr != NULL) {
@@ -178,6 +222,7 @@ uip_ds6_nbr_lookup(const uip_ipaddr_t *ipaddr)
     }
   }
   return NULL;
+#endif /* UIP_DS6_NBR_WITH_HASH */
 }
 /*---------------------------------------------------------------------------*/
 uip_ds6_nbr_t *
@@ -64,6 +64,22 @@
 
 NBR_TABLE_DECLARE(ds6_neighbors);
 
+/* UIP_DS6_NBR_CONF_WITH_HASH indexes the neighbor cache by IPv6
+   address, so that uip_ds6_nbr_lookup() does not iterate over all
+   neighbors. The index is an open addressing hash table of
+   UIP_DS6_NBR_CONF_HASH_SIZE pointers, keyed by the interface ID. */
+#ifdef UIP_DS6_NBR_CONF_WITH_HASH
+#define UIP_DS6_NBR_WITH_HASH UIP_DS6_NBR_CONF_WITH_HASH
+#else /* UIP_DS6_NBR_CONF_WITH_HASH */
+#define UIP_DS6_NBR_WITH_HASH 0
+#endif /* UIP_DS6_NBR_CONF_WITH_HASH */
+
+#ifdef UIP_DS6_NBR_CONF_HASH_SIZE
+#define UIP_DS6_NBR_HASH_SIZE UIP_DS6_NBR_CONF_HASH_SIZE
+#else /* UIP_DS6_NBR_CONF_HASH_SIZE */
+#define UIP_DS6_NBR_HASH_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS)
+#endif /* UIP_DS6_NBR_CONF_HASH_SIZE */
+
 /** \brief An entry in the nbr cache */
 typedef struct uip_ds6_nbr {
   uip_ipaddr_t ipaddr;
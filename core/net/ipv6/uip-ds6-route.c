@@ -75,8 +75,34 @@ MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+#if UIP_DS6_ROUTE_WITH_TRIE
+/* A node of the path-compressed binary trie that indexes the routes.
+   Nodes either carry the route(s) for a prefix or are branch nodes
+   with two children, so the trie never holds more than
+   2 * UIP_DS6_ROUTE_NB - 1 nodes. */
+struct route_trie_node {
+  struct route_trie_node *parent;
+  struct route_trie_node *child[2];
+  /* Best route for this prefix, NULL for a branch node */
+  uip_ds6_route_t *route;
+  uip_ipaddr_t prefix;
+  /* Number of routes with this prefix */
+  uint16_t routes;
+  /* Prefix length in bits */
+  uint8_t length;
+};
+
+MEMB(trienodememb, struct route_trie_node, 2 * UIP_DS6_ROUTE_NB);
+static struct route_trie_node *trie_root;
+static uint32_t lookup_counter;
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
+
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
 
+#if UIP_DS6_ROUTE_STATS
+struct uip_ds6_route_stats uip_ds6_route_stat;
+#endif /* UIP_DS6_ROUTE_STATS */
+
 /* Default routes are held on the defaultrouterlist and their
    structures are allocated from the defaultroutermemb memory block.*/
 LIST(defaultrouterlist);
@@ -119,6 +145,215 @@ assert_nbr_routes_list_sane(void)
 }
 #endif /* DEBUG != DEBUG_NONE */
 /*---------------------------------------------------------------------------*/
+#if (UIP_CONF_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_TRIE
+/* uip_ipaddr_prefixcmp() compares whole bytes only, so the trie does
+   the same to return the routes that the list lookup would. */
+#define TRIE_LENGTH(length) ((length) >= 128 ? 128 : ((length) & ~7))
+/*---------------------------------------------------------------------------*/
+static int
+trie_bit(const uip_ipaddr_t *addr, uint8_t pos)
+{
+  return (addr->u8[pos >> 3] >> (7 - (pos & 7))) & 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Number of leading bits that a and b have in common, at most max */
+static uint8_t
+trie_common_bits(const uip_ipaddr_t *a, const uip_ipaddr_t *b, uint8_t max)
+{
+  uint8_t i;
+  uint8_t bits;
+  uint8_t diff;
+
+  for(i = 0, bits = 0; bits < max; i++, bits += 8) {
+    diff = a->u8[i] ^ b->u8[i];
+    if(diff != 0) {
+      while((diff & 0x80) == 0) {
+        diff <<= 1;
+        bits++;
+      }
+      break;
+    }
+  }
+  return bits < max ? bits : max;
+}
+/*---------------------------------------------------------------------------*/
+/* Put node new in the place of node old below parent */
+static void
+trie_replace(struct route_trie_node *old, struct route_trie_node *new,
+             struct route_trie_node *parent)
+{
+  if(new != NULL) {
+    new->parent = parent;
+  }
+  if(parent == NULL) {
+    trie_root = new;
+  } else {
+    parent->child[parent->child[0] == old ? 0 : 1] = new;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct route_trie_node *
+trie_new_node(const uip_ipaddr_t *prefix, uint8_t length,
+              uip_ds6_route_t *route)
+{
+  struct route_trie_node *n;
+
+  n = memb_alloc(&trienodememb);
+  if(n != NULL) {
+    n->child[0] = n->child[1] = NULL;
+    n->route = route;
+    n->routes = route != NULL ? 1 : 0;
+    n->length = length;
+    uip_ipaddr_copy(&n->prefix, prefix);
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static int
+trie_insert(uip_ds6_route_t *r)
+{
+  struct route_trie_node *n;
+  struct route_trie_node *parent;
+  struct route_trie_node *leaf;
+  struct route_trie_node *branch;
+  uint8_t length;
+  uint8_t common;
+
+  length = TRIE_LENGTH(r->length);
+  parent = NULL;
+  common = 0;
+  for(n = trie_root; n != NULL; n = n->child[trie_bit(&r->ipaddr, n->length)]) {
+    common = trie_common_bits(&r->ipaddr, &n->prefix,
+                              length < n->length ? length : n->length);
+    if(common < n->length) {
+      break;
+    }
+    if(n->length == length) {
+      /* Another route for the same prefix: the lookup returns the most
+         specific one, as the list scan did */
+      n->routes++;
+      if(n->route == NULL || r->length >= n->route->length) {
+        n->route = r;
+      }
+      return 1;
+    }
+    parent = n;
+  }
+
+  leaf = trie_new_node(&r->ipaddr, length, r);
+  if(leaf == NULL) {
+    return 0;
+  }
+
+  if(n == NULL) {
+    leaf->parent = parent;
+    if(parent == NULL) {
+      trie_root = leaf;
+    } else {
+      parent->child[trie_bit(&r->ipaddr, parent->length)] = leaf;
+    }
+  } else if(common == length) {
+    /* The new prefix covers n: insert it above n */
+    trie_replace(n, leaf, parent);
+    leaf->child[trie_bit(&n->prefix, length)] = n;
+    n->parent = leaf;
+  } else {
+    /* The prefixes diverge after common bits: add a branch node */
+    branch = trie_new_node(&r->ipaddr, common, NULL);
+    if(branch == NULL) {
+      memb_free(&trienodememb, leaf);
+      return 0;
+    }
+    trie_replace(n, branch, parent);
+    branch->child[trie_bit(&r->ipaddr, common)] = leaf;
+    branch->child[trie_bit(&n->prefix, common)] = n;
+    leaf->parent = branch;
+    n->parent = branch;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a route from the trie. The route must already be off the
+   route list. */
+static void
+trie_remove(uip_ds6_route_t *r)
+{
+  struct route_trie_node *n;
+  struct route_trie_node *parent;
+  struct route_trie_node *child;
+  uip_ds6_route_t *other;
+  uint8_t length;
+
+  length = TRIE_LENGTH(r->length);
+  for(n = trie_root; n != NULL; n = n->child[trie_bit(&r->ipaddr, n->length)]) {
+    if(trie_common_bits(&r->ipaddr, &n->prefix, n->length) < n->length ||
+       n->length >= length) {
+      break;
+    }
+  }
+  if(n == NULL || n->length != length || n->routes == 0 ||
+     trie_common_bits(&r->ipaddr, &n->prefix, length) < length) {
+    PRINTF("uip-ds6-route: route not found in trie\n");
+    return;
+  }
+
+  n->routes--;
+  if(n->route == r) {
+    n->route = NULL;
+    if(n->routes > 0) {
+      /* Pick the best of the remaining routes for this prefix */
+      for(other = list_head(routelist);
+          other != NULL;
+          other = list_item_next(other)) {
+        if(TRIE_LENGTH(other->length) == length &&
+           uip_ipaddr_prefixcmp(&other->ipaddr, &n->prefix, length) &&
+           (n->route == NULL || other->length >= n->route->length)) {
+          n->route = other;
+        }
+      }
+    }
+  }
+  if(n->route != NULL || (n->child[0] != NULL && n->child[1] != NULL)) {
+    /* Still carries a route, or is needed as a branch node */
+    return;
+  }
+
+  parent = n->parent;
+  child = n->child[0] != NULL ? n->child[0] : n->child[1];
+  trie_replace(n, child, parent);
+  memb_free(&trienodememb, n);
+
+  if(child == NULL && parent != NULL && parent->route == NULL) {
+    /* The parent was a branch node and has a single child left */
+    child = parent->child[0] != NULL ? parent->child[0] : parent->child[1];
+    trie_replace(parent, child, parent->parent);
+    memb_free(&trienodememb, parent);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+trie_lookup(const uip_ipaddr_t *addr, uint16_t *visited)
+{
+  struct route_trie_node *n;
+  uip_ds6_route_t *found_route;
+
+  found_route = NULL;
+  for(n = trie_root; n != NULL; n = n->child[trie_bit(addr, n->length)]) {
+    (*visited)++;
+    if(trie_common_bits(addr, &n->prefix, n->length) < n->length) {
+      break;
+    }
+    if(n->route != NULL) {
+      found_route = n->route;
+    }
+    if(n->length >= 128) {
+      break;
+    }
+  }
+  return found_route;
+}
+#endif /* (UIP_CONF_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_TRIE */
+/*---------------------------------------------------------------------------*/
 #if UIP_DS6_NOTIFICATIONS
 static void
 call_route_callback(int event, uip_ipaddr_t *route,
@@ -162,6 +397,10 @@ uip_ds6_route_init(void)
 #if (UIP_CONF_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_WITH_TRIE
+  memb_init(&trienodememb);
+  trie_root = NULL;
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -254,20 +493,27 @@ uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
 #if (UIP_CONF_MAX_ROUTES != 0)
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+  uint16_t visited;
+#if !UIP_DS6_ROUTE_WITH_TRIE
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif /* !UIP_DS6_ROUTE_WITH_TRIE */
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n");
 
-
+  visited = 0;
+#if UIP_DS6_ROUTE_WITH_TRIE
+  found_route = trie_lookup(addr, &visited);
+#else /* UIP_DS6_ROUTE_WITH_TRIE */
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
       r != NULL;
       r = uip_ds6_route_next(r)) {
+    visited++;
     if(r->length >= longestmatch &&
        uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
       longestmatch = r->length;
@@ -278,6 +524,18 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
+
+#if UIP_DS6_ROUTE_STATS
+  uip_ds6_route_stat.lookups++;
+  uip_ds6_route_stat.visited += visited;
+  if(visited > uip_ds6_route_stat.max_visited) {
+    uip_ds6_route_stat.max_visited = visited;
+  }
+  if(found_route == NULL) {
+    uip_ds6_route_stat.misses++;
+  }
+#endif /* UIP_DS6_ROUTE_STATS */
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -289,6 +547,13 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     PRINTF("uip-ds6-route: No route found\n");
   }
 
+#if UIP_DS6_ROUTE_WITH_TRIE
+  /* Reordering the list would cost a scan, so recency is tracked with
+     a stamp that uip_ds6_route_add() compares when the table is full. */
+  if(found_route != NULL) {
+    found_route->last_lookup = ++lookup_counter;
+  }
+#else /* UIP_DS6_ROUTE_WITH_TRIE */
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
@@ -298,6 +563,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
 
   return found_route;
 #else /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -355,7 +621,20 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 #if UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
       /* Removing the oldest route entry from the route table. The
          least recently used route is the first route on the list. */
+#if UIP_DS6_ROUTE_WITH_TRIE
+      {
+        uip_ds6_route_t *r2;
+        for(r2 = list_head(routelist); r2 != NULL; r2 = list_item_next(r2)) {
+          if(oldest == NULL ||
+             lookup_counter - r2->last_lookup >
+             lookup_counter - oldest->last_lookup) {
+            oldest = r2;
+          }
+        }
+      }
+#else /* UIP_DS6_ROUTE_WITH_TRIE */
       oldest = list_tail(routelist);
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
 #endif
       if(oldest == NULL) {
         return NULL;
@@ -437,6 +716,14 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
 
+#if UIP_DS6_ROUTE_WITH_TRIE
+  r->last_lookup = lookup_counter;
+  if(!trie_insert(r)) {
+    /* Cannot happen: the trie has room for twice the routes */
+    PRINTF("uip_ds6_route_add: could not allocate trie node\n");
+  }
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
+
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
 #endif
@@ -479,6 +766,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_WITH_TRIE
+    trie_remove(route);
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
@@ -718,4 +1008,12 @@ uip_ds6_defrt_periodic(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_DS6_ROUTE_STATS
+void
+uip_ds6_route_stats_reset(void)
+{
+  memset(&uip_ds6_route_stat, 0, sizeof(uip_ds6_route_stat));
+}
+#endif /* UIP_DS6_ROUTE_STATS */
+/*---------------------------------------------------------------------------*/
 /** @} */
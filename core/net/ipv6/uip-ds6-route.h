@@ -88,6 +88,24 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/* UIP_DS6_ROUTE_CONF_WITH_TRIE indexes the routing table with a
+   path-compressed binary trie so that uip_ds6_route_lookup() no longer
+   scans every route. The trie uses up to 2 * UIP_DS6_ROUTE_NB nodes.
+   Route recency is then kept as a lookup stamp per route instead of by
+   reordering the route list. */
+#ifdef UIP_DS6_ROUTE_CONF_WITH_TRIE
+#define UIP_DS6_ROUTE_WITH_TRIE UIP_DS6_ROUTE_CONF_WITH_TRIE
+#else /* UIP_DS6_ROUTE_CONF_WITH_TRIE */
+#define UIP_DS6_ROUTE_WITH_TRIE 0
+#endif /* UIP_DS6_ROUTE_CONF_WITH_TRIE */
+
+/* UIP_DS6_ROUTE_CONF_STATS enables counters of the route lookup cost */
+#ifdef UIP_DS6_ROUTE_CONF_STATS
+#define UIP_DS6_ROUTE_STATS UIP_DS6_ROUTE_CONF_STATS
+#else /* UIP_DS6_ROUTE_CONF_STATS */
+#define UIP_DS6_ROUTE_STATS 0
+#endif /* UIP_DS6_ROUTE_CONF_STATS */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -157,6 +175,10 @@ typedef struct uip_ds6_route {
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   UIP_DS6_ROUTE_STATE_TYPE state;
 #endif
+#if UIP_DS6_ROUTE_WITH_TRIE
+  /* Value of the lookup counter when the route was last used */
+  uint32_t last_lookup;
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
   uint8_t length;
 } uip_ds6_route_t;
 
@@ -203,5 +225,19 @@ uip_ds6_route_t *uip_ds6_route_next(uip_ds6_route_t *);
 int uip_ds6_route_is_nexthop(const uip_ipaddr_t *ipaddr);
 /** @} */
 
+#if UIP_DS6_ROUTE_STATS
+/** \brief Route lookup statistics, kept if UIP_DS6_ROUTE_CONF_STATS is set */
+struct uip_ds6_route_stats {
+  uint32_t lookups;      /**< Number of uip_ds6_route_lookup() calls */
+  uint32_t misses;       /**< Lookups that found no route */
+  uint32_t visited;      /**< Route entries or trie nodes examined */
+  uint16_t max_visited;  /**< Most entries or nodes examined in one lookup */
+};
+
+extern struct uip_ds6_route_stats uip_ds6_route_stat;
+
+void uip_ds6_route_stats_reset(void);
+#endif /* UIP_DS6_ROUTE_STATS */
+
 #endif /* UIP_DS6_ROUTE_H */
 /** @} */
@@ -50,7 +50,9 @@
 
 #include "lib/list.h"
 #include "lib/memb.h"
+#include "lib/hashindex.h"
 
+#include <stddef.h>
 #include <string.h>
 
 #include <stdio.h>
@@ -93,11 +95,45 @@
 #define CSMA_MAX_MAX_FRAME_RETRIES 7
 #endif
 
+/* The number of priority classes. The class of an outgoing packet is
+   taken from PACKETBUF_ATTR_TRAFFIC_CLASS, capped to the highest class.
+   Packets of a higher class go ahead of lower ones in the queue of
+   their neighbor. */
+#ifdef CSMA_CONF_NUM_CLASSES
+#define CSMA_NUM_CLASSES CSMA_CONF_NUM_CLASSES
+#else
+#define CSMA_NUM_CLASSES 1
+#endif
+
+/* Fair queueing between neighbors. Queues take turns by deficit round
+   robin, where a packet costs the bytes it took on the air,
+   retransmissions included, so that a lossy neighbor does not get more
+   than its share of airtime. Packets of a class above 0 do not wait for
+   their turn. When all packet buffers are taken, a packet for a
+   neighbor with a short queue pushes out the last packet of the longest
+   queue. */
+#ifdef CSMA_CONF_FAIR_QUEUEING
+#define CSMA_FAIR_QUEUEING CSMA_CONF_FAIR_QUEUEING
+#else
+#define CSMA_FAIR_QUEUEING 0
+#endif
+
+/* Bytes of airtime added to the deficit of each neighbor per round */
+#ifdef CSMA_CONF_FQ_QUANTUM
+#define CSMA_FQ_QUANTUM CSMA_CONF_FQ_QUANTUM
+#else
+#define CSMA_FQ_QUANTUM 128
+#endif
+
+/* Sent callbacks of pushed-out packets waiting to be called */
+#define CSMA_FQ_MAX_DROPPED 4
+
 /* Packet metadata */
 struct qbuf_metadata {
   mac_callback_t sent;
   void *cptr;
   uint8_t max_transmissions;
+  uint8_t class;
 };
 
 /* Every neighbor has its own packet queue */
@@ -107,6 +143,13 @@ struct neighbor_queue {
   struct ctimer transmit_timer;
   uint8_t transmissions;
   uint8_t collisions;
+  uint16_t dropped;
+#if CSMA_FAIR_QUEUEING
+  /* Bytes the neighbor may still send in this round */
+  int16_t deficit;
+  /* Waiting for the next round */
+  uint8_t parked;
+#endif /* CSMA_FAIR_QUEUEING */
   LIST_STRUCT(queued_packet_list);
 };
 
@@ -124,18 +167,68 @@ struct neighbor_queue {
 #define CSMA_MAX_PACKET_PER_NEIGHBOR MAX_QUEUED_PACKETS
 #endif /* CSMA_CONF_MAX_PACKET_PER_NEIGHBOR */
 
+/* Index the neighbor queues by link-layer address, so that looking up
+   the queue of a packet does not iterate over all queues. The index is
+   an open addressing hash table of CSMA_CONF_HASH_SIZE pointers. */
+#ifdef CSMA_CONF_WITH_HASH
+#define CSMA_WITH_HASH CSMA_CONF_WITH_HASH
+#else
+#define CSMA_WITH_HASH 0
+#endif
+
+#ifdef CSMA_CONF_HASH_SIZE
+#define CSMA_HASH_SIZE CSMA_CONF_HASH_SIZE
+#else
+#define CSMA_HASH_SIZE (2 * CSMA_MAX_NEIGHBOR_QUEUES)
+#endif
+
 #define MAX_QUEUED_PACKETS QUEUEBUF_NUM
 MEMB(neighbor_memb, struct neighbor_queue, CSMA_MAX_NEIGHBOR_QUEUES);
 MEMB(packet_memb, struct rdc_buf_list, MAX_QUEUED_PACKETS);
 MEMB(metadata_memb, struct qbuf_metadata, MAX_QUEUED_PACKETS);
 LIST(neighbor_list);
 
+#if CSMA_STATS
+struct csma_stats csma_stat;
+#define CSMA_STAT(code) (code)
+#else /* CSMA_STATS */
+#define CSMA_STAT(code)
+#endif /* CSMA_STATS */
+
+#if CSMA_FAIR_QUEUEING
+/* A pushed-out packet, whose sender is told from a ctimer rather than in
+   the middle of sending another packet */
+struct dropped_packet {
+  mac_callback_t sent;
+  void *cptr;
+  linkaddr_t addr;
+};
+
+static struct dropped_packet dropped[CSMA_FQ_MAX_DROPPED];
+static uint8_t num_dropped;
+static struct ctimer dropped_timer;
+#endif /* CSMA_FAIR_QUEUEING */
+
 static void packet_sent(void *ptr, int status, int num_transmissions);
 static void transmit_packet_list(void *ptr);
+static void schedule_transmission(struct neighbor_queue *n);
+/*---------------------------------------------------------------------------*/
+#if CSMA_WITH_HASH
+#if CSMA_HASH_SIZE <= CSMA_MAX_NEIGHBOR_QUEUES
+#error CSMA_CONF_HASH_SIZE must be larger than CSMA_CONF_MAX_NEIGHBOR_QUEUES
+#endif
+
+/* Neighbor queues by address */
+HASHINDEX(neighbor_index, CSMA_HASH_SIZE,
+          offsetof(struct neighbor_queue, addr), LINKADDR_SIZE);
+#endif /* CSMA_WITH_HASH */
 /*---------------------------------------------------------------------------*/
 static struct neighbor_queue *
 neighbor_queue_from_addr(const linkaddr_t *addr)
 {
+#if CSMA_WITH_HASH
+  return hashindex_lookup(&neighbor_index, addr);
+#else /* CSMA_WITH_HASH */
   struct neighbor_queue *n = list_head(neighbor_list);
   while(n != NULL) {
     if(linkaddr_cmp(&n->addr, addr)) {
@@ -144,6 +237,18 @@ neighbor_queue_from_addr(const linkaddr_t *addr)
     n = list_item_next(n);
   }
   return NULL;
+#endif /* CSMA_WITH_HASH */
+}
+/*---------------------------------------------------------------------------*/
+static void
+free_neighbor(struct neighbor_queue *n)
+{
+  ctimer_stop(&n->transmit_timer);
+  list_remove(neighbor_list, n);
+#if CSMA_WITH_HASH
+  hashindex_remove(&neighbor_index, n);
+#endif /* CSMA_WITH_HASH */
+  memb_free(&neighbor_memb, n);
 }
 /*---------------------------------------------------------------------------*/
 static clock_time_t
@@ -163,12 +268,67 @@ backoff_period(void)
   return time;
 }
 /*---------------------------------------------------------------------------*/
+#if CSMA_FAIR_QUEUEING
+/* Start a new round once no neighbor may send in the current one. Each
+   neighbor is given as many quanta as it takes for one of them to have
+   a positive deficit. */
+static void
+next_round(void)
+{
+  struct neighbor_queue *n;
+  int16_t rounds;
+  int16_t r;
+
+  rounds = 0;
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(!n->parked) {
+      /* n is backing off or sending, and still in this round */
+      return;
+    }
+    r = -n->deficit / CSMA_FQ_QUANTUM + 1;
+    if(rounds == 0 || r < rounds) {
+      rounds = r;
+    }
+  }
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    n->deficit += rounds * CSMA_FQ_QUANTUM;
+    if(n->deficit > 0) {
+      n->parked = 0;
+      schedule_transmission(n);
+    }
+  }
+  if(rounds > 0) {
+    CSMA_STAT(csma_stat.rounds += rounds);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Charge a neighbor for the airtime of a transmission */
+static void
+charge(struct neighbor_queue *n, int num_transmissions)
+{
+  int32_t deficit;
+
+  deficit = (int32_t)n->deficit - (int32_t)num_transmissions * packetbuf_totlen();
+  n->deficit = deficit < -0x7fff ? -0x7fff : deficit;
+}
+#endif /* CSMA_FAIR_QUEUEING */
+/*---------------------------------------------------------------------------*/
 static void
 transmit_packet_list(void *ptr)
 {
   struct neighbor_queue *n = ptr;
   if(n) {
     struct rdc_buf_list *q = list_head(n->queued_packet_list);
+#if CSMA_FAIR_QUEUEING
+    if(q != NULL && n->deficit <= 0 &&
+       ((struct qbuf_metadata *)q->ptr)->class == 0) {
+      /* Wait for the next round */
+      n->parked = 1;
+      next_round();
+      return;
+    }
+#endif /* CSMA_FAIR_QUEUEING */
     if(q != NULL) {
       PRINTF("csma: preparing number %d %p, queue len %d\n", n->transmissions, q,
           list_length(n->queued_packet_list));
@@ -218,9 +378,11 @@ free_packet(struct neighbor_queue *n, struct rdc_buf_list *p, int status)
       schedule_transmission(n);
     } else {
       /* This was the last packet in the queue, we free the neighbor */
-      ctimer_stop(&n->transmit_timer);
-      list_remove(neighbor_list, n);
-      memb_free(&neighbor_memb, n);
+      free_neighbor(n);
+#if CSMA_FAIR_QUEUEING
+      /* The others may have been waiting for n to end the round */
+      next_round();
+#endif /* CSMA_FAIR_QUEUEING */
     }
   }
 }
@@ -241,14 +403,19 @@ tx_done(int status, struct rdc_buf_list *q, struct neighbor_queue *n)
   switch(status) {
   case MAC_TX_OK:
     PRINTF("csma: rexmit ok %d\n", n->transmissions);
+    CSMA_STAT(csma_stat.tx_packets++);
     break;
   case MAC_TX_COLLISION:
   case MAC_TX_NOACK:
     PRINTF("csma: drop with status %d after %d transmissions, %d collisions\n",
                  status, n->transmissions, n->collisions);
+    CSMA_STAT(csma_stat.tx_failed++);
+    n->dropped++;
     break;
   default:
     PRINTF("csma: rexmit failed %d: %d\n", n->transmissions, status);
+    CSMA_STAT(csma_stat.tx_failed++);
+    n->dropped++;
     break;
   }
 
@@ -344,6 +511,11 @@ packet_sent(void *ptr, int status, int num_transmissions)
     return;
   }
 
+  CSMA_STAT(csma_stat.tx_transmissions += num_transmissions);
+#if CSMA_FAIR_QUEUEING
+  charge(n, num_transmissions);
+#endif /* CSMA_FAIR_QUEUEING */
+
   switch(status) {
   case MAC_TX_OK:
     tx_ok(q, n, num_transmissions);
@@ -362,6 +534,105 @@ packet_sent(void *ptr, int status, int num_transmissions)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if CSMA_FAIR_QUEUEING
+static void
+call_dropped(void *ptr)
+{
+  struct dropped_packet d;
+
+  while(num_dropped > 0) {
+    d = dropped[0];
+    num_dropped--;
+    memmove(&dropped[0], &dropped[1], num_dropped * sizeof(dropped[0]));
+    packetbuf_clear();
+    packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &d.addr);
+    mac_call_sent_callback(d.sent, d.cptr, MAC_TX_ERR, 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Make room for a packet of the given class for n, by dropping the last
+   packet of the longest queue if it is longer than that of n by two, or
+   else the last packet of n if it is of a lower class */
+static void
+push_out(struct neighbor_queue *n, uint8_t class)
+{
+  struct neighbor_queue *longest;
+  struct neighbor_queue *m;
+  struct rdc_buf_list *q;
+  struct qbuf_metadata *metadata;
+  int len;
+  int max;
+
+  if(num_dropped == CSMA_FQ_MAX_DROPPED) {
+    return;
+  }
+
+  longest = NULL;
+  len = list_length(n->queued_packet_list);
+  if(len < CSMA_MAX_PACKET_PER_NEIGHBOR) {
+    max = len + 1;
+    for(m = list_head(neighbor_list); m != NULL; m = list_item_next(m)) {
+      len = list_length(m->queued_packet_list);
+      if(len > max) {
+        longest = m;
+        max = len;
+      }
+    }
+  }
+  if(longest == NULL) {
+    if(list_length(n->queued_packet_list) < 2) {
+      return;
+    }
+    longest = n;
+  }
+
+  /* The last packet is not the one being sent, as there are others */
+  q = list_tail(longest->queued_packet_list);
+  metadata = (struct qbuf_metadata *)q->ptr;
+  if(metadata->class > class || (longest == n && metadata->class == class)) {
+    return;
+  }
+  PRINTF("csma: pushing out a packet, queue length %d\n",
+         list_length(longest->queued_packet_list));
+  dropped[num_dropped].sent = metadata->sent;
+  dropped[num_dropped].cptr = metadata->cptr;
+  linkaddr_copy(&dropped[num_dropped].addr, &longest->addr);
+  num_dropped++;
+  ctimer_set(&dropped_timer, 0, call_dropped, NULL);
+
+  list_remove(longest->queued_packet_list, q);
+  queuebuf_free(q->buf);
+  memb_free(&metadata_memb, q->ptr);
+  memb_free(&packet_memb, q);
+  longest->dropped++;
+  CSMA_STAT(csma_stat.dropped_pushed_out++);
+}
+#endif /* CSMA_FAIR_QUEUEING */
+/*---------------------------------------------------------------------------*/
+/* Add q to the queue of n, behind the packets of the same or a higher
+   class */
+static void
+enqueue(struct neighbor_queue *n, struct rdc_buf_list *q)
+{
+  struct rdc_buf_list *prev;
+  struct rdc_buf_list *p;
+  uint8_t class;
+
+  class = ((struct qbuf_metadata *)q->ptr)->class;
+  prev = NULL;
+  for(p = list_head(n->queued_packet_list); p != NULL; p = list_item_next(p)) {
+    if(((struct qbuf_metadata *)p->ptr)->class < class) {
+      break;
+    }
+    prev = p;
+  }
+  if(prev == NULL) {
+    list_push(n->queued_packet_list, q);
+  } else {
+    list_insert(n->queued_packet_list, prev, q);
+  }
+}
+/*---------------------------------------------------------------------------*/
 static void
 send_packet(mac_callback_t sent, void *ptr)
 {
@@ -370,6 +641,8 @@ send_packet(mac_callback_t sent, void *ptr)
   static uint8_t initialized = 0;
   static uint16_t seqno;
   const linkaddr_t *addr = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  uint8_t class = MIN(packetbuf_attr(PACKETBUF_ATTR_TRAFFIC_CLASS),
+                      CSMA_NUM_CLASSES - 1);
 
   if(!initialized) {
     initialized = 1;
@@ -394,14 +667,29 @@ send_packet(mac_callback_t sent, void *ptr)
       linkaddr_copy(&n->addr, addr);
       n->transmissions = 0;
       n->collisions = CSMA_MIN_BE;
+      n->dropped = 0;
+#if CSMA_FAIR_QUEUEING
+      /* A new neighbor joins the current round */
+      n->deficit = CSMA_FQ_QUANTUM;
+      n->parked = 0;
+#endif /* CSMA_FAIR_QUEUEING */
       /* Init packet list for this neighbor */
       LIST_STRUCT_INIT(n, queued_packet_list);
       /* Add neighbor to the list */
       list_add(neighbor_list, n);
+#if CSMA_WITH_HASH
+      hashindex_add(&neighbor_index, n);
+#endif /* CSMA_WITH_HASH */
     }
   }
 
   if(n != NULL) {
+#if CSMA_FAIR_QUEUEING
+    if(memb_numfree(&packet_memb) == 0 ||
+       list_length(n->queued_packet_list) >= CSMA_MAX_PACKET_PER_NEIGHBOR) {
+      push_out(n, class);
+    }
+#endif /* CSMA_FAIR_QUEUEING */
     /* Add packet to the neighbor's queue */
     if(list_length(n->queued_packet_list) < CSMA_MAX_PACKET_PER_NEIGHBOR) {
       q = memb_alloc(&packet_memb);
@@ -421,13 +709,16 @@ send_packet(mac_callback_t sent, void *ptr)
             }
             metadata->sent = sent;
             metadata->cptr = ptr;
+            metadata->class = class;
 #if PACKETBUF_WITH_PACKET_TYPE
             if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
                PACKETBUF_ATTR_PACKET_TYPE_ACK) {
               list_push(n->queued_packet_list, q);
             } else
 #endif
-            {
+            if(class > 0) {
+              enqueue(n, q);
+            } else {
               list_add(n->queued_packet_list, q);
             }
 
@@ -435,6 +726,14 @@ send_packet(mac_callback_t sent, void *ptr)
                    list_length(n->queued_packet_list), memb_numfree(&packet_memb));
             /* If q is the first packet in the neighbor's queue, send asap */
             if(list_head(n->queued_packet_list) == q) {
+              /* The counts of a packet q went ahead of are not those
+                 of q */
+              n->transmissions = 0;
+              n->collisions = CSMA_MIN_BE;
+#if CSMA_FAIR_QUEUEING
+              /* A packet of a higher class does not wait for its turn */
+              n->parked = 0;
+#endif /* CSMA_FAIR_QUEUEING */
               schedule_transmission(n);
             }
             return;
@@ -447,16 +746,20 @@ send_packet(mac_callback_t sent, void *ptr)
       }
       /* The packet allocation failed. Remove and free neighbor entry if empty. */
       if(list_length(n->queued_packet_list) == 0) {
-        list_remove(neighbor_list, n);
-        memb_free(&neighbor_memb, n);
+        free_neighbor(n);
+        n = NULL;
       }
     } else {
       PRINTF("csma: Neighbor queue full\n");
     }
     PRINTF("csma: could not allocate packet, dropping packet\n");
+    if(n != NULL) {
+      n->dropped++;
+    }
   } else {
     PRINTF("csma: could not allocate neighbor, dropping packet\n");
   }
+  CSMA_STAT(csma_stat.dropped_full++);
   mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
 }
 /*---------------------------------------------------------------------------*/
@@ -493,7 +796,37 @@ init(void)
   memb_init(&packet_memb);
   memb_init(&metadata_memb);
   memb_init(&neighbor_memb);
+#if CSMA_WITH_HASH
+  hashindex_init(&neighbor_index);
+#endif /* CSMA_WITH_HASH */
+}
+/*---------------------------------------------------------------------------*/
+int
+csma_neighbor_stats(const linkaddr_t *addr, struct csma_neighbor_stats *stats)
+{
+  struct neighbor_queue *n;
+
+  n = neighbor_queue_from_addr(addr);
+  if(n == NULL) {
+    return 0;
+  }
+  stats->backlog = list_length(n->queued_packet_list);
+  stats->dropped = n->dropped;
+#if CSMA_FAIR_QUEUEING
+  stats->deficit = n->deficit;
+#else /* CSMA_FAIR_QUEUEING */
+  stats->deficit = 0;
+#endif /* CSMA_FAIR_QUEUEING */
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+#if CSMA_STATS
+void
+csma_stats_reset(void)
+{
+  memset(&csma_stat, 0, sizeof(csma_stat));
 }
+#endif /* CSMA_STATS */
 /*---------------------------------------------------------------------------*/
 const struct mac_driver csma_driver = {
   "CSMA",
@@ -43,6 +43,46 @@
 
 #include "net/mac/mac.h"
 #include "dev/radio.h"
+#include "net/linkaddr.h"
+
+/* CSMA_CONF_STATS keeps counters of sent and dropped packets */
+#ifdef CSMA_CONF_STATS
+#define CSMA_STATS CSMA_CONF_STATS
+#else /* CSMA_CONF_STATS */
+#define CSMA_STATS 0
+#endif /* CSMA_CONF_STATS */
+
+#if CSMA_STATS
+/** \brief CSMA statistics, kept if CSMA_CONF_STATS is set */
+struct csma_stats {
+  uint32_t tx_packets;       /**< Packets acknowledged, or sent if broadcast */
+  uint32_t tx_failed;        /**< Packets given up after retransmissions */
+  uint32_t tx_transmissions; /**< Transmissions, retransmissions included */
+  uint32_t dropped_full;     /**< Packets refused, for lack of a queue or buffer */
+  uint32_t dropped_pushed_out; /**< Queued packets dropped to make room */
+  uint32_t rounds;           /**< Fair queueing rounds */
+};
+
+extern struct csma_stats csma_stat;
+
+void csma_stats_reset(void);
+#endif /* CSMA_STATS */
+
+/** \brief State of the queue of a neighbor, while packets are queued */
+struct csma_neighbor_stats {
+  uint16_t backlog;          /**< Packets in the queue */
+  uint16_t dropped;          /**< Packets dropped since the queue was created */
+  int16_t deficit;           /**< Bytes the neighbor may still send this round */
+};
+
+/**
+ * \brief Get the state of the queue of a neighbor
+ * \param addr The link-layer address of the neighbor
+ * \param stats Where to store the state
+ * \return 1 if the neighbor has packets queued, 0 otherwise
+ */
+int csma_neighbor_stats(const linkaddr_t *addr,
+                        struct csma_neighbor_stats *stats);
 
 extern const struct mac_driver csma_driver;
 
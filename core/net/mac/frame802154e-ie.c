@@ -60,9 +60,15 @@ enum ieee802154e_header_ie_id {
 enum ieee802154e_payload_ie_id {
   PAYLOAD_IE_ESDU = 0,
   PAYLOAD_IE_MLME,
+  PAYLOAD_IE_IETF = 0x5,
   PAYLOAD_IE_LIST_TERMINATION = 0xf,
 };
 
+/* c.f. RFC 8137 and RFC 8480, IETF IE sub-IDs */
+enum ieee802154e_ietf_subie_id {
+  IETF_IE_SIXTOP = 0xc9,
+};
+
 /* c.f. IEEE 802.15.4e Table 4d */
 enum ieee802154e_mlme_short_subie_id {
   MLME_SHORT_IE_TSCH_SYNCHRONIZATION = 0x1a,
@@ -74,6 +80,11 @@ enum ieee802154e_mlme_short_subie_id {
   MLME_SHORT_IE_TSCH_MAC_METRICS_2,
 };
 
+/* Our own MLME short sub-IE, with an ID left unassigned by Table 4d */
+enum {
+  MLME_SHORT_IE_TSCH_CHANNEL_BLACKLIST = 0x10,
+};
+
 /* c.f. IEEE 802.15.4e Table 4e */
 enum ieee802154e_mlme_long_subie_id {
   MLME_LONG_IE_TSCH_CHANNEL_HOPPING_SEQUENCE = 0x9,
@@ -207,6 +218,22 @@ frame80215e_create_ie_mlme(uint8_t *buf, int len,
   }
 }
 
+/* Payload IE. IETF, with a 6top sub-IE. Used in 6P messages */
+int
+frame80215e_create_ie_ietf_sixtop(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int ie_len = 1;
+  if(len >= 2 + ie_len && ies != NULL) {
+    /* The length of the IETF IE covers the sub-ID and the 6P message */
+    create_payload_ie_descriptor(buf, PAYLOAD_IE_IETF, ie_len + ies->ie_sixtop_content_len);
+    buf[2] = IETF_IE_SIXTOP;
+    return 2 + ie_len;
+  } else {
+    return -1;
+  }
+}
+
 /* MLME sub-IE. TSCH synchronization. Used in EBs: ASN and join priority */
 int
 frame80215e_create_ie_tsch_synchronization(uint8_t *buf, int len,
@@ -290,6 +317,23 @@ frame80215e_create_ie_tsch_timeslot(uint8_t *buf, int len,
   }
 }
 
+/* MLME sub-IE. TSCH channel blacklist. Used in EBs: sequence number and
+ * blacklist bitmap */
+int
+frame80215e_create_ie_tsch_channel_blacklist(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int ie_len = 3;
+  if(ies != NULL && len >= 2 + ie_len) {
+    buf[2] = ies->ie_channel_blacklist_seqnum;
+    WRITE16(buf + 3, ies->ie_channel_blacklist);
+    create_mlme_short_ie_descriptor(buf, MLME_SHORT_IE_TSCH_CHANNEL_BLACKLIST, ie_len);
+    return 2 + ie_len;
+  } else {
+    return -1;
+  }
+}
+
 /* MLME sub-IE. TSCH channel hopping sequence. Used in EBs: hopping sequence */
 int
 frame80215e_create_ie_tsch_channel_hopping_sequence(uint8_t *buf, int len,
@@ -397,6 +441,16 @@ frame802154e_parse_mlme_short_ie(const uint8_t *buf, int len,
         return len;
       }
       break;
+    case MLME_SHORT_IE_TSCH_CHANNEL_BLACKLIST:
+      if(len == 3) {
+        if(ies != NULL) {
+          ies->ie_channel_blacklist_present = 1;
+          ies->ie_channel_blacklist_seqnum = buf[0];
+          READ16(buf + 1, ies->ie_channel_blacklist);
+        }
+        return len;
+      }
+      break;
     case MLME_SHORT_IE_TSCH_TIMESLOT:
       if(len == 1 || len == 25) {
         if(ies != NULL) {
@@ -529,6 +583,19 @@ frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
             len = 0; /* Reset len as we want to read subIEs and not jump over them */
             PRINTF("frame802154e: entering MLME ie with len %u\n", nested_mlme_len);
             break;
+          case PAYLOAD_IE_IETF:
+            /* The first byte is the sub-ID, c.f. RFC 8137 */
+            if(len < 1 || len > buf_size) {
+              PRINTF("frame802154e: wrong IETF ie len %u\n", len);
+              return -1;
+            }
+            if(buf[0] == IETF_IE_SIXTOP) {
+              ies->ie_sixtop_content = buf + 1;
+              ies->ie_sixtop_content_len = len - 1;
+            } else {
+              PRINTF("frame802154e: non-supported IETF sub-ie %x\n", buf[0]);
+            }
+            break;
           case PAYLOAD_IE_LIST_TERMINATION:
             PRINTF("frame802154e: payload ie list termination %u\n", len);
             return (len == 0) ? buf + len - start : -1;
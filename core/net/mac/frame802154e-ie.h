@@ -75,11 +75,18 @@ struct ieee802154_ies {
   uint8_t ie_tsch_timeslot_id;
   uint16_t ie_tsch_timeslot[tsch_ts_elements_count];
   struct tsch_slotframe_and_links ie_tsch_slotframe_and_link;
+  /* Channel blacklist, bit i for entry i of the hopping sequence */
+  uint8_t ie_channel_blacklist_present;
+  uint8_t ie_channel_blacklist_seqnum;
+  uint16_t ie_channel_blacklist;
   /* Payload Long MLME IEs */
   uint8_t ie_channel_hopping_sequence_id;
   /* We include and parse only the sequence len and list and omit unused fields */
   uint16_t ie_hopping_sequence_len;
   uint8_t ie_hopping_sequence_list[TSCH_HOPPING_SEQUENCE_MAX_LEN];
+  /* Payload IETF IE: 6top sub-IE (RFC 8480). Points to the 6P message */
+  const uint8_t *ie_sixtop_content;
+  uint16_t ie_sixtop_content_len;
 };
 
 /** Insert various Information Elements **/
@@ -100,6 +107,11 @@ int frame80215e_create_ie_payload_list_termination(uint8_t *buf, int len,
 /* Payload IE. MLME. Used to nest sub-IEs */
 int frame80215e_create_ie_mlme(uint8_t *buf, int len,
     struct ieee802154_ies *ies);
+/* Payload IE. IETF, with a 6top sub-IE (RFC 8480). Inserts the IE descriptor
+ * and the sub-IE ID only: the 6P message of ie_sixtop_content_len bytes is to
+ * be written right after */
+int frame80215e_create_ie_ietf_sixtop(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
 /* MLME sub-IE. TSCH synchronization. Used in EBs: ASN and join priority */
 int frame80215e_create_ie_tsch_synchronization(uint8_t *buf, int len,
     struct ieee802154_ies *ies);
@@ -112,6 +124,10 @@ int frame80215e_create_ie_tsch_timeslot(uint8_t *buf, int len,
 /* MLME sub-IE. TSCH channel hopping sequence. Used in EBs: hopping sequence */
 int frame80215e_create_ie_tsch_channel_hopping_sequence(uint8_t *buf, int len,
     struct ieee802154_ies *ies);
+/* MLME sub-IE. TSCH channel blacklist, not part of IEEE 802.15.4e. Used in
+ * EBs: the channels of the hopping sequence to skip */
+int frame80215e_create_ie_tsch_channel_blacklist(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
 
 /* Parse all Information Elements of a frame */
 int frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
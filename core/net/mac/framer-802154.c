@@ -99,6 +99,13 @@ create_frame(int type, int do_create)
 
   /* Insert IEEE 802.15.4 version bits. */
   params.fcf.frame_version = FRAME802154_VERSION;
+
+  /* The payload starts with Information Elements (e.g. 6P messages),
+   * which require a 802.15.4e frame */
+  if(packetbuf_attr(PACKETBUF_ATTR_MAC_METADATA)) {
+    params.fcf.ie_list_present = 1;
+    params.fcf.frame_version = FRAME802154_IEEE802154E_2012;
+  }
   
 #if LLSEC802154_USES_AUX_HEADER
   if(packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL)) {
@@ -232,6 +239,7 @@ parse(void)
     }
     packetbuf_set_addr(PACKETBUF_ADDR_SENDER, (linkaddr_t *)&frame.src_addr);
     packetbuf_set_attr(PACKETBUF_ATTR_PENDING, frame.fcf.frame_pending);
+    packetbuf_set_attr(PACKETBUF_ATTR_MAC_METADATA, frame.fcf.ie_list_present);
     if(frame.fcf.sequence_number_suppression == 0) {
       packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, frame.seq);
     } else {
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6top Protocol (6P, RFC 8480) messages. Multi-byte fields are
+ *         little endian. The body of each message is, by type and command:
+ *
+ *         Request       ADD, DELETE  Metadata CellOptions NumCells CellList
+ *                       RELOCATE     Metadata CellOptions NumCells
+ *                                    RelocationCellList CandidateCellList
+ *                       COUNT        Metadata CellOptions
+ *                       LIST         Metadata CellOptions Reserved Offset
+ *                                    MaxNumCells
+ *                       SIGNAL       Metadata Payload
+ *                       CLEAR        Metadata
+ *         Response      COUNT        NumCells (16 bits)
+ *                       SIGNAL       Payload
+ *                       CLEAR        (empty)
+ *                       other        CellList
+ *         Confirmation               CellList
+ *
+ *         Responses and confirmations with an error return code have an
+ *         empty body.
+ */
+
+#include <string.h>
+#include "net/mac/tsch/sixtop/sixp-pkt.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/net-debug.h"
+
+#define WRITE16(buf, val) \
+  do { ((uint8_t *)(buf))[0] = (val) & 0xff; \
+       ((uint8_t *)(buf))[1] = ((val) >> 8) & 0xff; } while(0)
+
+#define READ16(buf) \
+  ((uint16_t)(((const uint8_t *)(buf))[0] | ((const uint8_t *)(buf))[1] << 8))
+
+/*---------------------------------------------------------------------------*/
+/* Do messages of this type and return code carry a body? */
+static int
+has_body(enum sixp_pkt_type type, uint8_t code)
+{
+  return type == SIXP_PKT_TYPE_REQUEST
+         || code == SIXP_PKT_RC_SUCCESS || code == SIXP_PKT_RC_EOL;
+}
+/*---------------------------------------------------------------------------*/
+void
+sixp_pkt_get_cell(const uint8_t *cell_list, int i, struct sixp_cell *cell)
+{
+  cell->timeslot = READ16(cell_list + i * SIXP_PKT_CELL_LEN);
+  cell->channel_offset = READ16(cell_list + i * SIXP_PKT_CELL_LEN + 2);
+}
+/*---------------------------------------------------------------------------*/
+void
+sixp_pkt_set_cell(uint8_t *cell_list, int i, const struct sixp_cell *cell)
+{
+  WRITE16(cell_list + i * SIXP_PKT_CELL_LEN, cell->timeslot);
+  WRITE16(cell_list + i * SIXP_PKT_CELL_LEN + 2, cell->channel_offset);
+}
+/*---------------------------------------------------------------------------*/
+int
+sixp_pkt_has_cell(const uint8_t *cell_list, int n, const struct sixp_cell *cell)
+{
+  struct sixp_cell c;
+  int i;
+  for(i = 0; i < n; i++) {
+    sixp_pkt_get_cell(cell_list, i, &c);
+    if(c.timeslot == cell->timeslot && c.channel_offset == cell->channel_offset) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+sixp_pkt_create(enum sixp_pkt_type type, uint8_t code, enum sixp_pkt_cmd cmd,
+                uint8_t sfid, uint8_t seqnum,
+                const struct sixp_pkt_body *body, uint8_t *buf, int len)
+{
+  uint8_t *p = buf + SIXP_PKT_HDR_LEN;
+  int body_len = 0;
+  int cells_len;
+
+  if(len < SIXP_PKT_HDR_LEN || type > SIXP_PKT_TYPE_CONFIRMATION) {
+    return -1;
+  }
+  len -= SIXP_PKT_HDR_LEN;
+
+  buf[0] = SIXP_PKT_VERSION | (type << 4);
+  buf[1] = code;
+  buf[2] = sfid;
+  buf[3] = seqnum;
+
+  if(!has_body(type, code)) {
+    return SIXP_PKT_HDR_LEN;
+  }
+  if(body == NULL) {
+    return -1;
+  }
+
+  cells_len = body->cell_list_len * SIXP_PKT_CELL_LEN;
+
+  if(type == SIXP_PKT_TYPE_REQUEST) {
+    if(code != cmd) {
+      return -1;
+    }
+    switch(cmd) {
+      case SIXP_PKT_CMD_ADD:
+      case SIXP_PKT_CMD_DELETE:
+      case SIXP_PKT_CMD_RELOCATE:
+        body_len = 4 + cells_len;
+        if(cmd == SIXP_PKT_CMD_RELOCATE) {
+          if(body->rel_cell_list_len != body->num_cells) {
+            return -1;
+          }
+          body_len += body->rel_cell_list_len * SIXP_PKT_CELL_LEN;
+        }
+        if(len < body_len || body->num_cells > 0xff) {
+          return -1;
+        }
+        p[2] = body->cell_options;
+        p[3] = body->num_cells;
+        p += 4;
+        if(cmd == SIXP_PKT_CMD_RELOCATE) {
+          memcpy(p, body->rel_cell_list, body->rel_cell_list_len * SIXP_PKT_CELL_LEN);
+          p += body->rel_cell_list_len * SIXP_PKT_CELL_LEN;
+        }
+        memcpy(p, body->cell_list, cells_len);
+        break;
+      case SIXP_PKT_CMD_COUNT:
+        body_len = 3;
+        if(len < body_len) {
+          return -1;
+        }
+        p[2] = body->cell_options;
+        break;
+      case SIXP_PKT_CMD_LIST:
+        body_len = 8;
+        if(len < body_len) {
+          return -1;
+        }
+        p[2] = body->cell_options;
+        p[3] = 0; /* Reserved */
+        WRITE16(p + 4, body->offset);
+        WRITE16(p + 6, body->max_num_cells);
+        break;
+      case SIXP_PKT_CMD_SIGNAL:
+        body_len = 2 + body->payload_len;
+        if(len < body_len) {
+          return -1;
+        }
+        memcpy(p + 2, body->payload, body->payload_len);
+        break;
+      case SIXP_PKT_CMD_CLEAR:
+        body_len = 2;
+        if(len < body_len) {
+          return -1;
+        }
+        break;
+      default:
+        return -1;
+    }
+    /* Every request starts with the Metadata */
+    WRITE16(buf + SIXP_PKT_HDR_LEN, body->metadata);
+  } else if(type == SIXP_PKT_TYPE_RESPONSE && cmd == SIXP_PKT_CMD_COUNT) {
+    body_len = 2;
+    if(len < body_len) {
+      return -1;
+    }
+    WRITE16(p, body->num_cells);
+  } else if(type == SIXP_PKT_TYPE_RESPONSE && cmd == SIXP_PKT_CMD_SIGNAL) {
+    body_len = body->payload_len;
+    if(len < body_len) {
+      return -1;
+    }
+    memcpy(p, body->payload, body_len);
+  } else if(type == SIXP_PKT_TYPE_RESPONSE && cmd == SIXP_PKT_CMD_CLEAR) {
+    body_len = 0;
+  } else if(type == SIXP_PKT_TYPE_RESPONSE || cmd == SIXP_PKT_CMD_ADD
+            || cmd == SIXP_PKT_CMD_DELETE || cmd == SIXP_PKT_CMD_RELOCATE) {
+    body_len = cells_len;
+    if(len < body_len) {
+      return -1;
+    }
+    memcpy(p, body->cell_list, body_len);
+  } else {
+    /* Only ADD, DELETE and RELOCATE have a confirmation */
+    return -1;
+  }
+
+  return SIXP_PKT_HDR_LEN + body_len;
+}
+/*---------------------------------------------------------------------------*/
+int
+sixp_pkt_get_version(const uint8_t *buf, int len)
+{
+  return len > 0 ? buf[0] & 0x0f : -1;
+}
+/*---------------------------------------------------------------------------*/
+int
+sixp_pkt_parse(const uint8_t *buf, int len, struct sixp_pkt *pkt)
+{
+  if(len < SIXP_PKT_HDR_LEN) {
+    PRINTF("6P: message too short %d\n", len);
+    return -1;
+  }
+  pkt->type = (buf[0] >> 4) & 0x03;
+  pkt->code = buf[1];
+  pkt->sfid = buf[2];
+  pkt->seqnum = buf[3];
+  pkt->body = buf + SIXP_PKT_HDR_LEN;
+  pkt->body_len = len - SIXP_PKT_HDR_LEN;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Points body->cell_list to the cell list that makes the rest of the body */
+static int
+parse_cell_list(const uint8_t *p, int len, struct sixp_pkt_body *body)
+{
+  if(len % SIXP_PKT_CELL_LEN != 0 || len / SIXP_PKT_CELL_LEN > 0xff) {
+    PRINTF("6P: malformed cell list, len %d\n", len);
+    return -1;
+  }
+  body->cell_list = p;
+  body->cell_list_len = len / SIXP_PKT_CELL_LEN;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+sixp_pkt_parse_body(const struct sixp_pkt *pkt, enum sixp_pkt_cmd cmd,
+                    struct sixp_pkt_body *body)
+{
+  const uint8_t *p = pkt->body;
+  int len = pkt->body_len;
+
+  memset(body, 0, sizeof(struct sixp_pkt_body));
+
+  if(!has_body(pkt->type, pkt->code)) {
+    return 0;
+  }
+
+  if(pkt->type == SIXP_PKT_TYPE_REQUEST) {
+    if(pkt->code != cmd || len < 2) {
+      return -1;
+    }
+    body->metadata = READ16(p);
+    switch(cmd) {
+      case SIXP_PKT_CMD_ADD:
+      case SIXP_PKT_CMD_DELETE:
+      case SIXP_PKT_CMD_RELOCATE:
+        if(len < 4) {
+          return -1;
+        }
+        body->cell_options = p[2];
+        body->num_cells = p[3];
+        p += 4;
+        len -= 4;
+        if(cmd == SIXP_PKT_CMD_RELOCATE) {
+          if(len < body->num_cells * SIXP_PKT_CELL_LEN) {
+            return -1;
+          }
+          body->rel_cell_list = p;
+          body->rel_cell_list_len = body->num_cells;
+          p += body->num_cells * SIXP_PKT_CELL_LEN;
+          len -= body->num_cells * SIXP_PKT_CELL_LEN;
+        }
+        return parse_cell_list(p, len, body);
+      case SIXP_PKT_CMD_COUNT:
+        if(len != 3) {
+          return -1;
+        }
+        body->cell_options = p[2];
+        return 0;
+      case SIXP_PKT_CMD_LIST:
+        if(len != 8) {
+          return -1;
+        }
+        body->cell_options = p[2];
+        body->offset = READ16(p + 4);
+        body->max_num_cells = READ16(p + 6);
+        return 0;
+      case SIXP_PKT_CMD_SIGNAL:
+        body->payload = p + 2;
+        body->payload_len = len - 2;
+        return 0;
+      case SIXP_PKT_CMD_CLEAR:
+        return len == 2 ? 0 : -1;
+      default:
+        return -1;
+    }
+  } else if(pkt->type == SIXP_PKT_TYPE_RESPONSE && cmd == SIXP_PKT_CMD_COUNT) {
+    if(len != 2) {
+      return -1;
+    }
+    body->num_cells = READ16(p);
+    return 0;
+  } else if(pkt->type == SIXP_PKT_TYPE_RESPONSE && cmd == SIXP_PKT_CMD_SIGNAL) {
+    body->payload = p;
+    body->payload_len = len;
+    return 0;
+  } else if(pkt->type == SIXP_PKT_TYPE_RESPONSE && cmd == SIXP_PKT_CMD_CLEAR) {
+    return len == 0 ? 0 : -1;
+  } else if(pkt->type == SIXP_PKT_TYPE_RESPONSE || cmd == SIXP_PKT_CMD_ADD
+            || cmd == SIXP_PKT_CMD_DELETE || cmd == SIXP_PKT_CMD_RELOCATE) {
+    return parse_cell_list(p, len, body);
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
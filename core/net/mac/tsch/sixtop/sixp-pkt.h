@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6top Protocol (6P, RFC 8480) messages: building and parsing of
+ *         the 6P header and of the body of every command.
+ */
+
+#ifndef __SIXP_PKT_H__
+#define __SIXP_PKT_H__
+
+#include "contiki.h"
+
+/********** Constants *********/
+
+/* The 6P version we speak */
+#define SIXP_PKT_VERSION          0
+/* Length of the 6P header: Version/Type, Code, SFID, SeqNum */
+#define SIXP_PKT_HDR_LEN          4
+/* Length of a cell in a CellList: slotOffset and channelOffset */
+#define SIXP_PKT_CELL_LEN         4
+
+/* Message types */
+enum sixp_pkt_type {
+  SIXP_PKT_TYPE_REQUEST = 0,
+  SIXP_PKT_TYPE_RESPONSE = 1,
+  SIXP_PKT_TYPE_CONFIRMATION = 2,
+};
+
+/* Commands, the code of requests */
+enum sixp_pkt_cmd {
+  SIXP_PKT_CMD_ADD = 1,
+  SIXP_PKT_CMD_DELETE = 2,
+  SIXP_PKT_CMD_RELOCATE = 3,
+  SIXP_PKT_CMD_COUNT = 4,
+  SIXP_PKT_CMD_LIST = 5,
+  SIXP_PKT_CMD_SIGNAL = 6,
+  SIXP_PKT_CMD_CLEAR = 7,
+};
+
+/* Return codes, the code of responses and confirmations */
+enum sixp_pkt_rc {
+  SIXP_PKT_RC_SUCCESS = 0,
+  SIXP_PKT_RC_EOL = 1,
+  SIXP_PKT_RC_ERR = 2,
+  SIXP_PKT_RC_RESET = 3,
+  SIXP_PKT_RC_ERR_VERSION = 4,
+  SIXP_PKT_RC_ERR_SFID = 5,
+  SIXP_PKT_RC_ERR_SEQNUM = 6,
+  SIXP_PKT_RC_ERR_CELLLIST = 7,
+  SIXP_PKT_RC_ERR_BUSY = 8,
+  SIXP_PKT_RC_ERR_LOCKED = 9,
+};
+
+/* CellOptions bitmap */
+#define SIXP_PKT_CELL_OPTION_TX     0x01
+#define SIXP_PKT_CELL_OPTION_RX     0x02
+#define SIXP_PKT_CELL_OPTION_SHARED 0x04
+
+/************ Types ***********/
+
+struct sixp_cell {
+  uint16_t timeslot;
+  uint16_t channel_offset;
+};
+
+/* The fields of a 6P body. Which of them are present depends on the type
+ * and on the command (see sixp-pkt.c). Cell lists and the SIGNAL payload
+ * are not copied: they point into the message they were parsed from, or to
+ * the caller's buffer when building a message. Cells are read and written
+ * with sixp_pkt_get_cell and sixp_pkt_set_cell. */
+struct sixp_pkt_body {
+  uint16_t metadata;
+  uint8_t cell_options;
+  /* NumCells of ADD, DELETE and RELOCATE requests, or the total number of
+   * cells of a COUNT response */
+  uint16_t num_cells;
+  /* LIST requests */
+  uint16_t offset;
+  uint16_t max_num_cells;
+  /* CellList; the CandidateCellList of RELOCATE requests */
+  const uint8_t *cell_list;
+  uint8_t cell_list_len;        /* In cells */
+  /* RelocationCellList of RELOCATE requests */
+  const uint8_t *rel_cell_list;
+  uint8_t rel_cell_list_len;    /* In cells */
+  /* Opaque payload of SIGNAL requests and responses */
+  const uint8_t *payload;
+  uint16_t payload_len;
+};
+
+struct sixp_pkt {
+  enum sixp_pkt_type type;
+  uint8_t code;
+  uint8_t sfid;
+  uint8_t seqnum;
+  const uint8_t *body;
+  uint16_t body_len;
+};
+
+/********** Functions *********/
+
+/* Writes a 6P message to buf. cmd is the command of the transaction, which
+ * defines the body of responses and confirmations. Returns the message
+ * length, or -1 if body does not fit in len bytes or does not match the
+ * command */
+int sixp_pkt_create(enum sixp_pkt_type type, uint8_t code, enum sixp_pkt_cmd cmd,
+                    uint8_t sfid, uint8_t seqnum,
+                    const struct sixp_pkt_body *body, uint8_t *buf, int len);
+/* Parses the header of the 6P message in buf. pkt->body points into buf.
+ * Returns 0 on success, -1 if the message is too short. The version is not
+ * checked: see sixp_pkt_get_version */
+int sixp_pkt_parse(const uint8_t *buf, int len, struct sixp_pkt *pkt);
+/* Returns the version of the 6P message in buf, -1 if buf is empty */
+int sixp_pkt_get_version(const uint8_t *buf, int len);
+/* Parses the body of a message of the transaction of command cmd. Error
+ * responses have no body. Returns 0 on success, -1 if the body is
+ * malformed */
+int sixp_pkt_parse_body(const struct sixp_pkt *pkt, enum sixp_pkt_cmd cmd,
+                        struct sixp_pkt_body *body);
+/* Reads and writes cell i of a cell list */
+void sixp_pkt_get_cell(const uint8_t *cell_list, int i, struct sixp_cell *cell);
+void sixp_pkt_set_cell(uint8_t *cell_list, int i, const struct sixp_cell *cell);
+/* Looks for a cell in a cell list of n cells, returns 1 if found */
+int sixp_pkt_has_cell(const uint8_t *cell_list, int n, const struct sixp_cell *cell);
+
+#endif /* __SIXP_PKT_H__ */
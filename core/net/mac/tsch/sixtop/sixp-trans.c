@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6P transactions
+ */
+
+#include "contiki.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include "net/mac/tsch/sixtop/sixp-trans.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/net-debug.h"
+
+MEMB(trans_memb, struct sixp_trans, SIXP_MAX_TRANSACTIONS);
+LIST(trans_list);
+
+/*---------------------------------------------------------------------------*/
+struct sixp_trans *
+sixp_trans_alloc(struct sixtop_sf *sf, enum sixp_pkt_cmd cmd, uint8_t seqnum,
+                 const linkaddr_t *peer, int is_initiator)
+{
+  struct sixp_trans *t;
+
+  if(sixp_trans_find(peer) != NULL) {
+    return NULL;
+  }
+  t = memb_alloc(&trans_memb);
+  if(t == NULL) {
+    PRINTF("6P: no room for a transaction\n");
+    return NULL;
+  }
+  t->sf = sf;
+  linkaddr_copy(&t->peer_addr, peer);
+  t->cmd = cmd;
+  t->state = is_initiator ? SIXP_TRANS_STATE_REQUEST_SENDING
+                          : SIXP_TRANS_STATE_REQUEST_RECEIVED;
+  t->seqnum = seqnum;
+  t->is_initiator = is_initiator;
+  t->is_3step = 0;
+  t->rc = SIXP_PKT_RC_SUCCESS;
+  list_add(trans_list, t);
+  return t;
+}
+/*---------------------------------------------------------------------------*/
+struct sixp_trans *
+sixp_trans_find(const linkaddr_t *peer)
+{
+  struct sixp_trans *t;
+  for(t = list_head(trans_list); t != NULL; t = list_item_next(t)) {
+    if(linkaddr_cmp(&t->peer_addr, peer)) {
+      return t;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+int
+sixp_trans_is_valid(const struct sixp_trans *t)
+{
+  struct sixp_trans *curr;
+  for(curr = list_head(trans_list); curr != NULL; curr = list_item_next(curr)) {
+    if(curr == t) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+sixp_trans_free(struct sixp_trans *t)
+{
+  ctimer_stop(&t->timer);
+  list_remove(trans_list, t);
+  memb_free(&trans_memb, t);
+}
+/*---------------------------------------------------------------------------*/
+void
+sixp_trans_init(void)
+{
+  struct sixp_trans *t;
+  while((t = list_pop(trans_list)) != NULL) {
+    ctimer_stop(&t->timer);
+    memb_free(&trans_memb, t);
+  }
+  memb_init(&trans_memb);
+  list_init(trans_list);
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6P transactions. A transaction is a request and its response,
+ *         followed by a confirmation in 3-step transactions. We keep at
+ *         most one transaction per neighbor, in either role.
+ */
+
+#ifndef __SIXP_TRANS_H__
+#define __SIXP_TRANS_H__
+
+#include "contiki.h"
+#include "sys/ctimer.h"
+#include "net/linkaddr.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+
+/************ Types ***********/
+
+enum sixp_trans_state {
+  SIXP_TRANS_STATE_REQUEST_SENDING,
+  SIXP_TRANS_STATE_REQUEST_SENT,
+  SIXP_TRANS_STATE_REQUEST_RECEIVED,
+  SIXP_TRANS_STATE_RESPONSE_SENDING,
+  SIXP_TRANS_STATE_RESPONSE_SENT,
+  SIXP_TRANS_STATE_RESPONSE_RECEIVED,
+  SIXP_TRANS_STATE_CONFIRMATION_SENDING,
+};
+
+struct sixp_trans {
+  /* Transactions are stored as a list: "next" must be the first field */
+  struct sixp_trans *next;
+  struct sixtop_sf *sf;
+  linkaddr_t peer_addr;
+  enum sixp_pkt_cmd cmd;
+  enum sixp_trans_state state;
+  uint8_t seqnum;
+  /* Did we send the request? */
+  uint8_t is_initiator;
+  /* A request for cells with an empty CellList: the responder returns
+   * candidate cells, and the initiator confirms the ones it picked */
+  uint8_t is_3step;
+  /* Return code of the response */
+  uint8_t rc;
+  /* Aborts the transaction after sf->timeout_interval, set by sixp.c */
+  struct ctimer timer;
+};
+
+/********** Functions *********/
+
+/* Allocates a transaction with peer.
+ * NULL if a transaction with peer is ongoing, or no room is left */
+struct sixp_trans *sixp_trans_alloc(struct sixtop_sf *sf, enum sixp_pkt_cmd cmd,
+                                    uint8_t seqnum, const linkaddr_t *peer,
+                                    int is_initiator);
+/* Returns the ongoing transaction with peer, NULL if none */
+struct sixp_trans *sixp_trans_find(const linkaddr_t *peer);
+/* Is t an ongoing transaction? */
+int sixp_trans_is_valid(const struct sixp_trans *t);
+/* Ends a transaction */
+void sixp_trans_free(struct sixp_trans *t);
+/* Module initialization */
+void sixp_trans_init(void);
+
+#endif /* __SIXP_TRANS_H__ */
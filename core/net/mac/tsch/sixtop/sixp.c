@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6top Protocol (6P, RFC 8480). Each pair of neighbors shares a
+ *         sequence number (SeqNum). It is 0 after a CLEAR or a reboot, and
+ *         both ends increment it, skipping 0, when a transaction completes
+ *         with SUCCESS or EOL. A request whose SeqNum is not the one we
+ *         expect reveals that the peer's schedule and ours may differ: we
+ *         answer RC_ERR_SEQNUM, and leave it to the peer's scheduling
+ *         function to CLEAR.
+ */
+
+#include "contiki.h"
+#include "net/nbr-table.h"
+#include "net/packetbuf.h"
+#include "net/mac/tsch/tsch-log.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+#include "net/mac/tsch/sixtop/sixp.h"
+#include "net/mac/tsch/sixtop/sixp-trans.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/net-debug.h"
+
+struct sixp_nbr {
+  uint8_t seqnum;
+};
+NBR_TABLE(struct sixp_nbr, sixp_nbrs);
+
+/*---------------------------------------------------------------------------*/
+uint8_t
+sixp_get_seqnum(const linkaddr_t *peer)
+{
+  struct sixp_nbr *nbr = nbr_table_get_from_lladdr(sixp_nbrs, peer);
+  return nbr != NULL ? nbr->seqnum : 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_seqnum(const linkaddr_t *peer, uint8_t seqnum)
+{
+  struct sixp_nbr *nbr = nbr_table_get_from_lladdr(sixp_nbrs, peer);
+  if(nbr == NULL && seqnum != 0) {
+    nbr = nbr_table_add_lladdr(sixp_nbrs, peer, NBR_TABLE_REASON_MAC, NULL);
+  }
+  if(nbr != NULL) {
+    nbr->seqnum = seqnum;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Does a request for cells leave the choice of the cells to the responder? */
+static int
+is_3step(enum sixp_pkt_cmd cmd, const struct sixp_pkt_body *body)
+{
+  return (cmd == SIXP_PKT_CMD_ADD || cmd == SIXP_PKT_CMD_DELETE
+          || cmd == SIXP_PKT_CMD_RELOCATE)
+         && body != NULL && body->num_cells > 0 && body->cell_list_len == 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Ends a transaction that went through */
+static void
+complete(struct sixp_trans *t)
+{
+  PRINTF("6P: transaction %u with %u done, rc %u\n",
+         t->cmd, TSCH_LOG_ID_FROM_LINKADDR(&t->peer_addr), t->rc);
+  if(t->cmd == SIXP_PKT_CMD_CLEAR) {
+    set_seqnum(&t->peer_addr, 0);
+  } else if(t->rc == SIXP_PKT_RC_SUCCESS || t->rc == SIXP_PKT_RC_EOL) {
+    set_seqnum(&t->peer_addr, t->seqnum == 0xff ? 1 : t->seqnum + 1);
+  }
+  sixp_trans_free(t);
+}
+/*---------------------------------------------------------------------------*/
+/* Ends a transaction that failed, and tells its SF */
+static void
+abort_trans(struct sixp_trans *t)
+{
+  struct sixtop_sf *sf = t->sf;
+  enum sixp_pkt_cmd cmd = t->cmd;
+  int is_initiator = t->is_initiator;
+  linkaddr_t peer;
+
+  PRINTF("6P: transaction %u with %u aborted, state %u\n",
+         t->cmd, TSCH_LOG_ID_FROM_LINKADDR(&t->peer_addr), t->state);
+  linkaddr_copy(&peer, &t->peer_addr);
+  sixp_trans_free(t);
+  if(cmd == SIXP_PKT_CMD_CLEAR) {
+    /* The peer may have reset its sequence number already */
+    set_seqnum(&peer, 0);
+  }
+  if(sf->error != NULL) {
+    sf->error(cmd, is_initiator, &peer);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+timeout(void *ptr)
+{
+  abort_trans(ptr);
+}
+/*---------------------------------------------------------------------------*/
+static struct sixp_trans *
+new_trans(struct sixtop_sf *sf, enum sixp_pkt_cmd cmd, uint8_t seqnum,
+          const linkaddr_t *peer, int is_initiator)
+{
+  struct sixp_trans *t = sixp_trans_alloc(sf, cmd, seqnum, peer, is_initiator);
+  if(t != NULL) {
+    ctimer_set(&t->timer, sf->timeout_interval, timeout, t);
+  }
+  return t;
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(void *ptr, int status, int transmissions)
+{
+  struct sixp_trans *t = ptr;
+
+  /* The transaction may have ended, and its memory been reused, before the
+   * MAC was done with the frame */
+  if(!sixp_trans_is_valid(t)
+     || !linkaddr_cmp(&t->peer_addr, packetbuf_addr(PACKETBUF_ADDR_RECEIVER))) {
+    return;
+  }
+
+  switch(t->state) {
+    case SIXP_TRANS_STATE_REQUEST_SENDING:
+      if(status != MAC_TX_OK) {
+        abort_trans(t);
+      } else {
+        t->state = SIXP_TRANS_STATE_REQUEST_SENT;
+      }
+      break;
+    case SIXP_TRANS_STATE_RESPONSE_SENDING:
+      if(status != MAC_TX_OK) {
+        abort_trans(t);
+      } else if(t->is_3step && t->rc == SIXP_PKT_RC_SUCCESS) {
+        t->state = SIXP_TRANS_STATE_RESPONSE_SENT;
+      } else {
+        complete(t);
+      }
+      break;
+    case SIXP_TRANS_STATE_CONFIRMATION_SENDING:
+      if(status != MAC_TX_OK) {
+        abort_trans(t);
+      } else {
+        complete(t);
+      }
+      break;
+    default:
+      /* The response came in before the MAC reported on the request */
+      break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Answers a request without starting a transaction */
+static void
+send_error(uint8_t rc, uint8_t sfid, uint8_t seqnum, const linkaddr_t *peer)
+{
+  uint8_t msg[SIXP_PKT_HDR_LEN];
+  /* Error responses have no body: the command does not matter */
+  int len = sixp_pkt_create(SIXP_PKT_TYPE_RESPONSE, rc, SIXP_PKT_CMD_CLEAR,
+                            sfid, seqnum, NULL, msg, sizeof(msg));
+  PRINTF("6P: error %u to %u\n", rc, TSCH_LOG_ID_FROM_LINKADDR(peer));
+  if(len > 0) {
+    sixtop_output(peer, msg, len, NULL, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+sixp_output(enum sixp_pkt_type type, uint8_t code, uint8_t sfid,
+            const struct sixp_pkt_body *body, const linkaddr_t *peer)
+{
+  static uint8_t msg[SIXP_MAX_MSG_LEN];
+  struct sixtop_sf *sf = sixtop_find_sf(sfid);
+  struct sixp_trans *t = sixp_trans_find(peer);
+  int len;
+
+  if(sf == NULL) {
+    return -1;
+  }
+
+  if(type == SIXP_PKT_TYPE_REQUEST) {
+    if(t != NULL) {
+      PRINTF("6P: transaction with %u ongoing\n", TSCH_LOG_ID_FROM_LINKADDR(peer));
+      return -1;
+    }
+    t = new_trans(sf, code, sixp_get_seqnum(peer), peer, 1);
+    if(t == NULL) {
+      return -1;
+    }
+    t->is_3step = is_3step(code, body);
+  } else if(t == NULL || t->sf != sf
+            || (type == SIXP_PKT_TYPE_RESPONSE
+                && t->state != SIXP_TRANS_STATE_REQUEST_RECEIVED)
+            || (type == SIXP_PKT_TYPE_CONFIRMATION
+                && t->state != SIXP_TRANS_STATE_RESPONSE_RECEIVED)) {
+    PRINTF("6P: no transaction for message type %u\n", type);
+    return -1;
+  }
+
+  len = sixp_pkt_create(type, code, t->cmd, sfid, t->seqnum, body, msg, sizeof(msg));
+  if(len < 0) {
+    PRINTF("6P: failed to create message\n");
+    if(type == SIXP_PKT_TYPE_REQUEST) {
+      sixp_trans_free(t);
+    }
+    return -1;
+  }
+
+  if(type == SIXP_PKT_TYPE_REQUEST) {
+    t->state = SIXP_TRANS_STATE_REQUEST_SENDING;
+  } else if(type == SIXP_PKT_TYPE_RESPONSE) {
+    t->rc = code;
+    t->state = SIXP_TRANS_STATE_RESPONSE_SENDING;
+  } else {
+    t->rc = code;
+    t->state = SIXP_TRANS_STATE_CONFIRMATION_SENDING;
+  }
+
+  /* Note: the MAC may call packet_sent, and end the transaction, right away */
+  if(sixtop_output(peer, msg, len, packet_sent, t) < 0) {
+    sixp_trans_free(t);
+    return -1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+sixp_input(const uint8_t *buf, int len, const linkaddr_t *src)
+{
+  struct sixp_pkt pkt;
+  struct sixp_pkt_body body;
+  struct sixtop_sf *sf;
+  struct sixp_trans *t;
+  enum sixp_pkt_cmd cmd;
+
+  if(sixp_pkt_parse(buf, len, &pkt) < 0 || pkt.type > SIXP_PKT_TYPE_CONFIRMATION) {
+    return;
+  }
+
+  PRINTF("6P: input type %u code %u sfid %u seqnum %u from %u\n",
+         pkt.type, pkt.code, pkt.sfid, pkt.seqnum, TSCH_LOG_ID_FROM_LINKADDR(src));
+
+  if(sixp_pkt_get_version(buf, len) != SIXP_PKT_VERSION) {
+    if(pkt.type == SIXP_PKT_TYPE_REQUEST) {
+      send_error(SIXP_PKT_RC_ERR_VERSION, pkt.sfid, pkt.seqnum, src);
+    }
+    return;
+  }
+
+  sf = sixtop_find_sf(pkt.sfid);
+  if(sf == NULL) {
+    if(pkt.type == SIXP_PKT_TYPE_REQUEST) {
+      send_error(SIXP_PKT_RC_ERR_SFID, pkt.sfid, pkt.seqnum, src);
+    }
+    return;
+  }
+
+  t = sixp_trans_find(src);
+
+  if(pkt.type == SIXP_PKT_TYPE_REQUEST) {
+    cmd = pkt.code;
+    if(t != NULL) {
+      send_error(SIXP_PKT_RC_ERR_BUSY, pkt.sfid, pkt.seqnum, src);
+    } else if(cmd != SIXP_PKT_CMD_CLEAR && pkt.seqnum != sixp_get_seqnum(src)) {
+      send_error(SIXP_PKT_RC_ERR_SEQNUM, pkt.sfid, pkt.seqnum, src);
+    } else if(sixp_pkt_parse_body(&pkt, cmd, &body) < 0) {
+      send_error(SIXP_PKT_RC_ERR, pkt.sfid, pkt.seqnum, src);
+    } else if((t = new_trans(sf, cmd, pkt.seqnum, src, 0)) == NULL) {
+      send_error(SIXP_PKT_RC_ERR_BUSY, pkt.sfid, pkt.seqnum, src);
+    } else {
+      t->is_3step = is_3step(cmd, &body);
+      /* The SF answers with sixp_output */
+      sf->input(&pkt, cmd, &body, src);
+    }
+    return;
+  }
+
+  if(t == NULL || t->sf != sf || t->seqnum != pkt.seqnum) {
+    PRINTF("6P: no transaction for message from %u\n", TSCH_LOG_ID_FROM_LINKADDR(src));
+    return;
+  }
+  cmd = t->cmd;
+  if(sixp_pkt_parse_body(&pkt, cmd, &body) < 0) {
+    PRINTF("6P: malformed message from %u\n", TSCH_LOG_ID_FROM_LINKADDR(src));
+    return;
+  }
+
+  if(pkt.type == SIXP_PKT_TYPE_RESPONSE) {
+    if(!t->is_initiator || (t->state != SIXP_TRANS_STATE_REQUEST_SENDING
+                            && t->state != SIXP_TRANS_STATE_REQUEST_SENT)) {
+      return;
+    }
+    t->rc = pkt.code;
+    if(t->is_3step && t->rc == SIXP_PKT_RC_SUCCESS) {
+      /* The SF confirms with sixp_output */
+      t->state = SIXP_TRANS_STATE_RESPONSE_RECEIVED;
+    } else {
+      /* Complete first, so that the SF may start another transaction */
+      complete(t);
+    }
+  } else {
+    if(t->is_initiator || (t->state != SIXP_TRANS_STATE_RESPONSE_SENDING
+                           && t->state != SIXP_TRANS_STATE_RESPONSE_SENT)) {
+      return;
+    }
+    t->rc = pkt.code;
+    complete(t);
+  }
+  sf->input(&pkt, cmd, &body, src);
+}
+/*---------------------------------------------------------------------------*/
+void
+sixp_init(void)
+{
+  nbr_table_register(sixp_nbrs, NULL);
+  sixp_trans_init();
+}
+/*---------------------------------------------------------------------------*/
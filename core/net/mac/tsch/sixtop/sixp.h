@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6top Protocol (6P, RFC 8480): transactions between neighbors on
+ *         behalf of scheduling functions, and sequence numbers.
+ */
+
+#ifndef __SIXP_H__
+#define __SIXP_H__
+
+#include "contiki.h"
+#include "net/linkaddr.h"
+#include "net/mac/tsch/sixtop/sixp-pkt.h"
+
+/********** Functions *********/
+
+/* Sends a 6P message of scheduling function sfid to peer. A request starts
+ * a transaction, and is refused while another transaction with peer is
+ * ongoing. Responses and confirmations continue the ongoing transaction.
+ * Returns 0 if the message was handed to the MAC, -1 otherwise. The SF is
+ * told about a transaction that fails later through its error callback */
+int sixp_output(enum sixp_pkt_type type, uint8_t code, uint8_t sfid,
+                const struct sixp_pkt_body *body, const linkaddr_t *peer);
+/* Processes a 6P message received from src */
+void sixp_input(const uint8_t *buf, int len, const linkaddr_t *src);
+/* Returns the sequence number of the next transaction with peer */
+uint8_t sixp_get_seqnum(const linkaddr_t *peer);
+/* Module initialization */
+void sixp_init(void);
+
+#endif /* __SIXP_H__ */
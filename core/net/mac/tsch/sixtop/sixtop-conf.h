@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6top sublayer configuration
+ */
+
+#ifndef __SIXTOP_CONF_H__
+#define __SIXTOP_CONF_H__
+
+/* The maximum number of scheduling functions registered at once */
+#ifdef SIXTOP_CONF_MAX_SCHEDULING_FUNCTIONS
+#define SIXTOP_MAX_SCHEDULING_FUNCTIONS SIXTOP_CONF_MAX_SCHEDULING_FUNCTIONS
+#else
+#define SIXTOP_MAX_SCHEDULING_FUNCTIONS 1
+#endif
+
+/* The maximum number of concurrent 6P transactions. 6P allows at most one
+ * transaction with a given neighbor at a time */
+#ifdef SIXP_CONF_MAX_TRANSACTIONS
+#define SIXP_MAX_TRANSACTIONS SIXP_CONF_MAX_TRANSACTIONS
+#else
+#define SIXP_MAX_TRANSACTIONS 2
+#endif
+
+/* The maximum length of a 6P message, header included */
+#ifdef SIXP_CONF_MAX_MSG_LEN
+#define SIXP_MAX_MSG_LEN SIXP_CONF_MAX_MSG_LEN
+#else
+#define SIXP_MAX_MSG_LEN 64
+#endif
+
+/* MSF-like scheduling function (sixtop-msf.c) */
+
+/* Its Scheduling Function Identifier */
+#ifdef SIXTOP_MSF_CONF_SFID
+#define SIXTOP_MSF_SFID SIXTOP_MSF_CONF_SFID
+#else
+#define SIXTOP_MSF_SFID 0
+#endif
+
+/* The handle and length of the slotframe of the negotiated cells */
+#ifdef SIXTOP_MSF_CONF_SLOTFRAME_HANDLE
+#define SIXTOP_MSF_SLOTFRAME_HANDLE SIXTOP_MSF_CONF_SLOTFRAME_HANDLE
+#else
+#define SIXTOP_MSF_SLOTFRAME_HANDLE 1
+#endif
+#ifdef SIXTOP_MSF_CONF_SLOTFRAME_LENGTH
+#define SIXTOP_MSF_SLOTFRAME_LENGTH SIXTOP_MSF_CONF_SLOTFRAME_LENGTH
+#else
+#define SIXTOP_MSF_SLOTFRAME_LENGTH 31
+#endif
+
+/* Channel offsets of new cells are picked in [0, SIXTOP_MSF_NUM_CHANNEL_OFFSETS - 1] */
+#ifdef SIXTOP_MSF_CONF_NUM_CHANNEL_OFFSETS
+#define SIXTOP_MSF_NUM_CHANNEL_OFFSETS SIXTOP_MSF_CONF_NUM_CHANNEL_OFFSETS
+#else
+#define SIXTOP_MSF_NUM_CHANNEL_OFFSETS 16
+#endif
+
+/* The maximum number of cells towards the time source */
+#ifdef SIXTOP_MSF_CONF_MAX_CELLS
+#define SIXTOP_MSF_MAX_CELLS SIXTOP_MSF_CONF_MAX_CELLS
+#else
+#define SIXTOP_MSF_MAX_CELLS 8
+#endif
+
+/* The number of candidate cells offered in an ADD request for one cell */
+#ifdef SIXTOP_MSF_CONF_NUM_CANDIDATES
+#define SIXTOP_MSF_NUM_CANDIDATES SIXTOP_MSF_CONF_NUM_CANDIDATES
+#else
+#define SIXTOP_MSF_NUM_CANDIDATES 5
+#endif
+
+/* The cell usage is estimated over windows of this many cells elapsed */
+#ifdef SIXTOP_MSF_CONF_MAX_NUM_CELLS
+#define SIXTOP_MSF_MAX_NUM_CELLS SIXTOP_MSF_CONF_MAX_NUM_CELLS
+#else
+#define SIXTOP_MSF_MAX_NUM_CELLS 16
+#endif
+
+/* Above this usage (percent), add a cell. Below the low limit, delete one */
+#ifdef SIXTOP_MSF_CONF_LIM_NUMCELLSUSED_HIGH
+#define SIXTOP_MSF_LIM_NUMCELLSUSED_HIGH SIXTOP_MSF_CONF_LIM_NUMCELLSUSED_HIGH
+#else
+#define SIXTOP_MSF_LIM_NUMCELLSUSED_HIGH 75
+#endif
+#ifdef SIXTOP_MSF_CONF_LIM_NUMCELLSUSED_LOW
+#define SIXTOP_MSF_LIM_NUMCELLSUSED_LOW SIXTOP_MSF_CONF_LIM_NUMCELLSUSED_LOW
+#else
+#define SIXTOP_MSF_LIM_NUMCELLSUSED_LOW 25
+#endif
+
+/* How often the usage and the time source are checked */
+#ifdef SIXTOP_MSF_CONF_HOUSEKEEPING_PERIOD
+#define SIXTOP_MSF_HOUSEKEEPING_PERIOD SIXTOP_MSF_CONF_HOUSEKEEPING_PERIOD
+#else
+#define SIXTOP_MSF_HOUSEKEEPING_PERIOD CLOCK_SECOND
+#endif
+
+/* The timeout of its transactions */
+#ifdef SIXTOP_MSF_CONF_TIMEOUT
+#define SIXTOP_MSF_TIMEOUT SIXTOP_MSF_CONF_TIMEOUT
+#else
+#define SIXTOP_MSF_TIMEOUT (10 * CLOCK_SECOND)
+#endif
+
+#endif /* __SIXTOP_CONF_H__ */
@@ -0,0 +1,519 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         An MSF-like scheduling function (after RFC 9033). Every node
+ *         negotiates dedicated TX cells towards its time source (the RPL
+ *         preferred parent with TSCH_CONF_AUTOSELECT_TIME_SOURCE or
+ *         tsch-rpl), in a slotframe of its own. It counts the transmissions
+ *         to the time source and, every SIXTOP_MSF_MAX_NUM_CELLS cells
+ *         elapsed, adds a cell when they used more than
+ *         SIXTOP_MSF_LIM_NUMCELLSUSED_HIGH percent of the cells, and
+ *         deletes one when they used less than the low limit. Until it has
+ *         a cell, the shared cells count as one cell per slotframe.
+ *
+ *         Requests are 2-step: an ADD offers SIXTOP_MSF_NUM_CANDIDATES
+ *         random cells free at the sender, the time source keeps those
+ *         free at its end. A time source that could not deliver its
+ *         response clears the cells with the sender, and so does a sender
+ *         whose requests are answered RC_ERR_SEQNUM. Unlike MSF, there is
+ *         no autonomous cell, and cells are not relocated on collisions;
+ *         RELOCATE requests are served though.
+ */
+
+#include <string.h>
+#include "contiki.h"
+#include "lib/random.h"
+#include "sys/ctimer.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include "net/mac/tsch/tsch-schedule.h"
+#include "net/mac/tsch/tsch-log.h"
+#include "net/mac/tsch/sixtop/sixp.h"
+#include "net/mac/tsch/sixtop/sixp-trans.h"
+#include "net/mac/tsch/sixtop/sixtop-msf.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/net-debug.h"
+
+/* 6P CellOptions and TSCH link options share their TX, RX and SHARED bits */
+#define CELL_OPTIONS (LINK_OPTION_TX | LINK_OPTION_RX | LINK_OPTION_SHARED)
+
+/* The longest cell list we send */
+#define MAX_CELL_LIST MAX(SIXTOP_MSF_MAX_CELLS, SIXTOP_MSF_NUM_CANDIDATES)
+
+static struct ctimer housekeeping_timer;
+/* The time source, with which we negotiate our cells */
+static linkaddr_t parent_addr;
+static uint8_t has_parent;
+/* The cells of our last ADD or DELETE request */
+static uint8_t requested[MAX_CELL_LIST * SIXP_PKT_CELL_LEN];
+static uint8_t num_requested;
+/* Transmissions to the time source since window_start */
+static struct tsch_asn_t window_start;
+static uint16_t num_cells_used;
+
+/*---------------------------------------------------------------------------*/
+static struct tsch_slotframe *
+get_slotframe(void)
+{
+  struct tsch_slotframe *sf;
+  sf = tsch_schedule_get_slotframe_by_handle(SIXTOP_MSF_SLOTFRAME_HANDLE);
+  if(sf == NULL) {
+    /* The schedule is reset when joining a network */
+    sf = tsch_schedule_add_slotframe(SIXTOP_MSF_SLOTFRAME_HANDLE,
+                                     SIXTOP_MSF_SLOTFRAME_LENGTH);
+  }
+  return sf;
+}
+/*---------------------------------------------------------------------------*/
+/* The link options at our end of a cell the peer asks for */
+static uint8_t
+reverse_options(uint8_t cell_options)
+{
+  return ((cell_options & LINK_OPTION_TX) ? LINK_OPTION_RX : 0)
+         | ((cell_options & LINK_OPTION_RX) ? LINK_OPTION_TX : 0)
+         | (cell_options & LINK_OPTION_SHARED);
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_free(struct tsch_slotframe *sf, const struct sixp_cell *cell)
+{
+  return cell->timeslot < SIXTOP_MSF_SLOTFRAME_LENGTH
+         && tsch_schedule_get_link_by_timeslot(sf, cell->timeslot) == NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_link *
+find_link(struct tsch_slotframe *sf, const linkaddr_t *peer,
+          uint8_t link_options, const struct sixp_cell *cell)
+{
+  struct tsch_link *l = tsch_schedule_get_link_by_timeslot(sf, cell->timeslot);
+  if(l != NULL && l->channel_offset == cell->channel_offset
+     && linkaddr_cmp(&l->addr, peer)
+     && (l->link_options & CELL_OPTIONS) == link_options) {
+    return l;
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+add_link(struct tsch_slotframe *sf, const linkaddr_t *peer,
+         uint8_t link_options, const struct sixp_cell *cell)
+{
+  PRINTF("MSF: add link %u,%u options %x with %u\n", cell->timeslot,
+         cell->channel_offset, link_options, TSCH_LOG_ID_FROM_LINKADDR(peer));
+  return tsch_schedule_add_link(sf, link_options, LINK_TYPE_NORMAL, peer,
+                                cell->timeslot, cell->channel_offset) != NULL;
+}
+/*---------------------------------------------------------------------------*/
+int
+sixtop_msf_num_cells(const linkaddr_t *peer, uint8_t link_options)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  int n = 0;
+
+  sf = tsch_schedule_get_slotframe_by_handle(SIXTOP_MSF_SLOTFRAME_HANDLE);
+  if(sf != NULL) {
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      if(linkaddr_cmp(&l->addr, peer)
+         && (l->link_options & CELL_OPTIONS) == link_options) {
+        n++;
+      }
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Writes up to max of our cells with peer to list, skipping the first
+ * offset ones. Sets *eol if there are no more */
+static int
+list_cells(struct tsch_slotframe *sf, const linkaddr_t *peer,
+           uint8_t link_options, int offset, int max, uint8_t *list, int *eol)
+{
+  struct tsch_link *l;
+  struct sixp_cell cell;
+  int n = 0;
+
+  *eol = 1;
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    if(linkaddr_cmp(&l->addr, peer)
+       && (l->link_options & CELL_OPTIONS) == link_options) {
+      if(offset > 0) {
+        offset--;
+      } else if(n < max) {
+        cell.timeslot = l->timeslot;
+        cell.channel_offset = l->channel_offset;
+        sixp_pkt_set_cell(list, n++, &cell);
+      } else {
+        *eol = 0;
+        break;
+      }
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_cells(const linkaddr_t *peer)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  struct tsch_link *next;
+
+  sf = tsch_schedule_get_slotframe_by_handle(SIXTOP_MSF_SLOTFRAME_HANDLE);
+  if(sf != NULL) {
+    for(l = list_head(sf->links_list); l != NULL; l = next) {
+      next = list_item_next(l);
+      if(linkaddr_cmp(&l->addr, peer)) {
+        tsch_schedule_remove_link(sf, l);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Writes up to max random cells, free at our end, to list */
+static int
+pick_free_cells(struct tsch_slotframe *sf, uint8_t *list, int max)
+{
+  struct sixp_cell cell;
+  struct sixp_cell other;
+  int tries;
+  int n = 0;
+  int i;
+
+  for(tries = 0; n < max && tries < 4 * max; tries++) {
+    /* Timeslot 0 is left to the minimal schedule */
+    cell.timeslot = 1 + random_rand() % (SIXTOP_MSF_SLOTFRAME_LENGTH - 1);
+    cell.channel_offset = random_rand() % SIXTOP_MSF_NUM_CHANNEL_OFFSETS;
+    if(!is_free(sf, &cell)) {
+      continue;
+    }
+    for(i = 0; i < n; i++) {
+      sixp_pkt_get_cell(list, i, &other);
+      if(other.timeslot == cell.timeslot) {
+        break;
+      }
+    }
+    if(i == n) {
+      sixp_pkt_set_cell(list, n++, &cell);
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Removes all cells with peer, and asks peer to do the same */
+static void
+clear(const linkaddr_t *peer)
+{
+  struct sixp_pkt_body body;
+
+  PRINTF("MSF: clear cells with %u\n", TSCH_LOG_ID_FROM_LINKADDR(peer));
+  remove_cells(peer);
+  memset(&body, 0, sizeof(body));
+  sixp_output(SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_CLEAR, SIXTOP_MSF_SFID,
+              &body, peer);
+}
+/*---------------------------------------------------------------------------*/
+/* Asks peer for one more TX cell, or one less */
+static void
+request_cells(enum sixp_pkt_cmd cmd, const linkaddr_t *peer)
+{
+  struct tsch_slotframe *sf = get_slotframe();
+  struct sixp_pkt_body body;
+  int eol;
+
+  if(sf == NULL) {
+    return;
+  }
+  if(cmd == SIXP_PKT_CMD_ADD) {
+    num_requested = pick_free_cells(sf, requested, SIXTOP_MSF_NUM_CANDIDATES);
+  } else {
+    num_requested = list_cells(sf, peer, LINK_OPTION_TX, 0, 1, requested, &eol);
+  }
+  if(num_requested == 0) {
+    return;
+  }
+
+  memset(&body, 0, sizeof(body));
+  body.cell_options = SIXP_PKT_CELL_OPTION_TX;
+  body.num_cells = 1;
+  body.cell_list = requested;
+  body.cell_list_len = num_requested;
+  sixp_output(SIXP_PKT_TYPE_REQUEST, cmd, SIXTOP_MSF_SFID, &body, peer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+reset_window(void)
+{
+  window_start = tsch_current_asn;
+  num_cells_used = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+housekeeping(void *ptr)
+{
+  struct tsch_neighbor *ts = tsch_queue_get_time_source();
+  unsigned long elapsed;
+  unsigned long usage;
+  int num_tx;
+
+  ctimer_reset(&housekeeping_timer);
+
+  if(has_parent && (ts == NULL || !linkaddr_cmp(&ts->addr, &parent_addr))) {
+    /* Release the cells with the former time source */
+    clear(&parent_addr);
+    has_parent = 0;
+  }
+  if(!has_parent) {
+    if(ts != NULL) {
+      linkaddr_copy(&parent_addr, &ts->addr);
+      has_parent = 1;
+      reset_window();
+    }
+    return;
+  }
+
+  /* One transaction at a time */
+  if(sixp_trans_find(&parent_addr) != NULL) {
+    return;
+  }
+
+  num_tx = sixtop_msf_num_cells(&parent_addr, LINK_OPTION_TX);
+  elapsed = TSCH_ASN_DIFF(tsch_current_asn, window_start)
+            / SIXTOP_MSF_SLOTFRAME_LENGTH * MAX(num_tx, 1);
+  if(elapsed < SIXTOP_MSF_MAX_NUM_CELLS) {
+    return;
+  }
+
+  usage = 100UL * num_cells_used / elapsed;
+  PRINTF("MSF: %u cells, usage %lu%%\n", num_tx, usage);
+  if(usage > SIXTOP_MSF_LIM_NUMCELLSUSED_HIGH && num_tx < SIXTOP_MSF_MAX_CELLS) {
+    request_cells(SIXP_PKT_CMD_ADD, &parent_addr);
+  } else if(usage < SIXTOP_MSF_LIM_NUMCELLSUSED_LOW && num_tx > 0) {
+    request_cells(SIXP_PKT_CMD_DELETE, &parent_addr);
+  }
+  reset_window();
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_request(enum sixp_pkt_cmd cmd, const struct sixp_pkt_body *body,
+               const linkaddr_t *peer)
+{
+  static uint8_t list[MAX_CELL_LIST * SIXP_PKT_CELL_LEN];
+  struct tsch_slotframe *sf = get_slotframe();
+  struct sixp_pkt_body res;
+  struct sixp_cell cell;
+  struct sixp_cell rel_cell;
+  struct tsch_link *l;
+  uint8_t link_options = reverse_options(body->cell_options);
+  uint8_t rc = SIXP_PKT_RC_SUCCESS;
+  int max = MIN(body->num_cells, MAX_CELL_LIST);
+  int eol;
+  int n = 0;
+  int i;
+
+  memset(&res, 0, sizeof(res));
+
+  if(sf == NULL) {
+    rc = SIXP_PKT_RC_ERR;
+  } else if((cmd == SIXP_PKT_CMD_ADD || cmd == SIXP_PKT_CMD_DELETE
+             || cmd == SIXP_PKT_CMD_RELOCATE) && body->cell_list_len == 0) {
+    /* We only do 2-step transactions */
+    rc = SIXP_PKT_RC_ERR;
+  } else {
+    switch(cmd) {
+      case SIXP_PKT_CMD_ADD:
+        /* Keep the candidates that are free at our end */
+        for(i = 0; i < body->cell_list_len && n < max; i++) {
+          sixp_pkt_get_cell(body->cell_list, i, &cell);
+          if(is_free(sf, &cell) && add_link(sf, peer, link_options, &cell)) {
+            sixp_pkt_set_cell(list, n++, &cell);
+          }
+        }
+        break;
+      case SIXP_PKT_CMD_DELETE:
+        for(i = 0; i < body->cell_list_len && n < max; i++) {
+          sixp_pkt_get_cell(body->cell_list, i, &cell);
+          if((l = find_link(sf, peer, link_options, &cell)) != NULL) {
+            tsch_schedule_remove_link(sf, l);
+            sixp_pkt_set_cell(list, n++, &cell);
+          }
+        }
+        if(n == 0) {
+          rc = SIXP_PKT_RC_ERR_CELLLIST;
+        }
+        break;
+      case SIXP_PKT_CMD_RELOCATE:
+        /* Every cell to relocate must be one of ours */
+        for(i = 0; i < body->rel_cell_list_len; i++) {
+          sixp_pkt_get_cell(body->rel_cell_list, i, &rel_cell);
+          if(find_link(sf, peer, link_options, &rel_cell) == NULL) {
+            rc = SIXP_PKT_RC_ERR_CELLLIST;
+          }
+        }
+        if(rc != SIXP_PKT_RC_SUCCESS) {
+          break;
+        }
+        for(i = 0; i < body->cell_list_len && n < max; i++) {
+          sixp_pkt_get_cell(body->cell_list, i, &cell);
+          if(is_free(sf, &cell) && !sixp_pkt_has_cell(list, n, &cell)) {
+            sixp_pkt_set_cell(list, n++, &cell);
+          }
+        }
+        /* The first n cells move to the candidates we picked */
+        for(i = 0; i < n; i++) {
+          sixp_pkt_get_cell(body->rel_cell_list, i, &rel_cell);
+          sixp_pkt_get_cell(list, i, &cell);
+          tsch_schedule_remove_link(sf, find_link(sf, peer, link_options, &rel_cell));
+          add_link(sf, peer, link_options, &cell);
+        }
+        break;
+      case SIXP_PKT_CMD_COUNT:
+        res.num_cells = sixtop_msf_num_cells(peer, link_options);
+        break;
+      case SIXP_PKT_CMD_LIST:
+        n = list_cells(sf, peer, link_options, body->offset,
+                       MIN(body->max_num_cells, MAX_CELL_LIST), list, &eol);
+        if(eol) {
+          rc = SIXP_PKT_RC_EOL;
+        }
+        break;
+      case SIXP_PKT_CMD_SIGNAL:
+        break;
+      case SIXP_PKT_CMD_CLEAR:
+        remove_cells(peer);
+        break;
+      default:
+        rc = SIXP_PKT_RC_ERR;
+        break;
+    }
+  }
+
+  res.cell_list = list;
+  res.cell_list_len = n;
+  sixp_output(SIXP_PKT_TYPE_RESPONSE, rc, SIXTOP_MSF_SFID, &res, peer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_response(uint8_t rc, enum sixp_pkt_cmd cmd,
+                const struct sixp_pkt_body *body, const linkaddr_t *peer)
+{
+  struct tsch_slotframe *sf = get_slotframe();
+  struct sixp_cell cell;
+  struct tsch_link *l;
+  int i;
+
+  if(sf == NULL) {
+    return;
+  }
+
+  if(rc == SIXP_PKT_RC_ERR_SEQNUM) {
+    /* The peer lost track of our cells, or we did */
+    clear(peer);
+    return;
+  }
+
+  if(cmd == SIXP_PKT_CMD_ADD && rc == SIXP_PKT_RC_SUCCESS) {
+    for(i = 0; i < body->cell_list_len; i++) {
+      sixp_pkt_get_cell(body->cell_list, i, &cell);
+      if(sixp_pkt_has_cell(requested, num_requested, &cell) && is_free(sf, &cell)) {
+        add_link(sf, peer, LINK_OPTION_TX, &cell);
+      }
+    }
+  } else if(cmd == SIXP_PKT_CMD_DELETE && rc == SIXP_PKT_RC_SUCCESS) {
+    for(i = 0; i < body->cell_list_len; i++) {
+      sixp_pkt_get_cell(body->cell_list, i, &cell);
+      if((l = find_link(sf, peer, LINK_OPTION_TX, &cell)) != NULL) {
+        tsch_schedule_remove_link(sf, l);
+      }
+    }
+  } else if(cmd == SIXP_PKT_CMD_DELETE && rc == SIXP_PKT_RC_ERR_CELLLIST) {
+    /* The peer does not have these cells: neither should we */
+    for(i = 0; i < num_requested; i++) {
+      sixp_pkt_get_cell(requested, i, &cell);
+      if((l = find_link(sf, peer, LINK_OPTION_TX, &cell)) != NULL) {
+        tsch_schedule_remove_link(sf, l);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+input(const struct sixp_pkt *pkt, enum sixp_pkt_cmd cmd,
+      const struct sixp_pkt_body *body, const linkaddr_t *peer)
+{
+  if(pkt->type == SIXP_PKT_TYPE_REQUEST) {
+    handle_request(cmd, body, peer);
+  } else if(pkt->type == SIXP_PKT_TYPE_RESPONSE) {
+    handle_response(pkt->code, cmd, body, peer);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+error(enum sixp_pkt_cmd cmd, int is_initiator, const linkaddr_t *peer)
+{
+  /* The peer may not have got our response, and not know of the cells we
+   * added or deleted: start over. Failed requests are simply retried */
+  if(!is_initiator && (cmd == SIXP_PKT_CMD_ADD || cmd == SIXP_PKT_CMD_DELETE
+                       || cmd == SIXP_PKT_CMD_RELOCATE)) {
+    clear(peer);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(const linkaddr_t *dest, int status, int transmissions)
+{
+  if(has_parent && dest != NULL && linkaddr_cmp(dest, &parent_addr)) {
+    num_cells_used += transmissions;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  has_parent = 0;
+  num_requested = 0;
+  ctimer_set(&housekeeping_timer, SIXTOP_MSF_HOUSEKEEPING_PERIOD,
+             housekeeping, NULL);
+}
+/*---------------------------------------------------------------------------*/
+struct sixtop_sf sixtop_msf = {
+  SIXTOP_MSF_SFID,
+  SIXTOP_MSF_TIMEOUT,
+  init,
+  input,
+  error,
+  packet_sent,
+};
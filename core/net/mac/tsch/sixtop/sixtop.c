@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6top sublayer. A 6P message is sent alone in a data frame:
+ *         Header IE list termination 1, then an IETF payload IE holding the
+ *         6top sub-IE, whose content is the message.
+ */
+
+#include <string.h>
+#include "contiki.h"
+#include "net/packetbuf.h"
+#include "net/netstack.h"
+#include "net/mac/frame802154e-ie.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+#include "net/mac/tsch/sixtop/sixp.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/net-debug.h"
+
+static struct sixtop_sf *sfs[SIXTOP_MAX_SCHEDULING_FUNCTIONS];
+
+/*---------------------------------------------------------------------------*/
+int
+sixtop_add_sf(struct sixtop_sf *sf)
+{
+  int i;
+  if(sf == NULL || sf->input == NULL || sixtop_find_sf(sf->sfid) != NULL) {
+    return -1;
+  }
+  for(i = 0; i < SIXTOP_MAX_SCHEDULING_FUNCTIONS; i++) {
+    if(sfs[i] == NULL) {
+      sfs[i] = sf;
+      if(sf->init != NULL) {
+        sf->init();
+      }
+      PRINTF("6top: added SF %u\n", sf->sfid);
+      return 0;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+struct sixtop_sf *
+sixtop_find_sf(uint8_t sfid)
+{
+  int i;
+  for(i = 0; i < SIXTOP_MAX_SCHEDULING_FUNCTIONS; i++) {
+    if(sfs[i] != NULL && sfs[i]->sfid == sfid) {
+      return sfs[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+int
+sixtop_output(const linkaddr_t *dest, const uint8_t *msg, int len,
+              mac_callback_t callback, void *ptr)
+{
+  struct ieee802154_ies ies;
+  uint8_t *buf;
+  int hdr_len;
+  int ret;
+
+  packetbuf_clear();
+  buf = packetbuf_dataptr();
+  memset(&ies, 0, sizeof(ies));
+  ies.ie_sixtop_content_len = len;
+
+  if((hdr_len = frame80215e_create_ie_header_list_termination_1(buf,
+                  PACKETBUF_SIZE, &ies)) < 0
+     || (ret = frame80215e_create_ie_ietf_sixtop(buf + hdr_len,
+                  PACKETBUF_SIZE - hdr_len, &ies)) < 0
+     || hdr_len + ret + len > PACKETBUF_SIZE) {
+    PRINTF("6top: message too long %d\n", len);
+    return -1;
+  }
+  hdr_len += ret;
+  memcpy(buf + hdr_len, msg, len);
+  packetbuf_set_datalen(hdr_len + len);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_METADATA, 1);
+
+  NETSTACK_LLSEC.send(callback, ptr);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+sixtop_input(void)
+{
+  struct ieee802154_ies ies;
+  uint8_t msg[SIXP_MAX_MSG_LEN];
+  linkaddr_t src;
+  int len;
+
+  memset(&ies, 0, sizeof(ies));
+  if(!packetbuf_attr(PACKETBUF_ATTR_MAC_METADATA)
+     || frame802154e_parse_information_elements(packetbuf_dataptr(),
+                                                packetbuf_datalen(), &ies) < 0
+     || ies.ie_sixtop_content == NULL) {
+    return 0;
+  }
+
+  /* Answering the message overwrites packetbuf: copy it first */
+  len = ies.ie_sixtop_content_len;
+  if(len > (int)sizeof(msg)) {
+    PRINTF("6top: dropping message of len %d\n", len);
+    return 1;
+  }
+  memcpy(msg, ies.ie_sixtop_content, len);
+  linkaddr_copy(&src, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+
+  sixp_input(msg, len, &src);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+sixtop_packet_sent(const linkaddr_t *dest, int status, int transmissions)
+{
+  int i;
+  for(i = 0; i < SIXTOP_MAX_SCHEDULING_FUNCTIONS; i++) {
+    if(sfs[i] != NULL && sfs[i]->packet_sent != NULL) {
+      sfs[i]->packet_sent(dest, status, transmissions);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+sixtop_init(void)
+{
+  sixp_init();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         6top sublayer (6TiSCH Operation Sublayer, RFC 8480). 6P messages
+ *         travel in the IETF payload IE of 802.15.4e data frames, and are
+ *         handed to the scheduling function (SF) they are addressed to.
+ *         Enable with TSCH_CONF_WITH_SIXTOP, then register an SF with
+ *         sixtop_add_sf, e.g. sixtop_msf.
+ */
+
+#ifndef __SIXTOP_H__
+#define __SIXTOP_H__
+
+#include "contiki.h"
+#include "net/linkaddr.h"
+#include "net/mac/mac.h"
+#include "net/mac/tsch/sixtop/sixtop-conf.h"
+#include "net/mac/tsch/sixtop/sixp-pkt.h"
+
+/************ Types ***********/
+
+/* A scheduling function */
+struct sixtop_sf {
+  /* Scheduling Function Identifier */
+  uint8_t sfid;
+  /* Time after which an unfinished transaction is aborted */
+  clock_time_t timeout_interval;
+  /* Called when the SF is registered */
+  void (*init)(void);
+  /* Called for every request, response and confirmation of the SF, with
+   * the command of its transaction. The SF answers requests with
+   * sixp_output. Mandatory */
+  void (*input)(const struct sixp_pkt *pkt, enum sixp_pkt_cmd cmd,
+                const struct sixp_pkt_body *body, const linkaddr_t *peer);
+  /* Called when a transaction of the SF with peer is aborted: it timed out,
+   * or one of its messages was not acknowledged. Optional */
+  void (*error)(enum sixp_pkt_cmd cmd, int is_initiator, const linkaddr_t *peer);
+  /* Called for every packet leaving the TSCH queue, see
+   * sixtop_packet_sent. Optional */
+  void (*packet_sent)(const linkaddr_t *dest, int status, int transmissions);
+};
+
+/********** Functions *********/
+
+/* Registers a scheduling function. Returns 0 on success, -1 if the SFID is
+ * taken or no room is left */
+int sixtop_add_sf(struct sixtop_sf *sf);
+/* Returns the scheduling function of an SFID, NULL if none */
+struct sixtop_sf *sixtop_find_sf(uint8_t sfid);
+/* Sends the 6P message msg to dest in a data frame of its own. The MAC
+ * calls callback once the frame is sent or dropped */
+int sixtop_output(const linkaddr_t *dest, const uint8_t *msg, int len,
+                  mac_callback_t callback, void *ptr);
+/* Called by TSCH for every data frame received with Information Elements.
+ * Returns 1 if the frame held a 6P message, which was processed, 0 if the
+ * frame is to be passed to the upper layers */
+int sixtop_input(void);
+/* Passes the outcome of every packet sent to the SFs. Called by TSCH
+ * alongside TSCH_CALLBACK_PACKET_SENT, which is left to e.g. Orchestra */
+void sixtop_packet_sent(const linkaddr_t *dest, int status, int transmissions);
+/* Module initialization, called by TSCH */
+void sixtop_init(void);
+
+#endif /* __SIXTOP_H__ */
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         TSCH channel blacklisting. Slot operation counts the frames sent,
+ *         acknowledged, received and corrupted on every channel of the
+ *         hopping sequence. Every EB period, the PAN coordinator blacklists
+ *         the channels with a PRR below TSCH_CHANNEL_BLACKLIST_PRR_THRESHOLD,
+ *         the worst first, and gives them another chance after
+ *         TSCH_CHANNEL_BLACKLIST_PROBATION EB periods. Other nodes install
+ *         the blacklist found in the EBs of their time source, and pass it on
+ *         in their own EBs.
+ *
+ *         A link on a blacklisted channel uses one of the others instead,
+ *         picked from the ASN and channel offset the same way the hopping
+ *         sequence is walked. The links on the channels in use stay where
+ *         they are: until a node gets the new blacklist, only the links on
+ *         the channels that changed are out of step.
+ */
+
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/tsch-slot-operation.h"
+#include "net/mac/tsch/tsch-log.h"
+#include "net/mac/tsch/tsch-channel-blacklist.h"
+#include <string.h>
+
+#if TSCH_LOG_LEVEL >= 1
+#define DEBUG DEBUG_PRINT
+#else /* TSCH_LOG_LEVEL */
+#define DEBUG DEBUG_NONE
+#endif /* TSCH_LOG_LEVEL */
+#include "net/net-debug.h"
+
+#if TSCH_WITH_CHANNEL_BLACKLIST
+
+struct tsch_channel_stats tsch_channel_stats[TSCH_HOPPING_SEQUENCE_MAX_LEN];
+uint16_t tsch_channel_blacklist;
+uint8_t tsch_channel_blacklist_seqnum;
+
+/* The hopping sequence indices that are not blacklisted, and their number */
+static uint8_t whitelist[TSCH_HOPPING_SEQUENCE_MAX_LEN];
+static struct tsch_asn_divisor_t whitelist_length;
+/* The number of EB periods each blacklisted channel has left */
+static uint8_t probation[TSCH_HOPPING_SEQUENCE_MAX_LEN];
+
+/*---------------------------------------------------------------------------*/
+uint16_t
+tsch_channel_blacklist_substitute(struct tsch_asn_t *asn, uint8_t channel_offset)
+{
+  uint16_t index_of_0 = TSCH_ASN_MOD(*asn, whitelist_length);
+  return whitelist[(index_of_0 + channel_offset) % whitelist_length.val];
+}
+/*---------------------------------------------------------------------------*/
+static int
+count_channels(uint16_t blacklist)
+{
+  int n = 0;
+  int i;
+
+  for(i = 0; i < tsch_hopping_sequence_length.val; i++) {
+    if(!(blacklist & (1 << i))) {
+      n++;
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Puts a blacklist in use. Returns 1 on success, 0 if slot operation could
+ * not be locked */
+static int
+install(uint16_t blacklist)
+{
+  uint8_t list[TSCH_HOPPING_SEQUENCE_MAX_LEN];
+  int n = 0;
+  int i;
+
+  /* Ignore the bits beyond the hopping sequence, and never blacklist all
+   * channels */
+  blacklist &= (1UL << tsch_hopping_sequence_length.val) - 1;
+  if(count_channels(blacklist) == 0) {
+    blacklist = 0;
+  }
+  for(i = 0; i < tsch_hopping_sequence_length.val; i++) {
+    if(!(blacklist & (1 << i))) {
+      list[n++] = i;
+    }
+  }
+
+  if(!tsch_get_lock()) {
+    return 0;
+  }
+  tsch_channel_blacklist = blacklist;
+  memcpy(whitelist, list, n);
+  TSCH_ASN_DIVISOR_INIT(whitelist_length, n);
+  tsch_release_lock();
+
+  PRINTF("TSCH: channel blacklist %04x, %u channels in use\n", blacklist, n);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_channel_blacklist_set(uint8_t seqnum, uint16_t blacklist)
+{
+  if((seqnum != tsch_channel_blacklist_seqnum
+      || blacklist != tsch_channel_blacklist)
+     && install(blacklist)) {
+    tsch_channel_blacklist_seqnum = seqnum;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the index of the channel with the lowest PRR below the threshold,
+ * among the channels in use, -1 if none */
+static int
+worst_channel(uint16_t blacklist)
+{
+  struct tsch_channel_stats *s;
+  unsigned long total;
+  unsigned long prr;
+  unsigned long worst_prr = TSCH_CHANNEL_BLACKLIST_PRR_THRESHOLD;
+  int worst = -1;
+  int i;
+
+  for(i = 0; i < tsch_hopping_sequence_length.val; i++) {
+    s = &tsch_channel_stats[i];
+    total = (unsigned long)s->tx + s->rx + s->rx_failed;
+    if((blacklist & (1 << i)) || total < TSCH_CHANNEL_BLACKLIST_MIN_SAMPLES) {
+      continue;
+    }
+    prr = 100 * ((unsigned long)s->tx_acked + s->rx) / total;
+    if(prr < worst_prr) {
+      worst_prr = prr;
+      worst = i;
+    }
+  }
+  return worst;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_channel_blacklist_update(void)
+{
+  uint16_t blacklist = tsch_channel_blacklist;
+  int i;
+
+  if(tsch_is_coordinator) {
+    /* Give the channels whose probation is over another chance */
+    for(i = 0; i < tsch_hopping_sequence_length.val; i++) {
+      if((blacklist & (1 << i)) && --probation[i] == 0) {
+        blacklist &= ~(1 << i);
+        memset(&tsch_channel_stats[i], 0, sizeof(struct tsch_channel_stats));
+      }
+    }
+    /* Blacklist the bad ones, worst first */
+    while(count_channels(blacklist) > TSCH_CHANNEL_BLACKLIST_MIN_CHANNELS
+          && (i = worst_channel(blacklist)) >= 0) {
+      PRINTF("TSCH: blacklisting channel %u\n", tsch_hopping_sequence[i]);
+      blacklist |= 1 << i;
+      probation[i] = TSCH_CHANNEL_BLACKLIST_PROBATION;
+    }
+    if(blacklist != tsch_channel_blacklist && install(blacklist)) {
+      tsch_channel_blacklist_seqnum++;
+    }
+  }
+
+  /* Age the statistics */
+  for(i = 0; i < tsch_hopping_sequence_length.val; i++) {
+    tsch_channel_stats[i].tx >>= 1;
+    tsch_channel_stats[i].tx_acked >>= 1;
+    tsch_channel_stats[i].rx >>= 1;
+    tsch_channel_stats[i].rx_failed >>= 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_channel_blacklist_reset(void)
+{
+  memset(tsch_channel_stats, 0, sizeof(tsch_channel_stats));
+  memset(probation, 0, sizeof(probation));
+  tsch_channel_blacklist_seqnum = 0;
+  install(0);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         TSCH channel blacklisting, see TSCH_CONF_WITH_CHANNEL_BLACKLIST.
+ *         Channels are designated by their index in the hopping sequence.
+ */
+
+#ifndef __TSCH_CHANNEL_BLACKLIST_H__
+#define __TSCH_CHANNEL_BLACKLIST_H__
+
+/********** Includes **********/
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch-asn.h"
+#include "net/mac/tsch/tsch-conf.h"
+
+/******** Configuration *******/
+
+/* The number of transmissions and receptions on a channel before its PRR
+ * is trusted. The statistics are halved every EB period */
+#ifdef TSCH_CHANNEL_BLACKLIST_CONF_MIN_SAMPLES
+#define TSCH_CHANNEL_BLACKLIST_MIN_SAMPLES TSCH_CHANNEL_BLACKLIST_CONF_MIN_SAMPLES
+#else
+#define TSCH_CHANNEL_BLACKLIST_MIN_SAMPLES 16
+#endif
+
+/* A channel with a PRR below this many percent is blacklisted */
+#ifdef TSCH_CHANNEL_BLACKLIST_CONF_PRR_THRESHOLD
+#define TSCH_CHANNEL_BLACKLIST_PRR_THRESHOLD TSCH_CHANNEL_BLACKLIST_CONF_PRR_THRESHOLD
+#else
+#define TSCH_CHANNEL_BLACKLIST_PRR_THRESHOLD 50
+#endif
+
+/* The number of channels never blacklisted */
+#ifdef TSCH_CHANNEL_BLACKLIST_CONF_MIN_CHANNELS
+#define TSCH_CHANNEL_BLACKLIST_MIN_CHANNELS TSCH_CHANNEL_BLACKLIST_CONF_MIN_CHANNELS
+#else
+#define TSCH_CHANNEL_BLACKLIST_MIN_CHANNELS 4
+#endif
+
+/* The number of EB periods after which a blacklisted channel is tried again */
+#ifdef TSCH_CHANNEL_BLACKLIST_CONF_PROBATION
+#define TSCH_CHANNEL_BLACKLIST_PROBATION TSCH_CHANNEL_BLACKLIST_CONF_PROBATION
+#else
+#define TSCH_CHANNEL_BLACKLIST_PROBATION 32
+#endif
+
+/************ Types ***********/
+
+/* Statistics of a channel, updated from slot operation */
+struct tsch_channel_stats {
+  uint16_t tx;          /* Unicast transmissions */
+  uint16_t tx_acked;    /* Of which acknowledged */
+  uint16_t rx;          /* Frames received */
+  uint16_t rx_failed;   /* Frames seen on the air but not received */
+};
+
+/***** External Variables *****/
+
+extern struct tsch_channel_stats tsch_channel_stats[TSCH_HOPPING_SEQUENCE_MAX_LEN];
+/* The blacklist in use: bit i stands for entry i of the hopping sequence */
+extern uint16_t tsch_channel_blacklist;
+/* Incremented by the PAN coordinator on every change of the blacklist */
+extern uint8_t tsch_channel_blacklist_seqnum;
+
+/********** Functions *********/
+
+/* Returns the hopping sequence index to use at ASN asn and channel offset
+ * channel_offset, whose own is blacklisted. Called from slot operation */
+uint16_t tsch_channel_blacklist_substitute(struct tsch_asn_t *asn,
+                                           uint8_t channel_offset);
+/* Installs the blacklist received from our time source */
+void tsch_channel_blacklist_set(uint8_t seqnum, uint16_t blacklist);
+/* Called every EB period: the PAN coordinator updates the blacklist from
+ * its statistics, then the statistics of every node are aged */
+void tsch_channel_blacklist_update(void);
+/* Clears the blacklist and statistics, when the hopping sequence is set */
+void tsch_channel_blacklist_reset(void);
+
+/* Per-channel statistics, from slot operation */
+#define TSCH_CHANNEL_STATS_TX(index, acked) do { \
+    tsch_channel_stats[index].tx++; \
+    if(acked) { tsch_channel_stats[index].tx_acked++; } \
+  } while(0)
+#define TSCH_CHANNEL_STATS_RX(index, ok) do { \
+    if(ok) { tsch_channel_stats[index].rx++; } \
+    else { tsch_channel_stats[index].rx_failed++; } \
+  } while(0)
+
+#endif /* __TSCH_CHANNEL_BLACKLIST_H__ */
@@ -163,13 +163,54 @@
 #endif
 
 /* A custom feature allowing upper layers to assign packets to
- * a specific slotframe and link */
+ * a specific slotframe and link. The assignment only holds for links to
+ * other addresses: a Tx link whose address is the packet's neighbor
+ * (as installed by e.g. Orchestra's unicast_adaptive rule or 6top) carries
+ * any packet queued for that neighbor */
 #ifdef TSCH_CONF_WITH_LINK_SELECTOR
 #define TSCH_WITH_LINK_SELECTOR TSCH_CONF_WITH_LINK_SELECTOR
 #else /* TSCH_CONF_WITH_LINK_SELECTOR */
 #define TSCH_WITH_LINK_SELECTOR 0
 #endif /* TSCH_CONF_WITH_LINK_SELECTOR */
 
+/* 6top sublayer: negotiate cells with neighbors through 6P (RFC 8480),
+ * on behalf of the scheduling functions registered with sixtop_add_sf.
+ * Requires MODULES += core/net/mac/tsch/sixtop */
+#ifdef TSCH_CONF_WITH_SIXTOP
+#define TSCH_WITH_SIXTOP TSCH_CONF_WITH_SIXTOP
+#else /* TSCH_CONF_WITH_SIXTOP */
+#define TSCH_WITH_SIXTOP 0
+#endif /* TSCH_CONF_WITH_SIXTOP */
+
+/* Channel blacklisting: count the frames sent, acknowledged, received and
+ * corrupted on every channel of the hopping sequence, and skip the channels
+ * with a poor PRR. The PAN coordinator decides on the blacklist from its own
+ * statistics, every EB period, and the blacklist travels down the network
+ * in EBs. A link whose channel is blacklisted uses a channel picked from the
+ * others with the ASN instead, so that a change only affects the links on
+ * the channels it adds or removes. */
+#ifdef TSCH_CONF_WITH_CHANNEL_BLACKLIST
+#define TSCH_WITH_CHANNEL_BLACKLIST TSCH_CONF_WITH_CHANNEL_BLACKLIST
+#else /* TSCH_CONF_WITH_CHANNEL_BLACKLIST */
+#define TSCH_WITH_CHANNEL_BLACKLIST 0
+#endif /* TSCH_CONF_WITH_CHANNEL_BLACKLIST */
+
+#if TSCH_WITH_CHANNEL_BLACKLIST && TSCH_HOPPING_SEQUENCE_MAX_LEN > 16
+#error "TSCH_WITH_CHANNEL_BLACKLIST: the blacklist holds 16 channels at most"
+#endif
+
+/* Burst mode: the maximum number of frames sent to a neighbor back-to-back.
+ * While more frames are queued for the neighbor, the sender sets the frame
+ * pending bit. Once such a frame is acknowledged, both ends replay the link
+ * in the next timeslot, on the same channel offset, for the following frame.
+ * A burst takes precedence over the links scheduled in these timeslots.
+ * Set to 0 to disable. */
+#ifdef TSCH_CONF_BURST_MAX_LEN
+#define TSCH_BURST_MAX_LEN TSCH_CONF_BURST_MAX_LEN
+#else
+#define TSCH_BURST_MAX_LEN 0
+#endif
+
 /* Estimate the drift of the time-source neighbor and compensate for it? */
 #ifdef TSCH_CONF_ADAPTIVE_TIMESYNC
 #define TSCH_ADAPTIVE_TIMESYNC TSCH_CONF_ADAPTIVE_TIMESYNC
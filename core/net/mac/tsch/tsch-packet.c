@@ -46,6 +46,7 @@
 #include "net/mac/tsch/tsch-schedule.h"
 #include "net/mac/tsch/tsch-security.h"
 #include "net/mac/tsch/tsch-log.h"
+#include "net/mac/tsch/tsch-channel-blacklist.h"
 #include "net/mac/frame802154.h"
 #include "net/mac/framer-802154.h"
 #include "net/netstack.h"
@@ -259,6 +260,13 @@ tsch_packet_create_eb(uint8_t *buf, int buf_size,
   }
 #endif /* TSCH_PACKET_EB_WITH_HOPPING_SEQUENCE */
 
+  /* Add channel blacklist IE */
+#if TSCH_WITH_CHANNEL_BLACKLIST
+  ies.ie_channel_blacklist_present = 1;
+  ies.ie_channel_blacklist_seqnum = tsch_channel_blacklist_seqnum;
+  ies.ie_channel_blacklist = tsch_channel_blacklist;
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
+
   /* Add Slotframe and Link IE */
 #if TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
   {
@@ -312,6 +320,13 @@ tsch_packet_create_eb(uint8_t *buf, int buf_size,
   }
   curr_len += ret;
 
+  if(ies.ie_channel_blacklist_present) {
+    if((ret = frame80215e_create_ie_tsch_channel_blacklist(buf + curr_len, buf_size - curr_len, &ies)) == -1) {
+      return -1;
+    }
+    curr_len += ret;
+  }
+
   if((ret = frame80215e_create_ie_tsch_slotframe_and_link(buf + curr_len, buf_size - curr_len, &ies)) == -1) {
     return -1;
   }
@@ -344,6 +359,19 @@ tsch_packet_update_eb(uint8_t *buf, int buf_size, uint8_t tsch_sync_ie_offset)
   return 1;
 }
 /*---------------------------------------------------------------------------*/
+/* Set or clear the frame pending bit of a packet */
+void
+tsch_packet_set_frame_pending(uint8_t *buf, int buf_size, int pending)
+{
+  if(buf_size > 0) {
+    if(pending) {
+      buf[0] |= 1 << 4;
+    } else {
+      buf[0] &= ~(1 << 4);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
 /* Parse a IEEE 802.15.4e TSCH Enhanced Beacon (EB) */
 int
 tsch_packet_parse_eb(const uint8_t *buf, int buf_size,
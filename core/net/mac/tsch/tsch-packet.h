@@ -97,6 +97,8 @@ int tsch_packet_create_eb(uint8_t *buf, int buf_size,
     uint8_t *hdr_len, uint8_t *tsch_sync_ie_ptr);
 /* Update ASN in EB packet */
 int tsch_packet_update_eb(uint8_t *buf, int buf_size, uint8_t tsch_sync_ie_offset);
+/* Set or clear the frame pending bit of a packet */
+void tsch_packet_set_frame_pending(uint8_t *buf, int buf_size, int pending);
 /* Parse EB and extract ASN and join priority */
 int tsch_packet_parse_eb(const uint8_t *buf, int buf_size,
     frame802154_t *frame, struct ieee802154_ies *ies,
@@ -77,12 +77,58 @@ LIST(neighbor_list);
 struct tsch_neighbor *n_broadcast;
 struct tsch_neighbor *n_eb;
 
+#if TSCH_QUEUE_WITH_CLASS_WEIGHTS
+/* Number of consecutive packets served from each class in a round.
+ * Checked by tsch_queue_init() */
+static uint8_t class_weights[TSCH_QUEUE_NUM_CLASSES] = TSCH_QUEUE_CLASS_WEIGHTS;
+#endif /* TSCH_QUEUE_WITH_CLASS_WEIGHTS */
+
+/*---------------------------------------------------------------------------*/
+/* Get the queueing class of the packet currently in packetbuf */
+static uint8_t
+class_from_packetbuf(void)
+{
+  return MIN(packetbuf_attr(PACKETBUF_ATTR_TRAFFIC_CLASS), TSCH_QUEUE_NUM_CLASSES - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Select the class to be served next, -1 if all classes are empty.
+ * Classes are indexed by increasing priority. The selection only depends
+ * on the neighbor state, so that a peek and the following remove agree. */
+static int
+select_class(const struct tsch_neighbor *n)
+{
+  int i;
+#if TSCH_QUEUE_WITH_CLASS_WEIGHTS
+  /* Weighted round-robin: keep serving the current class while it has
+   * credit left, then move on to the next lower class (wrapping around) */
+  int c = n->wrr_class;
+  if(n->wrr_credit == 0) {
+    c = c > 0 ? c - 1 : TSCH_QUEUE_NUM_CLASSES - 1;
+  }
+  for(i = 0; i < TSCH_QUEUE_NUM_CLASSES; i++) {
+    if(!ringbufindex_empty(&n->tx_ringbuf[c])) {
+      return c;
+    }
+    c = c > 0 ? c - 1 : TSCH_QUEUE_NUM_CLASSES - 1;
+  }
+#else /* TSCH_QUEUE_WITH_CLASS_WEIGHTS */
+  /* Strict priority: serve the highest non-empty class */
+  for(i = TSCH_QUEUE_NUM_CLASSES - 1; i >= 0; i--) {
+    if(!ringbufindex_empty(&n->tx_ringbuf[i])) {
+      return i;
+    }
+  }
+#endif /* TSCH_QUEUE_WITH_CLASS_WEIGHTS */
+  return -1;
+}
+
 /*---------------------------------------------------------------------------*/
 /* Add a TSCH neighbor */
 struct tsch_neighbor *
 tsch_queue_add_nbr(const linkaddr_t *addr)
 {
   struct tsch_neighbor *n = NULL;
+  int i;
   /* If we have an entry for this neighbor already, we simply update it */
   n = tsch_queue_get_nbr(addr);
   if(n == NULL) {
@@ -92,7 +138,9 @@ tsch_queue_add_nbr(const linkaddr_t *addr)
       if(n != NULL) {
         /* Initialize neighbor entry */
         memset(n, 0, sizeof(struct tsch_neighbor));
-        ringbufindex_init(&n->tx_ringbuf, TSCH_QUEUE_NUM_PER_NEIGHBOR);
+        for(i = 0; i < TSCH_QUEUE_NUM_CLASSES; i++) {
+          ringbufindex_init(&n->tx_ringbuf[i], TSCH_QUEUE_NUM_PER_NEIGHBOR);
+        }
         linkaddr_copy(&n->addr, addr);
         n->is_broadcast = linkaddr_cmp(addr, &tsch_eb_address)
           || linkaddr_cmp(addr, &tsch_broadcast_address);
@@ -234,13 +282,13 @@ tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr)
   struct tsch_neighbor *n = NULL;
   int16_t put_index = -1;
   struct tsch_packet *p = NULL;
-
-  data_tcflow = 0; //by default.
+  uint8_t tx_class = 0;
 
   if(!tsch_is_locked()) {
     n = tsch_queue_add_nbr(addr);
     if(n != NULL) {
-      put_index = ringbufindex_peek_put(&n->tx_ringbuf);
+      tx_class = class_from_packetbuf();
+      put_index = ringbufindex_peek_put(&n->tx_ringbuf[tx_class]);
       if(put_index != -1) {
         p = memb_alloc(&packet_memb);
         if(p != NULL) {
@@ -248,44 +296,17 @@ tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr)
 #ifdef TSCH_CALLBACK_PACKET_READY
           TSCH_CALLBACK_PACKET_READY();
 #endif
-
-          
           p->qb = queuebuf_new_from_packetbuf();
           if(p->qb != NULL) {
             p->sent = sent;
             p->ptr = ptr;
             p->ret = MAC_TX_DEFERRED;
             p->transmissions = 0;
-
-            /* show queuebuf information. */
-            int i;
-            int dataLen=queuebuf_datalen(p->qb);
-            for(i=0;i<dataLen;i++){
-              uint8_t data=((uint8_t *)queuebuf_dataptr(p->qb))[i];
-              PRINTF("%02x ",data);
-            }
-            PRINTF("\n");
-
-            //check coap have created packet, if will, print it.
-            if( ((uint8_t *)queuebuf_dataptr(p->qb))[0] == 0x21 &&
-                ((uint8_t *)queuebuf_dataptr(p->qb))[dataLen-4] == 0xf0 && 
-                ((uint8_t *)queuebuf_dataptr(p->qb))[dataLen-3] == 0xff &&
-                dataLen >= 100) {
-
-              data_tcflow = ((int8_t *)queuebuf_dataptr(p->qb))[24]; //24 is tcflow in queuebuf location.
-              PRINTF("Traffic classes In TSCH queue : %02x\n", data_tcflow);
-              
-            }
-            
-
-#if   ENABLE_QOS_WHITE
-            tsch_queue_resorting_ringbuf_priority(n, p);       
-#else
             /* Add to ringbuf (actual add committed through atomic operation) */
-            n->tx_array[put_index] = p; //
-            ringbufindex_put(&n->tx_ringbuf); //input ringbuf.
-            PRINTF("TSCH-queue: packet is added put_index=%u, packet=%p\n", put_index, p);
-#endif /* ENABLE_QOS_WHITE */
+            n->tx_array[tx_class][put_index] = p;
+            ringbufindex_put(&n->tx_ringbuf[tx_class]);
+            PRINTF("TSCH-queue: packet is added class=%u put_index=%u, packet=%p\n",
+                   tx_class, put_index, p);
             return p;
           } else {
             memb_free(&packet_memb, p);
@@ -294,152 +315,10 @@ tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr)
       }
     }
   }
-  PRINTF("TSCH-queue:! add packet failed: %u %p %d %p %p\n", tsch_is_locked(), n, put_index, p, p ? p->qb : NULL);
+  PRINTF("TSCH-queue:! add packet failed: %u %p %u %d %p %p\n", tsch_is_locked(), n, tx_class, put_index, p, p ? p->qb : NULL);
   return 0;
 }
 /*---------------------------------------------------------------------------*/
-/* Resorting ringbuf packet by priority */
-void
-tsch_queue_resorting_ringbuf_priority(struct tsch_neighbor *n,struct tsch_packet *p)
-{
-  int dataLen=queuebuf_datalen(p->qb);
-  ringbufindex_ELM = ringbufindex_elements(&n->tx_ringbuf);
-  int16_t put_index = ringbufindex_peek_put(&n->tx_ringbuf); //peek put ringbuf data.
-  int16_t current_index = put_index-ringbufindex_ELM;
-    /* fix overflow issue. */
-  if((current_index) < 0) current_index = 15 - put_index;
-  
-  /* initialize value */
-  if(((uint8_t *)queuebuf_dataptr(p->qb))[0] == 0x21 &&
-     ((uint8_t *)queuebuf_dataptr(p->qb))[dataLen-4] == 0xf0 && 
-     ((uint8_t *)queuebuf_dataptr(p->qb))[dataLen-3] == 0xff &&
-     ringbufindex_ELM == 0) {
-          /* get_index to index temp. */
-          zero_index = 0x00;
-          one_index = 0x00;
-          two_index = 0x00;
-          /* strong the index = 0 issue. */
-          zero_flag = 0x00;
-          one_flag = 0x00;
-          //PRINTF("\nringbufindex : %u , get_index : %u , Go to Default.\n\n",ringbufindex_ELM,get_index);
-  }
-
-  //PRINTF("WHITE_TESTING TSCH-queue: packet is added put_index=%u, packet=%p\n", put_index, p);
-  PRINTF("\nShow RINGBUFFER_Elements: %u and First queue Packets : %u !!!\n", ringbufindex_ELM, current_index);
-  PRINTF("TESTING data_tcflow : %u\n", data_tcflow);
-
-  /* Filter the packets from here. 
-   * If first header is 0x21, be sure from coap.
-   */
-  if(((uint8_t *)queuebuf_dataptr(p->qb))[0] == 0x21 &&
-     ((uint8_t *)queuebuf_dataptr(p->qb))[dataLen-4] == 0xf0 && 
-     ((uint8_t *)queuebuf_dataptr(p->qb))[dataLen-3] == 0xff &&
-     ringbufindex_ELM >= 0 &&
-     dataLen > 100) 
-    {
-    /* check tcflow the value */
-    switch((int)data_tcflow){
-      case 0:
-                              zero_flag = 0x01;
-                              pkt_priority_same(n,p,&zero_index);           
-        break;
-      case 1:
-        if      (zero_flag)   pkt_priority_largerthan(n,p,&zero_index);
-        else                  
-        {
-                              one_flag = 0x01;
-                              pkt_priority_same(n,p,&one_index);
-        }
-        break;
-      case 2:
-        if      (one_flag)    pkt_priority_largerthan(n,p,&one_index);
-        else if (zero_flag)   pkt_priority_largerthan(n,p,&zero_index);
-        else                  pkt_priority_same(n,p,&two_index);
-        break;
-    } 
-    int16_t first;
-    for (first = 0; first <= ringbufindex_ELM ; first++) {
-      PRINTF("The RINGBUFFER packet sort : %u , %u\n",(current_index+first)%16, first);
-    }
-
-    //PRINTF("MAIN zero : %u ,   one : %u ,    two : %u\n",zero_index,one_index,two_index);
-
-    ringbufindex_put(&n->tx_ringbuf); //input ringbuf.
-  }else {
-    n->tx_array[(put_index)] = p; // end packet.
-    ringbufindex_put(&n->tx_ringbuf); //input ringbuf.
-  }
-}
-/*---------------------------------------------------------------------------*/
-/* Large than it*/
-void 
-pkt_priority_largerthan(struct tsch_neighbor *n,struct tsch_packet *p, int16_t *index_temp)
-{
-  int16_t i=0 , j=1;
-  int16_t put_index = ringbufindex_peek_put(&n->tx_ringbuf);
-  i=put_index;
-  while(1)
-  {
-    if(i<0)i=15;
-    n->tx_array[(i+1)%16] = n->tx_array[i%16];
-    if(i == *index_temp)break;
-    i--;
-  }
-  n->tx_array[*index_temp] = p;
-  
-  /*
-  struct tsch_packet *temp1 = NULL;
-  struct tsch_packet *temp2 = NULL;
-
-  
-  temp1 = n->tx_array[*index_temp];
-  n->tx_array[*index_temp] = p;
-
-
-  for(i = 0; i <= ringbufindex_ELM; i++){
-    temp2 = n->tx_array[(*index_temp+i+j) % 16]; // j=1. will happen overflow.
-    n->tx_array[(*index_temp+i+j) %16] = temp1;
-    //PRINTF("HERE SHOWING index_temp +i +j = %u  \n", *index_temp+i+j);
-  }
-  */
-  if((int)data_tcflow == 2) {
-    //two_index = *index_temp;
-    if(one_flag) {
-      if(zero_flag){
-        zero_index = (zero_index++)%16;
-      }
-      one_index = (one_index++)%16;
-    }else zero_index = (zero_index++)%16;
-  }
-  else if((int)data_tcflow == 1) {
-    //one_index = *index_temp;
-    zero_index = (zero_index++)%16;
-  }
-  
-  *index_temp = (*index_temp++)%16; // prevent overflow. 
-#if WHITE_DEBUG
-  PRINTF("zero : %u ,   one : %u ,    two : %u\n",zero_index,one_index,two_index);
-  PRINTF("LARGE __ index_temp : %u  \n\n", *index_temp);
-#endif /* WHITE_DEBUG */
-}
-/*---------------------------------------------------------------------------*/
-/* same */
-void
-pkt_priority_same(struct tsch_neighbor *n,struct tsch_packet *p, int16_t *index_temp) 
-{
-  int16_t put_index = ringbufindex_peek_put(&n->tx_ringbuf); //peek put ringbuf data.
-  if(*index_temp){
-    n->tx_array[put_index] = p;
-  }else {
-    *index_temp = put_index;
-    n->tx_array[put_index] = p;
-  }
-#if WHITE_DEBUG
-  PRINTF("zero : %u ,   one : %u ,    two : %u\n",zero_index,one_index,two_index);
-  PRINTF("SAME __ index_temp : %u  \n\n", *index_temp);  
-#endif /* WHITE_DEBUG */
-}
-/*---------------------------------------------------------------------------*/
 /* Returns the number of packets currently in the queue */
 int
 tsch_queue_packet_count(const linkaddr_t *addr)
@@ -448,37 +327,56 @@ tsch_queue_packet_count(const linkaddr_t *addr)
   if(!tsch_is_locked()) {
     n = tsch_queue_add_nbr(addr);
     if(n != NULL) {
-      return ringbufindex_elements(&n->tx_ringbuf);
+      return tsch_queue_nbr_packet_count(n);
     }
   }
   return -1;
 }
 /*---------------------------------------------------------------------------*/
+/* Returns the number of packets currently in the queue of a neighbor */
+int
+tsch_queue_nbr_packet_count(const struct tsch_neighbor *n)
+{
+  int i;
+  int count = 0;
+  for(i = 0; i < TSCH_QUEUE_NUM_CLASSES; i++) {
+    count += ringbufindex_elements(&n->tx_ringbuf[i]);
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
 /* Remove first packet from a neighbor queue */
 struct tsch_packet *
 tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n)
 {
   if(!tsch_is_locked()) {
     if(n != NULL) {
+      /* Remove from the class of the packet last returned by
+       * tsch_queue_get_packet_for_nbr. A higher class might have been
+       * filled in the meantime, the packet we have been working on is
+       * still at the head of its own class. */
+      int tx_class = n->tx_class;
+      int16_t get_index;
+      if(ringbufindex_empty(&n->tx_ringbuf[tx_class])) {
+        tx_class = select_class(n);
+        if(tx_class == -1) {
+          return NULL;
+        }
+      }
       /* Get and remove packet from ringbuf (remove committed through an atomic operation */
-      int16_t get_index = ringbufindex_get(&n->tx_ringbuf);
+      get_index = ringbufindex_get(&n->tx_ringbuf[tx_class]);
       if(get_index != -1) {
-        PRINTF("TSCH-queue: packet is removed, get_index=%u\n", get_index);
-
-
-        // /* go to default */
-        // if(ringbufindex_ELM < 1) {
-        //   /* get_index to index temp. */
-        //   zero_index = 0x00;
-        //   one_index = 0x00;
-        //   two_index = 0x00;
-        //   /* strong the index = 0 issue. */
-        //   zero_flag = 0x00;
-        //   one_flag = 0x00;
-        //   PRINTF("\nringbufindex : %u , get_index : %u , Go to Default.\n\n",ringbufindex_ELM,get_index);
-        // }
-
-        return n->tx_array[get_index];
+        PRINTF("TSCH-queue: packet is removed, class=%u get_index=%u\n", tx_class, get_index);
+#if TSCH_QUEUE_WITH_CLASS_WEIGHTS
+        /* Consume one credit of the class, or start serving a new one */
+        if(tx_class == n->wrr_class && n->wrr_credit > 0) {
+          n->wrr_credit--;
+        } else {
+          n->wrr_class = tx_class;
+          n->wrr_credit = class_weights[tx_class] - 1;
+        }
+#endif /* TSCH_QUEUE_WITH_CLASS_WEIGHTS */
+        return n->tx_array[tx_class][get_index];
       } else {
         return NULL;
       }
@@ -539,31 +437,41 @@ tsch_queue_free_unused_neighbors(void)
 int
 tsch_queue_is_empty(const struct tsch_neighbor *n)
 {
-  return !tsch_is_locked() && n != NULL && ringbufindex_empty(&n->tx_ringbuf);
+  return !tsch_is_locked() && n != NULL && select_class(n) == -1;
 }
 /*---------------------------------------------------------------------------*/
 /* Returns the first packet from a neighbor queue */
 struct tsch_packet *
-tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *link)
+tsch_queue_get_packet_for_nbr(struct tsch_neighbor *n, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
     int is_shared_link = link != NULL && link->link_options & LINK_OPTION_SHARED;
     if(n != NULL) {
-      int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf);
-      if(get_index != -1 &&
+      int tx_class = select_class(n);
+      if(tx_class != -1 &&
           !(is_shared_link && !tsch_queue_backoff_expired(n))) {    /* If this is a shared link,
                                                                     make sure the backoff has expired */
+        int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf[tx_class]);
+        struct tsch_packet *p = n->tx_array[tx_class][get_index];
 #if TSCH_WITH_LINK_SELECTOR
-        int packet_attr_slotframe = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
-        int packet_attr_timeslot = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
-        if(packet_attr_slotframe != 0xffff && packet_attr_slotframe != link->slotframe_handle) {
-          return NULL;
-        }
-        if(packet_attr_timeslot != 0xffff && packet_attr_timeslot != link->timeslot) {
-          return NULL;
+        /* The slotframe and timeslot set by the link selector only restrict
+         * links shared with other neighbors: a link dedicated to this
+         * neighbor may carry any of its packets, so that e.g. extra cells
+         * drain the queue next to the packets' base cell */
+        if(n->is_broadcast || !linkaddr_cmp(&link->addr, &n->addr)) {
+          int packet_attr_slotframe = queuebuf_attr(p->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
+          int packet_attr_timeslot = queuebuf_attr(p->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
+          if(packet_attr_slotframe != 0xffff && packet_attr_slotframe != link->slotframe_handle) {
+            return NULL;
+          }
+          if(packet_attr_timeslot != 0xffff && packet_attr_timeslot != link->timeslot) {
+            return NULL;
+          }
         }
 #endif
-        return n->tx_array[get_index];
+        /* Remember the class, for tsch_queue_remove_packet_from_queue */
+        n->tx_class = tx_class;
+        return p;
       }
     }
   }
@@ -657,6 +565,18 @@ tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr)
 void
 tsch_queue_init(void)
 {
+#if TSCH_QUEUE_WITH_CLASS_WEIGHTS
+  int i;
+
+  /* A weight of 0, also that of a class left out of the list, would
+   * underflow the round-robin credit */
+  for(i = 0; i < TSCH_QUEUE_NUM_CLASSES; i++) {
+    if(class_weights[i] == 0) {
+      PRINTF("TSCH-queue:! class %u has weight 0, using 1\n", i);
+      class_weights[i] = 1;
+    }
+  }
+#endif /* TSCH_QUEUE_WITH_CLASS_WEIGHTS */
   list_init(neighbor_list);
   memb_init(&neighbor_memb);
   memb_init(&packet_memb);
@@ -69,16 +69,27 @@
 #endif
 #endif
 
-#if ENABLE_QOS_WHITE
-#define TSCH_ENABLE_QOS 1
-int16_t zero_index, one_index, two_index; //define the packet start index.
-int16_t ringbufindex_ELM;
-int8_t data_tcflow, zero_flag, one_flag;
+/* The number of queueing classes per neighbor. Each class has its own
+ * ringbuf of TSCH_QUEUE_NUM_PER_NEIGHBOR packets. The class of an outgoing
+ * packet is taken from PACKETBUF_ATTR_TRAFFIC_CLASS, capped to the highest
+ * class. Higher classes have higher priority. */
+#ifdef TSCH_QUEUE_CONF_NUM_CLASSES
+#define TSCH_QUEUE_NUM_CLASSES TSCH_QUEUE_CONF_NUM_CLASSES
 #else
-#define TSCH_ENABLE_QOS 0
+#define TSCH_QUEUE_NUM_CLASSES 1
 #endif
 
-#define WHITE_DEBUG 1
+/* Per-class weights, as an array initializer indexed by class, e.g.
+ * { 1, 2, 4 }. If set, classes are served by weighted round-robin: up to
+ * weight packets from a class before moving on to the next lower class.
+ * Weights must be at least 1, tsch_queue_init() raises a zero or missing
+ * weight to 1. If not set, classes are served in strict priority order. */
+#ifdef TSCH_QUEUE_CONF_CLASS_WEIGHTS
+#define TSCH_QUEUE_WITH_CLASS_WEIGHTS 1
+#define TSCH_QUEUE_CLASS_WEIGHTS TSCH_QUEUE_CONF_CLASS_WEIGHTS
+#else
+#define TSCH_QUEUE_WITH_CLASS_WEIGHTS 0
+#endif
 
 /* The number of neighbor queues. There are two queues allocated at all times:
  * one for EBs, one for broadcasts. Other queues are for unicast to neighbors */
@@ -146,11 +157,16 @@ struct tsch_neighbor {
   uint8_t last_backoff_window; /* Last CSMA backoff window */
   uint8_t tx_links_count; /* How many links do we have to this neighbor? */
   uint8_t dedicated_tx_links_count; /* How many dedicated links do we have to this neighbor? */
-  /* Array for the ringbuf. Contains pointers to packets.
-   * Its size must be a power of two to allow for atomic put */
-  struct tsch_packet *tx_array[TSCH_QUEUE_NUM_PER_NEIGHBOR];
-  /* Circular buffer of pointers to packet. */
-  struct ringbufindex tx_ringbuf;
+  uint8_t tx_class; /* Class of the packet last returned by tsch_queue_get_packet_for_nbr */
+#if TSCH_QUEUE_WITH_CLASS_WEIGHTS
+  uint8_t wrr_class; /* Class currently served by weighted round-robin */
+  uint8_t wrr_credit; /* Number of packets still to be served from wrr_class */
+#endif /* TSCH_QUEUE_WITH_CLASS_WEIGHTS */
+  /* Arrays for the per-class ringbufs. Contain pointers to packets.
+   * Their size must be a power of two to allow for atomic put */
+  struct tsch_packet *tx_array[TSCH_QUEUE_NUM_CLASSES][TSCH_QUEUE_NUM_PER_NEIGHBOR];
+  /* Per-class circular buffers of pointers to packet. */
+  struct ringbufindex tx_ringbuf[TSCH_QUEUE_NUM_CLASSES];
 };
 
 /***** External Variables *****/
@@ -173,7 +189,10 @@ int tsch_queue_update_time_source(const linkaddr_t *new_addr);
 struct tsch_packet *tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr);
 /* Returns the number of packets currently a given neighbor queue */
 int tsch_queue_packet_count(const linkaddr_t *addr);
-/* Remove first packet from a neighbor queue. The packet is stored in a separate
+/* Returns the number of packets currently in the queue of a neighbor */
+int tsch_queue_nbr_packet_count(const struct tsch_neighbor *n);
+/* Remove first packet from a neighbor queue, i.e. the packet last returned by
+ * tsch_queue_get_packet_for_nbr. The packet is stored in a separate
  * dequeued packet list, for later processing. Return the packet. */
 struct tsch_packet *tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n);
 /* Free a packet */
@@ -185,7 +204,7 @@ void tsch_queue_free_unused_neighbors(void);
 /* Is the neighbor queue empty? */
 int tsch_queue_is_empty(const struct tsch_neighbor *n);
 /* Returns the first packet from a neighbor queue */
-struct tsch_packet *tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *link);
+struct tsch_packet *tsch_queue_get_packet_for_nbr(struct tsch_neighbor *n, struct tsch_link *link);
 /* Returns the head packet from a neighbor queue (from neighbor address) */
 struct tsch_packet *tsch_queue_get_packet_for_dest_addr(const linkaddr_t *addr, struct tsch_link *link);
 /* Returns the head packet of any neighbor queue with zero backoff counter.
@@ -202,11 +221,4 @@ void tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr);
 /* Initialize TSCH queue module */
 void tsch_queue_init(void);
 
-
-// White resorting ringbuf by priority.
-
-void tsch_queue_resorting_ringbuf_priority(struct tsch_neighbor *n,struct tsch_packet *p);
-void pkt_priority_largerthan(struct tsch_neighbor *n,struct tsch_packet *p, int16_t *index_temp);
-void pkt_priority_same(struct tsch_neighbor *n,struct tsch_packet *p, int16_t *index_temp);
-
 #endif /* __TSCH_QUEUE_H__ */
@@ -68,6 +68,49 @@ MEMB(link_memb, struct tsch_link, TSCH_SCHEDULE_MAX_LINKS);
 MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
 /* List of slotframes (each slotframe holds its own list of links) */
 LIST(slotframe_list);
+/* Index of all links, grouped by slotframe and sorted by timeslot within
+ * each slotframe. Rebuilt whenever the schedule changes, so that the slot
+ * operation can look up the next active link with a binary search. */
+static struct tsch_link *links_index[TSCH_SCHEDULE_MAX_LINKS];
+
+/*---------------------------------------------------------------------------*/
+/* Rebuild the timeslot index. Call with the TSCH lock taken. */
+static void
+update_links_index(void)
+{
+  uint16_t i = 0;
+  struct tsch_slotframe *sf = list_head(slotframe_list);
+  while(sf != NULL) {
+    struct tsch_link *l = list_head(sf->links_list);
+    sf->links_index = i;
+    while(l != NULL) {
+      links_index[i++] = l;
+      l = list_item_next(l);
+    }
+    sf->links_count = i - sf->links_index;
+    sf = list_item_next(sf);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the position in the slotframe's index of the first link with a
+ * timeslot greater or equal to a given timeslot (links_count if none) */
+static uint16_t
+links_index_lower_bound(const struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  struct tsch_link **links = &links_index[sf->links_index];
+  uint16_t low = 0;
+  uint16_t high = sf->links_count;
+  while(low < high) {
+    uint16_t mid = (low + high) / 2;
+    if(links[mid]->timeslot < timeslot) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+/*---------------------------------------------------------------------------*/
 
 /* Adds and returns a slotframe (NULL if failure) */
 struct tsch_slotframe *
@@ -91,6 +134,7 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
       LIST_STRUCT_INIT(sf, links_list);
       /* Add the slotframe to the global list */
       list_add(slotframe_list, sf);
+      update_links_index();
     }
     PRINTF("TSCH-schedule: add_slotframe %u %u\n",
            handle, size);
@@ -129,6 +173,7 @@ tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe)
       PRINTF("TSCH-schedule: remove slotframe %u %u\n", slotframe->handle, slotframe->size.val);
       memb_free(&slotframe_memb, slotframe);
       list_remove(slotframe_list, slotframe);
+      update_links_index();
       tsch_release_lock();
       return 1;
     }
@@ -195,8 +240,14 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
       } else {
         static int current_link_handle = 0;
         struct tsch_neighbor *n;
-        /* Add the link to the slotframe */
-        list_add(slotframe->links_list, l);
+        struct tsch_link *prev = NULL;
+        struct tsch_link *next = list_head(slotframe->links_list);
+        /* Add the link to the slotframe, keeping the list sorted by timeslot */
+        while(next != NULL && next->timeslot < timeslot) {
+          prev = next;
+          next = list_item_next(next);
+        }
+        list_insert(slotframe->links_list, prev, l);
         /* Initialize link */
         l->handle = current_link_handle++;
         l->link_options = link_options;
@@ -209,6 +260,7 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
           address = &linkaddr_null;
         }
         linkaddr_copy(&l->addr, address);
+        update_links_index();
 
         PRINTF("TSCH-schedule: add_link %u %u %u %u %u %u\n",
                slotframe->handle, link_options, link_type, timeslot, channel_offset, TSCH_LOG_ID_FROM_LINKADDR(address));
@@ -257,6 +309,7 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
 
       list_remove(slotframe->links_list, l);
       memb_free(&link_memb, l);
+      update_links_index();
 
       /* Release the lock before we update the neighbor (will take the lock) */
       tsch_release_lock();
@@ -294,15 +347,12 @@ tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe, uint16_t ti
 {
   if(!tsch_is_locked()) {
     if(slotframe != NULL) {
-      struct tsch_link *l = list_head(slotframe->links_list);
-      /* Loop over all items. Assume there is max one link per timeslot */
-      while(l != NULL) {
-        if(l->timeslot == timeslot) {
-          return l;
-        }
-        l = list_item_next(l);
+      /* Assume there is max one link per timeslot */
+      uint16_t i = links_index_lower_bound(slotframe, timeslot);
+      if(i < slotframe->links_count
+         && links_index[slotframe->links_index + i]->timeslot == timeslot) {
+        return links_index[slotframe->links_index + i];
       }
-      return l;
     }
   }
   return NULL;
@@ -325,8 +375,15 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
     while(sf != NULL) {
       /* Get timeslot from ASN, given the slotframe length */
       uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
-      struct tsch_link *l = list_head(sf->links_list);
-      while(l != NULL) {
+      /* The earliest link of this slotframe is the first one strictly after
+       * the current timeslot, or else the first one of the next slotframe
+       * iteration. There is max one link per timeslot. */
+      struct tsch_link *l = NULL;
+      if(sf->links_count > 0) {
+        uint16_t i = links_index_lower_bound(sf, timeslot + 1);
+        l = links_index[sf->links_index + (i < sf->links_count ? i : 0)];
+      }
+      if(l != NULL) {
         uint16_t time_to_timeslot =
           l->timeslot > timeslot ?
           l->timeslot - timeslot :
@@ -368,8 +425,6 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
             curr_best = new_best;
           }
         }
-
-        l = list_item_next(l);
       }
       sf = list_item_next(sf);
     }
@@ -391,6 +446,7 @@ tsch_schedule_init(void)
     memb_init(&link_memb);
     memb_init(&slotframe_memb);
     list_init(slotframe_list);
+    update_links_index();
     tsch_release_lock();
     return 1;
   } else {
@@ -120,8 +120,11 @@ struct tsch_slotframe {
   /* Number of timeslots in the slotframe.
    * Stored as struct asn_divisor_t because we often need ASN%size */
   struct tsch_asn_divisor_t size;
-  /* List of links belonging to this slotframe */
+  /* List of links belonging to this slotframe, sorted by timeslot */
   LIST_STRUCT(links_list);
+  /* Position and number of this slotframe's links in the timeslot index */
+  uint16_t links_index;
+  uint16_t links_count;
 };
 
 /********** Functions *********/
@@ -54,6 +54,7 @@
 #include "net/mac/tsch/tsch-packet.h"
 #include "net/mac/tsch/tsch-security.h"
 #include "net/mac/tsch/tsch-adaptive-timesync.h"
+#include "net/mac/tsch/tsch-channel-blacklist.h"
 #if CONTIKI_TARGET_COOJA || CONTIKI_TARGET_COOJA_IP64
 #include "lib/simEnvChange.h"
 #include "sys/cooja_mt.h"
@@ -161,8 +162,10 @@ static rtimer_clock_t volatile current_slot_start;
 /* Are we currently inside a slot? */
 static volatile int tsch_in_slot_operation = 0;
 
-/* If we are inside a slot, this tells the current channel */
+/* If we are inside a slot, this tells the current channel, and its index
+ * in the hopping sequence */
 static uint8_t current_channel;
+static uint16_t current_hopping_index;
 
 /* Info about the link, packet and neighbor of
  * the current (or next) slot */
@@ -174,6 +177,18 @@ static struct tsch_link *backup_link = NULL;
 static struct tsch_packet *current_packet = NULL;
 static struct tsch_neighbor *current_neighbor = NULL;
 
+/* Burst mode: set within a slot when a frame with the frame pending bit
+ * was acknowledged, to replay current_link in the next timeslot */
+static uint8_t burst_link_scheduled = 0;
+/* The number of burst timeslots since the last scheduled link */
+static uint8_t burst_count = 0;
+/* The neighbor the burst is sent to, NULL if we are receiving it */
+static struct tsch_neighbor *burst_neighbor = NULL;
+/* Set by tsch_get_lock(), as the neighbor queues may change while the
+ * lock is held. The slot operation ends the burst at the next timeslot
+ * boundary */
+static volatile uint8_t burst_end_requested = 0;
+
 /* Protothread for association */
 PT_THREAD(tsch_scan(struct pt *pt));
 /* Protothread for slot operation, called from rtimer interrupt
@@ -216,6 +231,8 @@ tsch_get_lock(void)
       busy_wait_time = RTIMER_NOW() - busy_wait_time;
     }
     if(!tsch_locked) {
+      /* Have the slot operation end any burst in progress */
+      burst_end_requested = 1;
       /* Take the lock if it is free */
       tsch_locked = 1;
       tsch_lock_requested = 0;
@@ -246,13 +263,25 @@ tsch_release_lock(void)
 /*---------------------------------------------------------------------------*/
 /* Channel hopping utility functions */
 
+/* Return index in the hopping sequence from ASN and channel offset */
+static uint16_t
+calculate_hopping_index(struct tsch_asn_t *asn, uint8_t channel_offset)
+{
+  uint16_t index_of_0 = TSCH_ASN_MOD(*asn, tsch_hopping_sequence_length);
+  uint16_t index_of_offset = (index_of_0 + channel_offset) % tsch_hopping_sequence_length.val;
+#if TSCH_WITH_CHANNEL_BLACKLIST
+  if(tsch_channel_blacklist & (1 << index_of_offset)) {
+    index_of_offset = tsch_channel_blacklist_substitute(asn, channel_offset);
+  }
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
+  return index_of_offset;
+}
+
 /* Return channel from ASN and channel offset */
 uint8_t
 tsch_calculate_channel(struct tsch_asn_t *asn, uint8_t channel_offset)
 {
-  uint16_t index_of_0 = TSCH_ASN_MOD(*asn, tsch_hopping_sequence_length);
-  uint16_t index_of_offset = (index_of_0 + channel_offset) % tsch_hopping_sequence_length.val;
-  return tsch_hopping_sequence[index_of_offset];
+  return tsch_hopping_sequence[calculate_hopping_index(asn, channel_offset)];
 }
 
 /*---------------------------------------------------------------------------*/
@@ -494,6 +523,8 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
   uint8_t in_queue;
   static int dequeued_index;
   static int packet_ready = 1;
+  /* did we set the frame pending bit? */
+  static uint8_t burst_link_requested;
 
   PT_BEGIN(pt);
 
@@ -538,6 +569,15 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
         packet_ready = 1;
       }
 
+      /* Burst mode: if more frames are queued for this neighbor, announce
+       * them with the frame pending bit */
+      burst_link_requested = 0;
+      if(TSCH_BURST_MAX_LEN > 0 && !is_broadcast) {
+        burst_link_requested = burst_count + 1 < TSCH_BURST_MAX_LEN
+          && tsch_queue_nbr_packet_count(current_neighbor) > 1;
+        tsch_packet_set_frame_pending(packet, packet_len, burst_link_requested);
+      }
+
 #if LLSEC802154_ENABLED
       if(tsch_is_pan_secured) {
         /* If we are going to encrypt, we need to generate the output in a separate buffer and keep
@@ -679,9 +719,18 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                   tsch_schedule_keepalive();
                 }
                 mac_tx_status = MAC_TX_OK;
+                /* The frame pending bit was acknowledged, send the next
+                 * frame in the next timeslot */
+                if(burst_link_requested) {
+                  burst_link_scheduled = 1;
+                  burst_neighbor = current_neighbor;
+                }
               } else {
                 mac_tx_status = MAC_TX_NOACK;
               }
+#if TSCH_WITH_CHANNEL_BLACKLIST
+              TSCH_CHANNEL_STATS_TX(current_hopping_index, mac_tx_status == MAC_TX_OK);
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
             } else {
               mac_tx_status = MAC_TX_OK;
             }
@@ -798,6 +847,12 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
       TSCH_DEBUG_RX_EVENT();
       tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
 
+#if TSCH_WITH_CHANNEL_BLACKLIST
+      if(!NETSTACK_RADIO.pending_packet()) {
+        /* A frame was on the air, but did not make it: count it as lost */
+        TSCH_CHANNEL_STATS_RX(current_hopping_index, 0);
+      }
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
       if(NETSTACK_RADIO.pending_packet()) {
         static int frame_valid;
         static int header_len;
@@ -892,6 +947,14 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
                 TSCH_DEBUG_RX_EVENT();
                 NETSTACK_RADIO.transmit(ack_len);
                 tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
+
+                /* The sender has more frames for us, listen for the next
+                 * one in the next timeslot */
+                if(TSCH_BURST_MAX_LEN > 0 && frame.fcf.frame_pending && !do_nack
+                   && burst_count + 1 < TSCH_BURST_MAX_LEN) {
+                  burst_link_scheduled = 1;
+                  burst_neighbor = NULL;
+                }
               }
             }
 
@@ -910,6 +973,9 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 
             /* Add current input to ringbuf */
             ringbufindex_put(&input_ringbuf);
+#if TSCH_WITH_CHANNEL_BLACKLIST
+            TSCH_CHANNEL_STATS_RX(current_hopping_index, 1);
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
 
             /* Log every reception */
             TSCH_LOG_ADD(tsch_log_rx,
@@ -975,18 +1041,40 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       /* Reset drift correction */
       drift_correction = 0;
       is_drift_correction_used = 0;
-      /* Get a packet ready to be sent */
-      current_packet = get_packet_and_neighbor_for_link(current_link, &current_neighbor);
-      /* There is no packet to send, and this link does not have Rx flag. Instead of doing
-       * nothing, switch to the backup link (has Rx flag) if any. */
-      if(current_packet == NULL && !(current_link->link_options & LINK_OPTION_RX) && backup_link != NULL) {
-        current_link = backup_link;
+      if(burst_count > 0 && burst_end_requested) {
+        /* A burst timeslot scheduled before the burst was ended. It is
+         * not in the schedule, and burst_neighbor may be gone: stay idle */
+        current_neighbor = NULL;
+        current_packet = NULL;
+        is_active_slot = 0;
+      } else if(burst_count > 0) {
+        /* Burst timeslot: send the next frame to the burst neighbor,
+         * or listen for it */
+        current_neighbor = burst_neighbor;
+        current_packet = NULL;
+        if(burst_neighbor != NULL) {
+          current_packet = tsch_queue_get_packet_for_nbr(burst_neighbor, current_link);
+        }
+        is_active_slot = current_packet != NULL || burst_neighbor == NULL;
+      } else {
+        /* Get a packet ready to be sent */
         current_packet = get_packet_and_neighbor_for_link(current_link, &current_neighbor);
+        /* There is no packet to send, and this link does not have Rx flag. Instead of doing
+         * nothing, switch to the backup link (has Rx flag) if any. The Tx flag only gave
+         * this link precedence for a transmission: without one, listen on the link with
+         * the lowest handle, as the neighbor that picked it expects. */
+        if(current_packet == NULL && backup_link != NULL
+           && (!(current_link->link_options & LINK_OPTION_RX)
+               || backup_link->slotframe_handle < current_link->slotframe_handle)) {
+          current_link = backup_link;
+          current_packet = get_packet_and_neighbor_for_link(current_link, &current_neighbor);
+        }
+        is_active_slot = current_packet != NULL || (current_link->link_options & LINK_OPTION_RX);
       }
-      is_active_slot = current_packet != NULL || (current_link->link_options & LINK_OPTION_RX);
       if(is_active_slot) {
         /* Hop channel */
-        current_channel = tsch_calculate_channel(&tsch_current_asn, current_link->channel_offset);
+        current_hopping_index = calculate_hopping_index(&tsch_current_asn, current_link->channel_offset);
+        current_channel = tsch_hopping_sequence[current_hopping_index];
         NETSTACK_RADIO.set_value(RADIO_PARAM_CHANNEL, current_channel);
         /* Turn the radio on already here if configured so; necessary for radios with slow startup */
         tsch_radio_on(TSCH_RADIO_CMD_ON_START_OF_TIMESLOT);
@@ -1032,6 +1120,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       /* Schedule next wakeup skipping slots if missed deadline */
       do {
         if(current_link != NULL
+            && burst_count == 0
             && current_link->link_options & LINK_OPTION_TX
             && current_link->link_options & LINK_OPTION_SHARED) {
           /* Decrement the backoff window for all neighbors able to transmit over
@@ -1039,12 +1128,25 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
           tsch_queue_update_all_backoff_windows(&current_link->addr);
         }
 
-        /* Get next active link */
-        current_link = tsch_schedule_get_next_active_link(&tsch_current_asn, &timeslot_diff, &backup_link);
-        if(current_link == NULL) {
-          /* There is no next link. Fall back to default
-           * behavior: wake up at the next slot. */
+        if(burst_end_requested) {
+          burst_end_requested = 0;
+          burst_link_scheduled = 0;
+        }
+        if(burst_link_scheduled && current_link != NULL) {
+          /* A burst is going on: replay the current link in the next timeslot */
+          burst_link_scheduled = 0;
+          burst_count++;
           timeslot_diff = 1;
+          backup_link = NULL;
+        } else {
+          burst_count = 0;
+          /* Get next active link */
+          current_link = tsch_schedule_get_next_active_link(&tsch_current_asn, &timeslot_diff, &backup_link);
+          if(current_link == NULL) {
+            /* There is no next link. Fall back to default
+             * behavior: wake up at the next slot. */
+            timeslot_diff = 1;
+          }
         }
         /* Update ASN */
         TSCH_ASN_INC(tsch_current_asn, timeslot_diff);
@@ -1103,5 +1205,8 @@ tsch_slot_operation_sync(rtimer_clock_t next_slot_start,
   tsch_current_asn = *next_slot_asn;
   last_sync_asn = tsch_current_asn;
   current_link = NULL;
+  burst_link_scheduled = 0;
+  burst_count = 0;
+  burst_end_requested = 0;
 }
 /*---------------------------------------------------------------------------*/
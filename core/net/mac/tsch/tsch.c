@@ -54,7 +54,11 @@
 #include "net/mac/tsch/tsch-log.h"
 #include "net/mac/tsch/tsch-packet.h"
 #include "net/mac/tsch/tsch-security.h"
+#include "net/mac/tsch/tsch-channel-blacklist.h"
 #include "net/mac/mac-sequence.h"
+#if TSCH_WITH_SIXTOP
+#include "net/mac/tsch/sixtop/sixtop.h"
+#endif
 #include "lib/random.h"
 
 #if FRAME802154_VERSION < FRAME802154_IEEE802154E_2012
@@ -332,6 +336,14 @@ eb_input(struct input_packet *current_input)
         }
 #endif /* TSCH_AUTOSELECT_TIME_SOURCE */
       }
+
+#if TSCH_WITH_CHANNEL_BLACKLIST
+      /* Follow the channel blacklist of our time source */
+      if(eb_ies.ie_channel_blacklist_present) {
+        tsch_channel_blacklist_set(eb_ies.ie_channel_blacklist_seqnum,
+                                   eb_ies.ie_channel_blacklist);
+      }
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
     }
   }
 }
@@ -383,6 +395,12 @@ tsch_tx_process_pending()
     struct tsch_packet *p = dequeued_array[dequeued_index];
     /* Put packet into packetbuf for packet_sent callback */
     queuebuf_to_packetbuf(p->qb);
+#ifdef TSCH_CALLBACK_PACKET_SENT
+    TSCH_CALLBACK_PACKET_SENT(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), p->ret, p->transmissions);
+#endif
+#if TSCH_WITH_SIXTOP
+    sixtop_packet_sent(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), p->ret, p->transmissions);
+#endif
     /* Call packet_sent callback */
     mac_call_sent_callback(p->sent, p->ptr, p->ret, p->transmissions);
     /* Free packet queuebuf */
@@ -402,6 +420,9 @@ tsch_start_coordinator(void)
   /* Initialize hopping sequence as default */
   memcpy(tsch_hopping_sequence, TSCH_DEFAULT_HOPPING_SEQUENCE, sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE));
   TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE));
+#if TSCH_WITH_CHANNEL_BLACKLIST
+  tsch_channel_blacklist_reset();
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
 #if TSCH_SCHEDULE_WITH_6TISCH_MINIMAL
   tsch_schedule_create_minimal();
 #endif
@@ -505,6 +526,15 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
     }
   }
 
+#if TSCH_WITH_CHANNEL_BLACKLIST
+  /* Channel blacklist, to be followed by every node of the network */
+  tsch_channel_blacklist_reset();
+  if(ies.ie_channel_blacklist_present) {
+    tsch_channel_blacklist_set(ies.ie_channel_blacklist_seqnum,
+                               ies.ie_channel_blacklist);
+  }
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
+
 #if TSCH_CHECK_TIME_AT_ASSOCIATION > 0
   /* Divide by 4k and multiply again to avoid integer overflow */
   uint32_t expected_asn = 4096 * TSCH_CLOCK_TO_SLOTS(clock_time() / 4096, tsch_timing_timeslot_length); /* Expected ASN based on our current time*/
@@ -730,6 +760,14 @@ PROCESS_THREAD(tsch_send_eb_process, ev, data)
   while(1) {
     unsigned long delay;
 
+#if TSCH_WITH_CHANNEL_BLACKLIST
+    if(tsch_is_associated) {
+      /* Once per EB period, update the blacklist (PAN coordinator) and age
+       * the channel statistics */
+      tsch_channel_blacklist_update();
+    }
+#endif /* TSCH_WITH_CHANNEL_BLACKLIST */
+
     if(tsch_is_associated && tsch_current_eb_period > 0) {
       /* Enqueue EB only if there isn't already one in queue */
       if(tsch_queue_packet_count(&tsch_eb_address) == 0) {
@@ -849,6 +887,9 @@ tsch_init(void)
   tsch_queue_init();
   tsch_schedule_init();
   tsch_log_init();
+#if TSCH_WITH_SIXTOP
+  sixtop_init();
+#endif
   ringbufindex_init(&input_ringbuf, TSCH_MAX_INCOMING_PACKETS);
   ringbufindex_init(&dequeued_ringbuf, TSCH_DEQUEUED_ARRAY_SIZE);
 
@@ -898,6 +939,10 @@ send_packet(mac_callback_t sent, void *ptr)
   }
 
   packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_DATAFRAME);
+  /* The frame pending bit is TSCH's own, set by the slot operation when it
+   * holds a burst link. Do not let the upper layers set it (sicslowpan does
+   * for fragment trains), even more so with bursts disabled */
+  packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 0);
 
 #if LLSEC802154_ENABLED
   if(tsch_is_pan_secured) {
@@ -940,26 +985,6 @@ send_packet(mac_callback_t sent, void *ptr)
              tsch_queue_packet_count(addr),
              p->header_len,
              queuebuf_datalen(p->qb));
-
-        /**debug test**/
-#if 0
-        int i;
-        int dataLen=queuebuf_datalen(p->qb);
-        //int headLen=p->header_len;
-        for(i=0;i<dataLen;i++){
-          uint8_t data=((uint8_t *)queuebuf_dataptr(p->qb))[i];
-          PRINTF("%02x ",data);
-        }
-
-        if( ((uint8_t *)queuebuf_dataptr(p->qb))[65] == 0x54 &&  //find the flags.
-            ((uint8_t *)queuebuf_dataptr(p->qb))[66] == 0x66) { //check coap have created packet, if will, print it.
-
-          uint8_t data=((uint8_t *)queuebuf_dataptr(p->qb))[24]; //24 is tcflow in queuebuf location.
-          PRINTF("\nTraffic classes In TSCH queue : %02x\n", data);
-        }
-        PRINTF("\n");
-#endif
-        
       (void)packet_count_before; /* Discard "variable set but unused" warning in case of TSCH_LOG_LEVEL of 0 */
     }
   }
@@ -998,6 +1023,16 @@ packet_input(void)
       PRINTF("TSCH: received from %u with seqno %u\n",
              TSCH_LOG_ID_FROM_LINKADDR(packetbuf_addr(PACKETBUF_ADDR_SENDER)),
              packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO));
+#ifdef TSCH_CALLBACK_PACKET_RECEIVED
+      TSCH_CALLBACK_PACKET_RECEIVED(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                                    packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+#endif
+#if TSCH_WITH_SIXTOP
+      if(sixtop_input()) {
+        /* A 6P message, not for the upper layers */
+        return;
+      }
+#endif
       NETSTACK_LLSEC.input();
     }
   }
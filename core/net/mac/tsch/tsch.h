@@ -157,6 +157,16 @@ void TSCH_CALLBACK_JOINING_NETWORK();
 void TSCH_CALLBACK_LEAVING_NETWORK();
 #endif
 
+/* Called by TSCH for every packet leaving the Tx queue, i.e. sent or dropped */
+#ifdef TSCH_CALLBACK_PACKET_SENT
+void TSCH_CALLBACK_PACKET_SENT(const linkaddr_t *dest, int status, int transmissions);
+#endif
+
+/* Called by TSCH for every data frame received, duplicates excluded */
+#ifdef TSCH_CALLBACK_PACKET_RECEIVED
+void TSCH_CALLBACK_PACKET_RECEIVED(const linkaddr_t *src, const linkaddr_t *dest);
+#endif
+
 /***** External Variables *****/
 
 /* Are we coordinator of the TSCH network? */
@@ -38,6 +38,7 @@
 #include <string.h>
 #include "lib/memb.h"
 #include "lib/list.h"
+#include "lib/hashindex.h"
 #include "net/nbr-table.h"
 
 #define DEBUG 0
@@ -83,6 +84,15 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_WITH_HASH
+#if NBR_TABLE_HASH_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error NBR_TABLE_CONF_HASH_SIZE must be larger than NBR_TABLE_MAX_NEIGHBORS
+#endif
+/* Keys by link-layer address */
+HASHINDEX(key_index, NBR_TABLE_HASH_SIZE,
+          offsetof(nbr_table_key_t, lladdr), LINKADDR_SIZE);
+#endif /* NBR_TABLE_WITH_HASH */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -136,6 +146,12 @@ index_from_lladdr(const linkaddr_t *lladdr)
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_WITH_HASH
+  key = hashindex_lookup(&key_index, lladdr);
+  if(key != NULL) {
+    return index_from_key(key);
+  }
+#else /* NBR_TABLE_WITH_HASH */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -143,6 +159,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     }
     key = list_item_next(key);
   }
+#endif /* NBR_TABLE_WITH_HASH */
   return -1;
 }
 /*---------------------------------------------------------------------------*/
@@ -195,6 +212,9 @@ remove_key(nbr_table_key_t *least_used_key)
   used_map[index_from_key(least_used_key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_WITH_HASH
+  hashindex_remove(&key_index, least_used_key);
+#endif /* NBR_TABLE_WITH_HASH */
 }
 /*---------------------------------------------------------------------------*/
 static nbr_table_key_t *
@@ -359,6 +379,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_rea
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_WITH_HASH
+    hashindex_add(&key_index, key);
+#endif /* NBR_TABLE_WITH_HASH */
   }
 
   /* Get item in the current table */
@@ -446,11 +469,17 @@ nbr_table_update_lladdr(const linkaddr_t *old_addr, const linkaddr_t *new_addr,
     return 0;
   }
   key = key_from_index(index);
+#if NBR_TABLE_WITH_HASH
+  hashindex_remove(&key_index, key);
+#endif /* NBR_TABLE_WITH_HASH */
   /**
    * Copy the new lladdr into the key - since we know that there is no
    * conflicting entry.
    */
   memcpy(&key->lladdr, new_addr, sizeof(linkaddr_t));
+#if NBR_TABLE_WITH_HASH
+  hashindex_add(&key_index, key);
+#endif /* NBR_TABLE_WITH_HASH */
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -322,11 +322,26 @@ count_matching_bytes(const void *p1, const void *p2, size_t n)
   return n;
 }
 /*---------------------------------------------------------------------------*/
+static void
+add_ext_len(uint8_t ext_len)
+{
+  uint8_t temp_len;
+
+  /* In-place update of IPv6 length field */
+  temp_len = UIP_IP_BUF->len[1];
+  UIP_IP_BUF->len[1] += ext_len;
+  if(UIP_IP_BUF->len[1] < temp_len) {
+    UIP_IP_BUF->len[0]++;
+  }
+
+  uip_ext_len += ext_len;
+  uip_len += ext_len;
+}
+/*---------------------------------------------------------------------------*/
 static int
 insert_srh_header(void)
 {
   /* Implementation of RFC6554 */
-  uint8_t temp_len;
   uint8_t path_len;
   uint8_t ext_len;
   uint8_t cmpri, cmpre; /* ComprI and ComprE fields of the RPL Source Routing Header */
@@ -337,6 +352,9 @@ insert_srh_header(void)
   rpl_ns_node_t *node;
   rpl_dag_t *dag;
   uip_ipaddr_t node_addr;
+#if RPL_NS_SRH_CACHE_NUM
+  rpl_ns_srh_t *srh;
+#endif /* RPL_NS_SRH_CACHE_NUM */
 
   PRINTF("RPL: SRH creating source routing header with destination ");
   PRINT6ADDR(&UIP_IP_BUF->destipaddr);
@@ -369,6 +387,26 @@ insert_srh_header(void)
     return 0;
   }
 
+#if RPL_NS_SRH_CACHE_NUM
+  /* Only once the path is known to be valid, as for a new header */
+  srh = rpl_ns_srh_lookup(dest_node);
+  if(srh != NULL) {
+    PRINTF("RPL: SRH from cache, ext len %u\n", srh->len);
+    if(uip_len + srh->len > UIP_BUFSIZE) {
+      PRINTF("RPL: Packet too long: impossible to add source routing header (%u bytes)\n", srh->len);
+      return 1;
+    }
+    memmove(uip_buf + uip_l2_l3_hdr_len + srh->len,
+        uip_buf + uip_l2_l3_hdr_len, uip_len - UIP_IPH_LEN);
+    memcpy(UIP_RH_BUF, srh->hdr, srh->len);
+    UIP_RH_BUF->next = UIP_IP_BUF->proto;
+    UIP_IP_BUF->proto = UIP_PROTO_ROUTING;
+    rpl_ns_get_node_global_addr(&UIP_IP_BUF->destipaddr, srh->next_hop);
+    add_ext_len(srh->len);
+    return 1;
+  }
+#endif /* RPL_NS_SRH_CACHE_NUM */
+
   /* Compute path length and compression factors (we use cmpri == cmpre) */
   path_len = 0;
   node = dest_node->parent;
@@ -445,19 +483,15 @@ insert_srh_header(void)
     node = node->parent;
   }
 
+#if RPL_NS_SRH_CACHE_NUM
+  rpl_ns_srh_add(dest_node, node, (uint8_t *)UIP_RH_BUF, ext_len);
+#endif /* RPL_NS_SRH_CACHE_NUM */
+
   /* The next hop (i.e. node whose parent is the root) is placed as the current IPv6 destination */
   rpl_ns_get_node_global_addr(&node_addr, node);
   uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &node_addr);
 
-  /* In-place update of IPv6 length field */
-  temp_len = UIP_IP_BUF->len[1];
-  UIP_IP_BUF->len[1] += ext_len;
-  if(UIP_IP_BUF->len[1] < temp_len) {
-    UIP_IP_BUF->len[0]++;
-  }
-
-  uip_ext_len += ext_len;
-  uip_len += ext_len;
+  add_ext_len(ext_len);
 
   return 1;
 }
@@ -47,6 +47,7 @@
 #include "net/rpl/rpl-ns.h"
 #include "lib/list.h"
 #include "lib/memb.h"
+#include "lib/hashindex.h"
 
 #if RPL_WITH_NON_STORING
 
@@ -54,6 +55,7 @@
 #include "net/ip/uip-debug.h"
 
 #include <limits.h>
+#include <stddef.h>
 #include <string.h>
 
 /* Total number of nodes */
@@ -63,6 +65,21 @@ static int num_nodes;
 LIST(nodelist);
 MEMB(nodememb, rpl_ns_node_t, RPL_NS_LINK_NUM);
 
+#if RPL_NS_WITH_HASH
+#if RPL_NS_HASH_SIZE <= RPL_NS_LINK_NUM
+#error "RPL_NS_CONF_HASH_SIZE must be greater than RPL_NS_CONF_LINK_NUM"
+#endif
+
+/* Nodes by link identifier */
+HASHINDEX(node_index, RPL_NS_HASH_SIZE,
+          offsetof(rpl_ns_node_t, link_identifier), 8);
+#endif /* RPL_NS_WITH_HASH */
+
+#if RPL_NS_SRH_CACHE_NUM
+/* Source routing headers, direct mapped by node */
+static rpl_ns_srh_t srh_cache[RPL_NS_SRH_CACHE_NUM];
+#endif /* RPL_NS_SRH_CACHE_NUM */
+
 /*---------------------------------------------------------------------------*/
 int
 rpl_ns_num_nodes(void)
@@ -81,16 +98,83 @@ node_matches_address(const rpl_dag_t *dag, const rpl_ns_node_t *node, const uip_
       && !memcmp(((const unsigned char *)addr) + 8, node->link_identifier, 8);
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_NS_SRH_CACHE_NUM
+static rpl_ns_srh_t *
+srh_slot(const rpl_ns_node_t *node)
+{
+  return &srh_cache[memb_index(&nodememb, (void *)node) % RPL_NS_SRH_CACHE_NUM];
+}
+/*---------------------------------------------------------------------------*/
+/* Drop the cached headers of all destinations whose path goes through
+   a node. Only the parent of that node has changed, so the path from
+   each destination up to it is the same as when the header was built. */
+static void
+srh_invalidate(const rpl_ns_node_t *node)
+{
+  rpl_ns_srh_t *srh;
+  const rpl_ns_node_t *n;
+  int max_depth;
+
+  for(srh = srh_cache; srh < &srh_cache[RPL_NS_SRH_CACHE_NUM]; srh++) {
+    max_depth = RPL_NS_LINK_NUM;
+    for(n = srh->dest; n != NULL && max_depth > 0; n = n->parent) {
+      if(n == node) {
+        srh->dest = NULL;
+        break;
+      }
+      max_depth--;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+rpl_ns_srh_t *
+rpl_ns_srh_lookup(const rpl_ns_node_t *dest)
+{
+  rpl_ns_srh_t *srh = srh_slot(dest);
+
+  return srh->dest == dest ? srh : NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_srh_add(rpl_ns_node_t *dest, rpl_ns_node_t *next_hop,
+               const uint8_t *hdr, uint8_t len)
+{
+  rpl_ns_srh_t *srh;
+
+  if(len <= RPL_NS_SRH_CACHE_LEN) {
+    srh = srh_slot(dest);
+    srh->dest = dest;
+    srh->next_hop = next_hop;
+    srh->len = len;
+    memcpy(srh->hdr, hdr, len);
+  }
+}
+#endif /* RPL_NS_SRH_CACHE_NUM */
+/*---------------------------------------------------------------------------*/
 rpl_ns_node_t *
 rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
 {
   rpl_ns_node_t *l;
+#if RPL_NS_WITH_HASH
+  int slot = -1;
+
+  if(addr == NULL) {
+    return NULL;
+  }
+  while((l = hashindex_lookup_next(&node_index, &addr->u8[8],
+                                   &slot)) != NULL) {
+    if(node_matches_address(dag, l, addr)) {
+      return l;
+    }
+  }
+#else /* RPL_NS_WITH_HASH */
   for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
     /* Compare prefix and node identifier */
     if(node_matches_address(dag, l, addr)) {
       return l;
     }
   }
+#endif /* RPL_NS_WITH_HASH */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -142,14 +226,20 @@ rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t
       return NULL;
     }
     child_node->parent = NULL;
+    memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
     list_add(nodelist, child_node);
+#if RPL_NS_WITH_HASH
+    hashindex_add(&node_index, child_node);
+#endif /* RPL_NS_WITH_HASH */
     num_nodes++;
   }
 
   /* Initialize node */
   child_node->dag = dag;
   child_node->lifetime = lifetime;
-  memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
+#if RPL_NS_SRH_CACHE_NUM
+  old_parent_node = child_node->parent;
+#endif /* RPL_NS_SRH_CACHE_NUM */
 
   /* Is the node reachable before the update? */
   if(rpl_ns_is_node_reachable(dag, child)) {
@@ -167,6 +257,12 @@ rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t
     child_node->parent = parent_node;
   }
 
+#if RPL_NS_SRH_CACHE_NUM
+  if(child_node->parent != old_parent_node) {
+    srh_invalidate(child_node);
+  }
+#endif /* RPL_NS_SRH_CACHE_NUM */
+
   return child_node;
 }
 /*---------------------------------------------------------------------------*/
@@ -176,6 +272,12 @@ rpl_ns_init(void)
   num_nodes = 0;
   memb_init(&nodememb);
   list_init(nodelist);
+#if RPL_NS_WITH_HASH
+  hashindex_init(&node_index);
+#endif /* RPL_NS_WITH_HASH */
+#if RPL_NS_SRH_CACHE_NUM
+  memset(srh_cache, 0, sizeof(srh_cache));
+#endif /* RPL_NS_SRH_CACHE_NUM */
 }
 /*---------------------------------------------------------------------------*/
 rpl_ns_node_t *
@@ -203,6 +305,7 @@ void
 rpl_ns_periodic(void)
 {
   rpl_ns_node_t *l;
+  rpl_ns_node_t *next;
   /* First pass, decrement lifetime for all nodes with non-infinite lifetime */
   for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
     /* Don't touch infinite lifetime nodes */
@@ -211,7 +314,8 @@ rpl_ns_periodic(void)
     }
   }
   /* Second pass, for all expire nodes, deallocate them iff no child points to them */
-  for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+  for(l = list_head(nodelist); l != NULL; l = next) {
+    next = list_item_next(l);
     if(l->lifetime == 0) {
       rpl_ns_node_t *l2;
       for(l2 = list_head(nodelist); l2 != NULL; l2 = list_item_next(l2)) {
@@ -220,9 +324,17 @@ rpl_ns_periodic(void)
         }
       }
       /* No child found, deallocate node */
-      list_remove(nodelist, l);
-      memb_free(&nodememb, l);
-      num_nodes--;
+      if(l2 == NULL) {
+#if RPL_NS_WITH_HASH
+        hashindex_remove(&node_index, l);
+#endif /* RPL_NS_WITH_HASH */
+#if RPL_NS_SRH_CACHE_NUM
+        srh_invalidate(l);
+#endif /* RPL_NS_SRH_CACHE_NUM */
+        list_remove(nodelist, l);
+        memb_free(&nodememb, l);
+        num_nodes--;
+      }
     }
   }
 }
@@ -49,6 +49,38 @@
 #define RPL_NS_LINK_NUM 32
 #endif /* RPL_NS_CONF_LINK_NUM */
 
+/* RPL_NS_CONF_WITH_HASH indexes the nodes by link identifier, so that
+   rpl_ns_get_node() does not iterate over all nodes. The index is an
+   open addressing hash table of RPL_NS_CONF_HASH_SIZE pointers. */
+#ifdef RPL_NS_CONF_WITH_HASH
+#define RPL_NS_WITH_HASH RPL_NS_CONF_WITH_HASH
+#else /* RPL_NS_CONF_WITH_HASH */
+#define RPL_NS_WITH_HASH 0
+#endif /* RPL_NS_CONF_WITH_HASH */
+
+#ifdef RPL_NS_CONF_HASH_SIZE
+#define RPL_NS_HASH_SIZE RPL_NS_CONF_HASH_SIZE
+#else /* RPL_NS_CONF_HASH_SIZE */
+#define RPL_NS_HASH_SIZE (2 * RPL_NS_LINK_NUM)
+#endif /* RPL_NS_CONF_HASH_SIZE */
+
+/* Number of source routing headers cached at the root, 0 to disable
+   the cache. A header is cached per destination and reused, as long
+   as the destination is reachable, until a node on its path changes
+   parent. Headers longer than
+   RPL_NS_CONF_SRH_CACHE_LEN bytes are built for every packet. */
+#ifdef RPL_NS_CONF_SRH_CACHE_NUM
+#define RPL_NS_SRH_CACHE_NUM RPL_NS_CONF_SRH_CACHE_NUM
+#else /* RPL_NS_CONF_SRH_CACHE_NUM */
+#define RPL_NS_SRH_CACHE_NUM 0
+#endif /* RPL_NS_CONF_SRH_CACHE_NUM */
+
+#ifdef RPL_NS_CONF_SRH_CACHE_LEN
+#define RPL_NS_SRH_CACHE_LEN RPL_NS_CONF_SRH_CACHE_LEN
+#else /* RPL_NS_CONF_SRH_CACHE_LEN */
+#define RPL_NS_SRH_CACHE_LEN 64
+#endif /* RPL_NS_CONF_SRH_CACHE_LEN */
+
 typedef struct rpl_ns_node {
   struct rpl_ns_node *next;
   uint32_t lifetime;
@@ -58,6 +90,17 @@ typedef struct rpl_ns_node {
   struct rpl_ns_node *parent;
 } rpl_ns_node_t;
 
+/* A source routing header built for a destination */
+typedef struct rpl_ns_srh {
+  /* The destination, NULL if the entry is unused */
+  rpl_ns_node_t *dest;
+  /* The first hop, which goes in the IPv6 destination address */
+  rpl_ns_node_t *next_hop;
+  /* Routing header and RPL source routing header, including padding */
+  uint8_t len;
+  uint8_t hdr[RPL_NS_SRH_CACHE_LEN];
+} rpl_ns_srh_t;
+
 int rpl_ns_num_nodes(void);
 void rpl_ns_expire_parent(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t *parent);
 rpl_ns_node_t *rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t *parent, uint32_t lifetime);
@@ -68,5 +111,10 @@ rpl_ns_node_t *rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
 int rpl_ns_is_node_reachable(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
 void rpl_ns_get_node_global_addr(uip_ipaddr_t *addr, rpl_ns_node_t *node);
 void rpl_ns_periodic(void);
+#if RPL_NS_SRH_CACHE_NUM
+rpl_ns_srh_t *rpl_ns_srh_lookup(const rpl_ns_node_t *dest);
+void rpl_ns_srh_add(rpl_ns_node_t *dest, rpl_ns_node_t *next_hop,
+                    const uint8_t *hdr, uint8_t len);
+#endif /* RPL_NS_SRH_CACHE_NUM */
 
 #endif /* RPL_NS_H */
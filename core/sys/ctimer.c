@@ -45,6 +45,7 @@
 #include "sys/ctimer.h"
 #include "contiki.h"
 #include "lib/list.h"
+#include <stddef.h>
 
 LIST(ctimer_list);
 
@@ -58,6 +59,17 @@ static char initialized;
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+static void
+add_to_list(struct ctimer *c)
+{
+#if ETIMER_WITH_WHEEL
+  if(initialized) {
+    return;
+  }
+#endif /* ETIMER_WITH_WHEEL */
+  list_add(ctimer_list, c);
+}
 /*---------------------------------------------------------------------------*/
 PROCESS(ctimer_process, "Ctimer process");
 PROCESS_THREAD(ctimer_process, ev, data)
@@ -69,9 +81,27 @@ PROCESS_THREAD(ctimer_process, ev, data)
     etimer_set(&c->etimer, c->etimer.timer.interval);
   }
   initialized = 1;
+#if ETIMER_WITH_WHEEL
+  /* From now on the etimers keep track of the pending callback
+     timers, the list is only needed before initialization. */
+  list_init(ctimer_list);
+#endif /* ETIMER_WITH_WHEEL */
 
   while(1) {
     PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_TIMER);
+#if ETIMER_WITH_WHEEL
+    c = (struct ctimer *)((char *)data - offsetof(struct ctimer, etimer));
+    /* Ignore the event if the timer has been stopped or set again
+       after it fired. */
+    if(c->etimer.slot == ETIMER_SLOT_FIRED) {
+      c->etimer.slot = ETIMER_SLOT_NONE;
+      PROCESS_CONTEXT_BEGIN(c->p);
+      if(c->f != NULL) {
+	c->f(c->ptr);
+      }
+      PROCESS_CONTEXT_END(c->p);
+    }
+#else /* ETIMER_WITH_WHEEL */
     for(c = list_head(ctimer_list); c != NULL; c = c->next) {
       if(&c->etimer == data) {
 	list_remove(ctimer_list, c);
@@ -83,6 +113,7 @@ PROCESS_THREAD(ctimer_process, ev, data)
 	break;
       }
     }
+#endif /* ETIMER_WITH_WHEEL */
   }
   PROCESS_END();
 }
@@ -118,7 +149,7 @@ ctimer_set_with_process(struct ctimer *c, clock_time_t t,
     c->etimer.timer.interval = t;
   }
 
-  list_add(ctimer_list, c);
+  add_to_list(c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -130,7 +161,7 @@ ctimer_reset(struct ctimer *c)
     PROCESS_CONTEXT_END(&ctimer_process);
   }
 
-  list_add(ctimer_list, c);
+  add_to_list(c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -142,7 +173,7 @@ ctimer_restart(struct ctimer *c)
     PROCESS_CONTEXT_END(&ctimer_process);
   }
 
-  list_add(ctimer_list, c);
+  add_to_list(c);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -49,10 +49,352 @@
 #include "sys/etimer.h"
 #include "sys/process.h"
 
-static struct etimer *timerlist;
 static clock_time_t next_expiration;
 
 PROCESS(etimer_process, "Event timer");
+
+#if ETIMER_WITH_WHEEL
+/*
+ * The wheel has ETIMER_WHEEL_LEVELS levels of 32 slots each. Level 0
+ * slots are one clock tick wide, each level above is 32 times coarser.
+ * A timer is put on the lowest level that can hold its expiration
+ * time, and moved down ("cascaded") when the lower level wraps
+ * around. Timers too far in the future for the top level are parked
+ * in its last slot and put back when that slot is cascaded.
+ */
+#ifdef ETIMER_CONF_WHEEL_LEVELS
+#define ETIMER_WHEEL_LEVELS ETIMER_CONF_WHEEL_LEVELS
+#else /* ETIMER_CONF_WHEEL_LEVELS */
+#define ETIMER_WHEEL_LEVELS 4
+#endif /* ETIMER_CONF_WHEEL_LEVELS */
+
+#if ETIMER_WHEEL_LEVELS > 6
+#error ETIMER_CONF_WHEEL_LEVELS must not be larger than 6
+#endif
+
+#define WHEEL_BITS  5
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK  (WHEEL_SLOTS - 1)
+#define WHEEL_SHIFT(level) (WHEEL_BITS * (level))
+#define WHEEL_RANGE (1UL << WHEEL_SHIFT(ETIMER_WHEEL_LEVELS))
+
+/* Largest clock difference that is still considered to be in the future */
+#define CLOCK_HALF ((clock_time_t)((clock_time_t)-1 >> 1))
+
+static struct etimer *wheel[ETIMER_WHEEL_LEVELS][WHEEL_SLOTS];
+/* One bit per non-empty slot */
+static unsigned long wheel_used[ETIMER_WHEEL_LEVELS];
+/* The next clock tick to process */
+static clock_time_t wheel_time;
+static unsigned int wheel_count;
+
+/*---------------------------------------------------------------------------*/
+static unsigned char
+slot_index(clock_time_t t, unsigned char level)
+{
+  return ((unsigned long)t >> WHEEL_SHIFT(level)) & WHEEL_MASK;
+}
+/*---------------------------------------------------------------------------*/
+/* Link a timer into the wheel slot that matches its expiration time
+   and return the earliest time at which that slot is processed. */
+static clock_time_t
+wheel_place(struct etimer *t)
+{
+  clock_time_t expires;
+  clock_time_t delta;
+  unsigned char level;
+  unsigned char index;
+
+  expires = t->timer.start + t->timer.interval;
+  delta = expires - wheel_time;
+  if(delta > CLOCK_HALF) {
+    /* Already expired, fire on the next tick. */
+    expires = wheel_time;
+    delta = 0;
+  } else if((unsigned long)delta >= WHEEL_RANGE) {
+    expires = wheel_time + (clock_time_t)(WHEEL_RANGE - 1);
+    delta = (clock_time_t)(WHEEL_RANGE - 1);
+  }
+
+  for(level = 0; level < ETIMER_WHEEL_LEVELS - 1; level++) {
+    if((unsigned long)delta < (1UL << WHEEL_SHIFT(level + 1))) {
+      break;
+    }
+  }
+  index = slot_index(expires, level);
+
+  t->slot = level * WHEEL_SLOTS + index;
+  t->prev = NULL;
+  t->next = wheel[level][index];
+  if(t->next != NULL) {
+    t->next->prev = t;
+  }
+  wheel[level][index] = t;
+  wheel_used[level] |= 1UL << index;
+
+  return (clock_time_t)(((unsigned long)expires >> WHEEL_SHIFT(level))
+                        << WHEEL_SHIFT(level));
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_unlink(struct etimer *t)
+{
+  unsigned char level = t->slot / WHEEL_SLOTS;
+  unsigned char index = t->slot % WHEEL_SLOTS;
+
+  if(t->prev != NULL) {
+    t->prev->next = t->next;
+  } else {
+    wheel[level][index] = t->next;
+    if(t->next == NULL) {
+      wheel_used[level] &= ~(1UL << index);
+    }
+  }
+  if(t->next != NULL) {
+    t->next->prev = t->prev;
+  }
+  t->next = t->prev = NULL;
+  t->slot = ETIMER_SLOT_NONE;
+  wheel_count--;
+}
+/*---------------------------------------------------------------------------*/
+/* The slot of a timer is only a hint: a timer that was never set, or
+   was reused without etimer_stop(), may hold any value there. Look
+   for the timer in the chain of that slot, without following any of
+   its own links. */
+static int
+wheel_contains(struct etimer *t)
+{
+  struct etimer *n;
+
+  if(t->slot >= ETIMER_WHEEL_LEVELS * WHEEL_SLOTS) {
+    return 0;
+  }
+  for(n = wheel[t->slot / WHEEL_SLOTS][t->slot % WHEEL_SLOTS];
+      n != NULL; n = n->next) {
+    if(n == t) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Move the timers of the slots that wheel_time has just entered down
+   to the lower levels. */
+static void
+cascade(void)
+{
+  struct etimer *t, *next;
+  unsigned char level;
+  unsigned char index;
+
+  for(level = 1; level < ETIMER_WHEEL_LEVELS; level++) {
+    index = slot_index(wheel_time, level);
+    t = wheel[level][index];
+    wheel[level][index] = NULL;
+    wheel_used[level] &= ~(1UL << index);
+    for(; t != NULL; t = next) {
+      next = t->next;
+      wheel_place(t);
+    }
+    if(index != 0) {
+      break;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Compute a lower bound of the next expiration time from the first
+   non-empty slot of each level. Timers on the upper levels may
+   expire later than the bound, which only costs an early poll. */
+static void
+update_time(void)
+{
+  clock_time_t bound;
+  clock_time_t earliest;
+  unsigned char level;
+  unsigned char current;
+  unsigned char offset;
+  unsigned char i;
+  unsigned char found;
+
+  if(wheel_count == 0) {
+    next_expiration = 0;
+    return;
+  }
+
+  found = 0;
+  earliest = 0;
+  for(level = 0; level < ETIMER_WHEEL_LEVELS; level++) {
+    if(wheel_used[level] == 0) {
+      continue;
+    }
+    /* Unless wheel_time is at its start, the current slot of the
+       upper levels has already been cascaded, so anything left there
+       is a full turn ahead. */
+    current = slot_index(wheel_time, level);
+    offset = 0;
+    if(((unsigned long)wheel_time & ((1UL << WHEEL_SHIFT(level)) - 1)) != 0) {
+      offset = 1;
+    }
+    for(i = offset; i < WHEEL_SLOTS + offset; i++) {
+      if(wheel_used[level] & (1UL << ((current + i) & WHEEL_MASK))) {
+        break;
+      }
+    }
+    bound = (clock_time_t)((((unsigned long)wheel_time >> WHEEL_SHIFT(level)) + i)
+                           << WHEEL_SHIFT(level));
+    if(!found || (clock_time_t)(bound - earliest) > CLOCK_HALF) {
+      earliest = bound;
+      found = 1;
+    }
+  }
+  next_expiration = earliest;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_wheel(void)
+{
+  struct etimer *t;
+  clock_time_t now;
+  unsigned char index;
+  unsigned char next;
+
+  now = clock_time();
+  while((clock_time_t)(now - wheel_time) <= CLOCK_HALF) {
+    index = wheel_time & WHEEL_MASK;
+    if(index == 0) {
+      cascade();
+    }
+
+    while((t = wheel[0][index]) != NULL) {
+      if(process_post(t->p, PROCESS_EVENT_TIMER, t) != PROCESS_ERR_OK) {
+        /* The event queue is full, try again later. */
+        etimer_request_poll();
+        update_time();
+        return;
+      }
+      wheel_unlink(t);
+      /* Reset the process ID of the event timer, to signal that the
+         etimer has expired. This is later checked in the
+         etimer_expired() function. */
+      t->p = PROCESS_NONE;
+      t->slot = ETIMER_SLOT_FIRED;
+    }
+
+    if(wheel_count == 0) {
+      wheel_time = now + 1;
+      break;
+    }
+
+    /* Skip empty level 0 slots up to the next wrap-around. */
+    for(next = index + 1; next < WHEEL_SLOTS; next++) {
+      if(wheel_used[0] & (1UL << next)) {
+        break;
+      }
+    }
+    if((clock_time_t)(next - index) > (clock_time_t)(now - wheel_time)) {
+      wheel_time = now + 1;
+    } else {
+      wheel_time += next - index;
+    }
+  }
+  update_time();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(etimer_process, ev, data)
+{
+  struct etimer *t, *next;
+  unsigned char level;
+  unsigned char index;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD();
+
+    if(ev == PROCESS_EVENT_EXITED) {
+      struct process *p = data;
+
+      for(level = 0; level < ETIMER_WHEEL_LEVELS; level++) {
+        for(index = 0; index < WHEEL_SLOTS; index++) {
+          for(t = wheel[level][index]; t != NULL; t = next) {
+            next = t->next;
+            if(t->p == p) {
+              wheel_unlink(t);
+            }
+          }
+        }
+      }
+      continue;
+    } else if(ev == PROCESS_EVENT_POLL) {
+      run_wheel();
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_timer(struct etimer *timer)
+{
+  clock_time_t bound;
+
+  etimer_request_poll();
+
+  if(wheel_contains(timer)) {
+    wheel_unlink(timer);
+  }
+  if(wheel_count == 0) {
+    wheel_time = clock_time();
+  }
+
+  timer->p = PROCESS_CURRENT();
+  bound = wheel_place(timer);
+  if(wheel_count == 0 ||
+     (clock_time_t)(bound - next_expiration) > CLOCK_HALF) {
+    next_expiration = bound;
+  }
+  wheel_count++;
+}
+/*---------------------------------------------------------------------------*/
+void
+etimer_adjust(struct etimer *et, int timediff)
+{
+  et->timer.start += timediff;
+  if(wheel_contains(et)) {
+    wheel_unlink(et);
+    wheel_place(et);
+    wheel_count++;
+    update_time();
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+etimer_pending(void)
+{
+  return wheel_count != 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+etimer_stop(struct etimer *et)
+{
+  if(wheel_contains(et)) {
+    wheel_unlink(et);
+    if(wheel_count == 0) {
+      next_expiration = 0;
+    }
+  }
+  et->next = NULL;
+  et->prev = NULL;
+  et->slot = ETIMER_SLOT_NONE;
+  /* Set the timer as expired */
+  et->p = PROCESS_NONE;
+}
+/*---------------------------------------------------------------------------*/
+#else /* ETIMER_WITH_WHEEL */
+
+static struct etimer *timerlist;
+
 /*---------------------------------------------------------------------------*/
 static void
 update_time(void)
@@ -141,12 +483,6 @@ PROCESS_THREAD(etimer_process, ev, data)
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
-void
-etimer_request_poll(void)
-{
-  process_poll(&etimer_process);
-}
-/*---------------------------------------------------------------------------*/
 static void
 add_timer(struct etimer *timer)
 {
@@ -174,6 +510,57 @@ add_timer(struct etimer *timer)
 }
 /*---------------------------------------------------------------------------*/
 void
+etimer_adjust(struct etimer *et, int timediff)
+{
+  et->timer.start += timediff;
+  update_time();
+}
+/*---------------------------------------------------------------------------*/
+int
+etimer_pending(void)
+{
+  return timerlist != NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+etimer_stop(struct etimer *et)
+{
+  struct etimer *t;
+
+  /* First check if et is the first event timer on the list. */
+  if(et == timerlist) {
+    timerlist = timerlist->next;
+    update_time();
+  } else {
+    /* Else walk through the list and try to find the item before the
+       et timer. */
+    for(t = timerlist; t != NULL && t->next != et; t = t->next);
+
+    if(t != NULL) {
+      /* We've found the item before the event timer that we are about
+	 to remove. We point the items next pointer to the event after
+	 the removed item. */
+      t->next = et->next;
+
+      update_time();
+    }
+  }
+
+  /* Remove the next pointer from the item to be removed. */
+  et->next = NULL;
+  /* Set the timer as expired */
+  et->p = PROCESS_NONE;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* ETIMER_WITH_WHEEL */
+/*---------------------------------------------------------------------------*/
+void
+etimer_request_poll(void)
+{
+  process_poll(&etimer_process);
+}
+/*---------------------------------------------------------------------------*/
+void
 etimer_set(struct etimer *et, clock_time_t interval)
 {
   timer_set(&et->timer, interval);
@@ -202,13 +589,6 @@ etimer_restart(struct etimer *et)
   add_timer(et);
 }
 /*---------------------------------------------------------------------------*/
-void
-etimer_adjust(struct etimer *et, int timediff)
-{
-  et->timer.start += timediff;
-  update_time();
-}
-/*---------------------------------------------------------------------------*/
 int
 etimer_expired(struct etimer *et)
 {
@@ -227,46 +607,10 @@ etimer_start_time(struct etimer *et)
   return et->timer.start;
 }
 /*---------------------------------------------------------------------------*/
-int
-etimer_pending(void)
-{
-  return timerlist != NULL;
-}
-/*---------------------------------------------------------------------------*/
 clock_time_t
 etimer_next_expiration_time(void)
 {
   return etimer_pending() ? next_expiration : 0;
 }
 /*---------------------------------------------------------------------------*/
-void
-etimer_stop(struct etimer *et)
-{
-  struct etimer *t;
-
-  /* First check if et is the first event timer on the list. */
-  if(et == timerlist) {
-    timerlist = timerlist->next;
-    update_time();
-  } else {
-    /* Else walk through the list and try to find the item before the
-       et timer. */
-    for(t = timerlist; t != NULL && t->next != et; t = t->next);
-
-    if(t != NULL) {
-      /* We've found the item before the event timer that we are about
-	 to remove. We point the items next pointer to the event after
-	 the removed item. */
-      t->next = et->next;
-
-      update_time();
-    }
-  }
-
-  /* Remove the next pointer from the item to be removed. */
-  et->next = NULL;
-  /* Set the timer as expired */
-  et->p = PROCESS_NONE;
-}
-/*---------------------------------------------------------------------------*/
 /** @} */
@@ -65,6 +65,25 @@
 #include "sys/timer.h"
 #include "sys/process.h"
 
+/*
+ * Keep pending event timers in a hierarchical timer wheel instead of
+ * a single unsorted list. Setting and stopping a timer then only
+ * looks at the timers of one slot, and expiring timers does not
+ * rescan every pending timer, at the cost of two extra fields per
+ * timer.
+ */
+#ifdef ETIMER_CONF_WITH_WHEEL
+#define ETIMER_WITH_WHEEL ETIMER_CONF_WITH_WHEEL
+#else /* ETIMER_CONF_WITH_WHEEL */
+#define ETIMER_WITH_WHEEL 0
+#endif /* ETIMER_CONF_WITH_WHEEL */
+
+#if ETIMER_WITH_WHEEL
+/* Values of etimer.slot for timers that are not in the wheel */
+#define ETIMER_SLOT_NONE  0xff
+#define ETIMER_SLOT_FIRED 0xfe
+#endif /* ETIMER_WITH_WHEEL */
+
 /**
  * A timer.
  *
@@ -77,6 +96,10 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+#if ETIMER_WITH_WHEEL
+  struct etimer *prev;
+  unsigned char slot;
+#endif /* ETIMER_WITH_WHEEL */
 };
 
 /**
@@ -47,6 +47,9 @@
 
 #include "sys/process.h"
 #include "sys/arg.h"
+#if PROCESS_CONF_DISPATCH_STATS
+#include "sys/rtimer.h"
+#endif /* PROCESS_CONF_DISPATCH_STATS */
 
 /*
  * Pointer to the currently running process structure.
@@ -68,8 +71,20 @@ struct event_data {
 static process_num_events_t nevents, fevent;
 static struct event_data events[PROCESS_CONF_NUMEVENTS];
 
+#if PROCESS_CONF_WITH_PRIORITY
+/* Separate queue for events posted to high-priority processes. It is
+   always emptied before the normal queue is looked at. */
+static process_num_events_t nevents_high, fevent_high;
+static struct event_data events_high[PROCESS_CONF_NUMEVENTS_HIGH];
+#define NEVENTS_HIGH nevents_high
+#else
+#define NEVENTS_HIGH 0
+#endif /* PROCESS_CONF_WITH_PRIORITY */
+
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
+process_num_events_t process_maxevents_high;
+unsigned short process_dropped_events;
 #endif
 
 static volatile unsigned char poll_requested;
@@ -95,6 +110,65 @@ process_alloc_event(void)
   return lastevent++;
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_CONF_WITH_PRIORITY
+void
+process_set_priority(struct process *p, unsigned char priority)
+{
+  p->priority = priority;
+}
+#endif /* PROCESS_CONF_WITH_PRIORITY */
+/*---------------------------------------------------------------------------*/
+#if PROCESS_CONF_WITH_SUBSCRIPTIONS
+void
+process_subscribe(struct process *p, process_event_t ev)
+{
+  unsigned char i;
+
+  p->subscribed = 1;
+  if(ev >= PROCESS_EVENT_MAX) {
+    i = ev - PROCESS_EVENT_MAX;
+    if(i < PROCESS_CONF_SUBSCRIPTION_EVENTS) {
+      p->subscriptions[i / 8] |= 1 << (i % 8);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+process_unsubscribe(struct process *p, process_event_t ev)
+{
+  unsigned char i;
+
+  if(ev >= PROCESS_EVENT_MAX) {
+    i = ev - PROCESS_EVENT_MAX;
+    if(i < PROCESS_CONF_SUBSCRIPTION_EVENTS) {
+      p->subscriptions[i / 8] &= ~(1 << (i % 8));
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Return non-zero if a broadcast event should be delivered to the
+ * process. System events and events beyond the subscription bitmap
+ * always are.
+ */
+static int
+is_subscribed(struct process *p, process_event_t ev)
+{
+  unsigned char i;
+
+  if(!p->subscribed || ev < PROCESS_EVENT_MAX) {
+    return 1;
+  }
+  i = ev - PROCESS_EVENT_MAX;
+  if(i >= PROCESS_CONF_SUBSCRIPTION_EVENTS) {
+    return 1;
+  }
+  return (p->subscriptions[i / 8] & (1 << (i % 8))) != 0;
+}
+#else
+#define is_subscribed(p, ev) 1
+#endif /* PROCESS_CONF_WITH_SUBSCRIPTIONS */
+/*---------------------------------------------------------------------------*/
 void
 process_start(struct process *p, process_data_t data)
 {
@@ -175,6 +249,10 @@ static void
 call_process(struct process *p, process_event_t ev, process_data_t data)
 {
   int ret;
+#if PROCESS_CONF_DISPATCH_STATS
+  rtimer_clock_t start;
+  unsigned short elapsed;
+#endif /* PROCESS_CONF_DISPATCH_STATS */
 
 #if DEBUG
   if(p->state == PROCESS_STATE_CALLED) {
@@ -187,7 +265,18 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
     PRINTF("process: calling process '%s' with event %d\n", PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+#if PROCESS_CONF_DISPATCH_STATS
+    start = RTIMER_NOW();
+#endif /* PROCESS_CONF_DISPATCH_STATS */
     ret = p->thread(&p->pt, ev, data);
+#if PROCESS_CONF_DISPATCH_STATS
+    elapsed = (unsigned short)(RTIMER_NOW() - start);
+    p->dispatch_count++;
+    p->dispatch_time += elapsed;
+    if(elapsed > p->dispatch_max) {
+      p->dispatch_max = elapsed;
+    }
+#endif /* PROCESS_CONF_DISPATCH_STATS */
     if(ret == PT_EXITED ||
        ret == PT_ENDED ||
        ev == PROCESS_EVENT_EXIT) {
@@ -210,8 +299,13 @@ process_init(void)
   lastevent = PROCESS_EVENT_MAX;
 
   nevents = fevent = 0;
+#if PROCESS_CONF_WITH_PRIORITY
+  nevents_high = fevent_high = 0;
+#endif /* PROCESS_CONF_WITH_PRIORITY */
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
+  process_maxevents_high = 0;
+  process_dropped_events = 0;
 #endif /* PROCESS_CONF_STATS */
 
   process_current = process_list = NULL;
@@ -258,6 +352,16 @@ do_event(void)
    * call the poll handlers inbetween.
    */
 
+#if PROCESS_CONF_WITH_PRIORITY
+  if(nevents_high > 0) {
+    /* Events for high-priority processes go first. */
+    ev = events_high[fevent_high].ev;
+    data = events_high[fevent_high].data;
+    receiver = events_high[fevent_high].p;
+    fevent_high = (fevent_high + 1) % PROCESS_CONF_NUMEVENTS_HIGH;
+    --nevents_high;
+  } else
+#endif /* PROCESS_CONF_WITH_PRIORITY */
   if(nevents > 0) {
     
     /* There are events that we should deliver. */
@@ -270,31 +374,35 @@ do_event(void)
        and decrease the number of events. */
     fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
     --nevents;
+  } else {
+    return;
+  }
 
-    /* If this is a broadcast event, we deliver it to all events, in
-       order of their priority. */
-    if(receiver == PROCESS_BROADCAST) {
-      for(p = process_list; p != NULL; p = p->next) {
+  /* If this is a broadcast event, we deliver it to all events, in
+     order of their priority. */
+  if(receiver == PROCESS_BROADCAST) {
+    for(p = process_list; p != NULL; p = p->next) {
 
-	/* If we have been requested to poll a process, we do this in
-	   between processing the broadcast event. */
-	if(poll_requested) {
-	  do_poll();
-	}
-	call_process(p, ev, data);
+      /* If we have been requested to poll a process, we do this in
+	 between processing the broadcast event. */
+      if(poll_requested) {
+	do_poll();
       }
-    } else {
-      /* This is not a broadcast event, so we deliver it to the
-	 specified process. */
-      /* If the event was an INIT event, we should also update the
-	 state of the process. */
-      if(ev == PROCESS_EVENT_INIT) {
-	receiver->state = PROCESS_STATE_RUNNING;
+      if(is_subscribed(p, ev)) {
+	call_process(p, ev, data);
       }
-
-      /* Make sure that the process actually is running. */
-      call_process(receiver, ev, data);
     }
+  } else {
+    /* This is not a broadcast event, so we deliver it to the
+       specified process. */
+    /* If the event was an INIT event, we should also update the
+       state of the process. */
+    if(ev == PROCESS_EVENT_INIT) {
+      receiver->state = PROCESS_STATE_RUNNING;
+    }
+
+    /* Make sure that the process actually is running. */
+    call_process(receiver, ev, data);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -309,13 +417,13 @@ process_run(void)
   /* Process one event from the queue */
   do_event();
 
-  return nevents + poll_requested;
+  return nevents + NEVENTS_HIGH + poll_requested;
 }
 /*---------------------------------------------------------------------------*/
 int
 process_nevents(void)
 {
-  return nevents + poll_requested;
+  return nevents + NEVENTS_HIGH + poll_requested;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -331,8 +439,39 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
 	   PROCESS_NAME_STRING(PROCESS_CURRENT()), ev,
 	   p == PROCESS_BROADCAST? "<broadcast>": PROCESS_NAME_STRING(p), nevents);
   }
-  
+
+#if PROCESS_CONF_WITH_PRIORITY
+  if(p != PROCESS_BROADCAST && p->priority != PROCESS_PRIORITY_NORMAL) {
+    /* Never fall back to the normal queue: the receiver could then
+       get its events out of order. */
+    if(nevents_high == PROCESS_CONF_NUMEVENTS_HIGH) {
+#if PROCESS_CONF_STATS
+      process_dropped_events++;
+#endif /* PROCESS_CONF_STATS */
+#if DEBUG
+      printf("soft panic: high-priority event queue is full when event %d was posted to %s from %s\n", ev, PROCESS_NAME_STRING(p), PROCESS_NAME_STRING(process_current));
+#endif /* DEBUG */
+      return PROCESS_ERR_FULL;
+    }
+    snum = (process_num_events_t)(fevent_high + nevents_high) %
+      PROCESS_CONF_NUMEVENTS_HIGH;
+    events_high[snum].ev = ev;
+    events_high[snum].data = data;
+    events_high[snum].p = p;
+    ++nevents_high;
+#if PROCESS_CONF_STATS
+    if(nevents_high > process_maxevents_high) {
+      process_maxevents_high = nevents_high;
+    }
+#endif /* PROCESS_CONF_STATS */
+    return PROCESS_ERR_OK;
+  }
+#endif /* PROCESS_CONF_WITH_PRIORITY */
+
   if(nevents == PROCESS_CONF_NUMEVENTS) {
+#if PROCESS_CONF_STATS
+    process_dropped_events++;
+#endif /* PROCESS_CONF_STATS */
 #if DEBUG
     if(p == PROCESS_BROADCAST) {
       printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
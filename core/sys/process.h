@@ -88,6 +88,48 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/*
+ * Two-level event dispatching. When enabled, events posted to a
+ * process with priority PROCESS_PRIORITY_HIGH (e.g. the TCP/IP
+ * process) go to a separate queue of PROCESS_CONF_NUMEVENTS_HIGH
+ * events, which is always served before the normal queue.
+ */
+#ifndef PROCESS_CONF_WITH_PRIORITY
+#define PROCESS_CONF_WITH_PRIORITY 0
+#endif /* PROCESS_CONF_WITH_PRIORITY */
+
+#ifndef PROCESS_CONF_NUMEVENTS_HIGH
+#define PROCESS_CONF_NUMEVENTS_HIGH 8
+#endif /* PROCESS_CONF_NUMEVENTS_HIGH */
+
+#define PROCESS_PRIORITY_NORMAL 0
+#define PROCESS_PRIORITY_HIGH   1
+
+/*
+ * Per-process dispatch statistics: number of calls and time spent in
+ * the process thread. Costs two RTIMER_NOW() reads per dispatch, so
+ * it is kept separate from PROCESS_CONF_STATS.
+ */
+#ifndef PROCESS_CONF_DISPATCH_STATS
+#define PROCESS_CONF_DISPATCH_STATS 0
+#endif /* PROCESS_CONF_DISPATCH_STATS */
+
+/*
+ * Broadcast event subscriptions. When enabled, a process that has
+ * subscribed to at least one event with process_subscribe() only
+ * receives the broadcast events it has subscribed to. Processes that
+ * never subscribe keep receiving all broadcast events. Only the first
+ * PROCESS_CONF_SUBSCRIPTION_EVENTS events allocated with
+ * process_alloc_event() can be filtered.
+ */
+#ifndef PROCESS_CONF_WITH_SUBSCRIPTIONS
+#define PROCESS_CONF_WITH_SUBSCRIPTIONS 0
+#endif /* PROCESS_CONF_WITH_SUBSCRIPTIONS */
+
+#ifndef PROCESS_CONF_SUBSCRIPTION_EVENTS
+#define PROCESS_CONF_SUBSCRIPTION_EVENTS 16
+#endif /* PROCESS_CONF_SUBSCRIPTION_EVENTS */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -323,6 +365,20 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_CONF_WITH_PRIORITY
+  unsigned char priority;
+#endif /* PROCESS_CONF_WITH_PRIORITY */
+#if PROCESS_CONF_WITH_SUBSCRIPTIONS
+  unsigned char subscribed;
+  unsigned char subscriptions[(PROCESS_CONF_SUBSCRIPTION_EVENTS + 7) / 8];
+#endif /* PROCESS_CONF_WITH_SUBSCRIPTIONS */
+#if PROCESS_CONF_DISPATCH_STATS
+  /* Number of calls and accumulated/maximum time spent in the
+     process thread, in rtimer ticks */
+  unsigned long dispatch_count;
+  unsigned long dispatch_time;
+  unsigned short dispatch_max;
+#endif /* PROCESS_CONF_DISPATCH_STATS */
 };
 
 /**
@@ -452,6 +508,42 @@ process_current = p
  */
 CCIF process_event_t process_alloc_event(void);
 
+/**
+ * \brief      Set the priority of a process.
+ * \param p    A pointer to the process' process structure.
+ * \param priority PROCESS_PRIORITY_NORMAL or PROCESS_PRIORITY_HIGH
+ *
+ *             Events posted to a high-priority process are
+ *             delivered before any event posted to a normal-priority
+ *             process. When the high-priority queue is full,
+ *             process_post() returns PROCESS_ERR_FULL. Set the
+ *             priority before events are posted to the process, so
+ *             that all its events are in the same queue. Has no
+ *             effect unless PROCESS_CONF_WITH_PRIORITY is set.
+ */
+#if PROCESS_CONF_WITH_PRIORITY
+CCIF void process_set_priority(struct process *p, unsigned char priority);
+#else
+#define process_set_priority(p, priority)
+#endif /* PROCESS_CONF_WITH_PRIORITY */
+
+/**
+ * \brief      Subscribe a process to a broadcast event.
+ * \param p    A pointer to the process' process structure.
+ * \param ev   An event allocated with process_alloc_event().
+ *
+ *             Once a process has subscribed to an event, it only
+ *             receives the broadcast events it has subscribed to. Has
+ *             no effect unless PROCESS_CONF_WITH_SUBSCRIPTIONS is set.
+ */
+#if PROCESS_CONF_WITH_SUBSCRIPTIONS
+CCIF void process_subscribe(struct process *p, process_event_t ev);
+CCIF void process_unsubscribe(struct process *p, process_event_t ev);
+#else
+#define process_subscribe(p, ev)
+#define process_unsubscribe(p, ev)
+#endif /* PROCESS_CONF_WITH_SUBSCRIPTIONS */
+
 /** @} */
 
 /**
@@ -521,6 +613,14 @@ int process_nevents(void);
 
 /** @} */
 
+#if PROCESS_CONF_STATS
+/* High-water mark of the normal and high-priority event queues */
+extern process_num_events_t process_maxevents;
+extern process_num_events_t process_maxevents_high;
+/* Number of events dropped because the event queue was full */
+extern unsigned short process_dropped_events;
+#endif /* PROCESS_CONF_STATS */
+
 CCIF extern struct process *process_list;
 
 #define PROCESS_LIST() process_list
@@ -54,8 +54,60 @@
 #define PRINTF(...)
 #endif
 
+#if RTIMER_MULTIPLE
+/* Pending tasks, sorted by time */
+static struct rtimer *rtimer_list;
+/* Set while rtimer_list is being modified outside of rtimer_run_next() */
+static volatile unsigned char locked;
+
+/* Shortest delay that can safely be given to rtimer_arch_schedule() */
+#define MIN_DELAY (RTIMER_GUARD_TIME > 0 ? RTIMER_GUARD_TIME : 1)
+#else /* RTIMER_MULTIPLE */
 static struct rtimer *next_rtimer;
+#endif /* RTIMER_MULTIPLE */
+
+#if RTIMER_STATS
+unsigned long rtimer_stats_late[RTIMER_STATS_BINS];
+unsigned long rtimer_stats_early;
+rtimer_clock_t rtimer_stats_max_late;
+#endif /* RTIMER_STATS */
 
+/*---------------------------------------------------------------------------*/
+#if RTIMER_STATS
+void
+rtimer_stats_reset(void)
+{
+  unsigned char i;
+
+  for(i = 0; i < RTIMER_STATS_BINS; i++) {
+    rtimer_stats_late[i] = 0;
+  }
+  rtimer_stats_early = 0;
+  rtimer_stats_max_late = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+record_delay(struct rtimer *t)
+{
+  rtimer_clock_t late;
+  unsigned char bin;
+
+  if(RTIMER_CLOCK_LT(RTIMER_NOW(), t->time)) {
+    rtimer_stats_early++;
+    return;
+  }
+  late = RTIMER_NOW() - t->time;
+  if(late > rtimer_stats_max_late) {
+    rtimer_stats_max_late = late;
+  }
+  for(bin = 0; late != 0 && bin < RTIMER_STATS_BINS - 1; bin++) {
+    late >>= 1;
+  }
+  rtimer_stats_late[bin]++;
+}
+#else /* RTIMER_STATS */
+#define record_delay(t)
+#endif /* RTIMER_STATS */
 /*---------------------------------------------------------------------------*/
 void
 rtimer_init(void)
@@ -63,6 +115,111 @@ rtimer_init(void)
   rtimer_arch_init();
 }
 /*---------------------------------------------------------------------------*/
+#if RTIMER_MULTIPLE
+static void
+remove_task(struct rtimer *task)
+{
+  struct rtimer **tp;
+
+  for(tp = &rtimer_list; *tp != NULL; tp = &(*tp)->next) {
+    if(*tp == task) {
+      *tp = task->next;
+      task->next = NULL;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+schedule_first(void)
+{
+  rtimer_clock_t now;
+
+  if(rtimer_list != NULL) {
+    now = RTIMER_NOW();
+    if(RTIMER_CLOCK_LT(rtimer_list->time, now + MIN_DELAY)) {
+      rtimer_arch_schedule(now + MIN_DELAY);
+    } else {
+      rtimer_arch_schedule(rtimer_list->time);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
+	   rtimer_clock_t duration,
+	   rtimer_callback_t func, void *ptr)
+{
+  struct rtimer **tp;
+  struct rtimer *first;
+
+  PRINTF("rtimer_set time %d\n", time);
+
+  locked = 1;
+  first = rtimer_list;
+  remove_task(rtimer);
+
+  rtimer->func = func;
+  rtimer->ptr = ptr;
+  rtimer->time = time;
+
+  /* Insert after all tasks that are due at the same time or earlier. */
+  for(tp = &rtimer_list;
+      *tp != NULL && !RTIMER_CLOCK_LT(time, (*tp)->time);
+      tp = &(*tp)->next);
+  rtimer->next = *tp;
+  *tp = rtimer;
+  locked = 0;
+
+  if(rtimer_list != first) {
+    schedule_first();
+  }
+  return RTIMER_OK;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_cancel(struct rtimer *rtimer)
+{
+  struct rtimer *first;
+
+  locked = 1;
+  first = rtimer_list;
+  remove_task(rtimer);
+  locked = 0;
+
+  if(rtimer_list != first) {
+    schedule_first();
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_run_next(void)
+{
+  struct rtimer *t;
+
+  if(locked) {
+    /* We interrupted rtimer_set() or rtimer_cancel(), try again
+       shortly. */
+    rtimer_arch_schedule(RTIMER_NOW() + MIN_DELAY);
+    return;
+  }
+
+  /* Run all tasks that are due. The interrupt may have been scheduled
+     for a task that has been cancelled or moved since, in which case
+     the first task is not due yet and is only rescheduled. */
+  while(rtimer_list != NULL &&
+        !RTIMER_CLOCK_LT(RTIMER_NOW(), rtimer_list->time)) {
+    t = rtimer_list;
+    rtimer_list = t->next;
+    t->next = NULL;
+    record_delay(t);
+    t->func(t, t->ptr);
+  }
+
+  schedule_first();
+}
+/*---------------------------------------------------------------------------*/
+#else /* RTIMER_MULTIPLE */
 int
 rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
 	   rtimer_clock_t duration,
@@ -89,6 +246,14 @@ rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
 }
 /*---------------------------------------------------------------------------*/
 void
+rtimer_cancel(struct rtimer *rtimer)
+{
+  if(next_rtimer == rtimer) {
+    next_rtimer = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
 rtimer_run_next(void)
 {
   struct rtimer *t;
@@ -97,12 +262,14 @@ rtimer_run_next(void)
   }
   t = next_rtimer;
   next_rtimer = NULL;
+  record_delay(t);
   t->func(t, t->ptr);
   if(next_rtimer != NULL) {
     rtimer_arch_schedule(next_rtimer->time);
   }
   return;
 }
+#endif /* RTIMER_MULTIPLE */
 /*---------------------------------------------------------------------------*/
 
 /** @}*/
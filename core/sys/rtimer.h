@@ -62,6 +62,34 @@ typedef unsigned short rtimer_clock_t;
 
 #define RTIMER_CLOCK_LT(a, b)      (RTIMER_CLOCK_DIFF((a),(b)) < 0)
 
+/*
+ * Keep any number of real-time tasks scheduled at the same time, in
+ * a queue sorted by deadline. Without this, only one task can be
+ * pending and setting a task replaces the pending one.
+ */
+#ifdef RTIMER_CONF_MULTIPLE
+#define RTIMER_MULTIPLE RTIMER_CONF_MULTIPLE
+#else /* RTIMER_CONF_MULTIPLE */
+#define RTIMER_MULTIPLE 0
+#endif /* RTIMER_CONF_MULTIPLE */
+
+/*
+ * Keep a histogram of how late real-time tasks are executed. Bin 0
+ * counts tasks run on time, bin i counts tasks run 2^(i-1) to 2^i - 1
+ * ticks late, and the last bin counts all tasks that were later.
+ */
+#ifdef RTIMER_CONF_STATS
+#define RTIMER_STATS RTIMER_CONF_STATS
+#else /* RTIMER_CONF_STATS */
+#define RTIMER_STATS 0
+#endif /* RTIMER_CONF_STATS */
+
+#ifdef RTIMER_CONF_STATS_BINS
+#define RTIMER_STATS_BINS RTIMER_CONF_STATS_BINS
+#else /* RTIMER_CONF_STATS_BINS */
+#define RTIMER_STATS_BINS 8
+#endif /* RTIMER_CONF_STATS_BINS */
+
 #include "rtimer-arch.h"
 
 /**
@@ -84,6 +112,9 @@ typedef void (* rtimer_callback_t)(struct rtimer *t, void *ptr);
  *             support module for the real-time module.
  */
 struct rtimer {
+#if RTIMER_MULTIPLE
+  struct rtimer *next;
+#endif /* RTIMER_MULTIPLE */
   rtimer_clock_t time;
   rtimer_callback_t func;
   void *ptr;
@@ -113,6 +144,16 @@ enum {
 int rtimer_set(struct rtimer *task, rtimer_clock_t time,
 	       rtimer_clock_t duration, rtimer_callback_t func, void *ptr);
 
+/**
+ * \brief      Cancel a real-time task.
+ * \param task A pointer to a task previously set with rtimer_set().
+ *
+ *             This function removes the task if it has not been
+ *             executed yet. Other pending tasks are not affected.
+ *
+ */
+void rtimer_cancel(struct rtimer *task);
+
 /**
  * \brief      Execute the next real-time task and schedule the next task, if any
  *
@@ -122,6 +163,20 @@ int rtimer_set(struct rtimer *task, rtimer_clock_t time,
  */
 void rtimer_run_next(void);
 
+#if RTIMER_STATS
+/* Histogram of task execution delays, see RTIMER_CONF_STATS */
+extern unsigned long rtimer_stats_late[RTIMER_STATS_BINS];
+/* Number of tasks executed before their time */
+extern unsigned long rtimer_stats_early;
+/* Largest execution delay seen, in rtimer ticks */
+extern rtimer_clock_t rtimer_stats_max_late;
+
+/**
+ * \brief      Clear the execution delay statistics
+ */
+void rtimer_stats_reset(void);
+#endif /* RTIMER_STATS */
+
 /**
  * \brief      Get the current clock time
  * \return     The current time
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Native microbenchmark of neighbor table lookups. Fills a
+ *         neighbor table with an increasing number of neighbors and
+ *         measures the cost of nbr_table_get_from_lladdr() for
+ *         present and absent addresses.
+ */
+
+#include "contiki.h"
+#include "net/nbr-table.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define LOOKUPS 200000
+
+struct bench_nbr {
+  uint16_t seq;
+};
+
+NBR_TABLE(struct bench_nbr, bench_nbrs);
+
+static const unsigned short sizes[] = { 8, 32, 64, 128, 200, 256 };
+static linkaddr_t addrs[2 * NBR_TABLE_MAX_NEIGHBORS];
+static unsigned short order[LOOKUPS];
+
+PROCESS(nbr_bench_process, "Neighbor table benchmark");
+AUTOSTART_PROCESSES(&nbr_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long
+cpu_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_addr(linkaddr_t *addr, unsigned short i)
+{
+  /* EUI-64 style addresses that differ only in the last bytes */
+  memset(addr, 0, sizeof(linkaddr_t));
+  addr->u8[0] = 0x02;
+  addr->u8[LINKADDR_SIZE - 2] = i >> 8;
+  addr->u8[LINKADDR_SIZE - 1] = i & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+/* Average cost of a lookup in tenths of nanoseconds */
+static unsigned long
+lookup_cost(unsigned short range, unsigned long *found)
+{
+  unsigned long start;
+  unsigned long i;
+
+  for(i = 0; i < LOOKUPS; i++) {
+    order[i] = random_rand() % range;
+  }
+
+  *found = 0;
+  start = cpu_ns();
+  for(i = 0; i < LOOKUPS; i++) {
+    if(nbr_table_get_from_lladdr(bench_nbrs, &addrs[order[i]]) != NULL) {
+      (*found)++;
+    }
+  }
+  return (cpu_ns() - start) * 10 / LOOKUPS;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(nbr_bench_process, ev, data)
+{
+  unsigned short n;
+  unsigned short i;
+  unsigned char run;
+  unsigned long hit;
+  unsigned long mix;
+  unsigned long found;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < 2 * NBR_TABLE_MAX_NEIGHBORS; i++) {
+    make_addr(&addrs[i], i + 1);
+  }
+
+  nbr_table_register(bench_nbrs, NULL);
+  printf("nbr-table lookup: %s, %u neighbors max\n",
+         NBR_TABLE_WITH_HASH ? "hash" : "list", NBR_TABLE_MAX_NEIGHBORS);
+
+  n = 0;
+  for(run = 0; run < sizeof(sizes) / sizeof(sizes[0]); run++) {
+    for(; n < sizes[run]; n++) {
+      nbr_table_add_lladdr(bench_nbrs, &addrs[n], NBR_TABLE_REASON_UNDEFINED, NULL);
+    }
+    random_init(n);
+    /* The first n addresses are in the table, the next n are not */
+    hit = lookup_cost(n, &found);
+    mix = lookup_cost(2 * n, &found);
+    printf("n %3u: %4lu.%lu ns per hit, %4lu.%lu ns per lookup with %lu%% misses\n",
+           n, hit / 10, hit % 10, mix / 10, mix % 10,
+           100 - found * 100 / LOOKUPS);
+  }
+  printf("DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+/**
+ * \file
+ *         Native regression test and benchmark of the IPv6 routing
+ *         table. Fills the table with 1000 and then 10000 routes,
+ *         checks uip_ds6_route_lookup() against a plain longest
+ *         prefix scan while routes are added and removed, and
+ *         measures the lookup cost.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define NEXTHOPS 8
+#define LOOKUPS 20000
+#define CHECKS 2000
+
+/* One route in SUBNET_EVERY is a /64 subnet route, the others are
+   host routes, a third of which fall inside a subnet route. */
+#define SUBNET_EVERY 8
+
+static const unsigned short sizes[] = { 1000, 10000 };
+static uip_ipaddr_t nexthops[NEXTHOPS];
+static uip_ipaddr_t dests[LOOKUPS];
+static unsigned long mismatches;
+
+PROCESS(route_bench_process, "Route table benchmark");
+AUTOSTART_PROCESSES(&route_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long
+cpu_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+/* Destination of route i, with its prefix length */
+static uint8_t
+route_prefix(uip_ipaddr_t *addr, unsigned short i)
+{
+  unsigned short subnet;
+
+  subnet = i / SUBNET_EVERY;
+  if(i % 3 == 1) {
+    /* Inside the subnet route of a neighbouring block */
+    subnet = (subnet / 2) * 2;
+  }
+  uip_ip6addr(addr, 0xfd00, 0, 0, subnet, 0, 0, 0, 0);
+  if(i % SUBNET_EVERY == 0) {
+    return 64;
+  }
+  addr->u16[6] = UIP_HTONS(i);
+  addr->u16[7] = UIP_HTONS(i * 7919);
+  return 128;
+}
+/*---------------------------------------------------------------------------*/
+/* Longest prefix match by a full scan of the routing table */
+static uip_ds6_route_t *
+reference_lookup(uip_ipaddr_t *addr)
+{
+  uip_ds6_route_t *r;
+  uip_ds6_route_t *found;
+
+  found = NULL;
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    if(uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length) &&
+       (found == NULL || r->length > found->length)) {
+      found = r;
+    }
+  }
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+/* Random destination: a routed host, an address in a routed subnet, or
+   an address with no route */
+static void
+random_dest(uip_ipaddr_t *addr, unsigned short n)
+{
+  unsigned short i;
+
+  i = random_rand() % n;
+  route_prefix(addr, i);
+  switch(random_rand() % 4) {
+  case 0:
+    addr->u16[7] ^= UIP_HTONS(random_rand() | 1);
+    break;
+  case 1:
+    addr->u16[0] = UIP_HTONS(0xfd01);
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(unsigned short n, const char *step)
+{
+  unsigned short i;
+  uip_ipaddr_t addr;
+
+  for(i = 0; i < CHECKS; i++) {
+    random_dest(&addr, n);
+    if(uip_ds6_route_lookup(&addr) != reference_lookup(&addr)) {
+      mismatches++;
+    }
+  }
+  printf("check %s: %lu mismatches, %d routes\n",
+         step, mismatches, uip_ds6_route_num_routes());
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_routes(unsigned short from, unsigned short to)
+{
+  unsigned short i;
+  uip_ipaddr_t addr;
+  uint8_t length;
+
+  for(i = from; i < to; i++) {
+    length = route_prefix(&addr, i);
+    if(uip_ds6_route_add(&addr, length, &nexthops[i % NEXTHOPS]) == NULL) {
+      printf("route %u could not be added\n", i);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_routes(unsigned short n)
+{
+  unsigned short i;
+  uip_ipaddr_t addr;
+  uip_ds6_route_t *r;
+
+  /* Every third route by address, then all routes via one neighbor */
+  for(i = 0; i < n; i += 3) {
+    route_prefix(&addr, i);
+    r = uip_ds6_route_lookup(&addr);
+    if(r != NULL && uip_ipaddr_cmp(&r->ipaddr, &addr)) {
+      uip_ds6_route_rm(r);
+    }
+  }
+  uip_ds6_route_rm_by_nexthop(&nexthops[NEXTHOPS - 1]);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(unsigned short n)
+{
+  unsigned long start;
+  unsigned long cost;
+  unsigned long i;
+  unsigned long found;
+
+  for(i = 0; i < LOOKUPS; i++) {
+    random_dest(&dests[i], n);
+  }
+
+  uip_ds6_route_stats_reset();
+  found = 0;
+  start = cpu_ns();
+  for(i = 0; i < LOOKUPS; i++) {
+    if(uip_ds6_route_lookup(&dests[i]) != NULL) {
+      found++;
+    }
+  }
+  cost = (cpu_ns() - start) * 10 / LOOKUPS;
+  printf("n %5u: %6lu.%lu ns per lookup, %lu%% found, "
+         "%lu visited on average, %u at most\n",
+         n, cost / 10, cost % 10, found * 100 / LOOKUPS,
+         (unsigned long)(uip_ds6_route_stat.visited / LOOKUPS),
+         uip_ds6_route_stat.max_visited);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(route_bench_process, ev, data)
+{
+  uip_lladdr_t lladdr;
+  unsigned char i;
+  unsigned short n;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < NEXTHOPS; i++) {
+    memset(&lladdr, 0, sizeof(lladdr));
+    lladdr.addr[0] = 0x02;
+    lladdr.addr[sizeof(lladdr) - 1] = i + 1;
+    uip_ip6addr(&nexthops[i], 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+    uip_ds6_nbr_add(&nexthops[i], &lladdr, 1, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+  }
+
+  printf("route lookup: %s, %u routes max\n",
+         UIP_DS6_ROUTE_WITH_TRIE ? "trie" : "list", UIP_DS6_ROUTE_NB);
+
+  n = 0;
+  for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    add_routes(n, sizes[i]);
+    n = sizes[i];
+    random_init(n);
+    check(n, "add");
+    bench(n);
+  }
+
+  remove_routes(n);
+  check(n, "remove");
+  add_routes(0, n);
+  check(n, "re-add");
+  printf("%s\n", mismatches == 0 ? "OK" : "FAIL");
+  printf("DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Runs several periodic real-time tasks at the same time and
+ *         reports how often each one ran and how late the tasks were
+ *         executed.
+ */
+
+#include "contiki.h"
+
+#include <stdio.h>
+
+/* How long to run the tasks */
+#define DURATION (10 * CLOCK_SECOND)
+
+#define NUM_TASKS 4
+
+static const rtimer_clock_t periods[NUM_TASKS] = {
+  RTIMER_SECOND / 50, RTIMER_SECOND / 20, RTIMER_SECOND / 7, RTIMER_SECOND / 3
+};
+static struct rtimer tasks[NUM_TASKS];
+static unsigned long runs[NUM_TASKS];
+
+PROCESS(rtimer_bench_process, "Rtimer benchmark");
+AUTOSTART_PROCESSES(&rtimer_bench_process);
+/*---------------------------------------------------------------------------*/
+static void
+periodic(struct rtimer *t, void *ptr)
+{
+  unsigned char i = (unsigned char)(uintptr_t)ptr;
+
+  runs[i]++;
+  /* Reschedule relative to the previous deadline to avoid drift. */
+  rtimer_set(t, RTIMER_TIME(t) + periods[i], 0, periodic, ptr);
+}
+/*---------------------------------------------------------------------------*/
+/* A task that records when it ran, to check that it did not run early */
+static struct rtimer late_task;
+static rtimer_clock_t late_ran_at;
+static unsigned char late_ran;
+
+static void
+late(struct rtimer *t, void *ptr)
+{
+  late_ran_at = RTIMER_NOW();
+  late_ran = 1;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(rtimer_bench_process, ev, data)
+{
+  static struct etimer et;
+  static rtimer_clock_t late_time;
+  static unsigned char cancel_ok;
+  unsigned char i;
+  rtimer_clock_t now;
+
+  PROCESS_BEGIN();
+
+  printf("rtimer: %s, %u tasks for %lu s\n",
+         RTIMER_MULTIPLE ? "multiple" : "single", NUM_TASKS,
+         (unsigned long)(DURATION / CLOCK_SECOND));
+
+  rtimer_stats_reset();
+  now = RTIMER_NOW();
+  for(i = 0; i < NUM_TASKS; i++) {
+    runs[i] = 0;
+    rtimer_set(&tasks[i], now + periods[i], 0, periodic, (void *)(uintptr_t)i);
+  }
+
+  etimer_set(&et, DURATION);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  for(i = 0; i < NUM_TASKS; i++) {
+    rtimer_cancel(&tasks[i]);
+  }
+
+  for(i = 0; i < NUM_TASKS; i++) {
+    printf("task %u period %lu ticks: %lu runs, expected %lu\n", i,
+           (unsigned long)periods[i], runs[i],
+           (unsigned long)(DURATION / CLOCK_SECOND) * RTIMER_SECOND / periods[i]);
+  }
+  printf("late histogram (ticks):");
+  for(i = 0; i < RTIMER_STATS_BINS; i++) {
+    printf(" %s%u:%lu", i == RTIMER_STATS_BINS - 1 ? ">=" : "",
+           i == 0 ? 0 : 1 << (i - 1), rtimer_stats_late[i]);
+  }
+  printf("\nearly %lu, max late %lu ticks\n", rtimer_stats_early,
+         (unsigned long)rtimer_stats_max_late);
+
+#if RTIMER_MULTIPLE
+  /* Cancel the first task after its interrupt has been scheduled. A
+     stale interrupt for it, simulated by calling rtimer_run_next(),
+     must not run the next task before it is due. */
+  now = RTIMER_NOW();
+  late_ran = 0;
+  late_time = now + RTIMER_SECOND / 2;
+  rtimer_set(&tasks[0], now + RTIMER_SECOND / 10, 0, periodic, (void *)0);
+  rtimer_set(&late_task, late_time, 0, late, NULL);
+  rtimer_cancel(&tasks[0]);
+  rtimer_run_next();
+  cancel_ok = !late_ran;
+
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  cancel_ok = cancel_ok && late_ran && !RTIMER_CLOCK_LT(late_ran_at, late_time);
+  printf("cancel head: %s\n", cancel_ok ? "OK" : "FAIL");
+#endif /* RTIMER_MULTIPLE */
+  printf("DONE\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Native microbenchmark for the etimer backends. Sets, stops
+ *         and expires 10, 100 and 10000 event timers and reports the
+ *         CPU time spent per timer.
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MAX_TIMERS 10000
+
+/* Timers expire uniformly within this interval */
+#define INTERVAL (2 * CLOCK_SECOND)
+
+static struct etimer timers[MAX_TIMERS];
+static const unsigned short sizes[] = { 10, 100, MAX_TIMERS };
+
+PROCESS(timer_bench_process, "Timer benchmark");
+AUTOSTART_PROCESSES(&timer_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long
+cpu_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(timer_bench_process, ev, data)
+{
+  static unsigned char run;
+  static unsigned short n;
+  static unsigned short i;
+  static unsigned short fired;
+  static unsigned short early;
+  static clock_time_t late_max;
+  static unsigned long start;
+  static unsigned long set_ns;
+  static unsigned long stop_ns;
+  static unsigned long idle_ns;
+  unsigned long expire_ns;
+  struct etimer *t;
+
+  PROCESS_BEGIN();
+
+  printf("etimer backend: %s\n", ETIMER_WITH_WHEEL ? "wheel" : "list");
+
+  /* The native main loop spins while waiting for timers. Measure its
+     cost over one interval so that it can be left out below. */
+  start = cpu_ns();
+  etimer_set(&timers[0], INTERVAL);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+  idle_ns = cpu_ns() - start;
+
+  for(run = 0; run < sizeof(sizes) / sizeof(sizes[0]); run++) {
+    n = sizes[run];
+    random_init(n);
+
+    start = cpu_ns();
+    for(i = 0; i < n; i++) {
+      etimer_set(&timers[i], 1 + random_rand() % INTERVAL);
+    }
+    set_ns = cpu_ns() - start;
+
+    /* Stop every other timer and set it again, as protocols do when
+       a transmission or a transaction completes early. */
+    start = cpu_ns();
+    for(i = 0; i < n; i += 2) {
+      etimer_stop(&timers[i]);
+    }
+    stop_ns = cpu_ns() - start;
+    for(i = 0; i < n; i += 2) {
+      etimer_set(&timers[i], 1 + random_rand() % INTERVAL);
+    }
+
+    fired = 0;
+    early = 0;
+    late_max = 0;
+    start = cpu_ns();
+    while(fired < n) {
+      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+      t = data;
+      if(!timer_expired(&t->timer)) {
+        early++;
+      } else if(clock_time() - etimer_expiration_time(t) > late_max) {
+        late_max = clock_time() - etimer_expiration_time(t);
+      }
+      fired++;
+    }
+    expire_ns = cpu_ns() - start;
+    expire_ns = expire_ns > idle_ns ? expire_ns - idle_ns : 0;
+
+    printf("n %5u set %6lu ns stop %6lu ns expire %7lu ns per timer,"
+           " early %u, max late %lu ticks\n",
+           n, set_ns / n, stop_ns / (n / 2), expire_ns / n,
+           early, (unsigned long)late_max);
+  }
+
+  printf("DONE\n");
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
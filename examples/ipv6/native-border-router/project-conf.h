@@ -54,6 +54,24 @@
 #undef NETSTACK_CONF_RDC
 #define NETSTACK_CONF_RDC border_router_rdc_driver
 
+#if WITH_COAP_PROXY
+/* caching CoAP proxy in front of the nodes */
+#define COAP_PROXY 1
+#define COAP_OBSERVE_CLIENT 1
+
+/* "proxy/<node address>/<path>" */
+#define COAP_PROXY_URL_LEN          72
+#define COAP_OBSERVER_URL_LEN       80
+#define COAP_MAX_HEADER_SIZE        96
+
+#define COAP_PROXY_CACHE_ENTRIES    16
+#define COAP_PROXY_MAX_WAITING      16
+#define COAP_MAX_OPEN_TRANSACTIONS  16
+#define COAP_MAX_OBSERVERS          16
+#define COAP_CONF_MAX_OBSERVEES     8
+#define REST_MAX_CHUNK_SIZE         128
+#endif /* WITH_COAP_PROXY */
+
 /* used by wpcap (see /cpu/native/net/wpcap-drv.c) */
 #define SELECT_CALLBACK 1
 
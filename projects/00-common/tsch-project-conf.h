@@ -90,7 +90,12 @@
 #define TSCH_LOG_CONF_LEVEL 0
 
 // #define TSCH_CONF_DEFAULT_HOPPING_SEQUENCE (uint8_t[]){ 14, 18, 22, 26 }
-#define TSCH_CONF_DEFAULT_HOPPING_SEQUENCE (uint8_t[]){ 14 }
+// #define TSCH_CONF_DEFAULT_HOPPING_SEQUENCE (uint8_t[]){ 14 }
+#define TSCH_CONF_DEFAULT_HOPPING_SEQUENCE TSCH_HOPPING_SEQUENCE_16_16
+
+/* Skip the channels with a poor PRR, e.g. under Wi-Fi interference */
+#undef TSCH_CONF_WITH_CHANNEL_BLACKLIST
+#define TSCH_CONF_WITH_CHANNEL_BLACKLIST 1
 
 /* 6TiSCH minimal schedule length.
  * Larger values result in less frequent active slots: reduces capacity and saves energy. */
@@ -141,6 +146,9 @@
 #define TSCH_CALLBACK_PACKET_READY orchestra_callback_packet_ready
 #define NETSTACK_CONF_ROUTING_NEIGHBOR_ADDED_CALLBACK orchestra_callback_child_added
 #define NETSTACK_CONF_ROUTING_NEIGHBOR_REMOVED_CALLBACK orchestra_callback_child_removed
+/* With TSCH_CONF_WITH_SIXTOP, TSCH also passes the packet outcomes to 6top */
+#define TSCH_CALLBACK_PACKET_SENT orchestra_callback_packet_sent
+#define TSCH_CALLBACK_PACKET_RECEIVED orchestra_callback_packet_received
 
 #endif /* WITH_ORCHESTRA */
 
@@ -141,6 +141,9 @@
 #define TSCH_CALLBACK_PACKET_READY orchestra_callback_packet_ready
 #define NETSTACK_CONF_ROUTING_NEIGHBOR_ADDED_CALLBACK orchestra_callback_child_added
 #define NETSTACK_CONF_ROUTING_NEIGHBOR_REMOVED_CALLBACK orchestra_callback_child_removed
+/* With TSCH_CONF_WITH_SIXTOP, TSCH also passes the packet outcomes to 6top */
+#define TSCH_CALLBACK_PACKET_SENT orchestra_callback_packet_sent
+#define TSCH_CALLBACK_PACKET_RECEIVED orchestra_callback_packet_received
 
 #endif /* WITH_ORCHESTRA */
 
@@ -159,8 +162,6 @@
 #define UIP_CONF_ND6_SEND_NA 0
 #undef SICSLOWPAN_CONF_FRAG
 #define SICSLOWPAN_CONF_FRAG 0
-#undef ENABLE_QOS_WHITE
-#define ENABLE_QOS_WHITE 1
 #endif /* CONTIKI_TARGET_Z1 */
 
 
@@ -52,8 +52,9 @@
 #define QUEUEBUF_CONF_NUM          4
 #endif
 
-#ifndef ENABLE_QOS_WHITE
-#define ENABLE_QOS_WHITE           1
+/* Per-neighbor TSCH queueing classes, set from the IPv6 traffic class */
+#ifndef TSCH_QUEUE_CONF_NUM_CLASSES
+#define TSCH_QUEUE_CONF_NUM_CLASSES 3
 #endif
 
 #ifndef MAX_LOG_LENGTH
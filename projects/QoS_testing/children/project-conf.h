@@ -48,8 +48,9 @@
 #define RPL_WITH_NON_STORING 1
 #define WITH_NON_STORING 1
 
-#ifndef ENABLE_QOS_WHITE
-#define ENABLE_QOS_WHITE           1
+/* Per-neighbor TSCH queueing classes, set from the IPv6 traffic class */
+#ifndef TSCH_QUEUE_CONF_NUM_CLASSES
+#define TSCH_QUEUE_CONF_NUM_CLASSES 3
 #endif
 
 // #ifndef QUEUEBUF_CONF_NUM
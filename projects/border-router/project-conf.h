@@ -39,6 +39,8 @@
 #if WITH_NON_STORING
 #undef RPL_NS_CONF_LINK_NUM
 #define RPL_NS_CONF_LINK_NUM 40 /* Number of links maintained at the root */
+#undef RPL_NS_CONF_WITH_HASH
+#define RPL_NS_CONF_WITH_HASH 1 /* Index the links by node address */
 #undef UIP_CONF_MAX_ROUTES
 #define UIP_CONF_MAX_ROUTES 0 /* No need for routes */
 #undef RPL_CONF_MOP
@@ -34,4 +34,12 @@
 
 #define UNIT_TEST_PRINT_FUNCTION test_print_report
 
+/* For test-process-priority */
+#define PROCESS_CONF_WITH_PRIORITY 1
+#define PROCESS_CONF_NUMEVENTS_HIGH 4
+
+#if WITH_TEST_MEMB
+#define MEMB_CONF_WITH_SLAB 1
+#endif /* WITH_TEST_MEMB */
+
 #endif /* !_PROJECT_CONF_H_ */
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "lib/hashindex.h"
+
+PROCESS(test_process, "hashindex.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM 6
+
+struct item {
+  unsigned char value;
+  unsigned char key[2];
+};
+
+static struct item items[NUM];
+static struct item extra = { NUM, { 0xff, 0xff } };
+
+/* With few slots, most keys share their probe sequence with others */
+HASHINDEX(test_index, NUM + 1, offsetof(struct item, key), 2);
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Are the items in the index exactly those marked in present? */
+static int
+check_items(const int *present)
+{
+  int i;
+
+  for(i = 0; i < NUM; i++) {
+    if(hashindex_lookup(&test_index, items[i].key) != (present[i] ? &items[i] : NULL)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_add_remove, "Add and remove");
+UNIT_TEST(test_add_remove)
+{
+  static const int order[NUM] = { 3, 0, 5, 1, 4, 2 };
+  int present[NUM];
+  int i;
+  int round;
+
+  UNIT_TEST_BEGIN();
+
+  for(round = 0; round < NUM; round++) {
+    hashindex_init(&test_index);
+    for(i = 0; i < NUM; i++) {
+      items[i].value = i;
+      items[i].key[0] = i;
+      items[i].key[1] = round;
+      UNIT_TEST_ASSERT(hashindex_add(&test_index, &items[i]) == 1);
+      present[i] = 1;
+    }
+    /* One slot is always left free */
+    UNIT_TEST_ASSERT(hashindex_add(&test_index, &extra) == 0);
+    UNIT_TEST_ASSERT(check_items(present));
+    UNIT_TEST_ASSERT(hashindex_lookup(&test_index, extra.key) == NULL);
+
+    /* Every removal may move the entries after it back */
+    for(i = 0; i < NUM; i++) {
+      hashindex_remove(&test_index, &items[order[(i + round) % NUM]]);
+      present[order[(i + round) % NUM]] = 0;
+      UNIT_TEST_ASSERT(check_items(present));
+    }
+    /* Removing an item that is not indexed does nothing */
+    hashindex_remove(&test_index, &items[0]);
+    UNIT_TEST_ASSERT(check_items(present));
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_same_key, "Items with the same key");
+UNIT_TEST(test_same_key)
+{
+  struct item *item;
+  int slot;
+  int found;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  hashindex_init(&test_index);
+  for(i = 0; i < NUM; i++) {
+    items[i].value = i;
+    items[i].key[0] = i % 2;
+    items[i].key[1] = 0;
+    UNIT_TEST_ASSERT(hashindex_add(&test_index, &items[i]) == 1);
+  }
+
+  /* Every item with the key is found once */
+  found = 0;
+  slot = -1;
+  while((item = hashindex_lookup_next(&test_index, items[1].key, &slot)) != NULL) {
+    UNIT_TEST_ASSERT(item->key[0] == 1);
+    UNIT_TEST_ASSERT((found & (1 << item->value)) == 0);
+    found |= 1 << item->value;
+  }
+  UNIT_TEST_ASSERT(found == ((1 << 1) | (1 << 3) | (1 << 5)));
+
+  hashindex_remove(&test_index, &items[3]);
+  found = 0;
+  slot = -1;
+  while((item = hashindex_lookup_next(&test_index, items[1].key, &slot)) != NULL) {
+    found |= 1 << item->value;
+  }
+  UNIT_TEST_ASSERT(found == ((1 << 1) | (1 << 5)));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_add_remove);
+  UNIT_TEST_RUN(test_same_key);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
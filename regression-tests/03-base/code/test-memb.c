@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "lib/memb.h"
+
+PROCESS(test_process, "memb.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+#if !MEMB_WITH_SLAB
+#error "The memb test needs MEMB_CONF_WITH_SLAB"
+#endif
+
+#define NUM 4
+
+struct item {
+  unsigned short a, b;
+};
+
+MEMB(items, struct item, NUM);
+/* Smaller than a free list link */
+MEMB(bytes, char, NUM);
+
+MEMB_SLAB(test_slab, sizeof(struct item), NUM);
+MEMB_SHARED(shared_a, struct item, NUM - 1, test_slab);
+MEMB_SHARED(shared_b, struct item, NUM - 1, test_slab);
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_free_list, "Free list");
+UNIT_TEST(test_free_list)
+{
+  struct item *p[NUM];
+  struct item *q;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  memb_init(&items);
+  for(i = 0; i < NUM; i++) {
+    p[i] = memb_alloc(&items);
+    UNIT_TEST_ASSERT(p[i] != NULL && memb_inmemb(&items, p[i]));
+  }
+  UNIT_TEST_ASSERT(memb_alloc(&items) == NULL);
+  UNIT_TEST_ASSERT(memb_numfree(&items) == 0);
+
+  /* The last freed block is allocated first. Freed blocks keep their
+     contents, as callers read a list link after freeing a list item */
+  p[1]->a = 0xffff;
+  p[1]->b = 0xfffe;
+  UNIT_TEST_ASSERT(memb_free(&items, p[1]) == 0);
+  UNIT_TEST_ASSERT(memb_free(&items, p[2]) == 0);
+  UNIT_TEST_ASSERT(p[1]->a == 0xffff && p[1]->b == 0xfffe);
+  UNIT_TEST_ASSERT(memb_numfree(&items) == 2);
+  q = memb_alloc(&items);
+  UNIT_TEST_ASSERT(q == p[2]);
+  q = memb_alloc(&items);
+  UNIT_TEST_ASSERT(q == p[1]);
+  UNIT_TEST_ASSERT(memb_alloc(&items) == NULL);
+
+  /* Double free, pointers into or outside of the block */
+  UNIT_TEST_ASSERT(memb_free(&items, p[0]) == 0);
+  UNIT_TEST_ASSERT(memb_free(&items, p[0]) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&items) == 1);
+  UNIT_TEST_ASSERT(memb_free(&items, (char *)p[3] + 1) == -1);
+  UNIT_TEST_ASSERT(memb_free(&items, &q) == -1);
+  UNIT_TEST_ASSERT(memb_numfree(&items) == 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_small_blocks, "Small blocks");
+UNIT_TEST(test_small_blocks)
+{
+  char *p[NUM];
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  memb_init(&bytes);
+  for(i = 0; i < NUM; i++) {
+    p[i] = memb_alloc(&bytes);
+    UNIT_TEST_ASSERT(p[i] != NULL);
+  }
+  UNIT_TEST_ASSERT(memb_alloc(&bytes) == NULL);
+  UNIT_TEST_ASSERT(memb_free(&bytes, p[2]) == 0);
+  UNIT_TEST_ASSERT(memb_free(&bytes, p[0]) == 0);
+  UNIT_TEST_ASSERT(memb_alloc(&bytes) == p[0]);
+  UNIT_TEST_ASSERT(memb_alloc(&bytes) == p[2]);
+  UNIT_TEST_ASSERT(memb_numfree(&bytes) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_shared, "Shared slab");
+UNIT_TEST(test_shared)
+{
+  struct item *a[NUM - 1];
+  struct item *b;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  memb_init(&test_slab);
+  memb_init(&shared_a);
+  memb_init(&shared_b);
+
+  /* shared_a is limited to NUM - 1 blocks */
+  for(i = 0; i < NUM - 1; i++) {
+    a[i] = memb_alloc(&shared_a);
+    UNIT_TEST_ASSERT(a[i] != NULL && memb_inmemb(&shared_a, a[i]));
+  }
+  UNIT_TEST_ASSERT(memb_alloc(&shared_a) == NULL);
+  UNIT_TEST_ASSERT(memb_numfree(&shared_a) == 0);
+
+  /* shared_b gets the last block of the slab */
+  UNIT_TEST_ASSERT(memb_numfree(&shared_b) == 1);
+  b = memb_alloc(&shared_b);
+  UNIT_TEST_ASSERT(b != NULL && memb_inmemb(&shared_b, b));
+  UNIT_TEST_ASSERT(memb_alloc(&shared_b) == NULL);
+  UNIT_TEST_ASSERT(memb_numfree(&test_slab) == 0);
+
+  /* Blocks can only be freed through the memory block they were
+     allocated for */
+  UNIT_TEST_ASSERT(!memb_inmemb(&shared_b, a[0]));
+  UNIT_TEST_ASSERT(memb_free(&shared_b, a[0]) == -1);
+  UNIT_TEST_ASSERT(memb_free(&test_slab, a[0]) == -1);
+  UNIT_TEST_ASSERT(memb_numfree(&test_slab) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&shared_b) == 0);
+
+  /* A block freed by shared_a can be used by shared_b */
+  UNIT_TEST_ASSERT(memb_free(&shared_a, a[0]) == 0);
+  UNIT_TEST_ASSERT(memb_free(&shared_a, a[0]) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&shared_a) == 1);
+  UNIT_TEST_ASSERT(memb_numfree(&shared_b) == 1);
+  UNIT_TEST_ASSERT(memb_alloc(&shared_b) == a[0]);
+  UNIT_TEST_ASSERT(memb_inmemb(&shared_b, a[0]));
+  UNIT_TEST_ASSERT(!memb_inmemb(&shared_a, a[0]));
+  UNIT_TEST_ASSERT(memb_free(&shared_a, a[0]) == -1);
+  UNIT_TEST_ASSERT(memb_free(&shared_b, a[0]) == 0);
+  UNIT_TEST_ASSERT(memb_free(&shared_b, b) == 0);
+  for(i = 1; i < NUM - 1; i++) {
+    UNIT_TEST_ASSERT(memb_free(&shared_a, a[i]) == 0);
+  }
+  UNIT_TEST_ASSERT(memb_numfree(&test_slab) == NUM);
+
+  /* memb_init() gives the blocks of a memory block back to the slab,
+     and leaves those of the others */
+  for(i = 0; i < NUM - 1; i++) {
+    a[i] = memb_alloc(&shared_a);
+  }
+  b = memb_alloc(&shared_b);
+  UNIT_TEST_ASSERT(memb_numfree(&test_slab) == 0);
+  memb_init(&shared_a);
+  UNIT_TEST_ASSERT(memb_numfree(&test_slab) == NUM - 1);
+  UNIT_TEST_ASSERT(memb_numfree(&shared_a) == NUM - 1);
+  UNIT_TEST_ASSERT(!memb_inmemb(&shared_a, a[0]));
+  UNIT_TEST_ASSERT(memb_inmemb(&shared_b, b));
+  UNIT_TEST_ASSERT(memb_free(&shared_b, b) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&test_slab) == NUM);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_free_list);
+  UNIT_TEST_RUN(test_small_blocks);
+  UNIT_TEST_RUN(test_shared);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+PROCESS(test_process, "process priority test");
+PROCESS(low_process, "normal-priority receiver");
+PROCESS(high_process, "high-priority receiver");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Events as delivered: receiver in the high bit, sequence number below */
+#define HIGH 0x80
+#define MAX_DELIVERED 16
+static unsigned char delivered[MAX_DELIVERED];
+static unsigned char ndelivered;
+
+static process_event_t test_event;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+record(unsigned char tag, process_event_t ev, process_data_t data)
+{
+  if(ev == test_event && ndelivered < MAX_DELIVERED) {
+    delivered[ndelivered++] = tag | (unsigned char)(uintptr_t)data;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(low_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_YIELD();
+    record(0, ev, data);
+  }
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(high_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_YIELD();
+    record(HIGH, ev, data);
+  }
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static int
+post(struct process *p, unsigned char seq)
+{
+  return process_post(p, test_event, (process_data_t)(uintptr_t)seq);
+}
+/*---------------------------------------------------------------------------*/
+/* Deliver all queued events from within the test process. Nothing is
+   posted to the test process itself, it would not be called again
+   while it is running. */
+static void
+drain(void)
+{
+  struct process *caller = process_current;
+
+  ndelivered = 0;
+  while(process_nevents() > 0) {
+    process_run();
+  }
+  process_current = caller;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_high_first, "High-priority events go first");
+UNIT_TEST(test_high_first)
+{
+  static const unsigned char expected[] = { HIGH | 3, HIGH | 4, 1, 2, 5 };
+  unsigned char i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(post(&low_process, 1) == PROCESS_ERR_OK);
+  UNIT_TEST_ASSERT(post(&low_process, 2) == PROCESS_ERR_OK);
+  UNIT_TEST_ASSERT(post(&high_process, 3) == PROCESS_ERR_OK);
+  UNIT_TEST_ASSERT(post(&high_process, 4) == PROCESS_ERR_OK);
+  UNIT_TEST_ASSERT(post(&low_process, 5) == PROCESS_ERR_OK);
+  drain();
+
+  UNIT_TEST_ASSERT(ndelivered == sizeof(expected));
+  for(i = 0; i < sizeof(expected); i++) {
+    UNIT_TEST_ASSERT(delivered[i] == expected[i]);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_high_full, "Full high-priority queue");
+UNIT_TEST(test_high_full)
+{
+  unsigned char i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < PROCESS_CONF_NUMEVENTS_HIGH; i++) {
+    UNIT_TEST_ASSERT(post(&high_process, i) == PROCESS_ERR_OK);
+  }
+  /* Must not go to the normal queue, where it would be delivered
+     after events posted later */
+  UNIT_TEST_ASSERT(post(&high_process, i) == PROCESS_ERR_FULL);
+  UNIT_TEST_ASSERT(process_nevents() == PROCESS_CONF_NUMEVENTS_HIGH);
+  /* The normal queue is still available */
+  UNIT_TEST_ASSERT(post(&low_process, 0) == PROCESS_ERR_OK);
+  drain();
+
+  UNIT_TEST_ASSERT(ndelivered == PROCESS_CONF_NUMEVENTS_HIGH + 1);
+  for(i = 0; i < PROCESS_CONF_NUMEVENTS_HIGH; i++) {
+    UNIT_TEST_ASSERT(delivered[i] == (HIGH | i));
+  }
+  UNIT_TEST_ASSERT(delivered[i] == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  test_event = process_alloc_event();
+  process_start(&low_process, NULL);
+  process_start(&high_process, NULL);
+  process_set_priority(&high_process, PROCESS_PRIORITY_HIGH);
+  /* Let the boot-time events settle */
+  drain();
+
+  UNIT_TEST_RUN(test_high_first);
+  UNIT_TEST_RUN(test_high_full);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -34,9 +34,55 @@
 
 #define UNIT_TEST_PRINT_FUNCTION test_print_report
 
+#if WITH_TEST_QUEUE_CLASSES
+/* Enough buffers for all packets of the queue classes benchmark */
+#undef QUEUEBUF_CONF_NUM
+#define QUEUEBUF_CONF_NUM   16
+#define TSCH_QUEUE_CONF_NUM_CLASSES 3
+#elif WITH_TEST_BURST
+/* Room for all fragments of a datagram, sent in bursts */
+#undef QUEUEBUF_CONF_NUM
+#define QUEUEBUF_CONF_NUM   16
+#define TSCH_CONF_BURST_MAX_LEN 8
+/* Tells the receiver when the first fragment of a datagram arrived */
+#define TSCH_CALLBACK_PACKET_RECEIVED test_packet_received
+/* Let the second node join quickly */
+#define TSCH_CONF_EB_PERIOD CLOCK_SECOND
+#elif WITH_TEST_ORCHESTRA
+#undef QUEUEBUF_CONF_NUM
+#define QUEUEBUF_CONF_NUM   16
+#define TSCH_CONF_EB_PERIOD CLOCK_SECOND
+/* Orchestra with adaptive cells, and 6top along with it */
+#define TSCH_SCHEDULE_CONF_WITH_6TISCH_MINIMAL 0
+#define TSCH_CONF_WITH_LINK_SELECTOR 1
+#define TSCH_CONF_WITH_SIXTOP 1
+#define TSCH_CALLBACK_NEW_TIME_SOURCE orchestra_callback_new_time_source
+#define TSCH_CALLBACK_PACKET_READY orchestra_callback_packet_ready
+#define TSCH_CALLBACK_PACKET_SENT orchestra_callback_packet_sent
+#define TSCH_CALLBACK_PACKET_RECEIVED orchestra_callback_packet_received
+#define ORCHESTRA_CONF_RULES { &eb_per_time_source, &unicast_adaptive, &default_common }
+/* An EB cell every 310 ms instead of 3.97 s, to let the second node join quickly */
+#define ORCHESTRA_CONF_EBSF_PERIOD 31
+/* Without RPL routes there is no per-neighbor unicast cell: the packets
+ * start in a short common slotframe, until the first adaptive cell takes
+ * them over */
+#define ORCHESTRA_CONF_COMMON_SHARED_PERIOD 7
+#elif WITH_TEST_SIXTOP_MSF
+#define TSCH_CONF_WITH_SIXTOP 1
+/* Time runs faster in the test: it advances the ASN itself */
+#define SIXTOP_MSF_CONF_HOUSEKEEPING_PERIOD (CLOCK_SECOND / 32)
+#define SIXTOP_MSF_CONF_TIMEOUT (CLOCK_SECOND / 4)
+#elif WITH_TEST_CHANNEL_BLACKLIST
+#define TSCH_CONF_WITH_CHANNEL_BLACKLIST 1
+#else /* WITH_TEST_QUEUE_CLASSES */
 /* Set the minimum value of QUEUEBUF_CONF_NUM for the flush_nbr_queue test */
 #undef QUEUEBUF_CONF_NUM
 #define QUEUEBUF_CONF_NUM   1
+#endif /* WITH_TEST_QUEUE_CLASSES */
+
+#if WITH_TEST_SIXTOP
+#define TSCH_CONF_WITH_SIXTOP 1
+#endif /* WITH_TEST_SIXTOP */
 
 #undef TSCH_LOG_CONF_LEVEL
 #define TSCH_LOG_CONF_LEVEL 2
@@ -45,7 +91,15 @@
 #define TSCH_CONF_AUTOSTART 1
 
 #undef NETSTACK_CONF_MAC
+#if WITH_TEST_SIXTOP_MSF
+/* 6P frames are handed to a model of the peers in the test */
+#define NETSTACK_CONF_MAC        air_mac_driver
+#elif WITH_TEST_CHANNEL_BLACKLIST
+/* The test picks the channels itself, TSCH must not hop */
+#define NETSTACK_CONF_MAC        nullmac_driver
+#else /* WITH_TEST_SIXTOP_MSF */
 #define NETSTACK_CONF_MAC        tschmac_driver
+#endif /* WITH_TEST_SIXTOP_MSF */
 
 #undef NETSTACK_CONF_RDC
 #define NETSTACK_CONF_RDC        nordc_driver
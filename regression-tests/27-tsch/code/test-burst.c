@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of TSCH burst mode. Node 2 joins the network of node 1 and
+ *         sends it datagrams large enough to be fragmented. The fragments
+ *         are queued back to back, so the sender sets the frame pending bit
+ *         and both nodes replay the only shared link of the schedule in
+ *         the following timeslots. Every datagram must then arrive intact,
+ *         its fragments in fewer timeslots than one slotframe each. The last
+ *         datagrams are sent while the TSCH lock is taken and released
+ *         over and over, which must end the bursts without losing frames.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "contiki-lib.h"
+
+#include "sys/node-id.h"
+#include "net/ip/simple-udp.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include "net/mac/tsch/tsch-schedule.h"
+#include "net/mac/tsch/tsch-slot-operation.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "TSCH burst mode test");
+AUTOSTART_PROCESSES(&test_process);
+
+#if TSCH_BURST_MAX_LEN < 2
+#error "The burst test needs TSCH_CONF_BURST_MAX_LEN"
+#endif
+
+#define UDP_PORT 5678
+/* About five fragments */
+#define DATAGRAM_LEN 400
+/* Datagrams sent in bursts, then while the lock is taken */
+#define NUM_BURST 3
+#define NUM_LOCKED 3
+#define NUM_DATAGRAMS (NUM_BURST + NUM_LOCKED)
+
+static struct simple_udp_connection conn;
+static uint8_t datagram[DATAGRAM_LEN];
+
+static unsigned received;
+static unsigned corrupted;
+/* The ASN of the first frame of the datagram being received */
+static uint32_t first_frame_asn;
+static int receiving;
+/* The most timeslots the fragments of a datagram sent in bursts took
+   to arrive, from the first one to the last */
+static uint32_t max_timeslots;
+static struct ctimer lock_timer;
+
+/*---------------------------------------------------------------------------*/
+/* Set as TSCH_CALLBACK_PACKET_RECEIVED */
+void
+test_packet_received(const linkaddr_t *src, const linkaddr_t *dest)
+{
+  if(!receiving && linkaddr_cmp(dest, &linkaddr_node_addr)) {
+    first_frame_asn = tsch_current_asn.ls4b;
+    receiving = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+receiver(struct simple_udp_connection *c,
+         const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+         const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+         const uint8_t *data, uint16_t datalen)
+{
+  uint32_t timeslots;
+  int i;
+
+  timeslots = tsch_current_asn.ls4b - first_frame_asn;
+  receiving = 0;
+  for(i = 0; i < datalen; i++) {
+    if(data[i] != (uint8_t)i) {
+      break;
+    }
+  }
+  if(datalen != DATAGRAM_LEN || i < datalen) {
+    corrupted++;
+  }
+  if(received < NUM_BURST && timeslots > max_timeslots) {
+    max_timeslots = timeslots;
+  }
+  received++;
+  printf("datagram %u: %u bytes in %lu timeslots\n",
+         received, datalen, (unsigned long)timeslots);
+}
+/*---------------------------------------------------------------------------*/
+/* Take the lock from process context and give it back, as schedule
+   and queue updates do */
+static void
+lock_and_release(void *ptr)
+{
+  if(tsch_get_lock()) {
+    tsch_release_lock();
+  }
+  ctimer_reset(&lock_timer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_datagram(const uip_ipaddr_t *addr)
+{
+  int i;
+
+  for(i = 0; i < DATAGRAM_LEN; i++) {
+    datagram[i] = (uint8_t)i;
+  }
+  simple_udp_sendto(&conn, datagram, DATAGRAM_LEN, addr);
+}
+/*---------------------------------------------------------------------------*/
+/* The minimal schedule of this tree has shared links in most timeslots:
+   keep a single one, so that only bursts can send fragments back to back */
+static void
+create_single_link_schedule(void)
+{
+  struct tsch_slotframe *sf;
+
+  tsch_schedule_remove_all_slotframes();
+  sf = tsch_schedule_add_slotframe(0, TSCH_SCHEDULE_DEFAULT_LENGTH);
+  tsch_schedule_add_link(sf,
+      LINK_OPTION_RX | LINK_OPTION_TX | LINK_OPTION_SHARED | LINK_OPTION_TIME_KEEPING,
+      LINK_TYPE_ADVERTISING, &tsch_broadcast_address,
+      0, 0);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_burst,
+                   "fragments should be sent in bursts");
+UNIT_TEST(test_burst)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(received == NUM_DATAGRAMS);
+  UNIT_TEST_ASSERT(corrupted == 0);
+  /* Without bursts, every fragment after the first waits for the next
+     slotframe */
+  UNIT_TEST_ASSERT(max_timeslots < 2 * TSCH_SCHEDULE_DEFAULT_LENGTH);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static uip_ipaddr_t addr;
+  static int i;
+  struct tsch_neighbor *n;
+
+  PROCESS_BEGIN();
+
+  simple_udp_register(&conn, UDP_PORT, NULL, UDP_PORT, receiver);
+  tsch_set_coordinator(node_id == 1);
+
+  etimer_set(&et, CLOCK_SECOND);
+  while(tsch_is_associated == 0) {
+    PROCESS_YIELD_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+  }
+  create_single_link_schedule();
+
+  if(node_id == 1) {
+    /* Receiver */
+    etimer_set(&et, 60 * CLOCK_SECOND);
+    while(received < NUM_DATAGRAMS && !etimer_expired(&et)) {
+      PROCESS_YIELD();
+    }
+
+    printf("Run unit-test\n");
+    printf("---\n");
+
+    UNIT_TEST_RUN(test_burst);
+  } else {
+    /* Sender: to the link-local address of the time source, which
+       needs no neighbor discovery once it is in the neighbor cache */
+    n = tsch_queue_get_time_source();
+    uip_ip6addr(&addr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+    uip_ds6_set_addr_iid(&addr, (uip_lladdr_t *)&n->addr);
+    uip_ds6_nbr_add(&addr, (uip_lladdr_t *)&n->addr, 0, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+
+    for(i = 0; i < NUM_DATAGRAMS; i++) {
+      etimer_set(&et, 2 * CLOCK_SECOND);
+      PROCESS_YIELD_UNTIL(etimer_expired(&et));
+      if(i == NUM_BURST) {
+        ctimer_set(&lock_timer, 1, lock_and_release, NULL);
+      }
+      send_datagram(&addr);
+    }
+    etimer_set(&et, 2 * CLOCK_SECOND);
+    PROCESS_YIELD_UNTIL(etimer_expired(&et));
+    ctimer_stop(&lock_timer);
+  }
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the TSCH channel blacklist. A PAN coordinator hops over
+ *         the 16 channels of TSCH_HOPPING_SEQUENCE_16_16, four of which
+ *         are hit by a Wi-Fi network and lose most frames. Slot operation
+ *         does not run: every EB period, the test sends frames until they
+ *         are acknowledged, on the channel slot operation would pick, and
+ *         feeds the per-channel statistics itself. Only the bad channels
+ *         must get blacklisted, a link on a channel in use must keep its
+ *         channel, and the blacklisted channels must be tried again once
+ *         their probation is over.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/tsch-channel-blacklist.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "TSCH channel blacklist test");
+AUTOSTART_PROCESSES(&test_process);
+
+#if !TSCH_WITH_CHANNEL_BLACKLIST
+#error "The channel blacklist test needs TSCH_CONF_WITH_CHANNEL_BLACKLIST"
+#endif
+
+#define EB_PERIODS (2 * TSCH_CHANNEL_BLACKLIST_PROBATION)
+/* Frames sent per EB period */
+#define FRAMES 200
+#define SLOTFRAME_LENGTH 7
+#define NUM_CHANNEL_OFFSETS 4
+/* Channels 12 to 15 overlap with Wi-Fi channel 1 */
+#define IS_BAD(channel) ((channel) >= 12 && (channel) <= 15)
+/* Percentage of frames lost on the bad channels, and on the others */
+#define BAD_LOSS 80
+#define GOOD_LOSS 5
+
+static struct tsch_asn_t asn;
+/* Transmissions on a blacklisted channel, or off the channel of a link
+   that had no reason to move, and periods with a channel blacklisted
+   that Wi-Fi does not hit */
+static int errors;
+/* Transmissions in the first and last EB period */
+static unsigned long first;
+static unsigned long last;
+/* EB periods with the bad channels blacklisted */
+static int blacklisted;
+/* Did the bad channels get another chance? */
+static int retried;
+
+#define CHECK(cond) do { if(!(cond)) { \
+  printf("check failed at L%u: %s\n", __LINE__, #cond); errors++; } } while(0)
+/*---------------------------------------------------------------------------*/
+/* The hopping sequence index of a link, as slot operation computes it.
+ * Sets *own to the index before blacklisting */
+static uint16_t
+hopping_index(struct tsch_asn_t *asn, uint8_t channel_offset, uint16_t *own)
+{
+  uint16_t index_of_0 = TSCH_ASN_MOD(*asn, tsch_hopping_sequence_length);
+  uint16_t index_of_offset = (index_of_0 + channel_offset) % tsch_hopping_sequence_length.val;
+  *own = index_of_offset;
+  if(tsch_channel_blacklist & (1 << index_of_offset)) {
+    index_of_offset = tsch_channel_blacklist_substitute(asn, channel_offset);
+  }
+  return index_of_offset;
+}
+/*---------------------------------------------------------------------------*/
+/* Sends a frame until it is acknowledged, on the next active slots.
+ * Returns the number of transmissions */
+static int
+send_frame(void)
+{
+  uint16_t index;
+  uint16_t own;
+  uint8_t channel;
+  int transmissions = 0;
+  int acked;
+
+  do {
+    TSCH_ASN_INC(asn, 1 + random_rand() % SLOTFRAME_LENGTH);
+    index = hopping_index(&asn, random_rand() % NUM_CHANNEL_OFFSETS, &own);
+    channel = tsch_hopping_sequence[index];
+    CHECK(!(tsch_channel_blacklist & (1 << index)));
+    if(!(tsch_channel_blacklist & (1 << own))) {
+      CHECK(index == own);
+    }
+    acked = random_rand() % 100 >= (IS_BAD(channel) ? BAD_LOSS : GOOD_LOSS);
+    TSCH_CHANNEL_STATS_TX(index, acked);
+    transmissions++;
+  } while(!acked);
+  return transmissions;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the blacklist of the channels hit by Wi-Fi */
+static uint16_t
+bad_channels(void)
+{
+  uint16_t blacklist = 0;
+  int i;
+
+  for(i = 0; i < tsch_hopping_sequence_length.val; i++) {
+    if(IS_BAD(tsch_hopping_sequence[i])) {
+      blacklist |= 1 << i;
+    }
+  }
+  return blacklist;
+}
+/*---------------------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_blacklist,
+                   "only the channels hit by Wi-Fi should be blacklisted");
+UNIT_TEST(test_blacklist)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(errors == 0);
+  /* Blacklisted after the first period, and again after the probation */
+  UNIT_TEST_ASSERT(blacklisted >= EB_PERIODS - 8);
+  UNIT_TEST_ASSERT(last < first);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_probation,
+                   "blacklisted channels should be tried again after their probation");
+UNIT_TEST(test_probation)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(retried);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static const uint8_t sequence[] = { 16, 17, 23, 18, 26, 15, 25, 22,
+                                      19, 11, 12, 13, 24, 14, 20, 21 };
+  static struct etimer et;
+  static int period;
+  unsigned long transmissions;
+  int i;
+
+  PROCESS_BEGIN();
+
+  memcpy(tsch_hopping_sequence, sequence, sizeof(sequence));
+  TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, sizeof(sequence));
+  tsch_is_coordinator = 1;
+  tsch_channel_blacklist_reset();
+
+  printf("period blacklist tx/frame\n");
+  for(period = 0; period < EB_PERIODS; period++) {
+    transmissions = 0;
+    for(i = 0; i < FRAMES; i++) {
+      transmissions += send_frame();
+    }
+    if(period == 0) {
+      first = transmissions;
+    }
+    last = transmissions;
+    printf("%6d %04x %lu.%02lu\n", period, tsch_channel_blacklist,
+           transmissions / FRAMES, transmissions * 100 / FRAMES % 100);
+
+    /* Only the channels hit by Wi-Fi are blacklisted */
+    CHECK((tsch_channel_blacklist & ~bad_channels()) == 0);
+    if(tsch_channel_blacklist == bad_channels()) {
+      blacklisted++;
+    } else if(blacklisted > 0) {
+      /* Bad channels come back one by one, as they were blacklisted */
+      retried = 1;
+    }
+    tsch_channel_blacklist_update();
+
+    /* Let the logs out */
+    etimer_set(&et, 1);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_blacklist);
+  UNIT_TEST_RUN(test_probation);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
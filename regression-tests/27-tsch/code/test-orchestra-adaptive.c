@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the Orchestra unicast_adaptive rule, with 6top enabled.
+ *         Node 2 joins the network of node 1 and keeps its queue to node 1
+ *         filled. Its packets are assigned to the shared cell of the common
+ *         slotframe, which cannot carry them all, so both nodes must add
+ *         adaptive cells. Once the sender has one, TSCH sends the packets
+ *         in its dedicated cells only, which must then carry more than the
+ *         common cell could. A scheduling function that
+ *         only counts the packets sent checks that 6top gets the outcome of
+ *         every packet along with Orchestra.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "contiki-lib.h"
+
+#include "sys/node-id.h"
+#include "net/ip/simple-udp.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include "net/mac/tsch/tsch-schedule.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+#include "orchestra.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "TSCH Orchestra adaptive cells test");
+AUTOSTART_PROCESSES(&test_process);
+
+#if !TSCH_WITH_LINK_SELECTOR || !TSCH_WITH_SIXTOP
+#error "The Orchestra test needs the link selector and 6top"
+#endif
+
+#define UDP_PORT 5678
+#define DATAGRAM_LEN 32
+/* The slotframe handle of unicast_adaptive, its index in ORCHESTRA_CONF_RULES */
+#define ADAPTIVE_HANDLE 1
+/* Packets the sender keeps in its queue to the time source */
+#define QUEUE_LEVEL 6
+/* The sender loads the link for LOAD_TIME, and measures its throughput
+ * over the second half of it, once the cells have been added */
+#define LOAD_TIME (20 * CLOCK_SECOND)
+/* The receiver runs the test once nothing arrived for QUIET_TIME seconds */
+#define QUIET_TIME 5
+
+static struct simple_udp_connection conn;
+static uint8_t datagram[DATAGRAM_LEN];
+
+static unsigned received;
+/* Packets to the time source acknowledged, as seen by the SF */
+static unsigned sf_sent;
+/* The most adaptive cells seen with the other node */
+static unsigned max_cells;
+/* Packets acknowledged and timeslots elapsed during the measurement */
+static unsigned measured_sent;
+static uint32_t measured_timeslots;
+static struct ctimer cells_timer;
+
+/*---------------------------------------------------------------------------*/
+static void
+sf_input(const struct sixp_pkt *pkt, enum sixp_pkt_cmd cmd,
+         const struct sixp_pkt_body *body, const linkaddr_t *peer)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+sf_packet_sent(const linkaddr_t *dest, int status, int transmissions)
+{
+  struct tsch_neighbor *n = tsch_queue_get_time_source();
+  if(status == MAC_TX_OK && n != NULL && linkaddr_cmp(dest, &n->addr)) {
+    sf_sent++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct sixtop_sf test_sf = {
+  0xf0, /* From the experimental SFID range */
+  CLOCK_SECOND,
+  NULL,
+  sf_input,
+  NULL,
+  sf_packet_sent,
+};
+/*---------------------------------------------------------------------------*/
+/* Keep the largest number of Rx (receiver) or Tx (sender) adaptive cells */
+static void
+count_cells(void *ptr)
+{
+  struct tsch_slotframe *sf = tsch_schedule_get_slotframe_by_handle(ADAPTIVE_HANDLE);
+  uint8_t options = node_id == 1 ? LINK_OPTION_RX : LINK_OPTION_TX;
+  unsigned cells = 0;
+  struct tsch_link *l;
+
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->link_options & options) {
+      cells++;
+    }
+  }
+  if(cells > max_cells) {
+    max_cells = cells;
+  }
+  ctimer_reset(&cells_timer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+receiver(struct simple_udp_connection *c,
+         const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+         const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+         const uint8_t *data, uint16_t datalen)
+{
+  received++;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_adaptive_rx,
+                   "receiver should listen in adaptive cells");
+UNIT_TEST(test_adaptive_rx)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(received > 0);
+  UNIT_TEST_ASSERT(max_cells > 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_adaptive_tx,
+                   "sender should use adaptive cells");
+UNIT_TEST(test_adaptive_tx)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("%u packets in %lu timeslots, %u cells\n",
+         measured_sent, (unsigned long)measured_timeslots, max_cells);
+  /* Orchestra got the outcome of the packets */
+  UNIT_TEST_ASSERT(max_cells > 0);
+  /* So did 6top */
+  UNIT_TEST_ASSERT(sf_sent > 0);
+  /* The dedicated cells carried more than the single common cell could */
+  UNIT_TEST_ASSERT(measured_sent >
+                   measured_timeslots / ORCHESTRA_COMMON_SHARED_PERIOD + 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static struct etimer load_timer;
+  static uip_ipaddr_t addr;
+  static uint32_t start_asn;
+  static unsigned start_sent;
+  static int measuring;
+  static unsigned last_received;
+  static int quiet;
+  struct tsch_neighbor *n;
+  int i;
+
+  PROCESS_BEGIN();
+
+  orchestra_init();
+  sixtop_add_sf(&test_sf);
+  simple_udp_register(&conn, UDP_PORT, NULL, UDP_PORT, receiver);
+  tsch_set_coordinator(node_id == 1);
+
+  etimer_set(&et, CLOCK_SECOND);
+  while(tsch_is_associated == 0) {
+    PROCESS_YIELD_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+  }
+  ctimer_set(&cells_timer, CLOCK_SECOND / 10, count_cells, NULL);
+
+  if(node_id == 1) {
+    /* Receiver: until the sender is done */
+    last_received = 0;
+    quiet = 0;
+    etimer_set(&et, CLOCK_SECOND);
+    while(quiet < QUIET_TIME) {
+      PROCESS_YIELD_UNTIL(etimer_expired(&et));
+      etimer_reset(&et);
+      if(received > 0 && received == last_received) {
+        quiet++;
+      } else {
+        quiet = 0;
+      }
+      last_received = received;
+    }
+    ctimer_stop(&cells_timer);
+
+    printf("Run unit-test\n");
+    printf("---\n");
+
+    UNIT_TEST_RUN(test_adaptive_rx);
+  } else {
+    /* Sender: to the link-local address of the time source, which
+       needs no neighbor discovery once it is in the neighbor cache */
+    n = tsch_queue_get_time_source();
+    uip_ip6addr(&addr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+    uip_ds6_set_addr_iid(&addr, (uip_lladdr_t *)&n->addr);
+    uip_ds6_nbr_add(&addr, (uip_lladdr_t *)&n->addr, 0, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+    etimer_set(&et, 2 * CLOCK_SECOND);
+    PROCESS_YIELD_UNTIL(etimer_expired(&et));
+
+    memset(datagram, 0x5a, sizeof(datagram));
+    measuring = 0;
+    etimer_set(&load_timer, LOAD_TIME / 2);
+    etimer_set(&et, 1);
+    while(measuring < 2) {
+      PROCESS_YIELD();
+      if(ev == PROCESS_EVENT_TIMER && data == &load_timer) {
+        /* Start, then end the measurement */
+        if(measuring == 0) {
+          start_asn = tsch_current_asn.ls4b;
+          start_sent = sf_sent;
+          etimer_reset(&load_timer);
+        } else {
+          measured_timeslots = tsch_current_asn.ls4b - start_asn;
+          measured_sent = sf_sent - start_sent;
+        }
+        measuring++;
+      } else if(ev == PROCESS_EVENT_TIMER && data == &et) {
+        /* Top up the queue, without looping on a full one */
+        n = tsch_queue_get_time_source();
+        for(i = 0; i < QUEUE_LEVEL && n != NULL
+            && tsch_queue_packet_count(&n->addr) < QUEUE_LEVEL; i++) {
+          simple_udp_sendto(&conn, datagram, DATAGRAM_LEN, &addr);
+        }
+        etimer_reset(&et);
+      }
+    }
+    etimer_stop(&et);
+    ctimer_stop(&cells_timer);
+
+    printf("Run unit-test\n");
+    printf("---\n");
+
+    UNIT_TEST_RUN(test_adaptive_tx);
+  }
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
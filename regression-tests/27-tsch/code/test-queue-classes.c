@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark of per-class queueing delay in the TSCH neighbor queues.
+ *         A mix of bulk (class 0) and prioritized (classes 1 and 2) broadcast
+ *         packets is enqueued at once; the delay from enqueueing to the
+ *         packet_sent callback is then reported per class.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "contiki-lib.h"
+
+#include "net/linkaddr.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-queue.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "TSCH queueing classes benchmark");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Traffic pattern: bulk packets with a few prioritized ones interleaved */
+static const uint8_t pattern[] = { 0, 0, 0, 2, 0, 0, 1, 0, 0, 2, 0, 1 };
+#define NUM_PACKETS (sizeof(pattern) / sizeof(pattern[0]))
+
+struct packet_record {
+  uint8_t tx_class;
+  clock_time_t enqueued;
+};
+static struct packet_record records[NUM_PACKETS];
+
+struct class_stats {
+  unsigned count;
+  unsigned long delay_sum;
+  clock_time_t delay_max;
+};
+static struct class_stats stats[TSCH_QUEUE_NUM_CLASSES];
+static unsigned sent_count;
+
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(void *ptr, int status, int transmissions)
+{
+  struct packet_record *r = ptr;
+  clock_time_t delay = clock_time() - r->enqueued;
+
+  stats[r->tx_class].count++;
+  stats[r->tx_class].delay_sum += delay;
+  if(delay > stats[r->tx_class].delay_max) {
+    stats[r->tx_class].delay_max = delay;
+  }
+  sent_count++;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+mean_delay(int c)
+{
+  return stats[c].count ? stats[c].delay_sum / stats[c].count : 0;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test,
+                   "higher classes should see a lower queueing delay");
+UNIT_TEST(test)
+{
+  int c;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(sent_count == NUM_PACKETS);
+  for(c = 1; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+    UNIT_TEST_ASSERT(mean_delay(c) < mean_delay(c - 1));
+    UNIT_TEST_ASSERT(stats[c].delay_max <= stats[c - 1].delay_max);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  int i;
+
+  PROCESS_BEGIN();
+
+  tsch_set_coordinator(1);
+
+  etimer_set(&et, CLOCK_SECOND);
+  while(tsch_is_associated == 0) {
+    PROCESS_YIELD_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+  }
+
+  /* Enqueue all packets at once, so that they compete for the same cells */
+  for(i = 0; i < NUM_PACKETS; i++) {
+    records[i].tx_class = MIN(pattern[i], TSCH_QUEUE_NUM_CLASSES - 1);
+    records[i].enqueued = clock_time();
+    packetbuf_clear();
+    packetbuf_set_datalen(sprintf(packetbuf_dataptr(), "packet %u", i));
+    packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_null);
+    packetbuf_set_attr(PACKETBUF_ATTR_TRAFFIC_CLASS, records[i].tx_class);
+    NETSTACK_MAC.send(packet_sent, &records[i]);
+  }
+
+  etimer_set(&et, CLOCK_SECOND / 4);
+  while(sent_count < NUM_PACKETS) {
+    PROCESS_YIELD_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+  }
+
+  for(i = 0; i < TSCH_QUEUE_NUM_CLASSES; i++) {
+    printf("Class %u: %u packets, mean delay %lu ticks, max delay %lu ticks\n",
+           i, stats[i].count, mean_delay(i), (unsigned long)stats[i].delay_max);
+  }
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Unit tests of the 6P messages of the 6top sublayer, and of their
+ *         encoding in the IETF payload IE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "contiki-lib.h"
+
+#include "net/mac/frame802154e-ie.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/sixtop/sixtop-conf.h"
+#include "net/mac/tsch/sixtop/sixp-pkt.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "6P message test");
+AUTOSTART_PROCESSES(&test_process);
+
+static const struct sixp_cell test_cells[] = {
+  { 1, 0 }, { 12, 3 }, { 300, 15 }
+};
+#define NUM_TEST_CELLS (sizeof(test_cells) / sizeof(struct sixp_cell))
+
+static uint8_t cell_list[NUM_TEST_CELLS * SIXP_PKT_CELL_LEN];
+static uint8_t msg[SIXP_MAX_MSG_LEN];
+
+UNIT_TEST_REGISTER(test_add_request,
+                   "an ADD request should parse back to what was written");
+UNIT_TEST(test_add_request)
+{
+  struct sixp_pkt_body body;
+  struct sixp_pkt pkt;
+  struct sixp_cell cell;
+  int len;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  memset(&body, 0, sizeof(body));
+  for(i = 0; i < NUM_TEST_CELLS; i++) {
+    sixp_pkt_set_cell(cell_list, i, &test_cells[i]);
+  }
+  body.metadata = 0x1234;
+  body.cell_options = SIXP_PKT_CELL_OPTION_TX | SIXP_PKT_CELL_OPTION_SHARED;
+  body.num_cells = 2;
+  body.cell_list = cell_list;
+  body.cell_list_len = NUM_TEST_CELLS;
+  len = sixp_pkt_create(SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_ADD,
+                        SIXP_PKT_CMD_ADD, 0, 7, &body, msg, sizeof(msg));
+  UNIT_TEST_ASSERT(len == SIXP_PKT_HDR_LEN + 4
+                   + NUM_TEST_CELLS * SIXP_PKT_CELL_LEN);
+  /* Too small a buffer */
+  UNIT_TEST_ASSERT(sixp_pkt_create(SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_ADD,
+                                   SIXP_PKT_CMD_ADD, 0, 7, &body,
+                                   msg, len - 1) < 0);
+
+  UNIT_TEST_ASSERT(sixp_pkt_get_version(msg, len) == SIXP_PKT_VERSION);
+  UNIT_TEST_ASSERT(sixp_pkt_parse(msg, len, &pkt) == 0);
+  UNIT_TEST_ASSERT(pkt.type == SIXP_PKT_TYPE_REQUEST);
+  UNIT_TEST_ASSERT(pkt.code == SIXP_PKT_CMD_ADD);
+  UNIT_TEST_ASSERT(pkt.sfid == 0 && pkt.seqnum == 7);
+
+  UNIT_TEST_ASSERT(sixp_pkt_parse_body(&pkt, SIXP_PKT_CMD_ADD, &body) == 0);
+  UNIT_TEST_ASSERT(body.metadata == 0x1234);
+  UNIT_TEST_ASSERT(body.cell_options
+                   == (SIXP_PKT_CELL_OPTION_TX | SIXP_PKT_CELL_OPTION_SHARED));
+  UNIT_TEST_ASSERT(body.num_cells == 2);
+  UNIT_TEST_ASSERT(body.cell_list_len == NUM_TEST_CELLS);
+  for(i = 0; i < NUM_TEST_CELLS; i++) {
+    sixp_pkt_get_cell(body.cell_list, i, &cell);
+    UNIT_TEST_ASSERT(cell.timeslot == test_cells[i].timeslot);
+    UNIT_TEST_ASSERT(cell.channel_offset == test_cells[i].channel_offset);
+  }
+
+  /* A truncated cell list */
+  pkt.body_len--;
+  UNIT_TEST_ASSERT(sixp_pkt_parse_body(&pkt, SIXP_PKT_CMD_ADD, &body) < 0);
+  /* A header alone is too short */
+  UNIT_TEST_ASSERT(sixp_pkt_parse(msg, SIXP_PKT_HDR_LEN - 1, &pkt) < 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_response,
+                   "responses should carry a body unless they report an error");
+UNIT_TEST(test_response)
+{
+  struct sixp_pkt_body body;
+  struct sixp_pkt pkt;
+  int len;
+
+  UNIT_TEST_BEGIN();
+
+  memset(&body, 0, sizeof(body));
+  body.num_cells = 513;
+  len = sixp_pkt_create(SIXP_PKT_TYPE_RESPONSE, SIXP_PKT_RC_SUCCESS,
+                        SIXP_PKT_CMD_COUNT, 0, 8, &body, msg, sizeof(msg));
+  UNIT_TEST_ASSERT(len == SIXP_PKT_HDR_LEN + 2);
+  UNIT_TEST_ASSERT(sixp_pkt_parse(msg, len, &pkt) == 0);
+  UNIT_TEST_ASSERT(pkt.type == SIXP_PKT_TYPE_RESPONSE);
+  UNIT_TEST_ASSERT(sixp_pkt_parse_body(&pkt, SIXP_PKT_CMD_COUNT, &body) == 0);
+  UNIT_TEST_ASSERT(body.num_cells == 513);
+
+  len = sixp_pkt_create(SIXP_PKT_TYPE_RESPONSE, SIXP_PKT_RC_ERR_BUSY,
+                        SIXP_PKT_CMD_ADD, 0, 8, &body, msg, sizeof(msg));
+  UNIT_TEST_ASSERT(len == SIXP_PKT_HDR_LEN);
+  UNIT_TEST_ASSERT(sixp_pkt_parse(msg, len, &pkt) == 0);
+  UNIT_TEST_ASSERT(pkt.code == SIXP_PKT_RC_ERR_BUSY);
+  UNIT_TEST_ASSERT(sixp_pkt_parse_body(&pkt, SIXP_PKT_CMD_ADD, &body) == 0);
+  UNIT_TEST_ASSERT(body.cell_list_len == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_ie,
+                   "a 6P message should travel in the IETF payload IE");
+UNIT_TEST(test_ie)
+{
+  static uint8_t buf[SIXP_MAX_MSG_LEN + 8];
+  struct sixp_pkt_body body;
+  struct ieee802154_ies ies;
+  int len;
+  int hdr_len;
+
+  UNIT_TEST_BEGIN();
+
+  memset(&body, 0, sizeof(body));
+  len = sixp_pkt_create(SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_CLEAR,
+                        SIXP_PKT_CMD_CLEAR, 0, 0, &body, msg, sizeof(msg));
+  UNIT_TEST_ASSERT(len == SIXP_PKT_HDR_LEN + 2);
+
+  memset(&ies, 0, sizeof(ies));
+  ies.ie_sixtop_content_len = len;
+  hdr_len = frame80215e_create_ie_header_list_termination_1(buf, sizeof(buf), &ies);
+  UNIT_TEST_ASSERT(hdr_len > 0);
+  UNIT_TEST_ASSERT(frame80215e_create_ie_ietf_sixtop(buf + hdr_len,
+                                                     sizeof(buf) - hdr_len, &ies) == 3);
+  hdr_len += 3;
+  memcpy(buf + hdr_len, msg, len);
+
+  memset(&ies, 0, sizeof(ies));
+  UNIT_TEST_ASSERT(frame802154e_parse_information_elements(buf, hdr_len + len,
+                                                           &ies) >= 0);
+  UNIT_TEST_ASSERT(ies.ie_sixtop_content == buf + hdr_len);
+  UNIT_TEST_ASSERT(ies.ie_sixtop_content_len == len);
+
+  /* An IE longer than the frame */
+  memset(&ies, 0, sizeof(ies));
+  UNIT_TEST_ASSERT(frame802154e_parse_information_elements(buf, hdr_len + len - 1,
+                                                           &ies) < 0);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_add_request);
+  UNIT_TEST_RUN(test_response);
+  UNIT_TEST_RUN(test_ie);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
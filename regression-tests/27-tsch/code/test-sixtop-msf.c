@@ -0,0 +1,663 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the 6top sublayer and of its MSF-like scheduling
+ *         function. The slot operation of TSCH does not run: the frames
+ *         of the node are handed to models of two neighbors, its time
+ *         source, which answers 6P requests and keeps its own copy of the
+ *         cells it granted, and a child, which sends scripted requests.
+ *         The test advances the ASN and reports the transmissions to the
+ *         time source itself. The TSCH schedule and queues are the real
+ *         ones.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/frame802154.h"
+#include "net/mac/frame802154e-ie.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include "net/mac/tsch/tsch-schedule.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+#include "net/mac/tsch/sixtop/sixp.h"
+#include "net/mac/tsch/sixtop/sixtop-msf.h"
+#include "lib/random.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "6top scheduling function test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Slotframes per step of the test */
+#define SLOTFRAMES_PER_STEP SIXTOP_MSF_MAX_NUM_CELLS
+#define MAX_STEPS 20
+#define MAX_FRAMES 4
+#define MAX_CELLS 16
+
+/* The TX cells with the time source, and the requests it got, after
+   each phase */
+static int load_cells;
+static unsigned long load_requests;
+static int idle_cells;
+static unsigned long idle_requests;
+static int reboot_cells;
+static int timeout_cells;
+static unsigned long timeout_requests[2];
+
+/* A frame on the air, with the callback its sender waits for */
+struct frame {
+  uint8_t buf[PACKETBUF_SIZE];
+  int len;
+  linkaddr_t dest;
+  mac_callback_t sent;
+  void *ptr;
+};
+
+static struct frame air[MAX_FRAMES];
+static int num_frames;
+
+/* A neighbor, with the cells it shares with us */
+struct peer {
+  linkaddr_t addr;
+  uint8_t seqnum;
+  uint8_t cells[MAX_CELLS * SIXP_PKT_CELL_LEN];
+  int num_cells;
+  /* Whether the peer answers our requests, and acknowledges our frames */
+  int answers;
+  int acks;
+  unsigned long requests;
+};
+
+static struct peer parent;
+static struct peer child;
+/* Answers of the time source that were not as expected, and steps
+   after which its cells and ours differed */
+static int errors;
+
+/* The last 6P message we sent */
+static uint8_t last_msg[SIXP_MAX_MSG_LEN];
+static struct sixp_pkt last_pkt;
+
+#define CHECK(cond) do { if(!(cond)) { \
+  printf("check failed at L%u: %s\n", __LINE__, #cond); errors++; } } while(0)
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  struct frame *f;
+
+  if(num_frames == MAX_FRAMES || NETSTACK_FRAMER.create() < 0) {
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
+    return;
+  }
+  f = &air[num_frames++];
+  f->len = packetbuf_totlen();
+  memcpy(f->buf, packetbuf_hdrptr(), f->len);
+  linkaddr_copy(&f->dest, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+  f->sent = sent;
+  f->ptr = ptr;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(int keep_radio_on)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Set as NETSTACK_CONF_MAC */
+const struct mac_driver air_mac_driver = {
+  "air",
+  init,
+  send_packet,
+  input,
+  on,
+  off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
+/* Extracts the 6P message of a frame we sent to last_msg and last_pkt.
+ * Returns -1 if the frame holds none */
+static int
+parse_frame(struct frame *f)
+{
+  frame802154_t frame;
+  struct ieee802154_ies ies;
+
+  memset(&ies, 0, sizeof(ies));
+  if(frame802154_parse(f->buf, f->len, &frame) == 0
+     || !frame.fcf.ie_list_present
+     || frame.fcf.frame_version != FRAME802154_IEEE802154E_2012
+     || frame802154e_parse_information_elements(frame.payload,
+                                                frame.payload_len, &ies) < 0
+     || ies.ie_sixtop_content == NULL
+     || ies.ie_sixtop_content_len > sizeof(last_msg)) {
+    return -1;
+  }
+  memcpy(last_msg, ies.ie_sixtop_content, ies.ie_sixtop_content_len);
+  return sixp_pkt_parse(last_msg, ies.ie_sixtop_content_len, &last_pkt);
+}
+/*---------------------------------------------------------------------------*/
+/* Frames a 6P message from peer and passes it up our stack */
+static int
+deliver(const struct peer *p, const uint8_t *msg, int len)
+{
+  static uint8_t frame[PACKETBUF_SIZE];
+  struct ieee802154_ies ies;
+  uint8_t *buf;
+  int hdr_len;
+  int frame_len;
+
+  packetbuf_clear();
+  buf = packetbuf_dataptr();
+  memset(&ies, 0, sizeof(ies));
+  ies.ie_sixtop_content_len = len;
+  hdr_len = frame80215e_create_ie_header_list_termination_1(buf,
+                                                            PACKETBUF_SIZE, &ies);
+  hdr_len += frame80215e_create_ie_ietf_sixtop(buf + hdr_len,
+                                               PACKETBUF_SIZE - hdr_len, &ies);
+  memcpy(buf + hdr_len, msg, len);
+  packetbuf_set_datalen(hdr_len + len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &p->addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_DATAFRAME);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_METADATA, 1);
+  if(NETSTACK_FRAMER.create() < 0) {
+    return -1;
+  }
+  frame_len = packetbuf_totlen();
+  memcpy(frame, packetbuf_hdrptr(), frame_len);
+
+  /* Over the air, and up our stack */
+  packetbuf_clear();
+  packetbuf_copyfrom(frame, frame_len);
+  if(NETSTACK_FRAMER.parse() < 0 || !sixtop_input()) {
+    return -1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_msg(struct peer *p, enum sixp_pkt_type type, uint8_t code,
+         enum sixp_pkt_cmd cmd, uint8_t sfid, uint8_t seqnum,
+         const struct sixp_pkt_body *body)
+{
+  uint8_t msg[SIXP_MAX_MSG_LEN];
+  int len;
+
+  len = sixp_pkt_create(type, code, cmd, sfid, seqnum, body, msg, sizeof(msg));
+  if(len < 0) {
+    return -1;
+  }
+  return deliver(p, msg, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+peer_clear(struct peer *p)
+{
+  p->num_cells = 0;
+  p->seqnum = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+next_seqnum(struct peer *p)
+{
+  p->seqnum = p->seqnum == 0xff ? 1 : p->seqnum + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* The time source answers a request of ours */
+static void
+parent_input(void)
+{
+  struct sixp_pkt_body body;
+  struct sixp_pkt_body res;
+  struct sixp_cell cell;
+  uint8_t granted[SIXP_PKT_CELL_LEN];
+  int i;
+
+  parent.requests++;
+  if(last_pkt.type != SIXP_PKT_TYPE_REQUEST
+     || last_pkt.sfid != SIXTOP_MSF_SFID
+     || sixp_pkt_parse_body(&last_pkt, last_pkt.code, &body) < 0) {
+    printf("unexpected message to the time source\n");
+    errors++;
+    return;
+  }
+  if(!parent.answers) {
+    return;
+  }
+
+  memset(&res, 0, sizeof(res));
+  if(last_pkt.code != SIXP_PKT_CMD_CLEAR && last_pkt.seqnum != parent.seqnum) {
+    send_msg(&parent, SIXP_PKT_TYPE_RESPONSE, SIXP_PKT_RC_ERR_SEQNUM,
+             last_pkt.code, SIXTOP_MSF_SFID, last_pkt.seqnum, &res);
+    return;
+  }
+
+  switch(last_pkt.code) {
+  case SIXP_PKT_CMD_ADD:
+    /* The time source has all cells free: grant the first candidate */
+    CHECK(body.cell_options == SIXP_PKT_CELL_OPTION_TX);
+    CHECK(body.num_cells == 1 && body.cell_list_len > 0);
+    sixp_pkt_get_cell(body.cell_list, 0, &cell);
+    sixp_pkt_set_cell(granted, 0, &cell);
+    sixp_pkt_set_cell(parent.cells, parent.num_cells++, &cell);
+    res.cell_list = granted;
+    res.cell_list_len = 1;
+    break;
+  case SIXP_PKT_CMD_DELETE:
+    CHECK(body.cell_list_len == 1);
+    sixp_pkt_get_cell(body.cell_list, 0, &cell);
+    CHECK(sixp_pkt_has_cell(parent.cells, parent.num_cells, &cell));
+    for(i = 0; i < parent.num_cells; i++) {
+      struct sixp_cell other;
+      sixp_pkt_get_cell(parent.cells, i, &other);
+      if(other.timeslot == cell.timeslot
+         && other.channel_offset == cell.channel_offset) {
+        sixp_pkt_get_cell(parent.cells, --parent.num_cells, &other);
+        sixp_pkt_set_cell(parent.cells, i, &other);
+        break;
+      }
+    }
+    res.cell_list = body.cell_list;
+    res.cell_list_len = 1;
+    break;
+  case SIXP_PKT_CMD_CLEAR:
+    peer_clear(&parent);
+    break;
+  default:
+    printf("unexpected command %u\n", last_pkt.code);
+    errors++;
+    return;
+  }
+  send_msg(&parent, SIXP_PKT_TYPE_RESPONSE, SIXP_PKT_RC_SUCCESS,
+           last_pkt.code, SIXTOP_MSF_SFID, last_pkt.seqnum, &res);
+  if(last_pkt.code == SIXP_PKT_CMD_CLEAR) {
+    parent.seqnum = 0;
+  } else {
+    next_seqnum(&parent);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Transmits the frames on the air. The time source answers its frames, the
+ * frames to the child are left in last_msg for the script to check.
+ * Returns the number of frames to the child */
+static int
+transmit(void)
+{
+  struct frame f;
+  struct peer *p;
+  int to_child = 0;
+
+  while(num_frames > 0) {
+    f = air[0];
+    memmove(&air[0], &air[1], --num_frames * sizeof(struct frame));
+    p = linkaddr_cmp(&f.dest, &parent.addr) ? &parent : &child;
+
+    /* The MAC callback comes first, then the answer */
+    packetbuf_clear();
+    packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &f.dest);
+    mac_call_sent_callback(f.sent, f.ptr, p->acks ? MAC_TX_OK : MAC_TX_NOACK, 1);
+    if(parse_frame(&f) < 0) {
+      /* Not a 6P frame, e.g. a DIS of RPL */
+      continue;
+    }
+    if(p == &parent) {
+      parent_input();
+    } else {
+      to_child++;
+    }
+  }
+  return to_child;
+}
+/*---------------------------------------------------------------------------*/
+/* Checks that our TX cells with the time source are the ones it granted */
+static int
+cells_agree(void)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  struct sixp_cell cell;
+  int n = 0;
+
+  sf = tsch_schedule_get_slotframe_by_handle(SIXTOP_MSF_SLOTFRAME_HANDLE);
+  for(l = sf != NULL ? list_head(sf->links_list) : NULL;
+      l != NULL; l = list_item_next(l)) {
+    if(linkaddr_cmp(&l->addr, &parent.addr)) {
+      cell.timeslot = l->timeslot;
+      cell.channel_offset = l->channel_offset;
+      if(l->link_options != LINK_OPTION_TX
+         || !sixp_pkt_has_cell(parent.cells, parent.num_cells, &cell)) {
+        return 0;
+      }
+      n++;
+    }
+  }
+  return n == parent.num_cells
+         && sixp_get_seqnum(&parent.addr) == parent.seqnum;
+}
+/*---------------------------------------------------------------------------*/
+/* Expects the last message to the child to be a response with code rc */
+static int
+is_response(uint8_t rc, uint8_t seqnum)
+{
+  return last_pkt.type == SIXP_PKT_TYPE_RESPONSE && last_pkt.code == rc
+         && last_pkt.seqnum == seqnum && last_pkt.sfid == SIXTOP_MSF_SFID;
+}
+/*---------------------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_load,
+                   "cells with the time source should follow the load");
+UNIT_TEST(test_load)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Three packets per slotframe: cells used at 75% at most */
+  UNIT_TEST_ASSERT(load_cells == 4);
+  UNIT_TEST_ASSERT(load_requests == 4);
+  /* No traffic: deleted one by one */
+  UNIT_TEST_ASSERT(idle_cells == 0);
+  UNIT_TEST_ASSERT(idle_requests == 8);
+  UNIT_TEST_ASSERT(errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_reboot,
+                   "cells should be cleared after a reboot of the time source");
+UNIT_TEST(test_reboot)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(reboot_cells == 4);
+  UNIT_TEST_ASSERT(errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_timeout,
+                   "an unanswered request should time out and be retried");
+UNIT_TEST(test_timeout)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(timeout_requests[0] == 1);
+  UNIT_TEST_ASSERT(timeout_requests[1] == 2);
+  UNIT_TEST_ASSERT(timeout_cells == 5);
+  UNIT_TEST_ASSERT(errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* We are the time source of the child. The ASN stands still from now
+   on, for our own scheduling function to stay idle. */
+UNIT_TEST_REGISTER(test_child,
+                   "requests of a child should be answered");
+UNIT_TEST(test_child)
+{
+  static uint8_t cells[SIXTOP_MSF_NUM_CANDIDATES * SIXP_PKT_CELL_LEN];
+  uint8_t msg[SIXP_MAX_MSG_LEN];
+  struct sixp_pkt_body body;
+  struct sixp_cell cell;
+  struct tsch_slotframe *sf;
+  int len;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  sf = tsch_schedule_get_slotframe_by_handle(SIXTOP_MSF_SLOTFRAME_HANDLE);
+  UNIT_TEST_ASSERT(sf != NULL);
+  memset(&body, 0, sizeof(body));
+  body.cell_options = SIXP_PKT_CELL_OPTION_TX;
+  body.num_cells = 2;
+  body.cell_list = cells;
+  body.cell_list_len = SIXTOP_MSF_NUM_CANDIDATES;
+  /* The first candidate is one of our cells with the time source */
+  sixp_pkt_get_cell(parent.cells, 0, &cell);
+  sixp_pkt_set_cell(cells, 0, &cell);
+  for(i = 1; i < SIXTOP_MSF_NUM_CANDIDATES; i++) {
+    do {
+      cell.timeslot = 1 + random_rand() % (SIXTOP_MSF_SLOTFRAME_LENGTH - 1);
+    } while(tsch_schedule_get_link_by_timeslot(sf, cell.timeslot) != NULL
+            || sixp_pkt_has_cell(cells, i, &cell));
+    cell.channel_offset = i;
+    sixp_pkt_set_cell(cells, i, &cell);
+  }
+  UNIT_TEST_ASSERT(send_msg(&child, SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_ADD,
+                            SIXP_PKT_CMD_ADD, SIXTOP_MSF_SFID, child.seqnum,
+                            &body) == 0);
+  /* A second request before the first transaction is over */
+  UNIT_TEST_ASSERT(send_msg(&child, SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_COUNT,
+                            SIXP_PKT_CMD_COUNT, SIXTOP_MSF_SFID, child.seqnum,
+                            &body) == 0);
+  UNIT_TEST_ASSERT(transmit() == 2);
+  UNIT_TEST_ASSERT(is_response(SIXP_PKT_RC_ERR_BUSY, child.seqnum));
+  /* The granted cells are RX cells at our end, none collides with ours */
+  UNIT_TEST_ASSERT(sixtop_msf_num_cells(&child.addr, LINK_OPTION_RX) == 2);
+  UNIT_TEST_ASSERT(sixtop_msf_num_cells(&child.addr, LINK_OPTION_TX) == 0);
+  UNIT_TEST_ASSERT(sixtop_msf_num_cells(&parent.addr, LINK_OPTION_TX) == 5);
+  next_seqnum(&child);
+
+  /* A wrong sequence number, SFID and version */
+  UNIT_TEST_ASSERT(send_msg(&child, SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_COUNT,
+                            SIXP_PKT_CMD_COUNT, SIXTOP_MSF_SFID,
+                            child.seqnum + 1, &body) == 0);
+  UNIT_TEST_ASSERT(transmit() == 1);
+  UNIT_TEST_ASSERT(is_response(SIXP_PKT_RC_ERR_SEQNUM, child.seqnum + 1));
+  UNIT_TEST_ASSERT(send_msg(&child, SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_COUNT,
+                            SIXP_PKT_CMD_COUNT, SIXTOP_MSF_SFID + 1,
+                            child.seqnum, &body) == 0);
+  UNIT_TEST_ASSERT(transmit() == 1);
+  UNIT_TEST_ASSERT(last_pkt.type == SIXP_PKT_TYPE_RESPONSE
+                   && last_pkt.code == SIXP_PKT_RC_ERR_SFID);
+  len = sixp_pkt_create(SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_COUNT,
+                        SIXP_PKT_CMD_COUNT, SIXTOP_MSF_SFID,
+                        child.seqnum, &body, msg, sizeof(msg));
+  msg[0] |= 0x01;
+  UNIT_TEST_ASSERT(deliver(&child, msg, len) == 0);
+  UNIT_TEST_ASSERT(transmit() == 1);
+  UNIT_TEST_ASSERT(is_response(SIXP_PKT_RC_ERR_VERSION, child.seqnum));
+
+  /* COUNT and LIST */
+  body.cell_options = SIXP_PKT_CELL_OPTION_TX;
+  UNIT_TEST_ASSERT(send_msg(&child, SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_COUNT,
+                            SIXP_PKT_CMD_COUNT, SIXTOP_MSF_SFID, child.seqnum,
+                            &body) == 0);
+  UNIT_TEST_ASSERT(transmit() == 1);
+  UNIT_TEST_ASSERT(is_response(SIXP_PKT_RC_SUCCESS, child.seqnum));
+  UNIT_TEST_ASSERT(sixp_pkt_parse_body(&last_pkt, SIXP_PKT_CMD_COUNT, &body) == 0
+                   && body.num_cells == 2);
+  next_seqnum(&child);
+  memset(&body, 0, sizeof(body));
+  body.cell_options = SIXP_PKT_CELL_OPTION_TX;
+  body.offset = 1;
+  body.max_num_cells = 5;
+  UNIT_TEST_ASSERT(send_msg(&child, SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_LIST,
+                            SIXP_PKT_CMD_LIST, SIXTOP_MSF_SFID, child.seqnum,
+                            &body) == 0);
+  UNIT_TEST_ASSERT(transmit() == 1);
+  UNIT_TEST_ASSERT(is_response(SIXP_PKT_RC_EOL, child.seqnum));
+  UNIT_TEST_ASSERT(sixp_pkt_parse_body(&last_pkt, SIXP_PKT_CMD_LIST, &body) == 0
+                   && body.cell_list_len == 1);
+  next_seqnum(&child);
+
+  /* Our response to a DELETE is lost: we clear the cells with the child */
+  child.acks = 0;
+  memset(&body, 0, sizeof(body));
+  body.cell_options = SIXP_PKT_CELL_OPTION_TX;
+  body.num_cells = 1;
+  body.cell_list = cells + SIXP_PKT_CELL_LEN;
+  body.cell_list_len = 1;
+  UNIT_TEST_ASSERT(send_msg(&child, SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_DELETE,
+                            SIXP_PKT_CMD_DELETE, SIXTOP_MSF_SFID, child.seqnum,
+                            &body) == 0);
+  UNIT_TEST_ASSERT(transmit() == 2);
+  UNIT_TEST_ASSERT(last_pkt.type == SIXP_PKT_TYPE_REQUEST
+                   && last_pkt.code == SIXP_PKT_CMD_CLEAR);
+  UNIT_TEST_ASSERT(sixtop_msf_num_cells(&child.addr, LINK_OPTION_RX) == 0);
+  UNIT_TEST_ASSERT(sixtop_msf_num_cells(&parent.addr, LINK_OPTION_TX) == 5);
+  /* The CLEAR was not acknowledged either: the sequence number is reset */
+  UNIT_TEST_ASSERT(sixp_get_seqnum(&child.addr) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static int step;
+  static int load;
+  static int num_tx;
+  static unsigned long requests;
+  linkaddr_t addr;
+
+  PROCESS_BEGIN();
+
+  memset(&addr, 0, sizeof(addr));
+  addr.u8[LINKADDR_SIZE - 1] = 1;
+  linkaddr_set_node_addr(&addr);
+  memset(&parent, 0, sizeof(parent));
+  parent.addr.u8[LINKADDR_SIZE - 1] = 2;
+  parent.answers = parent.acks = 1;
+  memset(&child, 0, sizeof(child));
+  child.addr.u8[LINKADDR_SIZE - 1] = 3;
+  child.acks = 1;
+
+  tsch_schedule_init();
+  tsch_queue_init();
+  sixtop_init();
+  CHECK(sixtop_add_sf(&sixtop_msf) == 0);
+  CHECK(sixtop_add_sf(&sixtop_msf) < 0);
+  tsch_queue_add_nbr(&parent.addr);
+  tsch_queue_update_time_source(&parent.addr);
+
+/* A step of the test: SLOTFRAMES_PER_STEP slotframes in which we have
+ * load packets per slotframe for the time source, as many as our cells
+ * carry, then a housekeeping of the scheduling function */
+#define STEP() do { \
+    num_tx = sixtop_msf_num_cells(&parent.addr, LINK_OPTION_TX); \
+    TSCH_ASN_INC(tsch_current_asn, SLOTFRAMES_PER_STEP * SIXTOP_MSF_SLOTFRAME_LENGTH); \
+    sixtop_packet_sent(&parent.addr, MAC_TX_OK, \
+                                MIN(load, MAX(num_tx, 1)) * SLOTFRAMES_PER_STEP); \
+    etimer_set(&et, 2 * SIXTOP_MSF_HOUSEKEEPING_PERIOD); \
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et)); \
+    transmit(); \
+  } while(0)
+
+  /* Let the scheduling function pick up its time source */
+  etimer_set(&et, 2 * SIXTOP_MSF_HOUSEKEEPING_PERIOD);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  load = 3;
+  for(step = 0; step < MAX_STEPS; step++) {
+    STEP();
+    CHECK(cells_agree());
+  }
+  load_cells = sixtop_msf_num_cells(&parent.addr, LINK_OPTION_TX);
+  load_requests = parent.requests;
+
+  load = 0;
+  for(step = 0; step < MAX_STEPS; step++) {
+    STEP();
+    CHECK(cells_agree());
+  }
+  idle_cells = sixtop_msf_num_cells(&parent.addr, LINK_OPTION_TX);
+  idle_requests = parent.requests;
+
+  /* The time source reboots and loses its cells and sequence numbers: the
+   * first request is answered RC_ERR_SEQNUM, our cells are cleared */
+  load = 3;
+  for(step = 0; step < 2; step++) {
+    STEP();
+  }
+  peer_clear(&parent);
+  for(step = 0; step < MAX_STEPS; step++) {
+    STEP();
+    CHECK(cells_agree());
+  }
+  reboot_cells = sixtop_msf_num_cells(&parent.addr, LINK_OPTION_TX);
+
+  /* The time source does not answer: the transaction times out, and the
+   * request is retried */
+  load = 5;
+  parent.answers = 0;
+  requests = parent.requests;
+  STEP();
+  timeout_requests[0] = parent.requests - requests;
+  etimer_set(&et, SIXTOP_MSF_TIMEOUT + SIXTOP_MSF_HOUSEKEEPING_PERIOD);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  parent.answers = 1;
+  STEP();
+  timeout_requests[1] = parent.requests - requests;
+  CHECK(cells_agree());
+  timeout_cells = sixtop_msf_num_cells(&parent.addr, LINK_OPTION_TX);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_load);
+  UNIT_TEST_RUN(test_reboot);
+  UNIT_TEST_RUN(test_timeout);
+  UNIT_TEST_RUN(test_child);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+#define UNIT_TEST_PRINT_FUNCTION test_print_report
+
+#if WITH_TEST_MMEM
+/* Small enough that the random workload runs out of memory at times */
+#define MMEM_CONF_SIZE 1024
+#endif /* WITH_TEST_MMEM */
+
+#if WITH_TEST_DS6_NBR
+#define NBR_TABLE_CONF_MAX_NEIGHBORS 512
+#define NBR_TABLE_CONF_WITH_HASH 1
+#define UIP_DS6_NBR_CONF_WITH_HASH 1
+#endif /* WITH_TEST_DS6_NBR */
+
+#if WITH_TEST_RPL_NS
+#define RPL_CONF_MOP RPL_MOP_NON_STORING
+#define RPL_NS_CONF_LINK_NUM 1024
+#define RPL_NS_CONF_WITH_HASH 1
+#define RPL_NS_CONF_SRH_CACHE_NUM 64
+#define UIP_CONF_MAX_ROUTES 0
+#define UIP_CONF_BUFFER_SIZE 1280
+#endif /* WITH_TEST_RPL_NS */
+
+#if WITH_TEST_SICSLOWPAN
+/* Keeps the frames sent, for the test to feed back to sicslowpan */
+#undef NETSTACK_CONF_MAC
+#define NETSTACK_CONF_MAC loopback_mac_driver
+#undef UIP_CONF_BUFFER_SIZE
+#define UIP_CONF_BUFFER_SIZE 1280
+#undef QUEUEBUF_CONF_NUM
+#define QUEUEBUF_CONF_NUM 16
+#define SICSLOWPAN_CONF_FRAG_STATS 1
+/* With SICSLOWPAN_CONF_SFR, two packets can wait for their RFRAG-ACK,
+   and the test of the ACK timeout does not wait long */
+#define SICSLOWPAN_CONF_SFR_TX_CONTEXTS 2
+#define SICSLOWPAN_CONF_SFR_ACK_TIMEOUT (CLOCK_SECOND / 4)
+#endif /* WITH_TEST_SICSLOWPAN */
+
+#if WITH_TEST_CSMA
+/* Frames are handed to a model of the channel in the test */
+#undef NETSTACK_CONF_MAC
+#define NETSTACK_CONF_MAC csma_driver
+#undef NETSTACK_CONF_RDC
+#define NETSTACK_CONF_RDC loopback_rdc_driver
+#define CSMA_CONF_MAX_NEIGHBOR_QUEUES 4
+#define CSMA_CONF_NUM_CLASSES 2
+#define CSMA_CONF_STATS 1
+#endif /* WITH_TEST_CSMA */
+
+#if WITH_TEST_COAP_OBSERVE
+/* The test takes the place of 6LoWPAN and sees the IPv6 packets sent */
+#undef NETSTACK_CONF_NETWORK
+#define NETSTACK_CONF_NETWORK capture_network_driver
+#undef NBR_TABLE_CONF_MAX_NEIGHBORS
+#define NBR_TABLE_CONF_MAX_NEIGHBORS 20
+/* Fewer transactions than observers */
+#undef COAP_MAX_OPEN_TRANSACTIONS
+#define COAP_MAX_OPEN_TRANSACTIONS 4
+#undef COAP_MAX_OBSERVERS
+#define COAP_MAX_OBSERVERS 16
+#undef COAP_OBSERVE_MIN_INTERVAL
+#define COAP_OBSERVE_MIN_INTERVAL (CLOCK_SECOND / 2)
+#undef REST_MAX_CHUNK_SIZE
+#define REST_MAX_CHUNK_SIZE 64
+#endif /* WITH_TEST_COAP_OBSERVE */
+
+#if WITH_TEST_REST_DISPATCH
+/* Room for all resources of the test, unless set smaller to test the
+   resources left out of the trie */
+#ifndef REST_MAX_PATH_NODES
+#define REST_MAX_PATH_NODES 80
+#endif
+#endif /* WITH_TEST_REST_DISPATCH */
+
+#if WITH_TEST_COAP_COCOA
+/* The test takes the place of 6LoWPAN and models the paths */
+#undef NETSTACK_CONF_NETWORK
+#define NETSTACK_CONF_NETWORK model_network_driver
+#ifndef COAP_CONGESTION_CONTROL
+#define COAP_CONGESTION_CONTROL 1
+#endif
+#undef COAP_MAX_OPEN_TRANSACTIONS
+#define COAP_MAX_OPEN_TRANSACTIONS 8
+#endif /* WITH_TEST_COAP_COCOA */
+
+#if WITH_TEST_COAP_PROXY
+/* The test takes the place of 6LoWPAN, of the clients and of the nodes */
+#undef NETSTACK_CONF_NETWORK
+#define NETSTACK_CONF_NETWORK capture_network_driver
+#undef NBR_TABLE_CONF_MAX_NEIGHBORS
+#define NBR_TABLE_CONF_MAX_NEIGHBORS 20
+#define COAP_PROXY 1
+#define COAP_OBSERVE_CLIENT 1
+#define COAP_PROXY_URL_LEN 32
+#define COAP_OBSERVER_URL_LEN 40
+/* Fewer entries than resources, to test the eviction */
+#define COAP_PROXY_CACHE_ENTRIES 4
+#define COAP_PROXY_SEPARATE_TIMEOUT (2 * CLOCK_SECOND)
+#undef COAP_MAX_OPEN_TRANSACTIONS
+#define COAP_MAX_OPEN_TRANSACTIONS 16
+#undef COAP_MAX_OBSERVERS
+#define COAP_MAX_OBSERVERS 8
+#endif /* WITH_TEST_COAP_PROXY */
+
+#endif /* PROJECT_CONF_H_ */
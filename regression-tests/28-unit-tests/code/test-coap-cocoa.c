@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the retransmission timeouts of CoAP. A client sends
+ *         confirmable requests, one at a time, to a destination close by,
+ *         with a short round-trip time and lossy, and to one far away,
+ *         with a long and varying round-trip time. The network driver of
+ *         the test models both paths. With COAP_CONGESTION_CONTROL, the
+ *         retransmission timeout of each destination must follow its
+ *         round-trip time, and requests beyond COAP_NSTART must wait.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "lib/random.h"
+#include "rest-engine.h"
+#include "er-coap.h"
+#include "er-coap-transactions.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+#define SERVER_PORT UIP_HTONS(COAP_DEFAULT_PORT)
+/* Messages in flight, retransmissions included */
+#define MAX_MESSAGES 16
+
+#define IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UDP_BUF ((struct uip_udp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+
+struct path {
+  const char *name;
+  clock_time_t rtt_min;
+  clock_time_t rtt_max;
+  uint8_t loss;             /* percent of the transmissions lost */
+  unsigned requests;
+  uip_ipaddr_t addr;
+  /* the request in progress */
+  uint8_t busy;
+  /* results */
+  unsigned issued;
+  unsigned completed;
+  unsigned timeouts;
+  unsigned transmissions;
+  unsigned spurious;
+};
+
+static struct path paths[] = {
+  { "near", CLOCK_SECOND / 25, CLOCK_SECOND / 12, 20, 12 },
+  { "far", CLOCK_SECOND * 5 / 2, CLOCK_SECOND * 9 / 2, 0, 5 },
+};
+#define NUM_PATHS (sizeof(paths) / sizeof(paths[0]))
+
+/* A message delivered to a destination, until it is acknowledged */
+struct message {
+  uint16_t mid;
+  uint8_t delivered;
+  struct ctimer ack_timer;
+};
+
+static struct message messages[MAX_MESSAGES];
+static struct process *test_process_ptr;
+static uint8_t ack[1];
+/*---------------------------------------------------------------------------*/
+static void
+acknowledge(void *ptr)
+{
+  struct message *m = ptr;
+  coap_transaction_t *t = coap_get_transaction_by_mid(m->mid);
+  restful_response_handler callback;
+  void *callback_data;
+
+  if(t != NULL) {
+    /* as the engine does for an ACK */
+    callback = t->callback;
+    callback_data = t->callback_data;
+    coap_complete_transaction(t);
+    if(callback) {
+      callback(callback_data, ack);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct message *
+get_message(uint16_t mid)
+{
+  struct message *free_message = NULL;
+  int i;
+
+  for(i = 0; i < MAX_MESSAGES; i++) {
+    if(messages[i].mid == mid) {
+      return &messages[i];
+    }
+    if(free_message == NULL && ctimer_expired(&messages[i].ack_timer)) {
+      free_message = &messages[i];
+    }
+  }
+  if(free_message != NULL) {
+    free_message->mid = mid;
+    free_message->delivered = 0;
+  }
+  return free_message;
+}
+/*---------------------------------------------------------------------------*/
+/* Takes the place of 6LoWPAN: delivers or loses the messages */
+static uint8_t
+model_output(const uip_lladdr_t *lladdr)
+{
+  uint8_t *coap = &uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN];
+  struct path *p;
+  struct message *m;
+  uint16_t mid;
+  int i;
+
+  if(IP_BUF->proto != UIP_PROTO_UDP || UDP_BUF->destport != SERVER_PORT) {
+    return 0;
+  }
+  i = IP_BUF->destipaddr.u8[15] - 1;
+  TEST_CHECK(i >= 0 && i < NUM_PATHS);
+  if(i < 0 || i >= NUM_PATHS) {
+    return 0;
+  }
+  p = &paths[i];
+  p->transmissions++;
+
+  mid = coap[2] << 8 | coap[3];
+  m = get_message(mid);
+  TEST_CHECK(m != NULL);
+  if(m == NULL) {
+    return 0;
+  }
+  if(m->delivered) {
+    /* the ACK is on its way */
+    p->spurious++;
+  } else if(random_rand() % 100 >= p->loss) {
+    m->delivered = 1;
+    ctimer_set(&m->ack_timer, p->rtt_min
+               + random_rand() % (p->rtt_max - p->rtt_min + 1),
+               acknowledge, m);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+model_init(void)
+{
+  tcpip_set_outputfunc(model_output);
+}
+/*---------------------------------------------------------------------------*/
+static void
+model_input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+/* Set as NETSTACK_CONF_NETWORK */
+const struct network_driver model_network_driver = {
+  "model",
+  model_init,
+  model_input
+};
+/*---------------------------------------------------------------------------*/
+static void
+response(void *data, void *response)
+{
+  struct path *p = data;
+
+  if(response == NULL) {
+    p->timeouts++;
+  } else {
+    p->completed++;
+  }
+  p->busy = 0;
+  process_poll(test_process_ptr);
+}
+/*---------------------------------------------------------------------------*/
+static int
+request(struct path *p)
+{
+  coap_packet_t packet[1];
+  coap_transaction_t *t;
+
+  coap_init_message(packet, COAP_TYPE_CON, COAP_GET, coap_get_mid());
+  coap_set_header_uri_path(packet, "sensors/temperature");
+  t = coap_new_transaction(packet->mid, &p->addr, SERVER_PORT);
+  if(t == NULL) {
+    return 0;
+  }
+  t->callback = response;
+  t->callback_data = p;
+  t->packet_len = coap_serialize_message(packet, t->packet);
+  p->busy = 1;
+  p->issued++;
+  coap_send_transaction(t);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+busy(void)
+{
+  int i;
+
+  for(i = 0; i < NUM_PATHS; i++) {
+    if(paths[i].busy || paths[i].issued < paths[i].requests) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+#if COAP_CONGESTION_CONTROL
+static struct coap_peer_stats stats[NUM_PATHS];
+/* Outstanding requests to the near destination right after three were
+   sent, and the most while they completed */
+static unsigned nstart_outstanding;
+static unsigned nstart_outstanding_max;
+#endif /* COAP_CONGESTION_CONTROL */
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_requests, "Requests complete on both paths");
+UNIT_TEST(test_requests)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_PATHS; i++) {
+    printf("%-4s %u requests, %u timeouts, %u transmissions, %u spurious\n",
+           paths[i].name, paths[i].completed, paths[i].timeouts,
+           paths[i].transmissions, paths[i].spurious);
+    UNIT_TEST_ASSERT(paths[i].completed + paths[i].timeouts == paths[i].requests);
+  }
+  /* A timeout may happen on the lossy path, if rarely */
+  UNIT_TEST_ASSERT(paths[1].timeouts == 0);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+#if COAP_CONGESTION_CONTROL
+UNIT_TEST_REGISTER(test_rto, "Timeouts follow the round-trip time of each path");
+UNIT_TEST(test_rto)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_PATHS; i++) {
+    UNIT_TEST_ASSERT(coap_get_peer_stats(&paths[i].addr, &stats[i]));
+    printf("%-4s RTO %lu ms\n", paths[i].name,
+           (unsigned long)(stats[i].rto * 1000 / CLOCK_SECOND));
+    UNIT_TEST_ASSERT(stats[i].outstanding == 0);
+    UNIT_TEST_ASSERT(stats[i].retransmissions == paths[i].transmissions
+                     - paths[i].completed - paths[i].timeouts);
+  }
+  /* The weak estimator keeps that of the lossy path above its
+     round-trip time */
+  UNIT_TEST_ASSERT(stats[0].rto < COAP_RESPONSE_TIMEOUT_TICKS);
+  UNIT_TEST_ASSERT(stats[1].rto > paths[1].rtt_max);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_nstart, "Requests beyond COAP_NSTART wait");
+UNIT_TEST(test_nstart)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(nstart_outstanding == COAP_NSTART);
+  UNIT_TEST_ASSERT(nstart_outstanding_max <= COAP_NSTART);
+  UNIT_TEST_ASSERT(coap_transaction_stat.deferred >= 3 - COAP_NSTART);
+  UNIT_TEST_ASSERT(paths[0].completed + paths[0].timeouts == paths[0].requests);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+#endif /* COAP_CONGESTION_CONTROL */
+/*---------------------------------------------------------------------------*/
+PROCESS(test_process, "CoAP congestion control test");
+AUTOSTART_PROCESSES(&test_process);
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static uip_lladdr_t lladdr;
+  static struct path *p;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  test_process_ptr = PROCESS_CURRENT();
+  rest_init_engine();
+  for(i = 0; i < NUM_PATHS; i++) {
+    memset(&lladdr, 0, sizeof(lladdr));
+    lladdr.addr[sizeof(lladdr.addr) - 1] = i + 1;
+    uip_ip6addr(&paths[i].addr, 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+    uip_ds6_nbr_add(&paths[i].addr, &lladdr, 0, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+  }
+
+  while(busy()) {
+    for(i = 0; i < NUM_PATHS; i++) {
+      p = &paths[i];
+      if(!p->busy && p->issued < p->requests) {
+        TEST_CHECK(request(p));
+      }
+    }
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+  }
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_requests);
+#if COAP_CONGESTION_CONTROL
+  UNIT_TEST_RUN(test_rto);
+
+  /* Three requests at once to the near destination */
+  p = &paths[0];
+  p->requests += 3;
+  TEST_CHECK(request(p) && request(p) && request(p));
+  TEST_CHECK(coap_get_peer_stats(&p->addr, &stats[0]));
+  nstart_outstanding = stats[0].outstanding;
+  while(p->completed + p->timeouts < p->requests) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    TEST_CHECK(coap_get_peer_stats(&p->addr, &stats[0]));
+    if(stats[0].outstanding > nstart_outstanding_max) {
+      nstart_outstanding_max = stats[0].outstanding;
+    }
+  }
+  UNIT_TEST_RUN(test_nstart);
+#endif /* COAP_CONGESTION_CONTROL */
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
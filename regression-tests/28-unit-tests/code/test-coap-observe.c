@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of CoAP observe notifications. Sixteen clients observe one
+ *         resource of a server with room for four transactions. The test
+ *         takes the place of 6LoWPAN and checks every notification sent:
+ *         the representation must be rendered once per change, each
+ *         observer must get its own token, message ID and Observe value,
+ *         changes in quick succession must be coalesced, and confirmable
+ *         notifications must be retransmitted until they are acknowledged.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "rest-engine.h"
+#include "er-coap.h"
+#include "er-coap-observe.h"
+#include "er-coap-transactions.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+#define NUM_CLIENTS COAP_MAX_OBSERVERS
+#define CLIENT_PORT UIP_HTONS(COAP_DEFAULT_PORT + 1)
+#define TRIGGERS 10
+
+#define IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UDP_BUF ((struct uip_udp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+
+struct client {
+  uip_ipaddr_t addr;
+  unsigned received;
+  coap_message_type_t type;
+  uint16_t mid;
+  uint32_t observe;
+};
+
+static struct client clients[NUM_CLIENTS];
+static unsigned renders;
+static unsigned value;
+
+static void res_get_handler(void *request, void *response, uint8_t *buffer,
+                            uint16_t preferred_size, int32_t *offset);
+static void res_event_handler(void);
+
+EVENT_RESOURCE(res_counter, "obs", res_get_handler, NULL, NULL, NULL,
+               res_event_handler);
+/*---------------------------------------------------------------------------*/
+static void
+res_get_handler(void *request, void *response, uint8_t *buffer,
+                uint16_t preferred_size, int32_t *offset)
+{
+  renders++;
+  REST.set_header_content_type(response, REST.type.TEXT_PLAIN);
+  REST.set_response_payload(response, buffer,
+                            snprintf((char *)buffer, preferred_size,
+                                     "value %u", value));
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_event_handler(void)
+{
+  value++;
+  REST.notify_subscribers(&res_counter);
+}
+/*---------------------------------------------------------------------------*/
+/* Takes the place of 6LoWPAN: checks every notification */
+static uint8_t
+capture_output(const uip_lladdr_t *lladdr)
+{
+  static coap_packet_t message[1];
+  static char expected[16];
+  struct client *c;
+  int i;
+
+  if(IP_BUF->proto != UIP_PROTO_UDP || UDP_BUF->destport != CLIENT_PORT) {
+    return 0;
+  }
+  i = IP_BUF->destipaddr.u8[15] - 1;
+  TEST_CHECK(i >= 0 && i < NUM_CLIENTS);
+  if(i < 0 || i >= NUM_CLIENTS) {
+    return 0;
+  }
+  c = &clients[i];
+
+  if(coap_parse_message(message, &uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN],
+                        uip_len - UIP_IPUDPH_LEN) != NO_ERROR) {
+    printf("malformed notification for client %d\n", i);
+    test_errors++;
+    return 0;
+  }
+  TEST_CHECK(message->code == CONTENT_2_05);
+  TEST_CHECK(message->token_len == 2 && message->token[0] == 0xa0
+        && message->token[1] == i);
+  TEST_CHECK(IS_OPTION(message, COAP_OPTION_OBSERVE));
+  TEST_CHECK(IS_OPTION(message, COAP_OPTION_CONTENT_FORMAT)
+        && message->content_format == TEXT_PLAIN);
+  snprintf(expected, sizeof(expected), "value %u", value);
+  TEST_CHECK(message->payload_len == strlen(expected)
+        && memcmp(message->payload, expected, message->payload_len) == 0);
+
+  if(c->received > 0 && message->mid == c->mid) {
+    /* a retransmission is the same message */
+    TEST_CHECK(message->type == COAP_TYPE_CON && c->type == COAP_TYPE_CON);
+    TEST_CHECK(message->observe == c->observe);
+  } else if(c->received > 0) {
+    TEST_CHECK(message->observe > c->observe);
+  }
+  c->received++;
+  c->type = message->type;
+  c->mid = message->mid;
+  c->observe = message->observe;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+capture_init(void)
+{
+  tcpip_set_outputfunc(capture_output);
+}
+/*---------------------------------------------------------------------------*/
+static void
+capture_input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+/* Set as NETSTACK_CONF_NETWORK */
+const struct network_driver capture_network_driver = {
+  "capture",
+  capture_init,
+  capture_input
+};
+/*---------------------------------------------------------------------------*/
+static void
+observe(int i)
+{
+  coap_packet_t request[1];
+  coap_packet_t response[1];
+  uint8_t token[2] = { 0xa0, i };
+  uip_lladdr_t lladdr;
+
+  memset(&lladdr, 0, sizeof(lladdr));
+  lladdr.addr[sizeof(lladdr.addr) - 1] = i + 1;
+  uip_ip6addr(&clients[i].addr, 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+  uip_ds6_nbr_add(&clients[i].addr, &lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, i);
+  coap_set_header_uri_path(request, "obs");
+  coap_set_header_observe(request, 0);
+  coap_set_token(request, token, sizeof(token));
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, i);
+
+  uip_ipaddr_copy(&IP_BUF->srcipaddr, &clients[i].addr);
+  UDP_BUF->srcport = CLIENT_PORT;
+  coap_observe_handler(&res_counter, request, response);
+  TEST_CHECK(IS_OPTION(response, COAP_OPTION_OBSERVE));
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+received(coap_message_type_t type)
+{
+  unsigned n = 0;
+  int i;
+
+  for(i = 0; i < NUM_CLIENTS; i++) {
+    n += clients[i].received;
+    TEST_CHECK(clients[i].type == type);
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+/* Notifications received after ten changes, right away and after the
+   minimum interval */
+static unsigned burst_received[2];
+/* Confirmable notifications received after each of two changes, and
+   after all but the first client acknowledged */
+static unsigned con_received[3];
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_fan_out, "One render for all observers");
+UNIT_TEST(test_fan_out)
+{
+  coap_transaction_t *t[COAP_MAX_OPEN_TRANSACTIONS];
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  rest_init_engine();
+  rest_activate_resource(&res_counter, "obs");
+  for(i = 0; i < NUM_CLIENTS; i++) {
+    observe(i);
+  }
+  UNIT_TEST_ASSERT(list_length(coap_get_observers()) == NUM_CLIENTS);
+
+  res_counter.trigger();
+  UNIT_TEST_ASSERT(received(COAP_TYPE_NON) == NUM_CLIENTS);
+  UNIT_TEST_ASSERT(renders == 1);
+  /* The observers took none of the transactions */
+  for(i = 0; i < COAP_MAX_OPEN_TRANSACTIONS; i++) {
+    t[i] = coap_new_transaction(coap_get_mid(), &clients[0].addr, CLIENT_PORT);
+    UNIT_TEST_ASSERT(t[i] != NULL);
+  }
+  for(i = 0; i < COAP_MAX_OPEN_TRANSACTIONS; i++) {
+    coap_clear_transaction(t[i]);
+  }
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_rate_limit, "Changes in quick succession coalesced");
+UNIT_TEST(test_rate_limit)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The first change and the last one are sent */
+  UNIT_TEST_ASSERT(burst_received[0] == 2 * NUM_CLIENTS);
+  UNIT_TEST_ASSERT(burst_received[1] == 3 * NUM_CLIENTS);
+  UNIT_TEST_ASSERT(renders == 3);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_confirmable, "Confirmable notifications retransmitted");
+UNIT_TEST(test_confirmable)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The second one replaces the first, which is not acknowledged yet */
+  UNIT_TEST_ASSERT(con_received[0] == 4 * NUM_CLIENTS);
+  UNIT_TEST_ASSERT(con_received[1] == 5 * NUM_CLIENTS);
+  /* Only the client that did not acknowledge gets it again */
+  UNIT_TEST_ASSERT(clients[0].received == 6);
+  UNIT_TEST_ASSERT(con_received[2] == 5 * NUM_CLIENTS + 1);
+  UNIT_TEST_ASSERT(renders == 5);
+  UNIT_TEST_ASSERT(list_length(coap_get_observers()) == NUM_CLIENTS);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(test_process, "CoAP observe test");
+AUTOSTART_PROCESSES(&test_process);
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static coap_observer_t *obs;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_fan_out);
+
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  for(i = 0; i < TRIGGERS; i++) {
+    res_counter.trigger();
+  }
+  burst_received[0] = received(COAP_TYPE_NON);
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  burst_received[1] = received(COAP_TYPE_NON);
+  UNIT_TEST_RUN(test_rate_limit);
+
+  /* Confirmable notifications, the second one before the first is
+   * acknowledged */
+  for(obs = list_head(coap_get_observers()); obs != NULL; obs = obs->next) {
+    obs->obs_counter = COAP_OBSERVE_REFRESH_INTERVAL;
+  }
+  res_counter.trigger();
+  con_received[0] = received(COAP_TYPE_CON);
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  res_counter.trigger();
+  con_received[1] = received(COAP_TYPE_CON);
+  /* All but the first client acknowledge */
+  for(i = 1; i < NUM_CLIENTS; i++) {
+    coap_observe_ack(&clients[i].addr, CLIENT_PORT, clients[i].mid);
+  }
+  etimer_set(&et, CLOCK_SECOND * COAP_RESPONSE_TIMEOUT
+             * COAP_RESPONSE_RANDOM_FACTOR + 1);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  con_received[2] = received(COAP_TYPE_CON);
+  UNIT_TEST_RUN(test_confirmable);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
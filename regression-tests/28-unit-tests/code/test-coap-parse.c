@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the CoAP parser and serializer, with a request as a
+ *         border router forwards it to a node. Messages built from a
+ *         coap_packet_t and with the message writer are compared byte by
+ *         byte, parsed back through both the option iterator and
+ *         coap_parse_message(), and malformed messages are checked to be
+ *         rejected.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "er-coap.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+static const uint8_t token[] = { 0xde, 0xad, 0xbe, 0xef };
+static const uint8_t etag[] = { 0x01, 0x02, 0x03, 0x04 };
+static const char *segments[] = { "sensors", "temperature", "room1" };
+
+static uint8_t message[COAP_MAX_PACKET_SIZE + 1];
+static uint8_t written[COAP_MAX_PACKET_SIZE + 1];
+static uint8_t work[COAP_MAX_PACKET_SIZE + 1];
+static coap_packet_t packet[1];
+
+static size_t request_len;
+/*---------------------------------------------------------------------------*/
+/* A request as a border router forwards it to a node */
+static size_t
+serialize_request(uint8_t *buffer)
+{
+  coap_init_message(packet, COAP_TYPE_CON, COAP_GET, 0x1234);
+  coap_set_token(packet, token, sizeof(token));
+  coap_set_header_etag(packet, etag, sizeof(etag));
+  coap_set_header_observe(packet, 0);
+  coap_set_header_uri_path(packet, "sensors/temperature/room1");
+  coap_set_header_uri_query(packet, "u=c&p=2");
+  coap_set_header_accept(packet, APPLICATION_JSON);
+  coap_set_header_block2(packet, 2, 0, 64);
+  return coap_serialize_message(packet, buffer);
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+write_request(uint8_t *buffer)
+{
+  coap_message_writer_t writer;
+  int i;
+
+  coap_message_writer_init(&writer, buffer, COAP_MAX_PACKET_SIZE + 1,
+                           COAP_TYPE_CON, COAP_GET, 0x1234,
+                           token, sizeof(token));
+  coap_write_option(&writer, COAP_OPTION_ETAG, etag, sizeof(etag));
+  coap_write_int_option(&writer, COAP_OPTION_OBSERVE, 0);
+  for(i = 0; i < 3; i++) {
+    coap_write_option(&writer, COAP_OPTION_URI_PATH, segments[i],
+                      strlen(segments[i]));
+  }
+  coap_write_option(&writer, COAP_OPTION_URI_QUERY, "u=c", 3);
+  coap_write_option(&writer, COAP_OPTION_URI_QUERY, "p=2", 3);
+  coap_write_int_option(&writer, COAP_OPTION_ACCEPT, APPLICATION_JSON);
+  coap_write_int_option(&writer, COAP_OPTION_BLOCK2, 2 << 4 | 2);
+  return coap_write_payload(&writer, NULL, 0);
+}
+/*---------------------------------------------------------------------------*/
+/* The options a forwarding proxy looks at */
+static int
+scan_request(const uint8_t *buffer, size_t len, unsigned *accept)
+{
+  coap_option_iterator_t it;
+  int path_segments = 0;
+
+  if(coap_option_iterator_init(&it, buffer, len) != NO_ERROR) {
+    return -1;
+  }
+  while(coap_option_find(&it, COAP_OPTION_URI_PATH) > 0) {
+    path_segments++;
+  }
+  *accept = 0;
+  if(coap_option_find(&it, COAP_OPTION_ACCEPT) > 0) {
+    *accept = coap_option_get_int(&it);
+  }
+  return path_segments;
+}
+/*---------------------------------------------------------------------------*/
+static coap_status_t
+parse(const uint8_t *data, size_t len)
+{
+  memcpy(work, data, len);
+  return coap_parse_message(packet, work, len);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_writer_request, "Message writer matches serializer");
+UNIT_TEST(test_writer_request)
+{
+  UNIT_TEST_BEGIN();
+
+  request_len = serialize_request(message);
+  UNIT_TEST_ASSERT(request_len > 0);
+  UNIT_TEST_ASSERT(write_request(written) == request_len);
+  UNIT_TEST_ASSERT(memcmp(message, written, request_len) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_request, "Request parses back");
+UNIT_TEST(test_request)
+{
+  const char *str;
+  const uint8_t *bytes;
+  uint32_t num;
+  uint16_t size;
+  unsigned int accept;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(parse(message, request_len) == NO_ERROR);
+  UNIT_TEST_ASSERT(packet->type == COAP_TYPE_CON && packet->code == COAP_GET);
+  UNIT_TEST_ASSERT(packet->mid == 0x1234 && packet->token_len == sizeof(token));
+  UNIT_TEST_ASSERT(memcmp(packet->token, token, sizeof(token)) == 0);
+  UNIT_TEST_ASSERT(coap_get_header_etag(packet, &bytes) == sizeof(etag)
+                   && memcmp(bytes, etag, sizeof(etag)) == 0);
+  UNIT_TEST_ASSERT(coap_get_header_observe(packet, &num) && num == 0);
+  UNIT_TEST_ASSERT(coap_get_header_uri_path(packet, &str) == 25
+                   && strncmp(str, "sensors/temperature/room1", 25) == 0);
+  UNIT_TEST_ASSERT(coap_get_header_uri_query(packet, &str) == 7
+                   && strncmp(str, "u=c&p=2", 7) == 0);
+  UNIT_TEST_ASSERT(coap_get_header_accept(packet, &accept)
+                   && accept == APPLICATION_JSON);
+  UNIT_TEST_ASSERT(coap_get_header_block2(packet, &num, NULL, &size, NULL)
+                   && num == 2 && size == 64);
+  UNIT_TEST_ASSERT(packet->payload_len == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_iterator, "Options found one at a time");
+UNIT_TEST(test_iterator)
+{
+  coap_option_iterator_t it;
+  const uint8_t *payload;
+  unsigned int accept;
+  int options = 0;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(coap_option_iterator_init(&it, message, request_len) == NO_ERROR);
+  UNIT_TEST_ASSERT(it.mid == 0x1234 && it.token_len == sizeof(token)
+                   && memcmp(it.token, token, sizeof(token)) == 0);
+  while(coap_option_next(&it) > 0) {
+    options++;
+  }
+  UNIT_TEST_ASSERT(options == 9);
+  UNIT_TEST_ASSERT(coap_option_get_payload(&it, &payload) == 0 && payload == NULL);
+
+  /* repeated options come one at a time, in order */
+  coap_option_iterator_init(&it, message, request_len);
+  for(i = 0; i < 3; i++) {
+    UNIT_TEST_ASSERT(coap_option_find(&it, COAP_OPTION_URI_PATH) == 1
+                     && it.length == strlen(segments[i])
+                     && memcmp(it.value, segments[i], it.length) == 0);
+  }
+  /* stops in front of the next larger option, which is still found */
+  UNIT_TEST_ASSERT(coap_option_find(&it, COAP_OPTION_URI_PATH) == 0);
+  UNIT_TEST_ASSERT(coap_option_find(&it, COAP_OPTION_URI_QUERY) == 1
+                   && it.length == 3);
+  UNIT_TEST_ASSERT(coap_option_find(&it, COAP_OPTION_ETAG) == 0);
+
+  UNIT_TEST_ASSERT(scan_request(message, request_len, &accept) == 3
+                   && accept == APPLICATION_JSON);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_response, "Response parses back");
+UNIT_TEST(test_response)
+{
+  coap_option_iterator_t it;
+  const uint8_t *payload;
+  uint32_t age;
+  size_t len;
+
+  UNIT_TEST_BEGIN();
+
+  coap_init_message(packet, COAP_TYPE_ACK, CONTENT_2_05, 0x1234);
+  coap_set_token(packet, token, sizeof(token));
+  coap_set_header_content_format(packet, TEXT_PLAIN);
+  coap_set_header_max_age(packet, 300);
+  coap_set_payload(packet, "22.5 C", 6);
+  len = coap_serialize_message(packet, message);
+  UNIT_TEST_ASSERT(len == 4 + 4 + 1 + 3 + 1 + 6);
+
+  UNIT_TEST_ASSERT(coap_option_iterator_init(&it, message, len) == NO_ERROR);
+  UNIT_TEST_ASSERT(coap_option_find(&it, COAP_OPTION_MAX_AGE) == 1
+                   && coap_option_get_int(&it) == 300);
+  UNIT_TEST_ASSERT(coap_option_next(&it) == 0);
+  UNIT_TEST_ASSERT(coap_option_get_payload(&it, &payload) == 6
+                   && memcmp(payload, "22.5 C", 6) == 0);
+
+  UNIT_TEST_ASSERT(parse(message, len) == NO_ERROR);
+  UNIT_TEST_ASSERT(coap_get_header_max_age(packet, &age) && age == 300);
+  UNIT_TEST_ASSERT(coap_get_payload(packet, &payload) == 6
+                   && memcmp(payload, "22.5 C", 6) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_malformed, "Malformed messages rejected");
+UNIT_TEST(test_malformed)
+{
+  coap_option_iterator_t it;
+  static const uint8_t short_header[] = { 0x40, 0x01, 0x00 };
+  static const uint8_t long_token[] = { 0x49, 0x01, 0x00, 0x01 };
+  static const uint8_t short_token[] = { 0x44, 0x01, 0x00, 0x01, 0xaa };
+  static const uint8_t bad_version[] = { 0x80, 0x01, 0x00, 0x01 };
+  static const uint8_t long_option[] = { 0x40, 0x01, 0x00, 0x01, 0xb4, 'a' };
+  static const uint8_t short_delta[] = { 0x40, 0x01, 0x00, 0x01, 0xd0 };
+  static const uint8_t short_length[] = { 0x40, 0x01, 0x00, 0x01, 0xbe, 0x01 };
+  static const uint8_t reserved[] = { 0x40, 0x01, 0x00, 0x01, 0xf1, 'a' };
+  static const uint8_t large_number[] = { 0x40, 0x01, 0x00, 0x01, 0xe0, 0x01, 0x00 };
+  static const uint8_t critical[] = { 0x40, 0x01, 0x00, 0x01, 0xd0, 0x00 };
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(parse(short_header, sizeof(short_header)) == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(parse(long_token, sizeof(long_token)) == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(parse(short_token, sizeof(short_token)) == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(parse(bad_version, sizeof(bad_version)) == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(parse(long_option, sizeof(long_option)) == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(parse(short_delta, sizeof(short_delta)) == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(parse(short_length, sizeof(short_length)) == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(parse(reserved, sizeof(reserved)) == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(parse(large_number, sizeof(large_number)) == BAD_REQUEST_4_00);
+  UNIT_TEST_ASSERT(parse(critical, sizeof(critical)) == BAD_OPTION_4_02);
+
+  /* the iterator leaves the meaning of option numbers to the caller */
+  coap_option_iterator_init(&it, large_number, sizeof(large_number));
+  UNIT_TEST_ASSERT(coap_option_next(&it) == 1 && it.number == 525 && it.length == 0);
+  coap_option_iterator_init(&it, short_delta, sizeof(short_delta));
+  UNIT_TEST_ASSERT(coap_option_next(&it) == -1 && coap_option_next(&it) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_writer, "Message writer checks its input");
+UNIT_TEST(test_writer)
+{
+  coap_message_writer_t writer;
+  coap_option_iterator_t it;
+  static const uint32_t values[] = { 0, 0xff, 0x100, 0xffffff, 0x1000000 };
+  static const size_t lengths[] = { 0, 1, 2, 3, 4 };
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  coap_message_writer_init(&writer, written, sizeof(written), COAP_TYPE_NON,
+                           CONTENT_2_05, 1, NULL, 0);
+  for(i = 0; i < 5; i++) {
+    coap_write_int_option(&writer, COAP_OPTION_OBSERVE + i, values[i]);
+  }
+  coap_option_iterator_init(&it, written, coap_write_payload(&writer, NULL, 0));
+  for(i = 0; i < 5; i++) {
+    UNIT_TEST_ASSERT(coap_option_next(&it) == 1 && it.length == lengths[i]
+                     && coap_option_get_int(&it) == values[i]);
+  }
+
+  /* options out of order */
+  coap_message_writer_init(&writer, written, sizeof(written), COAP_TYPE_NON,
+                           CONTENT_2_05, 1, NULL, 0);
+  UNIT_TEST_ASSERT(coap_write_option(&writer, COAP_OPTION_URI_PATH, "a", 1) == 1);
+  UNIT_TEST_ASSERT(coap_write_option(&writer, COAP_OPTION_ETAG, "a", 1) == 0);
+  UNIT_TEST_ASSERT(coap_write_payload(&writer, "a", 1) == 0);
+
+  /* out of space, and the writer stays failed */
+  coap_message_writer_init(&writer, written, 10, COAP_TYPE_NON,
+                           CONTENT_2_05, 1, token, sizeof(token));
+  UNIT_TEST_ASSERT(coap_write_option(&writer, COAP_OPTION_URI_PATH, "abcd", 4) == 0);
+  UNIT_TEST_ASSERT(coap_write_option(&writer, COAP_OPTION_URI_QUERY, "a", 0) == 0);
+  coap_message_writer_init(&writer, written, 6, COAP_TYPE_NON,
+                           CONTENT_2_05, 1, token, sizeof(token));
+  UNIT_TEST_ASSERT(writer.current == NULL);
+
+  /* options beyond COAP_MAX_HEADER_SIZE are refused before the payload */
+  memset(work, 'x', COAP_MAX_HEADER_SIZE);
+  work[COAP_MAX_HEADER_SIZE] = '\0';
+  coap_init_message(packet, COAP_TYPE_NON, CONTENT_2_05, 1);
+  coap_set_header_uri_path(packet, (char *)work);
+  UNIT_TEST_ASSERT(coap_serialize_message(packet, written) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(test_process, "CoAP parser test");
+AUTOSTART_PROCESSES(&test_process);
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_writer_request);
+  UNIT_TEST_RUN(test_request);
+  UNIT_TEST_RUN(test_iterator);
+  UNIT_TEST_RUN(test_response);
+  UNIT_TEST_RUN(test_malformed);
+  UNIT_TEST_RUN(test_writer);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
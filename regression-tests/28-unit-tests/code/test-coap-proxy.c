@@ -0,0 +1,688 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the caching CoAP proxy. The test takes the place of
+ *         6LoWPAN, of five clients and of two nodes behind the proxy. It
+ *         counts the requests that reach the nodes and checks every
+ *         message the proxy sends: request coalescing, cache hits per URI
+ *         and Accept, Max-Age expiry and ETag revalidation, observe
+ *         aggregation, LRU eviction, forwarded PUT requests and separate
+ *         responses.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "rest-engine.h"
+#include "er-coap-engine.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+#define NUM_CLIENTS 5
+#define NUM_NODES 2
+#define CLIENT_PORT UIP_HTONS(COAP_DEFAULT_PORT + 1)
+#define NODE_PORT UIP_HTONS(COAP_DEFAULT_PORT)
+#define QUEUE_LEN 16
+
+#define IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UDP_BUF ((struct uip_udp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+
+/* A message sent by the proxy */
+struct message {
+  uip_ipaddr_t addr;
+  uint16_t len;
+  uint8_t data[COAP_MAX_PACKET_SIZE + 1];
+};
+
+static struct message queue[QUEUE_LEN];
+static int queued;
+
+static uip_ipaddr_t clients[NUM_CLIENTS];
+static uip_ipaddr_t nodes[NUM_NODES];
+static uint16_t last_mid;
+
+/* what the proxy sent */
+static unsigned upstream;       /* requests to the nodes */
+static unsigned node_acks;
+static unsigned node_rsts;
+static unsigned client_acks;    /* empty ACKs of separate responses */
+/* requests to the nodes before the step being tested */
+static unsigned upstream_before;
+/*---------------------------------------------------------------------------*/
+static int
+is_node(const uip_ipaddr_t *addr)
+{
+  int i;
+
+  for(i = 0; i < NUM_NODES; i++) {
+    if(uip_ipaddr_cmp(addr, &nodes[i])) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Takes the place of 6LoWPAN: keeps the messages for the test */
+static uint8_t
+capture_output(const uip_lladdr_t *lladdr)
+{
+  uint8_t *coap = &uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN];
+  uint16_t len = uip_len - UIP_IPUDPH_LEN;
+
+  if(IP_BUF->proto != UIP_PROTO_UDP || len < 4) {
+    return 0;
+  }
+  if(is_node(&IP_BUF->destipaddr)) {
+    TEST_CHECK(UDP_BUF->destport == NODE_PORT);
+    if(coap[1] == 0) {
+      if((coap[0] & 0x30) >> 4 == COAP_TYPE_RST) {
+        node_rsts++;
+      } else {
+        node_acks++;
+      }
+      return 0;
+    }
+    if(coap[1] <= COAP_DELETE) {
+      upstream++;
+    }
+  } else {
+    TEST_CHECK(UDP_BUF->destport == CLIENT_PORT);
+    if(coap[1] == 0) {
+      client_acks++;
+      return 0;
+    }
+  }
+
+  TEST_CHECK(queued < QUEUE_LEN);
+  if(queued < QUEUE_LEN) {
+    uip_ipaddr_copy(&queue[queued].addr, &IP_BUF->destipaddr);
+    queue[queued].len = len;
+    memcpy(queue[queued].data, coap, len);
+    queued++;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+capture_init(void)
+{
+  tcpip_set_outputfunc(capture_output);
+}
+/*---------------------------------------------------------------------------*/
+static void
+capture_input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+/* Set as NETSTACK_CONF_NETWORK */
+const struct network_driver capture_network_driver = {
+  "capture",
+  capture_init,
+  capture_input
+};
+/*---------------------------------------------------------------------------*/
+/* Delivers a message to the proxy, as received from addr */
+static void
+inject(const uip_ipaddr_t *addr, uint16_t port, coap_packet_t *message)
+{
+  static uint8_t data[COAP_MAX_PACKET_SIZE + 1];
+  uint16_t len;
+  uint16_t sum;
+
+  len = coap_serialize_message(message, data);
+  TEST_CHECK(len > 0);
+
+  memset(uip_buf, 0, UIP_LLH_LEN + UIP_IPUDPH_LEN);
+  IP_BUF->vtc = 0x60;
+  IP_BUF->len[0] = (UIP_UDPH_LEN + len) >> 8;
+  IP_BUF->len[1] = (UIP_UDPH_LEN + len) & 0xff;
+  IP_BUF->proto = UIP_PROTO_UDP;
+  IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&IP_BUF->srcipaddr, addr);
+  uip_ipaddr_copy(&IP_BUF->destipaddr, &uip_ds6_get_link_local(-1)->ipaddr);
+  UDP_BUF->srcport = port;
+  UDP_BUF->destport = UIP_HTONS(COAP_DEFAULT_PORT);
+  UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + len);
+  memcpy(&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN], data, len);
+  uip_len = UIP_IPUDPH_LEN + len;
+  sum = ~uip_udpchksum();
+  UDP_BUF->udpchksum = sum == 0 ? 0xffff : sum;
+
+  tcpip_input();
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_empty(const uip_ipaddr_t *addr, uint16_t port, coap_message_type_t type,
+           uint16_t mid)
+{
+  coap_packet_t message[1];
+
+  coap_init_message(message, type, 0, mid);
+  inject(addr, port, message);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Takes the first message the proxy sent to addr, NULL if there is none.
+ * Confirmable messages to clients are acknowledged.
+ */
+static coap_packet_t *
+take(const uip_ipaddr_t *addr)
+{
+  static coap_packet_t message[1];
+  static uint8_t data[COAP_MAX_PACKET_SIZE + 1];
+  uint16_t len;
+  int i;
+
+  for(i = 0; i < queued; i++) {
+    if(uip_ipaddr_cmp(&queue[i].addr, addr)) {
+      break;
+    }
+  }
+  if(i == queued) {
+    return NULL;
+  }
+  len = queue[i].len;
+  memcpy(data, queue[i].data, len);
+  memmove(&queue[i], &queue[i + 1], (queued - i - 1) * sizeof(queue[0]));
+  queued--;
+
+  if(coap_parse_message(message, data, len) != NO_ERROR) {
+    printf("malformed message\n");
+    test_errors++;
+    return NULL;
+  }
+  if(message->type == COAP_TYPE_CON && !is_node(addr)) {
+    send_empty(addr, CLIENT_PORT, COAP_TYPE_ACK, message->mid);
+  }
+  return message;
+}
+/*---------------------------------------------------------------------------*/
+static coap_packet_t *
+new_request(int client, uint8_t code, const char *url)
+{
+  static coap_packet_t request[1];
+  uint8_t token[2] = { 0xc0, client };
+
+  coap_init_message(request, COAP_TYPE_CON, code, ++last_mid);
+  coap_set_token(request, token, sizeof(token));
+  coap_set_header_uri_path(request, url);
+  return request;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_request(int client, coap_packet_t *request)
+{
+  inject(&clients[client], CLIENT_PORT, request);
+}
+/*---------------------------------------------------------------------------*/
+static coap_packet_t *
+new_response(coap_packet_t *request, coap_message_type_t type, uint8_t code)
+{
+  static coap_packet_t response[1];
+
+  coap_init_message(response, type, code,
+                    type == COAP_TYPE_ACK ? request->mid : ++last_mid);
+  coap_set_token(response, request->token, request->token_len);
+  return response;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_response(int node, coap_packet_t *response, const char *payload)
+{
+  if(payload != NULL) {
+    coap_set_header_content_format(response, TEXT_PLAIN);
+    coap_set_payload(response, payload, strlen(payload));
+  }
+  inject(&nodes[node], NODE_PORT, response);
+}
+/*---------------------------------------------------------------------------*/
+static int
+has_payload(coap_packet_t *message, const char *payload)
+{
+  return message->payload_len == strlen(payload)
+         && memcmp(message->payload, payload, message->payload_len) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+has_etag(coap_packet_t *message, const char *etag)
+{
+  return message->etag_len == strlen(etag)
+         && memcmp(message->etag, etag, message->etag_len) == 0;
+}
+/*---------------------------------------------------------------------------*/
+/* The response a client got, checked against the token it sent */
+static coap_packet_t *
+take_response(int client, uint8_t code)
+{
+  coap_packet_t *response = take(&clients[client]);
+
+  TEST_CHECK(response != NULL);
+  if(response == NULL) {
+    return NULL;
+  }
+  TEST_CHECK(response->code == code);
+  TEST_CHECK(response->token_len == 2 && response->token[0] == 0xc0
+             && response->token[1] == client);
+  return response;
+}
+/*---------------------------------------------------------------------------*/
+/* The request a node got from the proxy */
+static coap_packet_t *
+take_request(int node, uint8_t code, const char *path)
+{
+  coap_packet_t *request = take(&nodes[node]);
+
+  TEST_CHECK(request != NULL);
+  if(request == NULL) {
+    return NULL;
+  }
+  TEST_CHECK(request->code == code);
+  TEST_CHECK(request->type == COAP_TYPE_CON);
+  TEST_CHECK(request->uri_path_len == strlen(path)
+             && memcmp(request->uri_path, path, request->uri_path_len) == 0);
+  return request;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_coalescing, "Concurrent requests coalesced");
+UNIT_TEST(test_coalescing)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Three clients, one request to the node */
+  UNIT_TEST_ASSERT(upstream == 1);
+  UNIT_TEST_ASSERT(client_acks == 3);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_cache, "Requests answered from the cache");
+UNIT_TEST(test_cache)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Only the other Accept went to the node */
+  UNIT_TEST_ASSERT(upstream == 2);
+  UNIT_TEST_ASSERT(coap_proxy_stat.hits == 3);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_revalidation, "Expired entries revalidated");
+UNIT_TEST(test_revalidation)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(upstream == 3);
+  UNIT_TEST_ASSERT(coap_proxy_stat.revalidated == 1);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_observe, "Observers share one observation");
+UNIT_TEST(test_observe)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(upstream - upstream_before == 1);
+  UNIT_TEST_ASSERT(coap_proxy_stat.notifications == 1);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_observe_end, "Observation ends with the last observer");
+UNIT_TEST(test_observe_end)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(list_length(coap_get_observers()) == 0);
+  UNIT_TEST_ASSERT(node_rsts == 1);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_eviction, "Least recently used entries evicted");
+UNIT_TEST(test_eviction)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Three old entries for the four new ones, then r1 for temp and the
+     entry of r2 for r1 */
+  UNIT_TEST_ASSERT(coap_proxy_stat.evictions == 5);
+  UNIT_TEST_ASSERT(upstream - upstream_before == 6);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_put, "PUT forwarded, cached entry invalidated");
+UNIT_TEST(test_put)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The PUT and the GET that follows it */
+  UNIT_TEST_ASSERT(upstream - upstream_before == 2);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_separate, "Separate responses passed on");
+UNIT_TEST(test_separate)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(node_acks == 1);
+  UNIT_TEST_ASSERT(queued == 0);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(test_process, "CoAP proxy test");
+AUTOSTART_PROCESSES(&test_process);
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static coap_packet_t *m;
+  static coap_packet_t *r;
+  static uip_lladdr_t lladdr;
+  static char url[COAP_PROXY_URL_LEN];
+  static int i;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < NUM_CLIENTS + NUM_NODES; i++) {
+    memset(&lladdr, 0, sizeof(lladdr));
+    lladdr.addr[sizeof(lladdr.addr) - 1] = i + 1;
+    if(i < NUM_CLIENTS) {
+      uip_ip6addr(&clients[i], 0xfe80, 0, 0, 0, 0, 0, 0, 0xc0 + i);
+      uip_ds6_nbr_add(&clients[i], &lladdr, 0, NBR_REACHABLE,
+                      NBR_TABLE_REASON_UNDEFINED, NULL);
+    } else {
+      uip_ip6addr(&nodes[i - NUM_CLIENTS], 0xfe80, 0, 0, 0, 0, 0, 0,
+                  0xa0 + i - NUM_CLIENTS);
+      uip_ds6_nbr_add(&nodes[i - NUM_CLIENTS], &lladdr, 0, NBR_REACHABLE,
+                      NBR_TABLE_REASON_UNDEFINED, NULL);
+    }
+  }
+
+  rest_init_engine();
+  coap_proxy_init();
+  PROCESS_PAUSE();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* Three clients ask for the same resource: one request to the node */
+  for(i = 0; i < 3; i++) {
+    send_request(i, new_request(i, COAP_GET, "proxy/fe80::a0/temp"));
+  }
+  PROCESS_PAUSE();
+  r = take_request(0, COAP_GET, "temp");
+  TEST_CHECK(take(&nodes[0]) == NULL);
+  if(r != NULL) {
+    m = new_response(r, COAP_TYPE_ACK, CONTENT_2_05);
+    coap_set_header_max_age(m, 2);
+    coap_set_header_etag(m, (const uint8_t *)"e1", 2);
+    send_response(0, m, "21 C");
+  }
+  PROCESS_PAUSE();
+  for(i = 0; i < 3; i++) {
+    m = take_response(i, CONTENT_2_05);
+    TEST_CHECK(m == NULL || (has_payload(m, "21 C") && has_etag(m, "e1")
+                             && m->type == COAP_TYPE_CON));
+  }
+  UNIT_TEST_RUN(test_coalescing);
+
+  /* Answered from the cache */
+  send_request(3, new_request(3, COAP_GET, "proxy/fe80::a0/temp"));
+  m = take_response(3, CONTENT_2_05);
+  TEST_CHECK(m == NULL || (m->type == COAP_TYPE_ACK && has_payload(m, "21 C")
+                           && IS_OPTION(m, COAP_OPTION_MAX_AGE)
+                           && m->max_age <= 2));
+
+  /* The client has the representation already */
+  m = new_request(1, COAP_GET, "proxy/fe80::a0/temp");
+  coap_set_header_etag(m, (const uint8_t *)"e1", 2);
+  send_request(1, m);
+  m = take_response(1, VALID_2_03);
+  TEST_CHECK(m == NULL || (m->payload_len == 0 && has_etag(m, "e1")));
+
+  /* Another Accept is another entry */
+  m = new_request(0, COAP_GET, "proxy/fe80::a0/temp");
+  coap_set_header_accept(m, APPLICATION_JSON);
+  send_request(0, m);
+  PROCESS_PAUSE();
+  r = take_request(0, COAP_GET, "temp");
+  TEST_CHECK(r == NULL || (IS_OPTION(r, COAP_OPTION_ACCEPT)
+                           && r->accept == APPLICATION_JSON));
+  if(r != NULL) {
+    m = new_response(r, COAP_TYPE_ACK, CONTENT_2_05);
+    coap_set_header_content_format(m, APPLICATION_JSON);
+    coap_set_payload(m, "{\"t\":21}", 8);
+    inject(&nodes[0], NODE_PORT, m);
+  }
+  PROCESS_PAUSE();
+  m = take_response(0, CONTENT_2_05);
+  TEST_CHECK(m == NULL || (m->content_format == APPLICATION_JSON
+                           && has_payload(m, "{\"t\":21}")));
+  send_request(4, new_request(4, COAP_GET, "proxy/fe80::a0/temp"));
+  m = take_response(4, CONTENT_2_05);
+  TEST_CHECK(m == NULL || has_payload(m, "21 C"));
+  UNIT_TEST_RUN(test_cache);
+
+  /* Max-Age expired: revalidated with the ETag */
+  etimer_set(&et, 3 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  send_request(2, new_request(2, COAP_GET, "proxy/fe80::a0/temp"));
+  PROCESS_PAUSE();
+  r = take_request(0, COAP_GET, "temp");
+  TEST_CHECK(r == NULL || has_etag(r, "e1"));
+  if(r != NULL) {
+    m = new_response(r, COAP_TYPE_ACK, VALID_2_03);
+    coap_set_header_etag(m, (const uint8_t *)"e1", 2);
+    send_response(0, m, NULL);
+  }
+  PROCESS_PAUSE();
+  m = take_response(2, CONTENT_2_05);
+  TEST_CHECK(m == NULL || (has_payload(m, "21 C") && has_etag(m, "e1")
+                           && m->max_age == COAP_DEFAULT_MAX_AGE));
+  UNIT_TEST_RUN(test_revalidation);
+
+  /* Four clients observe a resource: one observation of the node */
+  upstream_before = upstream;
+  for(i = 0; i < 4; i++) {
+    m = new_request(i, COAP_GET, "proxy/fe80::a0/light");
+    coap_set_header_observe(m, 0);
+    send_request(i, m);
+  }
+  PROCESS_PAUSE();
+  r = take_request(0, COAP_GET, "light");
+  TEST_CHECK(take(&nodes[0]) == NULL);
+  TEST_CHECK(r == NULL || (IS_OPTION(r, COAP_OPTION_OBSERVE) && r->observe == 0));
+  if(r != NULL) {
+    m = new_response(r, COAP_TYPE_ACK, CONTENT_2_05);
+    coap_set_header_observe(m, 5);
+    send_response(0, m, "100 lx");
+    /* notifications use the token of the registration */
+    m = new_response(r, COAP_TYPE_NON, CONTENT_2_05);
+  }
+  PROCESS_PAUSE();
+  for(i = 0; i < 4; i++) {
+    r = take_response(i, CONTENT_2_05);
+    TEST_CHECK(r == NULL || (IS_OPTION(r, COAP_OPTION_OBSERVE)
+                             && has_payload(r, "100 lx")));
+    TEST_CHECK(take(&clients[i]) == NULL);
+  }
+
+  /* A notification of the node goes to all clients */
+  coap_set_header_observe(m, 6);
+  send_response(0, m, "200 lx");
+  PROCESS_PAUSE();
+  for(i = 0; i < 4; i++) {
+    r = take_response(i, CONTENT_2_05);
+    TEST_CHECK(r == NULL || (IS_OPTION(r, COAP_OPTION_OBSERVE)
+                             && has_payload(r, "200 lx")));
+  }
+
+  /* A fifth observer joins from the cache */
+  m = new_request(4, COAP_GET, "proxy/fe80::a0/light");
+  coap_set_header_observe(m, 0);
+  send_request(4, m);
+  r = take_response(4, CONTENT_2_05);
+  TEST_CHECK(r == NULL || (r->type == COAP_TYPE_ACK
+                           && IS_OPTION(r, COAP_OPTION_OBSERVE)
+                           && has_payload(r, "200 lx")));
+  PROCESS_PAUSE();
+  UNIT_TEST_RUN(test_observe);
+
+  /* All clients leave: the next notification is rejected */
+  for(i = 0; i < NUM_CLIENTS; i++) {
+    m = new_request(i, COAP_GET, "proxy/fe80::a0/light");
+    coap_set_header_observe(m, 1);
+    send_request(i, m);
+    r = take_response(i, CONTENT_2_05);
+    TEST_CHECK(r == NULL || !IS_OPTION(r, COAP_OPTION_OBSERVE));
+  }
+  PROCESS_PAUSE();
+  m = new_response(m, COAP_TYPE_NON, CONTENT_2_05);
+  coap_set_header_observe(m, 7);
+  send_response(0, m, "300 lx");
+  PROCESS_PAUSE();
+  for(i = 0; i < NUM_CLIENTS; i++) {
+    TEST_CHECK(take(&clients[i]) == NULL);
+  }
+  UNIT_TEST_RUN(test_observe_end);
+
+  /* LRU eviction: four new entries evict the three old ones */
+  upstream_before = upstream;
+  for(i = 0; i < 4; i++) {
+    snprintf(url, sizeof(url), "proxy/fe80::a1/r%d", i);
+    send_request(0, new_request(0, COAP_GET, url));
+    PROCESS_PAUSE();
+    r = take_request(1, COAP_GET, url + 15);
+    if(r != NULL) {
+      send_response(1, new_response(r, COAP_TYPE_ACK, CONTENT_2_05), "on");
+    }
+    PROCESS_PAUSE();
+    take_response(0, CONTENT_2_05);
+  }
+  TEST_CHECK(coap_proxy_stat.evictions == 3);
+  /* r0 was used last, r1 is the least recently used */
+  send_request(0, new_request(0, COAP_GET, "proxy/fe80::a1/r0"));
+  take_response(0, CONTENT_2_05);
+  send_request(0, new_request(0, COAP_GET, "proxy/fe80::a0/temp"));
+  PROCESS_PAUSE();
+  r = take_request(0, COAP_GET, "temp");
+  if(r != NULL) {
+    send_response(0, new_response(r, COAP_TYPE_ACK, CONTENT_2_05), "22 C");
+  }
+  PROCESS_PAUSE();
+  take_response(0, CONTENT_2_05);
+  send_request(0, new_request(0, COAP_GET, "proxy/fe80::a1/r2"));
+  take_response(0, CONTENT_2_05);
+  send_request(0, new_request(0, COAP_GET, "proxy/fe80::a1/r1"));
+  PROCESS_PAUSE();
+  r = take_request(1, COAP_GET, "r1");
+  if(r != NULL) {
+    send_response(1, new_response(r, COAP_TYPE_ACK, CONTENT_2_05), "on");
+  }
+  PROCESS_PAUSE();
+  take_response(0, CONTENT_2_05);
+  UNIT_TEST_RUN(test_eviction);
+
+  upstream_before = upstream;
+  /* A PUT is forwarded and invalidates the cached representation */
+  m = new_request(1, COAP_PUT, "proxy/fe80::a1/r2");
+  coap_set_header_content_format(m, TEXT_PLAIN);
+  coap_set_payload(m, "off", 3);
+  send_request(1, m);
+  PROCESS_PAUSE();
+  r = take_request(1, COAP_PUT, "r2");
+  TEST_CHECK(r == NULL || has_payload(r, "off"));
+  if(r != NULL) {
+    send_response(1, new_response(r, COAP_TYPE_ACK, CHANGED_2_04), NULL);
+  }
+  PROCESS_PAUSE();
+  take_response(1, CHANGED_2_04);
+  send_request(1, new_request(1, COAP_GET, "proxy/fe80::a1/r2"));
+  PROCESS_PAUSE();
+  r = take_request(1, COAP_GET, "r2");
+  if(r != NULL) {
+    send_response(1, new_response(r, COAP_TYPE_ACK, CONTENT_2_05), "off");
+  }
+  PROCESS_PAUSE();
+  m = take_response(1, CONTENT_2_05);
+  TEST_CHECK(m == NULL || has_payload(m, "off"));
+  UNIT_TEST_RUN(test_put);
+
+  /* A separate response of the node */
+  send_request(2, new_request(2, COAP_GET, "proxy/fe80::a1/slow"));
+  PROCESS_PAUSE();
+  r = take_request(1, COAP_GET, "slow");
+  if(r != NULL) {
+    send_empty(&nodes[1], NODE_PORT, COAP_TYPE_ACK, r->mid);
+    send_response(1, new_response(r, COAP_TYPE_CON, CONTENT_2_05), "late");
+  }
+  PROCESS_PAUSE();
+  m = take_response(2, CONTENT_2_05);
+  TEST_CHECK(m == NULL || has_payload(m, "late"));
+
+  /* The separate response never comes */
+  send_request(3, new_request(3, COAP_GET, "proxy/fe80::a1/lost"));
+  PROCESS_PAUSE();
+  r = take_request(1, COAP_GET, "lost");
+  if(r != NULL) {
+    send_empty(&nodes[1], NODE_PORT, COAP_TYPE_ACK, r->mid);
+  }
+  etimer_set(&et, COAP_PROXY_SEPARATE_TIMEOUT + CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  take_response(3, GATEWAY_TIMEOUT_5_04);
+  UNIT_TEST_RUN(test_separate);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the CSMA neighbor queues. Packets arrive at the same
+ *         rate for two good neighbors, in bursts, and a lossy one, which
+ *         acknowledges one transmission in four. The RDC driver of the
+ *         test models a channel with room for a few transmissions per
+ *         clock tick, less than the lossy neighbor alone would take. Every
+ *         packet must be reported sent or dropped exactly once. With fair
+ *         queueing, the good neighbors must get their packets through, and
+ *         packets of a higher class must not wait behind the backlog of
+ *         their neighbor.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+#include "net/mac/csma.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+#if !CSMA_STATS
+#error "The csma test needs CSMA_CONF_STATS"
+#endif
+
+#define NUM_NEIGHBORS 3
+#define LOSSY 2
+/* The lossy neighbor acknowledges one transmission in LOSS_PERIOD */
+#define LOSS_PERIOD 4
+#define TICKS 500
+/* Transmissions the channel has room for per clock tick */
+#define TRANSMISSIONS_PER_TICK 4
+#define PAYLOAD_LEN 50
+/* The good neighbors get BURST packets every BURST ticks, in turn */
+#define BURST 2
+/* A packet of class 1 for the lossy neighbor every PRIORITY_PERIOD ticks */
+#define PRIORITY_PERIOD 50
+
+struct neighbor {
+  linkaddr_t addr;
+  unsigned long offered;
+  unsigned long delivered;
+  unsigned long failed;
+  unsigned long transmissions;
+};
+
+static struct neighbor neighbors[NUM_NEIGHBORS];
+
+/* A transmission waiting for the channel */
+struct request {
+  mac_callback_t sent;
+  void *ptr;
+  struct rdc_buf_list *list;
+};
+
+#define MAX_REQUESTS 16
+static struct request requests[MAX_REQUESTS];
+static int num_requests;
+static unsigned long overflows;
+
+static unsigned long tick;
+static unsigned long priority_sent_tick;
+static unsigned long priority_delay_max;
+static unsigned long priority_delivered;
+static unsigned long priority_offered;
+static int priority_pending;
+static unsigned long callbacks_unknown;
+
+PROCESS(test_process, "CSMA neighbor queues test");
+AUTOSTART_PROCESSES(&test_process);
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  /* csma sends lists only */
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *list)
+{
+  if(num_requests == MAX_REQUESTS) {
+    overflows++;
+    return;
+  }
+  requests[num_requests].sent = sent;
+  requests[num_requests].ptr = ptr;
+  requests[num_requests].list = list;
+  num_requests++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(int keep_radio_on)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+/* Set as NETSTACK_CONF_RDC */
+const struct rdc_driver loopback_rdc_driver = {
+  "loopback",
+  init,
+  send_packet,
+  send_list,
+  packet_input,
+  on,
+  off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
+static struct neighbor *
+neighbor_from_addr(const linkaddr_t *addr)
+{
+  int i;
+
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    if(linkaddr_cmp(&neighbors[i].addr, addr)) {
+      return &neighbors[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Transmit the frame that has waited the longest for the channel */
+static void
+transmit(void)
+{
+  struct request r;
+  struct neighbor *nb;
+  int status;
+
+  if(num_requests > 0) {
+    r = requests[0];
+    num_requests--;
+    memmove(&requests[0], &requests[1], num_requests * sizeof(requests[0]));
+
+    queuebuf_to_packetbuf(r.list->buf);
+    nb = neighbor_from_addr(packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+    status = MAC_TX_OK;
+    /* Frames to other nodes are sent by the IPv6 stack of the node */
+    if(nb != NULL) {
+      nb->transmissions++;
+      if(nb == &neighbors[LOSSY] && nb->transmissions % LOSS_PERIOD != 0) {
+        status = MAC_TX_NOACK;
+      }
+    }
+    mac_call_sent_callback(r.sent, r.ptr, status, 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+sent_callback(void *ptr, int status, int num_tx)
+{
+  struct neighbor *nb = ptr;
+
+  if(nb == NULL) {
+    /* The packet of class 1 */
+    if(status == MAC_TX_OK) {
+      priority_delivered++;
+      if(tick - priority_sent_tick > priority_delay_max) {
+        priority_delay_max = tick - priority_sent_tick;
+      }
+    }
+    priority_pending = 0;
+    return;
+  }
+  if(nb < neighbors || nb >= neighbors + NUM_NEIGHBORS) {
+    callbacks_unknown++;
+    return;
+  }
+  if(status == MAC_TX_OK) {
+    nb->delivered++;
+  } else {
+    nb->failed++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+offer(struct neighbor *nb, uint8_t class)
+{
+  packetbuf_clear();
+  memset(packetbuf_dataptr(), 0x5a, PAYLOAD_LEN);
+  packetbuf_set_datalen(PAYLOAD_LEN);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &nb->addr);
+  packetbuf_set_attr(PACKETBUF_ATTR_TRAFFIC_CLASS, class);
+  NETSTACK_MAC.send(sent_callback, class > 0 ? NULL : nb);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_accounting, "Every packet reported once");
+UNIT_TEST(test_accounting)
+{
+  struct csma_neighbor_stats stats;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(callbacks_unknown == 0);
+  UNIT_TEST_ASSERT(overflows == 0);
+  UNIT_TEST_ASSERT(num_requests == 0);
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    UNIT_TEST_ASSERT(neighbors[i].delivered + neighbors[i].failed
+                     == neighbors[i].offered);
+    /* The queues are drained, and freed */
+    UNIT_TEST_ASSERT(!csma_neighbor_stats(&neighbors[i].addr, &stats));
+  }
+  UNIT_TEST_ASSERT(!priority_pending);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+#if CSMA_CONF_FAIR_QUEUEING
+UNIT_TEST_REGISTER(test_fairness, "Good neighbors served next to a lossy one");
+UNIT_TEST(test_fairness)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    if(i != LOSSY) {
+      UNIT_TEST_ASSERT(neighbors[i].delivered >= neighbors[i].offered * 95 / 100);
+    }
+  }
+  /* The lossy neighbor gets the airtime left */
+  UNIT_TEST_ASSERT(neighbors[LOSSY].delivered > 0);
+  UNIT_TEST_ASSERT(csma_stat.dropped_pushed_out > 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_priority, "Packets of class 1 ahead of the backlog");
+UNIT_TEST(test_priority)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Packets of class 1 push out others if need be. The lossy neighbor
+     may need LOSS_PERIOD transmissions. */
+  UNIT_TEST_ASSERT(priority_offered == TICKS / PRIORITY_PERIOD);
+  UNIT_TEST_ASSERT(priority_delivered == priority_offered);
+  UNIT_TEST_ASSERT(priority_delay_max <= 2 * LOSS_PERIOD);
+
+  UNIT_TEST_END();
+}
+#endif /* CSMA_CONF_FAIR_QUEUEING */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static int slot;
+  static int i;
+  int j;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    neighbors[i].addr.u8[0] = i + 1;
+    neighbors[i].addr.u8[1] = 0xcc;
+  }
+  csma_stats_reset();
+
+  for(tick = 0; tick < TICKS; tick++) {
+    /* The lossy neighbor first, to take the buffers freed in the last tick */
+    for(i = NUM_NEIGHBORS - 1; i >= 0; i--) {
+      if(i == LOSSY) {
+        neighbors[i].offered++;
+        offer(&neighbors[i], 0);
+      } else if(tick % BURST == i) {
+        for(j = 0; j < BURST; j++) {
+          neighbors[i].offered++;
+          offer(&neighbors[i], 0);
+        }
+      }
+    }
+    if(tick % PRIORITY_PERIOD == 0 && !priority_pending) {
+      priority_pending = 1;
+      priority_sent_tick = tick;
+      priority_offered++;
+      offer(&neighbors[LOSSY], 1);
+    }
+    /* The csma timers run between transmissions */
+    for(slot = 0; slot < TRANSMISSIONS_PER_TICK; slot++) {
+      transmit();
+      for(i = 0; i < 4; i++) {
+        PROCESS_PAUSE();
+      }
+    }
+  }
+
+  /* Let the queues drain */
+  for(slot = 0; slot < 10 * QUEUEBUF_NUM * LOSS_PERIOD; slot++) {
+    transmit();
+    for(i = 0; i < 4; i++) {
+      PROCESS_PAUSE();
+    }
+  }
+
+  printf("%lu packets, %lu failed, %lu transmissions, %lu dropped for lack of room, %lu pushed out, %lu rounds\n",
+         (unsigned long)csma_stat.tx_packets, (unsigned long)csma_stat.tx_failed,
+         (unsigned long)csma_stat.tx_transmissions,
+         (unsigned long)csma_stat.dropped_full,
+         (unsigned long)csma_stat.dropped_pushed_out,
+         (unsigned long)csma_stat.rounds);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_accounting);
+#if CSMA_CONF_FAIR_QUEUEING
+  UNIT_TEST_RUN(test_fairness);
+  UNIT_TEST_RUN(test_priority);
+#endif /* CSMA_CONF_FAIR_QUEUEING */
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the IPv6 neighbor cache lookups. Fills the cache with
+ *         up to 500 neighbors and checks uip_ds6_nbr_lookup() and
+ *         uip_ds6_nbr_lladdr_from_ipaddr() against a scan of the cache
+ *         while neighbors are added, removed and added again with
+ *         another address.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "lib/random.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "ds6 neighbor cache test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_NEIGHBORS 500
+#define CHECKS 5000
+
+static uip_ipaddr_t addrs[NUM_NEIGHBORS];
+
+/*---------------------------------------------------------------------------*/
+/* Link-layer and IPv6 address of neighbor i. Neighbors that have been
+   added again (generation 1) get a global address instead of a
+   link-local one. */
+static void
+make_addr(uip_lladdr_t *lladdr, uip_ipaddr_t *ipaddr, unsigned short i,
+          unsigned char generation)
+{
+  memset(lladdr, 0, sizeof(uip_lladdr_t));
+  lladdr->addr[0] = 0x02;
+  lladdr->addr[sizeof(uip_lladdr_t) - 2] = i >> 8;
+  lladdr->addr[sizeof(uip_lladdr_t) - 1] = i & 0xff;
+  if(generation == 0) {
+    uip_ip6addr(ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  } else {
+    uip_ip6addr(ipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, 0);
+  }
+  uip_ds6_set_addr_iid(ipaddr, lladdr);
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_nbr_t *
+reference_lookup(const uip_ipaddr_t *ipaddr)
+{
+  uip_ds6_nbr_t *nbr;
+
+  for(nbr = nbr_table_head(ds6_neighbors);
+      nbr != NULL;
+      nbr = nbr_table_next(ds6_neighbors, nbr)) {
+    if(uip_ipaddr_cmp(&nbr->ipaddr, ipaddr)) {
+      return nbr;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Look up random addresses of the first 2n neighbors of both
+   generations, of which at most n are in the cache. Returns the number
+   of lookups that differ from a scan of the cache. */
+static unsigned
+mismatches(unsigned short n)
+{
+  unsigned short i;
+  unsigned count;
+  uip_lladdr_t lladdr;
+  uip_ipaddr_t ipaddr;
+  uip_ds6_nbr_t *nbr;
+  const uip_lladdr_t *found;
+
+  count = 0;
+  for(i = 0; i < CHECKS; i++) {
+    make_addr(&lladdr, &ipaddr, random_rand() % (2 * n), random_rand() % 2);
+    nbr = reference_lookup(&ipaddr);
+    found = uip_ds6_nbr_lladdr_from_ipaddr(&ipaddr);
+    if(uip_ds6_nbr_lookup(&ipaddr) != nbr ||
+       found != (nbr == NULL ? NULL : uip_ds6_nbr_get_ll(nbr))) {
+      count++;
+    }
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_neighbors(unsigned short from, unsigned short to)
+{
+  uip_lladdr_t lladdr;
+
+  for(; from < to; from++) {
+    make_addr(&lladdr, &addrs[from], from, 0);
+    uip_ds6_nbr_add(&addrs[from], &lladdr, 0, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_add, "Lookups while neighbors are added");
+UNIT_TEST(test_add)
+{
+  UNIT_TEST_BEGIN();
+
+  add_neighbors(0, 5);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_num() == 5);
+  UNIT_TEST_ASSERT(mismatches(5) == 0);
+  add_neighbors(5, 100);
+  UNIT_TEST_ASSERT(mismatches(100) == 0);
+  add_neighbors(100, NUM_NEIGHBORS);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_num() == NUM_NEIGHBORS);
+  UNIT_TEST_ASSERT(mismatches(NUM_NEIGHBORS) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_remove, "Lookups after neighbors are removed and added again");
+UNIT_TEST(test_remove)
+{
+  uip_lladdr_t lladdr;
+  unsigned short i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Remove every third neighbor, then add every fifth one again with
+     its global address */
+  for(i = 0; i < NUM_NEIGHBORS; i += 3) {
+    uip_ds6_nbr_rm(uip_ds6_nbr_lookup(&addrs[i]));
+  }
+  UNIT_TEST_ASSERT(uip_ds6_nbr_num() == NUM_NEIGHBORS * 2 / 3);
+  UNIT_TEST_ASSERT(mismatches(NUM_NEIGHBORS) == 0);
+  for(i = 0; i < NUM_NEIGHBORS; i += 5) {
+    make_addr(&lladdr, &addrs[i], i, 1);
+    uip_ds6_nbr_add(&addrs[i], &lladdr, 0, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+  }
+  UNIT_TEST_ASSERT(mismatches(NUM_NEIGHBORS) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  random_init(1);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_add);
+  UNIT_TEST_RUN(test_remove);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
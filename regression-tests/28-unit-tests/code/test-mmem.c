@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the managed memory allocator, with in-place or
+ *         incremental compaction. A random sequence of allocations and
+ *         frees must keep the contents of every block, never let two
+ *         blocks overlap, and succeed exactly when enough memory is
+ *         free, however fragmented.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "lib/mmem.h"
+#include "lib/random.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "mmem test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define ROUNDS 200
+#define OPS_PER_ROUND 50
+#define NUM_BLOCKS 48
+#define MAX_BLOCK 64
+
+static struct mmem blocks[NUM_BLOCKS];
+static unsigned char allocated[NUM_BLOCKS];
+static unsigned char tags[NUM_BLOCKS];
+static unsigned int used;
+static unsigned long moved;
+
+/*---------------------------------------------------------------------------*/
+static void
+fill(int i)
+{
+  unsigned int j;
+  unsigned char *p = (unsigned char *)MMEM_PTR(&blocks[i]);
+
+  for(j = 0; j < blocks[i].size; j++) {
+    p[j] = tags[i] + j;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+intact(int i)
+{
+  unsigned int j;
+  unsigned char *p = (unsigned char *)MMEM_PTR(&blocks[i]);
+
+  for(j = 0; j < blocks[i].size; j++) {
+    if(p[j] != (unsigned char)(tags[i] + j)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_all(void)
+{
+  struct mmem_stats stats;
+  char *a, *b;
+  int i, j;
+
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    if(!allocated[i]) {
+      continue;
+    }
+    TEST_CHECK(intact(i));
+    a = (char *)MMEM_PTR(&blocks[i]);
+    for(j = i + 1; j < NUM_BLOCKS; j++) {
+      if(allocated[j]) {
+        b = (char *)MMEM_PTR(&blocks[j]);
+        TEST_CHECK(a + blocks[i].size <= b || b + blocks[j].size <= a);
+      }
+    }
+  }
+  mmem_get_stats(&stats);
+  TEST_CHECK(stats.free == MMEM_CONF_SIZE - used);
+  TEST_CHECK(stats.largest_free <= stats.free);
+}
+/*---------------------------------------------------------------------------*/
+static void
+random_op(void)
+{
+  int i;
+  unsigned int size;
+  int ok;
+
+  i = random_rand() % NUM_BLOCKS;
+  if(allocated[i]) {
+    TEST_CHECK(intact(i));
+    used -= blocks[i].size;
+    mmem_free(&blocks[i]);
+    allocated[i] = 0;
+  } else {
+    size = 1 + random_rand() % MAX_BLOCK;
+    ok = mmem_alloc(&blocks[i], size);
+    /* Must succeed whenever enough memory is free, fragmented or not */
+    TEST_CHECK(ok == (MMEM_CONF_SIZE - used >= size));
+    if(ok) {
+      allocated[i] = 1;
+      tags[i] = random_rand();
+      used += size;
+      fill(i);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_free_last, "Freeing the last block frees a hole before it");
+UNIT_TEST(test_free_last)
+{
+  struct mmem a, b, c;
+  struct mmem_stats stats;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(mmem_alloc(&a, 16));
+  UNIT_TEST_ASSERT(mmem_alloc(&b, 16));
+  UNIT_TEST_ASSERT(mmem_alloc(&c, 16));
+  mmem_free(&b);
+  mmem_free(&c);
+  /* Before the compaction process has run */
+  mmem_get_stats(&stats);
+  UNIT_TEST_ASSERT(stats.largest_free == MMEM_CONF_SIZE - 16);
+  UNIT_TEST_ASSERT(stats.holes == 0);
+  mmem_free(&a);
+  mmem_get_stats(&stats);
+  UNIT_TEST_ASSERT(stats.largest_free == MMEM_CONF_SIZE);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_moved, "Bytes moved by compaction");
+UNIT_TEST(test_moved)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Freeing a block in front of two others of 16 bytes moves them */
+  UNIT_TEST_ASSERT(moved == 32);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_random, "Random allocations and frees");
+UNIT_TEST(test_random)
+{
+  struct mmem_stats stats;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(test_errors == 0);
+  mmem_get_stats(&stats);
+  UNIT_TEST_ASSERT(stats.free == MMEM_CONF_SIZE);
+  UNIT_TEST_ASSERT(stats.largest_free == MMEM_CONF_SIZE);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct mmem a, b, c;
+  static int round;
+  struct mmem_stats stats;
+  int i;
+
+  PROCESS_BEGIN();
+
+  mmem_init();
+  random_init(1);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_free_last);
+
+  mmem_alloc(&a, 16);
+  mmem_alloc(&b, 16);
+  mmem_alloc(&c, 16);
+  mmem_get_stats(&stats);
+  moved = stats.moved;
+  mmem_free(&a);
+  /* Let the compaction process run */
+  PROCESS_PAUSE();
+  mmem_get_stats(&stats);
+  moved = stats.moved - moved;
+  mmem_free(&b);
+  mmem_free(&c);
+  UNIT_TEST_RUN(test_moved);
+
+  for(round = 0; round < ROUNDS; round++) {
+    for(i = 0; i < OPS_PER_ROUND; i++) {
+      random_op();
+    }
+    check_all();
+    PROCESS_PAUSE();
+    check_all();
+  }
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    if(allocated[i]) {
+      mmem_free(&blocks[i]);
+      allocated[i] = 0;
+    }
+  }
+  PROCESS_PAUSE();
+  UNIT_TEST_RUN(test_random);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of the resource lookup of the REST engine. Resources are
+ *         activated under paths of the form of IPSO objects on a LWM2M
+ *         gateway, and every lookup is checked against a scan of the
+ *         resource list. Requests are then dispatched to check the method
+ *         handlers.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "rest-engine.h"
+#include "er-coap.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+#define NUM_OBJECTS 4
+#define NUM_INSTANCES 3
+#define NUM_RESOURCES 4
+#define NUM_PATHS (NUM_OBJECTS * NUM_INSTANCES * NUM_RESOURCES)
+#define PATH_LEN 16
+
+static const uint16_t objects[NUM_OBJECTS] = { 3303, 3304, 3311, 3340 };
+static const uint16_t resources[NUM_RESOURCES] = { 5700, 5701, 5601, 5602 };
+
+static resource_t res[NUM_PATHS];
+static char paths[NUM_PATHS][PATH_LEN];
+static unsigned get_calls;
+static unsigned sub_calls;
+
+static void get_handler(void *request, void *response, uint8_t *buffer,
+                        uint16_t preferred_size, int32_t *offset);
+static void sub_get_handler(void *request, void *response, uint8_t *buffer,
+                            uint16_t preferred_size, int32_t *offset);
+
+PARENT_RESOURCE(res_parent, "", sub_get_handler, NULL, NULL, NULL);
+
+/* Requests of the test, some of them for no resource */
+static const char *misses[] = {
+  "3303/0/9999", "3303/7/5700", "9999/0/5700", "3303", "3303/0",
+  "3303/0/5700/1", "3303//5700", "", "lwm", "lwm2mx"
+};
+static const char *sub_resources[] = { "lwm2m", "lwm2m/", "lwm2m/1/2" };
+/*---------------------------------------------------------------------------*/
+static void
+get_handler(void *request, void *response, uint8_t *buffer,
+            uint16_t preferred_size, int32_t *offset)
+{
+  get_calls++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+sub_get_handler(void *request, void *response, uint8_t *buffer,
+                uint16_t preferred_size, int32_t *offset)
+{
+  sub_calls++;
+}
+/*---------------------------------------------------------------------------*/
+/* The lookup of the REST engine before the path trie */
+static resource_t *
+scan(const char *url, int url_len)
+{
+  resource_t *resource;
+  int res_url_len;
+
+  for(resource = (resource_t *)list_head(rest_get_resources());
+      resource; resource = resource->next) {
+    res_url_len = strlen(resource->url);
+    if((url_len == res_url_len
+        || (url_len > res_url_len
+            && (resource->flags & HAS_SUB_RESOURCES)
+            && url[res_url_len] == '/'))
+       && strncmp(resource->url, url, res_url_len) == 0) {
+      return resource;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+check(const char *url, resource_t *expected)
+{
+  resource_t *r = rest_find_resource(url, strlen(url));
+
+  if(r != expected || r != scan(url, strlen(url))) {
+    printf("lookup of \"%s\": %s\n", url, r ? r->url : "none");
+    return 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+dispatch(const char *url, rest_resource_flags_t method)
+{
+  coap_packet_t request[1];
+  coap_packet_t response[1];
+  uint8_t buffer[REST_MAX_CHUNK_SIZE];
+  int32_t offset = 0;
+
+  coap_init_message(request, COAP_TYPE_CON,
+                    method == METHOD_GET ? COAP_GET : COAP_PUT, 0);
+  coap_set_header_uri_path(request, url);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+  rest_invoke_restful_service(request, response, buffer, sizeof(buffer),
+                              &offset);
+  return response->code;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_lookup, "Lookups agree with a scan of the resources");
+UNIT_TEST(test_lookup)
+{
+  int i, o, n, r;
+
+  UNIT_TEST_BEGIN();
+
+  i = 0;
+  for(o = 0; o < NUM_OBJECTS; o++) {
+    for(n = 0; n < NUM_INSTANCES; n++) {
+      for(r = 0; r < NUM_RESOURCES; r++) {
+        snprintf(paths[i], PATH_LEN, "%u/%u/%u", objects[o], n, resources[r]);
+        res[i].get_handler = get_handler;
+        rest_activate_resource(&res[i], paths[i]);
+        i++;
+      }
+    }
+  }
+  rest_activate_resource(&res_parent, "lwm2m");
+
+  for(i = 0; i < NUM_PATHS; i++) {
+    UNIT_TEST_ASSERT(check(paths[i], &res[i]));
+  }
+  for(i = 0; i < sizeof(misses) / sizeof(misses[0]); i++) {
+    UNIT_TEST_ASSERT(check(misses[i], NULL));
+  }
+  for(i = 0; i < sizeof(sub_resources) / sizeof(sub_resources[0]); i++) {
+    UNIT_TEST_ASSERT(check(sub_resources[i], &res_parent));
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_dispatch, "Requests reach the method handlers");
+UNIT_TEST(test_dispatch)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(dispatch(paths[NUM_PATHS - 1], METHOD_GET) == CONTENT_2_05);
+  UNIT_TEST_ASSERT(get_calls == 1);
+  UNIT_TEST_ASSERT(dispatch(paths[0], METHOD_PUT) == METHOD_NOT_ALLOWED_4_05);
+  UNIT_TEST_ASSERT(dispatch(misses[0], METHOD_GET) == NOT_FOUND_4_04);
+  UNIT_TEST_ASSERT(dispatch(sub_resources[2], METHOD_GET) == CONTENT_2_05);
+  UNIT_TEST_ASSERT(sub_calls == 1 && get_calls == 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(test_process, "REST dispatch test");
+AUTOSTART_PROCESSES(&test_process);
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_lookup);
+  UNIT_TEST_RUN(test_dispatch);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
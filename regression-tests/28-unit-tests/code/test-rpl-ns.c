@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of source routing at a non-storing RPL root, with the node
+ *         index and the source routing header cache. Builds a DODAG of up
+ *         to 1000 nodes from DAO-like updates, and checks the header that
+ *         rpl_update_header() inserts for every node against the parent
+ *         chain while nodes change parent, expire and join again.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/rpl/rpl-private.h"
+#include "net/rpl/rpl-ns.h"
+#include "lib/random.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_RH_BUF ((struct uip_routing_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+#define UIP_RPL_SRH_BUF ((struct uip_rpl_srh_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN + RPL_RH_LEN])
+
+#define NODES 1000
+#define PAYLOAD_LEN 32
+
+static uip_ipaddr_t root_addr;
+static uip_ipaddr_t addrs[NODES + 1];
+static unsigned short parents[NODES + 1];
+static rpl_dag_t *dag;
+static unsigned long with_srh;
+
+PROCESS(test_process, "Non-storing root test");
+AUTOSTART_PROCESSES(&test_process);
+/*---------------------------------------------------------------------------*/
+/* Node 0 is the root, the others get addresses derived from
+   EUI-64 link-layer addresses */
+static void
+make_addr(uip_ipaddr_t *ipaddr, unsigned short i)
+{
+  uip_ip6addr(ipaddr, 0xfd00, 0, 0, 0, 0x0212, 0x7400, i >> 8, i & 0xff);
+}
+/*---------------------------------------------------------------------------*/
+static void
+update(unsigned short i, unsigned short parent, uint32_t lifetime)
+{
+  parents[i] = parent;
+  rpl_ns_update_node(dag, &addrs[i],
+                     parent == 0 ? &root_addr : &addrs[parent], lifetime);
+}
+/*---------------------------------------------------------------------------*/
+/* Any node but i itself, as DAOs never name the sender as its parent */
+static unsigned short
+random_parent(unsigned short i, unsigned short n)
+{
+  unsigned short parent;
+
+  do {
+    parent = random_rand() % (n + 1);
+  } while(parent == i);
+  return parent;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_ns_node_t *
+reference_get_node(const uip_ipaddr_t *addr)
+{
+  rpl_ns_node_t *node;
+
+  for(node = rpl_ns_node_head(); node != NULL; node = rpl_ns_node_next(node)) {
+    if(node->dag == dag && memcmp(node->link_identifier, &addr->u8[8], 8) == 0) {
+      return node;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_packet(unsigned short i)
+{
+  int k;
+
+  memset(UIP_IP_BUF, 0, UIP_IPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  UIP_IP_BUF->len[1] = PAYLOAD_LEN;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &root_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &addrs[i]);
+  for(k = 0; k < PAYLOAD_LEN; k++) {
+    uip_buf[UIP_LLH_LEN + UIP_IPH_LEN + k] = k;
+  }
+  uip_ext_len = 0;
+  uip_len = UIP_IPH_LEN + PAYLOAD_LEN;
+}
+/*---------------------------------------------------------------------------*/
+/* Check the header inserted for node i against the parent chain */
+static int
+verify_packet(unsigned short i, int ret)
+{
+  rpl_ns_node_t *chain[RPL_NS_LINK_NUM];
+  rpl_ns_node_t *root;
+  rpl_ns_node_t *node;
+  uip_ipaddr_t addr;
+  uint8_t *hop;
+  int cmpr;
+  int ext_len;
+  int n;
+  int k;
+
+  root = reference_get_node(&root_addr);
+  n = 0;
+  for(node = reference_get_node(&addrs[i]);
+      node != NULL && node != root && n < RPL_NS_LINK_NUM;
+      node = node->parent) {
+    chain[n++] = node;
+  }
+  if(n == 0) {
+    /* Unknown destination, sent without a header */
+    return ret == 1 && uip_len == UIP_IPH_LEN + PAYLOAD_LEN
+      && uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &addrs[i]);
+  }
+  if(node != root) {
+    /* Unreachable destination, dropped */
+    return ret == 0;
+  }
+  if(n == 1) {
+    /* Neighbor of the root, no header needed */
+    return ret == 1 && UIP_IP_BUF->proto == UIP_PROTO_UDP
+      && uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &addrs[i]);
+  }
+
+  with_srh++;
+  rpl_ns_get_node_global_addr(&addr, chain[n - 1]);
+  if(ret != 1 || UIP_IP_BUF->proto != UIP_PROTO_ROUTING
+     || UIP_RH_BUF->next != UIP_PROTO_UDP
+     || UIP_RH_BUF->routing_type != RPL_RH_TYPE_SRH
+     || UIP_RH_BUF->seg_left != n - 1
+     || !uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &addr)) {
+    return 0;
+  }
+  ext_len = (UIP_RH_BUF->len + 1) * 8;
+  if(uip_len != UIP_IPH_LEN + ext_len + PAYLOAD_LEN
+     || uip_ext_len != ext_len
+     || UIP_IP_BUF->len[0] * 256 + UIP_IP_BUF->len[1] != ext_len + PAYLOAD_LEN) {
+    return 0;
+  }
+  /* The hops after the first one, last is the destination */
+  cmpr = UIP_RPL_SRH_BUF->cmpr >> 4;
+  hop = (uint8_t *)UIP_RH_BUF + RPL_RH_LEN + RPL_SRH_LEN;
+  for(k = n - 2; k >= 0; k--) {
+    rpl_ns_get_node_global_addr(&addr, chain[k]);
+    if(memcmp(&addr, &addrs[i], cmpr) != 0
+       || memcmp(hop, &addr.u8[cmpr], 16 - cmpr) != 0) {
+      return 0;
+    }
+    hop += 16 - cmpr;
+  }
+  for(k = 0; k < PAYLOAD_LEN; k++) {
+    if(uip_buf[UIP_LLH_LEN + UIP_IPH_LEN + ext_len + k] != k) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Send a packet to each of the first n nodes, return the number of
+   packets whose header does not match the parent chain */
+static unsigned
+mismatches(unsigned short n)
+{
+  unsigned short i;
+  unsigned count;
+  int ret;
+
+  count = 0;
+  with_srh = 0;
+  for(i = 1; i <= n; i++) {
+    make_packet(i);
+    ret = rpl_update_header();
+    if(!verify_packet(i, ret)) {
+      count++;
+    }
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_nodes(unsigned short from, unsigned short to)
+{
+  /* Each node picks a random earlier node as parent, which gives a
+     depth of about seven hops at 1000 nodes */
+  for(; from <= to; from++) {
+    make_addr(&addrs[from], from);
+    update(from, random_rand() % from, 0xffffffff);
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_add, "Source routes while nodes join");
+UNIT_TEST(test_add)
+{
+  UNIT_TEST_BEGIN();
+
+  add_nodes(1, 100);
+  UNIT_TEST_ASSERT(rpl_ns_num_nodes() == 101);
+  UNIT_TEST_ASSERT(mismatches(100) == 0);
+  UNIT_TEST_ASSERT(with_srh > 0);
+  /* Again, from the cache */
+  UNIT_TEST_ASSERT(mismatches(100) == 0);
+  add_nodes(101, NODES);
+  UNIT_TEST_ASSERT(rpl_ns_num_nodes() == NODES + 1);
+  UNIT_TEST_ASSERT(mismatches(NODES) == 0);
+  UNIT_TEST_ASSERT(mismatches(NODES) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_move, "Source routes after nodes change parent");
+UNIT_TEST(test_move)
+{
+  unsigned short i;
+  unsigned short k;
+
+  UNIT_TEST_BEGIN();
+
+  /* Move a tenth of the nodes to another parent. Moves that would
+     create a loop are rejected by rpl_ns_update_node(). */
+  for(i = 0; i < NODES / 10; i++) {
+    k = 1 + random_rand() % NODES;
+    update(k, random_parent(k, NODES), 0xffffffff);
+  }
+  UNIT_TEST_ASSERT(mismatches(NODES) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_expire, "Source routes after nodes expire and join again");
+UNIT_TEST(test_expire)
+{
+  unsigned short i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Let a third of the nodes expire. Only those without children are
+     removed. */
+  for(i = 1; i <= NODES; i += 3) {
+    update(i, parents[i], 1);
+  }
+  rpl_ns_periodic();
+  UNIT_TEST_ASSERT(rpl_ns_num_nodes() < NODES + 1);
+  UNIT_TEST_ASSERT(mismatches(NODES) == 0);
+
+  for(i = 1; i <= NODES; i += 3) {
+    update(i, random_parent(i, NODES), 0xffffffff);
+  }
+  UNIT_TEST_ASSERT(mismatches(NODES) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static uip_ipaddr_t prefix;
+
+  PROCESS_BEGIN();
+
+  uip_ip6addr(&root_addr, 0xfd00, 0, 0, 0, 0x0212, 0x7400, 0xffff, 0xffff);
+  uip_ds6_addr_add(&root_addr, 0, ADDR_MANUAL);
+  dag = rpl_set_root(RPL_DEFAULT_INSTANCE, &root_addr);
+  uip_ip6addr(&prefix, 0xfd00, 0, 0, 0, 0, 0, 0, 0);
+  rpl_set_prefix(dag, &prefix, 64);
+  random_init(1);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_add);
+  UNIT_TEST_RUN(test_move);
+  UNIT_TEST_RUN(test_expire);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Test of 6LoWPAN fragmentation and reassembly. A MAC driver that
+ *         keeps every frame sent loops UDP packets with 256-byte payloads
+ *         back into sicslowpan, with fragments in order, reversed,
+ *         interleaved with those of another packet, and lost. Reassembled
+ *         packets must match the packets sent. With selective fragment
+ *         recovery, the RFRAG-ACKs are looped back too, lost fragments
+ *         must be sent again, and fragments of a packet for another node
+ *         must be forwarded without reassembly.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/rime/rime.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_UDP_BUF ((struct uip_udp_hdr *)&uip_buf[UIP_LLIPH_LEN])
+
+#ifndef SICSLOWPAN_CONF_SFR
+#define SICSLOWPAN_CONF_SFR 0
+#endif
+
+#if !SICSLOWPAN_FRAG_STATS
+#error "The sicslowpan test needs SICSLOWPAN_CONF_FRAG_STATS"
+#endif
+
+#define PAYLOAD_LEN 256
+#define PACKET_LEN (UIP_IPUDPH_LEN + PAYLOAD_LEN)
+#define MAX_FRAMES 16
+
+/* Frames sent again, or forwarded */
+#define OTHER 2
+
+struct frame {
+  uint8_t len;
+  uint8_t pending;
+  uint8_t data[PACKETBUF_SIZE];
+};
+
+/* Frames sent by sicslowpan, and by the packet sent before */
+static struct frame frames[3][MAX_FRAMES];
+static int num_frames[3];
+static int sending;
+
+/* RFRAG-ACKs sent by sicslowpan */
+static struct frame acks[MAX_FRAMES];
+static int num_acks;
+
+/* Packets as they were sent, by the first payload byte */
+static uint8_t packets[2][PACKET_LEN];
+static unsigned received[2];
+static unsigned total_received;
+
+static linkaddr_t peer_addr;
+
+static void input_callback(void);
+static void output_callback(int mac_status);
+RIME_SNIFFER(checker, input_callback, output_callback);
+
+PROCESS(test_process, "6LoWPAN fragmentation test");
+AUTOSTART_PROCESSES(&test_process);
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  struct frame *f;
+
+  if((((uint8_t *)packetbuf_dataptr())[0] & 0xfe) == SICSLOWPAN_DISPATCH_RFRAG_ACK) {
+    f = num_acks < MAX_FRAMES ? &acks[num_acks++] : NULL;
+  } else {
+    f = num_frames[sending] < MAX_FRAMES ? &frames[sending][num_frames[sending]++] : NULL;
+  }
+  if(f == NULL) {
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
+    return;
+  }
+  f->len = packetbuf_datalen();
+  f->pending = packetbuf_attr(PACKETBUF_ATTR_PENDING);
+  memcpy(f->data, packetbuf_dataptr(), f->len);
+  mac_call_sent_callback(sent, ptr, MAC_TX_OK, 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(int keep_radio_on)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Set as NETSTACK_CONF_MAC */
+const struct mac_driver loopback_mac_driver = {
+  "loopback",
+  init,
+  send_packet,
+  input,
+  on,
+  off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
+/* Called by sicslowpan with a complete packet in uip_buf */
+static void
+input_callback(void)
+{
+  uint8_t id = uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN] & 1;
+
+  TEST_CHECK(uip_len == PACKET_LEN);
+  TEST_CHECK(memcmp(&uip_buf[UIP_LLH_LEN], packets[id], PACKET_LEN) == 0);
+  /* The upper layers still see the frame that completed the packet */
+  TEST_CHECK(!linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_SENDER), &linkaddr_null));
+  received[id]++;
+  total_received++;
+  /* Keep the packet from the IP stack */
+  uip_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+output_callback(int mac_status)
+{
+}
+/*---------------------------------------------------------------------------*/
+/* Send a UDP packet from us to the peer, with a payload that starts
+   with id, and keep its fragments in frames[id]. The packet is for
+   the peer, or for dest through the peer if dest is not NULL. */
+static void
+send_to(uint8_t id, uint8_t seed, const uip_ipaddr_t *dest)
+{
+  uip_lladdr_t lladdr;
+  int i;
+
+  memcpy(&lladdr, &peer_addr, sizeof(lladdr));
+  memset(UIP_IP_BUF, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  UIP_IP_BUF->len[0] = (UIP_UDPH_LEN + PAYLOAD_LEN) >> 8;
+  UIP_IP_BUF->len[1] = (UIP_UDPH_LEN + PAYLOAD_LEN) & 0xff;
+  if(dest == NULL) {
+    uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+    uip_ip6addr(&UIP_IP_BUF->destipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+    uip_ds6_set_addr_iid(&UIP_IP_BUF->destipaddr, &lladdr);
+  } else {
+    uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, 0);
+    uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, dest);
+  }
+  uip_ds6_set_addr_iid(&UIP_IP_BUF->srcipaddr, &uip_lladdr);
+  UIP_UDP_BUF->srcport = UIP_HTONS(5683);
+  UIP_UDP_BUF->destport = UIP_HTONS(5683);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + PAYLOAD_LEN);
+  UIP_UDP_BUF->udpchksum = UIP_HTONS(0x1234 + seed);
+  for(i = 0; i < PAYLOAD_LEN; i++) {
+    uip_buf[UIP_LLIPH_LEN + UIP_UDPH_LEN + i] = i + seed;
+  }
+  uip_buf[UIP_LLIPH_LEN + UIP_UDPH_LEN] = (seed & 0xfe) | id;
+  memcpy(packets[id], UIP_IP_BUF, PACKET_LEN);
+  uip_len = PACKET_LEN;
+
+  sending = id;
+  num_frames[id] = 0;
+  received[0] = received[1] = 0;
+  tcpip_output(&lladdr);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send(uint8_t id, uint8_t seed)
+{
+  send_to(id, seed, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver_from(const struct frame *f, const linkaddr_t *sender,
+             const linkaddr_t *receiver)
+{
+  packetbuf_clear();
+  packetbuf_copyfrom(f->data, f->len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, sender);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, receiver);
+  NETSTACK_NETWORK.input();
+}
+/*---------------------------------------------------------------------------*/
+/* Deliver a frame we sent to the peer, as if the peer received it */
+static void
+deliver(const struct frame *f)
+{
+  deliver_from(f, &linkaddr_node_addr, &peer_addr);
+}
+/*---------------------------------------------------------------------------*/
+/* Hand the RFRAG-ACKs the peer sent to the sender, and keep the
+   fragments it sends again in frames[OTHER] */
+static void
+acknowledge(void)
+{
+  int n;
+  int k;
+
+  n = num_acks;
+  num_acks = 0;
+  sending = OTHER;
+  num_frames[OTHER] = 0;
+  for(k = 0; k < n; k++) {
+    deliver_from(&acks[k], &peer_addr, &linkaddr_node_addr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* All but the last fragment of a packet we sent are marked as pending */
+static int
+pending_ok(uint8_t id)
+{
+  int i;
+
+  for(i = 0; i < num_frames[id]; i++) {
+    if(frames[id][i].pending != (i < num_frames[id] - 1)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+#if SICSLOWPAN_CONF_SFR
+/* Fragments sent with SFR, with the ACK request flag on the last one */
+static int
+rfrag_ok(const struct frame *f, int n)
+{
+  int i;
+
+  for(i = 0; i < n; i++) {
+    if((f[i].data[0] & 0xfe) != SICSLOWPAN_DISPATCH_RFRAG
+       || ((f[i].data[2] & 0x80) != 0) != (i == n - 1)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+#endif /* SICSLOWPAN_CONF_SFR */
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_in_order, "Fragments in order");
+UNIT_TEST(test_in_order)
+{
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  send(0, 1);
+  UNIT_TEST_ASSERT(num_frames[0] > 1);
+  UNIT_TEST_ASSERT(pending_ok(0));
+#if SICSLOWPAN_CONF_SFR
+  UNIT_TEST_ASSERT(rfrag_ok(frames[0], num_frames[0]));
+#endif /* SICSLOWPAN_CONF_SFR */
+  for(k = 0; k < num_frames[0]; k++) {
+    deliver(&frames[0][k]);
+  }
+  acknowledge();
+  UNIT_TEST_ASSERT(received[0] == 1);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_reversed, "Fragments in reverse order");
+UNIT_TEST(test_reversed)
+{
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  /* First fragment, then the others in reverse order */
+  send(0, 2);
+  deliver(&frames[0][0]);
+  for(k = num_frames[0] - 1; k > 0; k--) {
+    deliver(&frames[0][k]);
+  }
+  acknowledge();
+  UNIT_TEST_ASSERT(received[0] == 1);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_interleaved, "Fragments of two packets interleaved");
+UNIT_TEST(test_interleaved)
+{
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  send(0, 4);
+  send(1, 5);
+  for(k = 0; k < num_frames[0]; k++) {
+    deliver(&frames[0][k]);
+    deliver(&frames[1][k]);
+  }
+  acknowledge();
+  UNIT_TEST_ASSERT(received[0] == 1);
+  UNIT_TEST_ASSERT(received[1] == 1);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+#if SICSLOWPAN_CONF_SFR
+UNIT_TEST_REGISTER(test_recovered, "Lost fragment sent again");
+UNIT_TEST(test_recovered)
+{
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  /* The RFRAG-ACK for the last fragment reports the second one
+     missing, and only this one is sent again */
+  send(0, 6);
+  deliver(&frames[0][0]);
+  for(k = 2; k < num_frames[0]; k++) {
+    deliver(&frames[0][k]);
+  }
+  acknowledge();
+  UNIT_TEST_ASSERT(num_frames[OTHER] == 1);
+  UNIT_TEST_ASSERT(frames[OTHER][0].len == frames[0][1].len);
+  UNIT_TEST_ASSERT(rfrag_ok(frames[OTHER], num_frames[OTHER]));
+  deliver(&frames[OTHER][0]);
+  acknowledge();
+  UNIT_TEST_ASSERT(num_frames[OTHER] == 0);
+  UNIT_TEST_ASSERT(received[0] == 1);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Run once the ACK timeout of a packet whose last fragment was lost
+   has passed */
+UNIT_TEST_REGISTER(test_timeout, "All fragments sent again after a timeout");
+UNIT_TEST(test_timeout)
+{
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_frames[OTHER] == num_frames[0]);
+  UNIT_TEST_ASSERT(rfrag_ok(frames[OTHER], num_frames[OTHER]));
+  for(k = 0; k < num_frames[OTHER]; k++) {
+    deliver(&frames[OTHER][k]);
+  }
+  acknowledge();
+  UNIT_TEST_ASSERT(received[0] == 1);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_forwarding, "Fragments forwarded without reassembly");
+UNIT_TEST(test_forwarding)
+{
+  static linkaddr_t next_addr;
+  static uip_ipaddr_t next_ipaddr;
+  static uip_ipaddr_t dest;
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  /* A packet for another node, which the peer forwards to its default
+     router next_addr. The forwarded fragments are then reassembled by
+     next_addr, and the RFRAG-ACK goes back through the peer. */
+  memset(&next_addr, 0, sizeof(next_addr));
+  next_addr.u8[0] = 0x02;
+  next_addr.u8[LINKADDR_SIZE - 1] = 0x02;
+  uip_ip6addr(&next_ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&next_ipaddr, (uip_lladdr_t *)&next_addr);
+  uip_ds6_nbr_add(&next_ipaddr, (uip_lladdr_t *)&next_addr, 1,
+                  NBR_REACHABLE, NBR_TABLE_REASON_UNDEFINED, NULL);
+  uip_ds6_defrt_add(&next_ipaddr, 0);
+  uip_ip6addr(&dest, 0xfd00, 0, 0, 0, 0, 0, 0, 0x99);
+
+  send_to(0, 8, &dest);
+  sending = OTHER;
+  num_frames[OTHER] = 0;
+  for(k = 0; k < num_frames[0]; k++) {
+    deliver(&frames[0][k]);
+  }
+  UNIT_TEST_ASSERT(received[0] == 0);
+  UNIT_TEST_ASSERT(num_frames[OTHER] == num_frames[0]);
+  UNIT_TEST_ASSERT(rfrag_ok(frames[OTHER], num_frames[OTHER]));
+
+  memcpy(frames[1], frames[OTHER], sizeof(frames[OTHER]));
+  num_frames[1] = num_frames[OTHER];
+  packets[0][7]--; /* The hop limit */
+  uip_ds6_addr_add(&dest, 0, ADDR_MANUAL);
+  for(k = 0; k < num_frames[1]; k++) {
+    deliver_from(&frames[1][k], &linkaddr_node_addr, &next_addr);
+  }
+  uip_ds6_addr_rm(uip_ds6_addr_lookup(&dest));
+  UNIT_TEST_ASSERT(received[0] == 1);
+  /* next_addr acknowledges to the peer, the peer to us */
+  UNIT_TEST_ASSERT(num_acks == 1);
+  num_acks = 0;
+  deliver_from(&acks[0], &next_addr, &linkaddr_node_addr);
+  acknowledge();
+  UNIT_TEST_ASSERT(num_frames[OTHER] == 0);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+#else /* SICSLOWPAN_CONF_SFR */
+/*---------------------------------------------------------------------------*/
+/* Run once SICSLOWPAN_REASS_MAXAGE has passed since two packets lost
+   their last fragment */
+UNIT_TEST_REGISTER(test_after_loss, "Reassembly after lost fragments");
+UNIT_TEST(test_after_loss)
+{
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(total_received == 4);
+  send(0, 8);
+  for(k = 0; k < num_frames[0]; k++) {
+    deliver(&frames[0][k]);
+  }
+  UNIT_TEST_ASSERT(received[0] == 1);
+  /* Counted as the new packet arrives */
+  UNIT_TEST_ASSERT(sicslowpan_frag_stat.rx_timeouts == 2);
+  UNIT_TEST_ASSERT(test_errors == 0);
+
+  UNIT_TEST_END();
+}
+#endif /* SICSLOWPAN_CONF_SFR */
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_stats, "Fragmentation statistics");
+UNIT_TEST(test_stats)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("sent %lu packets in %lu fragments, %lu dropped\n",
+         (unsigned long)sicslowpan_frag_stat.tx_packets,
+         (unsigned long)sicslowpan_frag_stat.tx_fragments,
+         (unsigned long)sicslowpan_frag_stat.tx_dropped);
+  printf("received %lu fragments, %lu packets, %lu fragments dropped, %lu timeouts\n",
+         (unsigned long)sicslowpan_frag_stat.rx_fragments,
+         (unsigned long)sicslowpan_frag_stat.rx_packets,
+         (unsigned long)sicslowpan_frag_stat.rx_dropped,
+         (unsigned long)sicslowpan_frag_stat.rx_timeouts);
+  UNIT_TEST_ASSERT(sicslowpan_frag_stat.tx_packets == 7);
+  UNIT_TEST_ASSERT(sicslowpan_frag_stat.tx_dropped == 0);
+  UNIT_TEST_ASSERT(sicslowpan_frag_stat.rx_dropped == 0);
+  UNIT_TEST_ASSERT(sicslowpan_frag_stat.rx_packets == total_received);
+#if SICSLOWPAN_CONF_SFR
+  printf("sent %lu fragments again, %lu RFRAG-ACKs sent, %lu received, %lu forwarded\n",
+         (unsigned long)sicslowpan_frag_stat.tx_retransmits,
+         (unsigned long)sicslowpan_frag_stat.acks_sent,
+         (unsigned long)sicslowpan_frag_stat.acks_received,
+         (unsigned long)sicslowpan_frag_stat.forwarded);
+  UNIT_TEST_ASSERT(sicslowpan_frag_stat.rx_timeouts == 0);
+  UNIT_TEST_ASSERT(sicslowpan_frag_stat.tx_retransmits > 0);
+  UNIT_TEST_ASSERT(sicslowpan_frag_stat.forwarded > 0);
+#endif /* SICSLOWPAN_CONF_SFR */
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  int k;
+
+  PROCESS_BEGIN();
+
+  memset(&peer_addr, 0, sizeof(peer_addr));
+  peer_addr.u8[0] = 0x02;
+  peer_addr.u8[LINKADDR_SIZE - 1] = 0x01;
+  rime_sniffer_add(&checker);
+  sicslowpan_frag_stats_reset();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_in_order);
+  UNIT_TEST_RUN(test_reversed);
+  UNIT_TEST_RUN(test_interleaved);
+
+#if SICSLOWPAN_CONF_SFR
+  UNIT_TEST_RUN(test_recovered);
+
+  /* The last fragment is lost, and no RFRAG-ACK comes. All fragments
+     are sent again after SICSLOWPAN_CONF_SFR_ACK_TIMEOUT. */
+  send(0, 7);
+  for(k = 0; k < num_frames[0] - 1; k++) {
+    deliver(&frames[0][k]);
+  }
+  sending = OTHER;
+  num_frames[OTHER] = 0;
+  etimer_set(&et, SICSLOWPAN_CONF_SFR_ACK_TIMEOUT + 1);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(test_timeout);
+
+  UNIT_TEST_RUN(test_forwarding);
+#else /* SICSLOWPAN_CONF_SFR */
+  /* Two packets lose their last fragment. Their reassembly is given up
+     after SICSLOWPAN_REASS_MAXAGE, and the next packet goes through. */
+  send(0, 6);
+  for(k = 0; k < num_frames[0] - 1; k++) {
+    deliver(&frames[0][k]);
+  }
+  send(1, 7);
+  for(k = 0; k < num_frames[1] - 1; k++) {
+    deliver(&frames[1][k]);
+  }
+  etimer_set(&et, CLOCK_SECOND * (SICSLOWPAN_REASS_MAXAGE + 16) / 16);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(test_after_loss);
+#endif /* SICSLOWPAN_CONF_SFR */
+
+  UNIT_TEST_RUN(test_stats);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/